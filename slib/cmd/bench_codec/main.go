@@ -0,0 +1,170 @@
+// Compares JSON and binary encodings of statestore log entries and object views
+package main
+
+import (
+	"encoding/json"
+	"flag"
+	"fmt"
+	"log"
+	"testing"
+
+	"cs.utexas.edu/zjia/faas/slib/common"
+	"cs.utexas.edu/zjia/faas/slib/statestore"
+)
+
+var FLAGS_numReplayLogs = flag.Int("num_replay_logs", 1000, "Number of log entries decoded in one replay")
+var FLAGS_numFields = flag.Int("num_fields", 32, "Number of fields in the object view")
+var FLAGS_arraySize = flag.Int("array_size", 64, "Size of the array field in the object view")
+
+func makeLogEntry(i int) *statestore.ObjectLogEntry {
+	ops := []*statestore.WriteOp{
+		{
+			OpType:  statestore.OP_NumberFetchAdd,
+			ObjName: "userid:12345",
+			Path:    "followers",
+			Value:   statestore.NumberValue(1),
+		},
+	}
+	if i%2 == 0 {
+		ops = append(ops, &statestore.WriteOp{
+			OpType:   statestore.OP_ArrayPushBackWithLimit,
+			ObjName:  "userid:12345",
+			Path:     "timeline",
+			Value:    statestore.StringValue(fmt.Sprintf("post:%016x", i)),
+			IntParam: *FLAGS_arraySize,
+		})
+	}
+	return &statestore.ObjectLogEntry{
+		LogType: statestore.LOG_NormalOp,
+		Ops:     ops,
+	}
+}
+
+func makeView() map[string]interface{} {
+	view := make(map[string]interface{})
+	for i := 0; i < *FLAGS_numFields; i++ {
+		if i%2 == 0 {
+			view[fmt.Sprintf("field%d", i)] = float64(i)
+		} else {
+			view[fmt.Sprintf("field%d", i)] = fmt.Sprintf("value-of-field-%d", i)
+		}
+	}
+	timeline := make([]interface{}, *FLAGS_arraySize)
+	for i := range timeline {
+		timeline[i] = fmt.Sprintf("post:%016x", i)
+	}
+	view["timeline"] = timeline
+	view["profile"] = map[string]interface{}{
+		"name":      "user",
+		"followers": float64(100),
+		"verified":  true,
+	}
+	return view
+}
+
+func encodeLogs(logs []*statestore.ObjectLogEntry, binary bool) [][]byte {
+	statestore.FLAGS_BinaryEncoding = binary
+	encoded := make([][]byte, len(logs))
+	for i, l := range logs {
+		encoded[i] = statestore.EncodeObjectLogEntry(l)
+	}
+	return encoded
+}
+
+func report(name string, result testing.BenchmarkResult) {
+	log.Printf("[INFO] %-36s %s %s", name, result.String(), result.MemString())
+}
+
+func main() {
+	flag.Parse()
+
+	logs := make([]*statestore.ObjectLogEntry, *FLAGS_numReplayLogs)
+	for i := range logs {
+		logs[i] = makeLogEntry(i)
+	}
+	for _, binary := range []bool{false, true} {
+		format := "JSON"
+		if binary {
+			format = "binary"
+		}
+		encoded := encodeLogs(logs, binary)
+		totalSize := 0
+		for _, data := range encoded {
+			totalSize += len(data)
+		}
+		log.Printf("[INFO] %s: average size of log entries = %.1f bytes",
+			format, float64(totalSize)/float64(len(encoded)))
+		report(format+" log entry encode", testing.Benchmark(func(b *testing.B) {
+			b.ReportAllocs()
+			for i := 0; i < b.N; i++ {
+				statestore.EncodeObjectLogEntry(logs[i%len(logs)])
+			}
+		}))
+		report(format+" log entry decode", testing.Benchmark(func(b *testing.B) {
+			b.ReportAllocs()
+			for i := 0; i < b.N; i++ {
+				if _, err := statestore.DecodeObjectLogEntry(encoded[i%len(encoded)]); err != nil {
+					b.Fatal(err)
+				}
+			}
+		}))
+		report(format+" replay decode", testing.Benchmark(func(b *testing.B) {
+			b.ReportAllocs()
+			for i := 0; i < b.N; i++ {
+				for _, data := range encoded {
+					if _, err := statestore.DecodeObjectLogEntry(data); err != nil {
+						b.Fatal(err)
+					}
+				}
+			}
+		}))
+	}
+
+	view := makeView()
+	jsonView, err := json.Marshal(view)
+	if err != nil {
+		panic(err)
+	}
+	encoder := common.NewBinaryEncoder(len(jsonView))
+	encoder.PutValue(view)
+	binaryView := encoder.Bytes()
+	// One log entry changes one field of the view
+	updated := common.CloneValue(view).(map[string]interface{})
+	updated["profile"].(map[string]interface{})["followers"] = float64(101)
+	encoder = common.NewBinaryEncoder(64)
+	encoder.PutObjectDelta(view, updated)
+	deltaView := encoder.Bytes()
+	log.Printf("[INFO] Object view size: JSON=%d bytes, binary=%d bytes, delta=%d bytes",
+		len(common.CompressData(jsonView)), len(common.CompressData(binaryView)),
+		len(common.CompressData(deltaView)))
+	report("JSON view decode", testing.Benchmark(func(b *testing.B) {
+		b.ReportAllocs()
+		for i := 0; i < b.N; i++ {
+			var contents interface{}
+			if err := json.Unmarshal(jsonView, &contents); err != nil {
+				b.Fatal(err)
+			}
+		}
+	}))
+	report("binary view decode", testing.Benchmark(func(b *testing.B) {
+		b.ReportAllocs()
+		for i := 0; i < b.N; i++ {
+			decoder := common.NewBinaryDecoder(binaryView)
+			decoder.Value()
+			if decoder.Err() != nil {
+				b.Fatal(decoder.Err())
+			}
+		}
+	}))
+	report("delta view decode", testing.Benchmark(func(b *testing.B) {
+		b.ReportAllocs()
+		for i := 0; i < b.N; i++ {
+			contents := common.CloneValue(view).(map[string]interface{})
+			decoder := common.NewBinaryDecoder(deltaView)
+			decoder.ApplyObjectDelta(contents)
+			if decoder.Err() != nil {
+				b.Fatal(decoder.Err())
+			}
+		}
+	}))
+}
@@ -0,0 +1,199 @@
+// Compares producer/consumer throughput of the library queue (Queue) and the
+// engine-side queue (ServerQueue), against an in-memory shared log with a
+// fixed latency per shared log operation
+package main
+
+import (
+	"context"
+	"flag"
+	"log"
+	"sync"
+	"sync/atomic"
+	"time"
+
+	slibsync "cs.utexas.edu/zjia/faas/slib/sync"
+
+	"cs.utexas.edu/zjia/faas/types"
+)
+
+var FLAGS_numProducers = flag.Int("num_producers", 4, "Number of producers")
+var FLAGS_numConsumers = flag.Int("num_consumers", 4, "Number of consumers")
+var FLAGS_numItems = flag.Int("num_items", 2000, "Number of items pushed by all producers")
+var FLAGS_opLatency = flag.Duration("op_latency", 200*time.Microsecond, "Latency of one shared log operation")
+
+// memEnv implements shared log operations used by queues. Other methods of
+// types.Environment are not implemented.
+type memEnv struct {
+	types.Environment
+
+	mu      sync.Mutex
+	logs    []*types.LogEntry
+	cursors map[uint64]uint64
+	numOps  uint64
+}
+
+func newMemEnv() *memEnv {
+	return &memEnv{
+		logs:    make([]*types.LogEntry, 0, 1024),
+		cursors: make(map[uint64]uint64),
+	}
+}
+
+func (env *memEnv) roundTrip() {
+	atomic.AddUint64(&env.numOps, 1)
+	time.Sleep(*FLAGS_opLatency)
+}
+
+func hasTag(logEntry *types.LogEntry, tag uint64) bool {
+	if tag == 0 {
+		return true
+	}
+	for _, t := range logEntry.Tags {
+		if t == tag {
+			return true
+		}
+	}
+	return false
+}
+
+func cloneLogEntry(logEntry *types.LogEntry) *types.LogEntry {
+	cloned := *logEntry
+	return &cloned
+}
+
+// Caller should hold env.mu
+func (env *memEnv) findNext(tag uint64, seqNum uint64) *types.LogEntry {
+	for i := seqNum; i < uint64(len(env.logs)); i++ {
+		if hasTag(env.logs[i], tag) {
+			return cloneLogEntry(env.logs[i])
+		}
+	}
+	return nil
+}
+
+func (env *memEnv) SharedLogAppend(ctx context.Context, tags []uint64, data []byte) (uint64, error) {
+	env.roundTrip()
+	env.mu.Lock()
+	defer env.mu.Unlock()
+	seqNum := uint64(len(env.logs))
+	env.logs = append(env.logs, &types.LogEntry{
+		SeqNum: seqNum,
+		Tags:   tags,
+		Data:   data,
+	})
+	return seqNum, nil
+}
+
+func (env *memEnv) SharedLogReadNext(ctx context.Context, tag uint64, seqNum uint64) (*types.LogEntry, error) {
+	env.roundTrip()
+	env.mu.Lock()
+	defer env.mu.Unlock()
+	return env.findNext(tag, seqNum), nil
+}
+
+func (env *memEnv) SharedLogReadNextBlock(ctx context.Context, tag uint64, seqNum uint64) (*types.LogEntry, error) {
+	return env.SharedLogReadNext(ctx, tag, seqNum)
+}
+
+func (env *memEnv) SharedLogReadPrev(ctx context.Context, tag uint64, seqNum uint64) (*types.LogEntry, error) {
+	env.roundTrip()
+	env.mu.Lock()
+	defer env.mu.Unlock()
+	if seqNum >= uint64(len(env.logs)) {
+		seqNum = uint64(len(env.logs))
+	} else {
+		seqNum++
+	}
+	for i := seqNum; i > 0; i-- {
+		if hasTag(env.logs[i-1], tag) {
+			return cloneLogEntry(env.logs[i-1]), nil
+		}
+	}
+	return nil, nil
+}
+
+func (env *memEnv) SharedLogSetAuxData(ctx context.Context, seqNum uint64, auxData []byte) error {
+	env.roundTrip()
+	env.mu.Lock()
+	defer env.mu.Unlock()
+	env.logs[seqNum].AuxData = auxData
+	return nil
+}
+
+// Same as the engine, pops of one queue are serialized at its cursor
+func (env *memEnv) SharedLogQueuePop(ctx context.Context, tag uint64) (*types.LogEntry, error) {
+	env.roundTrip()
+	env.mu.Lock()
+	defer env.mu.Unlock()
+	logEntry := env.findNext(tag, env.cursors[tag])
+	if logEntry != nil {
+		env.cursors[tag] = logEntry.SeqNum + 1
+	}
+	return logEntry, nil
+}
+
+func (env *memEnv) SharedLogQueuePopBlock(ctx context.Context, tag uint64) (*types.LogEntry, error) {
+	return env.SharedLogQueuePop(ctx, tag)
+}
+
+type queue interface {
+	Push(payload string) error
+	Pop() (string, error)
+}
+
+func runBenchmark(name string, newQueue func(env types.Environment) (queue, error)) {
+	env := newMemEnv()
+	var numPushed, numPopped int64
+	var wg sync.WaitGroup
+	startTime := time.Now()
+	for i := 0; i < *FLAGS_numProducers; i++ {
+		wg.Add(1)
+		go func() {
+			defer wg.Done()
+			q, err := newQueue(env)
+			if err != nil {
+				log.Fatalf("[FATAL] Failed to create queue: %v", err)
+			}
+			for atomic.AddInt64(&numPushed, 1) <= int64(*FLAGS_numItems) {
+				if err := q.Push("item"); err != nil {
+					log.Fatalf("[FATAL] Push failed: %v", err)
+				}
+			}
+		}()
+	}
+	for i := 0; i < *FLAGS_numConsumers; i++ {
+		wg.Add(1)
+		go func() {
+			defer wg.Done()
+			q, err := newQueue(env)
+			if err != nil {
+				log.Fatalf("[FATAL] Failed to create queue: %v", err)
+			}
+			for atomic.LoadInt64(&numPopped) < int64(*FLAGS_numItems) {
+				if _, err := q.Pop(); err == nil {
+					atomic.AddInt64(&numPopped, 1)
+				} else if !slibsync.IsQueueEmptyError(err) {
+					log.Fatalf("[FATAL] Pop failed: %v", err)
+				}
+			}
+		}()
+	}
+	wg.Wait()
+	elapsed := time.Since(startTime)
+	log.Printf("[INFO] %-12s %d items in %v, throughput=%.1f items/s, shared log ops per item=%.2f",
+		name, *FLAGS_numItems, elapsed, float64(*FLAGS_numItems)/elapsed.Seconds(),
+		float64(atomic.LoadUint64(&env.numOps))/float64(*FLAGS_numItems))
+}
+
+func main() {
+	flag.Parse()
+	ctx := context.Background()
+	log.Printf("[INFO] %d producers, %d consumers, latency of shared log ops = %v",
+		*FLAGS_numProducers, *FLAGS_numConsumers, *FLAGS_opLatency)
+	runBenchmark("Queue", func(env types.Environment) (queue, error) {
+		return slibsync.NewQueue(ctx, env, "bench")
+	})
+	runBenchmark("ServerQueue", func(env types.Environment) (queue, error) {
+		return slibsync.NewServerQueue(ctx, env, "bench")
+	})
+}
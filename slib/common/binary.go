@@ -0,0 +1,307 @@
+package common
+
+import (
+	"encoding/binary"
+	"fmt"
+	"math"
+	"reflect"
+)
+
+// Binary encoding of JSON-like values, i.e., nil, bool, float64, string,
+// []interface{} and map[string]interface{}, as produced by encoding/json
+const (
+	binaryNull = iota
+	binaryFalse
+	binaryTrue
+	binaryNumber
+	binaryString
+	binaryArray
+	binaryObject
+)
+
+// Ops in deltas of objects
+const (
+	deltaSet = iota
+	deltaDelete
+	deltaNested
+)
+
+type BinaryEncoder struct {
+	buf []byte
+}
+
+func NewBinaryEncoder(capacity int) *BinaryEncoder {
+	return &BinaryEncoder{buf: make([]byte, 0, capacity)}
+}
+
+func (e *BinaryEncoder) Bytes() []byte {
+	return e.buf
+}
+
+func (e *BinaryEncoder) PutByte(v byte) {
+	e.buf = append(e.buf, v)
+}
+
+func (e *BinaryEncoder) PutUvarint(v uint64) {
+	var tmp [binary.MaxVarintLen64]byte
+	n := binary.PutUvarint(tmp[:], v)
+	e.buf = append(e.buf, tmp[:n]...)
+}
+
+func (e *BinaryEncoder) PutVarint(v int64) {
+	var tmp [binary.MaxVarintLen64]byte
+	n := binary.PutVarint(tmp[:], v)
+	e.buf = append(e.buf, tmp[:n]...)
+}
+
+func (e *BinaryEncoder) PutFloat64(v float64) {
+	var tmp [8]byte
+	binary.LittleEndian.PutUint64(tmp[:], math.Float64bits(v))
+	e.buf = append(e.buf, tmp[:]...)
+}
+
+func (e *BinaryEncoder) PutString(v string) {
+	e.PutUvarint(uint64(len(v)))
+	e.buf = append(e.buf, v...)
+}
+
+func (e *BinaryEncoder) PutValue(v interface{}) {
+	switch v := v.(type) {
+	case nil:
+		e.PutByte(binaryNull)
+	case bool:
+		if v {
+			e.PutByte(binaryTrue)
+		} else {
+			e.PutByte(binaryFalse)
+		}
+	case float64:
+		e.PutByte(binaryNumber)
+		e.PutFloat64(v)
+	case int:
+		e.PutByte(binaryNumber)
+		e.PutFloat64(float64(v))
+	case string:
+		e.PutByte(binaryString)
+		e.PutString(v)
+	case []interface{}:
+		e.PutByte(binaryArray)
+		e.PutUvarint(uint64(len(v)))
+		for _, elem := range v {
+			e.PutValue(elem)
+		}
+	case map[string]interface{}:
+		e.PutByte(binaryObject)
+		e.PutUvarint(uint64(len(v)))
+		for key, elem := range v {
+			e.PutString(key)
+			e.PutValue(elem)
+		}
+	default:
+		panic(fmt.Sprintf("Unsupported type %T for binary encoding", v))
+	}
+}
+
+// CloneValue makes a deep copy of JSON-like value, faster than DeepCopy
+func CloneValue(v interface{}) interface{} {
+	switch v := v.(type) {
+	case []interface{}:
+		array := make([]interface{}, len(v))
+		for i, elem := range v {
+			array[i] = CloneValue(elem)
+		}
+		return array
+	case map[string]interface{}:
+		object := make(map[string]interface{}, len(v))
+		for key, elem := range v {
+			object[key] = CloneValue(elem)
+		}
+		return object
+	default:
+		return v
+	}
+}
+
+// PutObjectDelta encodes changes from `base` to `current`, which can be
+// applied to a copy of `base` with BinaryDecoder.ApplyObjectDelta
+func (e *BinaryEncoder) PutObjectDelta(base map[string]interface{}, current map[string]interface{}) {
+	numChanges := 0
+	for key, value := range current {
+		if baseValue, exists := base[key]; !exists || !reflect.DeepEqual(baseValue, value) {
+			numChanges++
+		}
+	}
+	for key := range base {
+		if _, exists := current[key]; !exists {
+			numChanges++
+		}
+	}
+	e.PutUvarint(uint64(numChanges))
+	for key, value := range current {
+		baseValue, exists := base[key]
+		if exists && reflect.DeepEqual(baseValue, value) {
+			continue
+		}
+		e.PutString(key)
+		baseObject, baseIsObject := baseValue.(map[string]interface{})
+		object, isObject := value.(map[string]interface{})
+		if exists && baseIsObject && isObject {
+			e.PutByte(deltaNested)
+			e.PutObjectDelta(baseObject, object)
+		} else {
+			e.PutByte(deltaSet)
+			e.PutValue(value)
+		}
+	}
+	for key := range base {
+		if _, exists := current[key]; !exists {
+			e.PutString(key)
+			e.PutByte(deltaDelete)
+		}
+	}
+}
+
+// BinaryDecoder keeps the first error, after which all reads return zero values
+type BinaryDecoder struct {
+	buf []byte
+	pos int
+	err error
+}
+
+func NewBinaryDecoder(data []byte) *BinaryDecoder {
+	return &BinaryDecoder{buf: data, pos: 0, err: nil}
+}
+
+func (d *BinaryDecoder) Err() error {
+	return d.err
+}
+
+func (d *BinaryDecoder) fail(what string) {
+	if d.err == nil {
+		d.err = fmt.Errorf("Failed to decode %s at offset %d", what, d.pos)
+	}
+}
+
+func (d *BinaryDecoder) Byte() byte {
+	if d.err != nil || d.pos >= len(d.buf) {
+		d.fail("byte")
+		return 0
+	}
+	v := d.buf[d.pos]
+	d.pos++
+	return v
+}
+
+func (d *BinaryDecoder) Uvarint() uint64 {
+	if d.err != nil {
+		return 0
+	}
+	v, n := binary.Uvarint(d.buf[d.pos:])
+	if n <= 0 {
+		d.fail("uvarint")
+		return 0
+	}
+	d.pos += n
+	return v
+}
+
+func (d *BinaryDecoder) Varint() int64 {
+	if d.err != nil {
+		return 0
+	}
+	v, n := binary.Varint(d.buf[d.pos:])
+	if n <= 0 {
+		d.fail("varint")
+		return 0
+	}
+	d.pos += n
+	return v
+}
+
+func (d *BinaryDecoder) Float64() float64 {
+	if d.err != nil || d.pos+8 > len(d.buf) {
+		d.fail("float64")
+		return 0
+	}
+	v := math.Float64frombits(binary.LittleEndian.Uint64(d.buf[d.pos:]))
+	d.pos += 8
+	return v
+}
+
+func (d *BinaryDecoder) String() string {
+	length := d.Uvarint()
+	if d.err != nil || uint64(len(d.buf)-d.pos) < length {
+		d.fail("string")
+		return ""
+	}
+	v := string(d.buf[d.pos : d.pos+int(length)])
+	d.pos += int(length)
+	return v
+}
+
+// Length of array or object, which takes at least one byte per element
+func (d *BinaryDecoder) length() int {
+	length := d.Uvarint()
+	if d.err != nil || uint64(len(d.buf)-d.pos) < length {
+		d.fail("length")
+		return 0
+	}
+	return int(length)
+}
+
+func (d *BinaryDecoder) Value() interface{} {
+	switch d.Byte() {
+	case binaryNull:
+		return nil
+	case binaryFalse:
+		return false
+	case binaryTrue:
+		return true
+	case binaryNumber:
+		return d.Float64()
+	case binaryString:
+		return d.String()
+	case binaryArray:
+		length := d.length()
+		array := make([]interface{}, length)
+		for i := 0; i < length && d.err == nil; i++ {
+			array[i] = d.Value()
+		}
+		return array
+	case binaryObject:
+		length := d.length()
+		object := make(map[string]interface{}, length)
+		for i := 0; i < length && d.err == nil; i++ {
+			key := d.String()
+			object[key] = d.Value()
+		}
+		return object
+	default:
+		d.fail("value type")
+		return nil
+	}
+}
+
+// ApplyObjectDelta applies changes encoded by BinaryEncoder.PutObjectDelta
+// to `object` in place
+func (d *BinaryDecoder) ApplyObjectDelta(object map[string]interface{}) {
+	numChanges := d.length()
+	for i := 0; i < numChanges && d.err == nil; i++ {
+		key := d.String()
+		switch d.Byte() {
+		case deltaSet:
+			object[key] = d.Value()
+		case deltaDelete:
+			delete(object, key)
+		case deltaNested:
+			nested, ok := object[key].(map[string]interface{})
+			if !ok {
+				d.fail("nested delta")
+				return
+			}
+			d.ApplyObjectDelta(nested)
+		default:
+			d.fail("delta op")
+		}
+	}
+}
@@ -7,3 +7,4 @@ const ObjectLogTagLowBits = 2
 const TxnHistoryLogTagLowBits = 3
 const QueueLogTagLowBits = 4
 const QueuePushLogTagLowBits = 5
+const ServerQueueLogTagLowBits = 6
@@ -0,0 +1,208 @@
+package statestore
+
+import (
+	"encoding/json"
+	"fmt"
+
+	"cs.utexas.edu/zjia/faas/slib/common"
+
+	"github.com/golang/snappy"
+)
+
+// Encoded log entries and aux data start with a zero byte followed by the
+// format version. Snappy-compressed JSON, written by older versions, never
+// starts with a zero byte, as its first byte is the varint-encoded length of
+// the (non-empty) JSON.
+const (
+	encodingMarker = 0x00
+
+	ENCODING_Binary      = 1
+	ENCODING_BinaryDelta = 2 // Object view as delta against a checkpoint
+)
+
+type viewDelta struct {
+	baseSeqNum uint64
+	data       []byte
+}
+
+func withEncodingHeader(version byte, body []byte) []byte {
+	compressed := snappy.Encode(nil, body)
+	encoded := make([]byte, 0, len(compressed)+2)
+	encoded = append(encoded, encodingMarker, version)
+	return append(encoded, compressed...)
+}
+
+// splitEncodingHeader returns version 0 for snappy-compressed JSON
+func splitEncodingHeader(encoded []byte) (byte, []byte, error) {
+	if len(encoded) >= 2 && encoded[0] == encodingMarker {
+		body, err := snappy.Decode(nil, encoded[2:])
+		return encoded[1], body, err
+	}
+	body, err := snappy.Decode(nil, encoded)
+	return 0, body, err
+}
+
+func putWriteOp(e *common.BinaryEncoder, op *WriteOp) {
+	e.PutUvarint(uint64(op.OpType))
+	e.PutString(op.ObjName)
+	e.PutString(op.Path)
+	// Same as JSON, contents of Object and Array values are not encoded
+	e.PutUvarint(uint64(op.Value.ValueType))
+	switch op.Value.ValueType {
+	case VALUE_Number:
+		e.PutFloat64(op.Value.NumberValue)
+	case VALUE_String:
+		e.PutString(op.Value.StringValue)
+	case VALUE_Bool:
+		e.PutValue(op.Value.BoolValue)
+	}
+	e.PutVarint(int64(op.IntParam))
+}
+
+func decodeWriteOp(d *common.BinaryDecoder) *WriteOp {
+	op := &WriteOp{
+		OpType:  int(d.Uvarint()),
+		ObjName: d.String(),
+		Path:    d.String(),
+	}
+	op.Value.ValueType = int(d.Uvarint())
+	switch op.Value.ValueType {
+	case VALUE_Number:
+		op.Value.NumberValue = d.Float64()
+	case VALUE_String:
+		op.Value.StringValue = d.String()
+	case VALUE_Bool:
+		op.Value.BoolValue, _ = d.Value().(bool)
+	}
+	op.IntParam = int(d.Varint())
+	return op
+}
+
+// EncodeObjectLogEntry encodes `l` in binary if FLAGS_BinaryEncoding is set,
+// otherwise as snappy-compressed JSON
+func EncodeObjectLogEntry(l *ObjectLogEntry) []byte {
+	if !FLAGS_BinaryEncoding {
+		encoded, err := json.Marshal(l)
+		if err != nil {
+			panic(err)
+		}
+		return common.CompressData(encoded)
+	}
+	e := common.NewBinaryEncoder(64)
+	e.PutUvarint(uint64(l.LogType))
+	e.PutUvarint(l.TxnId)
+	e.PutUvarint(uint64(len(l.Ops)))
+	for _, op := range l.Ops {
+		putWriteOp(e, op)
+	}
+	return withEncodingHeader(ENCODING_Binary, e.Bytes())
+}
+
+// DecodeObjectLogEntry decodes log entries of both formats
+func DecodeObjectLogEntry(encoded []byte) (*ObjectLogEntry, error) {
+	version, body, err := splitEncodingHeader(encoded)
+	if err != nil {
+		return nil, err
+	}
+	objectLog := &ObjectLogEntry{}
+	switch version {
+	case 0:
+		if err := json.Unmarshal(body, objectLog); err != nil {
+			return nil, err
+		}
+	case ENCODING_Binary:
+		d := common.NewBinaryDecoder(body)
+		objectLog.LogType = int(d.Uvarint())
+		objectLog.TxnId = d.Uvarint()
+		numOps := int(d.Uvarint())
+		if numOps > 0 {
+			objectLog.Ops = make([]*WriteOp, 0, numOps)
+		}
+		for i := 0; i < numOps && d.Err() == nil; i++ {
+			objectLog.Ops = append(objectLog.Ops, decodeWriteOp(d))
+		}
+		if d.Err() != nil {
+			return nil, d.Err()
+		}
+	default:
+		return nil, fmt.Errorf("Unknown encoding version %d of log entry", version)
+	}
+	return objectLog, nil
+}
+
+// encodeAuxData encodes aux data, including object views
+func encodeAuxData(data interface{}) []byte {
+	if !FLAGS_BinaryEncoding {
+		encoded, err := json.Marshal(data)
+		if err != nil {
+			panic(err)
+		}
+		return common.CompressData(encoded)
+	}
+	e := common.NewBinaryEncoder(256)
+	e.PutValue(data)
+	return withEncodingHeader(ENCODING_Binary, e.Bytes())
+}
+
+// encodeViewDelta encodes object view `contents` as delta against `base`,
+// the checkpoint at `baseSeqNum`
+func encodeViewDelta(base *ObjectView, contents map[string]interface{}) []byte {
+	baseContents, ok := base.contents.Data().(map[string]interface{})
+	if !ok {
+		return nil
+	}
+	e := common.NewBinaryEncoder(64)
+	e.PutUvarint(base.nextSeqNum - 1)
+	e.PutObjectDelta(baseContents, contents)
+	return withEncodingHeader(ENCODING_BinaryDelta, e.Bytes())
+}
+
+// decodeAuxData returns either decoded contents or delta of object view
+func decodeAuxData(encoded []byte) (map[string]interface{}, *viewDelta, error) {
+	version, body, err := splitEncodingHeader(encoded)
+	if err != nil {
+		return nil, nil, err
+	}
+	var contents interface{}
+	switch version {
+	case 0:
+		if err := json.Unmarshal(body, &contents); err != nil {
+			return nil, nil, err
+		}
+	case ENCODING_Binary:
+		d := common.NewBinaryDecoder(body)
+		contents = d.Value()
+		if d.Err() != nil {
+			return nil, nil, d.Err()
+		}
+	case ENCODING_BinaryDelta:
+		d := common.NewBinaryDecoder(body)
+		baseSeqNum := d.Uvarint()
+		if d.Err() != nil {
+			return nil, nil, d.Err()
+		}
+		return nil, &viewDelta{baseSeqNum: baseSeqNum, data: body}, nil
+	default:
+		return nil, nil, fmt.Errorf("Unknown encoding version %d of aux data", version)
+	}
+	if object, ok := contents.(map[string]interface{}); ok {
+		return object, nil, nil
+	} else {
+		return nil, nil, fmt.Errorf("Aux data is not an object")
+	}
+}
+
+// apply returns contents of object view by applying the delta to a copy of `base`
+func (delta *viewDelta) apply(base *ObjectView) (map[string]interface{}, error) {
+	contents, ok := common.CloneValue(base.contents.Data()).(map[string]interface{})
+	if !ok {
+		return nil, fmt.Errorf("Checkpoint is not an object")
+	}
+	d := common.NewBinaryDecoder(delta.data)
+	d.Uvarint()
+	d.ApplyObjectDelta(contents)
+	if d.Err() != nil {
+		return nil, d.Err()
+	}
+	return contents, nil
+}
@@ -2,10 +2,11 @@ package statestore
 
 import (
 	"context"
-	"encoding/json"
 	"fmt"
 	"log"
 	"os"
+	"strconv"
+	"sync"
 
 	"cs.utexas.edu/zjia/faas/slib/common"
 
@@ -19,6 +20,17 @@ import (
 var FLAGS_DisableAuxData bool = false
 var FLAGS_RedisForAuxData bool = false
 
+// Encode log entries and aux data in binary, instead of JSON
+var FLAGS_BinaryEncoding bool = false
+
+// Cache object views of NormalOp logs as deltas against the last checkpoint.
+// Requires binary encoding and checkpoints.
+var FLAGS_DeltaViews bool = false
+
+// Register a checkpoint of the object view after replaying this many logs.
+// Zero disables checkpoints.
+var FLAGS_CheckpointInterval int = 0
+
 var redisClient *redis.Client
 
 func init() {
@@ -35,6 +47,22 @@ func init() {
 		}
 		redisClient = redis.NewClient(opt)
 	}
+	if val, exists := os.LookupEnv("BINARY_ENCODING"); exists && val == "1" {
+		FLAGS_BinaryEncoding = true
+		log.Printf("[INFO] Binary encoding enabled")
+	}
+	if val, exists := os.LookupEnv("DELTA_VIEWS"); exists && val == "1" {
+		FLAGS_DeltaViews = true
+		log.Printf("[INFO] Delta-encoded object views enabled")
+	}
+	if val, exists := os.LookupEnv("CHECKPOINT_INTERVAL"); exists {
+		interval, err := strconv.Atoi(val)
+		if err != nil {
+			log.Fatalf("[FATAL] Failed to parse CHECKPOINT_INTERVAL %s: %v", val, err)
+		}
+		FLAGS_CheckpointInterval = interval
+		log.Printf("[INFO] Checkpoint interval set to %d", interval)
+	}
 }
 
 const (
@@ -48,6 +76,7 @@ const (
 type ObjectLogEntry struct {
 	seqNum   uint64
 	auxData  map[string]interface{}
+	auxDelta *viewDelta // Set instead of auxData for delta-encoded object view
 	writeSet map[string]bool
 
 	LogType int        `json:"t"`
@@ -73,12 +102,7 @@ func (l *ObjectLogEntry) fillWriteSet() {
 }
 
 func decodeLogEntry(logEntry *types.LogEntry) *ObjectLogEntry {
-	reader, err := common.DecompressReader(logEntry.Data)
-	if err != nil {
-		panic(err)
-	}
-	objectLog := &ObjectLogEntry{}
-	err = json.NewDecoder(reader).Decode(objectLog)
+	objectLog, err := DecodeObjectLogEntry(logEntry.Data)
 	if err != nil {
 		panic(err)
 	}
@@ -97,16 +121,12 @@ func decodeLogEntry(logEntry *types.LogEntry) *ObjectLogEntry {
 		auxData = logEntry.AuxData
 	}
 	if len(auxData) > 0 {
-		reader, err := common.DecompressReader(auxData)
-		if err != nil {
-			panic(err)
-		}
-		var contents map[string]interface{}
-		err = json.NewDecoder(reader).Decode(&contents)
+		contents, delta, err := decodeAuxData(auxData)
 		if err != nil {
 			panic(err)
 		}
 		objectLog.auxData = contents
+		objectLog.auxDelta = delta
 	}
 	objectLog.seqNum = logEntry.SeqNum
 	objectLog.fillWriteSet()
@@ -193,6 +213,9 @@ func (txnCommitLog *ObjectLogEntry) checkTxnCommitResult(env *envImpl) (bool, er
 }
 
 func (l *ObjectLogEntry) hasCachedObjectView(objName string) bool {
+	if l.LogType == LOG_NormalOp && l.auxDelta != nil {
+		return true
+	}
 	if l.auxData == nil {
 		return false
 	}
@@ -206,7 +229,24 @@ func (l *ObjectLogEntry) hasCachedObjectView(objName string) bool {
 	return false
 }
 
-func (l *ObjectLogEntry) loadCachedObjectView(objName string) *ObjectView {
+func (l *ObjectLogEntry) loadCachedObjectView(obj *ObjectRef) *ObjectView {
+	objName := obj.name
+	if l.LogType == LOG_NormalOp && l.auxDelta != nil {
+		base := obj.loadCheckpoint(l.auxDelta.baseSeqNum)
+		if base == nil {
+			// Checkpoint is gone, thus the view has to be rebuilt
+			return nil
+		}
+		contents, err := l.auxDelta.apply(base)
+		if err != nil {
+			panic(err)
+		}
+		return &ObjectView{
+			name:       objName,
+			nextSeqNum: l.seqNum + 1,
+			contents:   gabs.Wrap(contents),
+		}
+	}
 	if l.auxData == nil {
 		return nil
 	}
@@ -229,12 +269,20 @@ func (l *ObjectLogEntry) loadCachedObjectView(objName string) *ObjectView {
 	return nil
 }
 
-func (l *ObjectLogEntry) cacheObjectView(env *envImpl, view *ObjectView) {
+func (l *ObjectLogEntry) cacheObjectView(obj *ObjectRef, view *ObjectView) {
+	env := obj.env
 	if FLAGS_DisableAuxData {
 		return
 	}
 	if l.LogType == LOG_NormalOp {
 		if l.auxData == nil {
+			contents, isObject := view.contents.Data().(map[string]interface{})
+			if FLAGS_DeltaViews && FLAGS_BinaryEncoding && isObject && obj.checkpoint != nil {
+				if encoded := encodeViewDelta(obj.checkpoint, contents); encoded != nil {
+					env.setLogAuxDataEncoded(l.seqNum, encoded)
+					return
+				}
+			}
 			env.setLogAuxData(l.seqNum, view.contents.Data())
 		}
 	} else if l.LogType == LOG_TxnCommit {
@@ -293,13 +341,20 @@ func (obj *ObjectRef) syncToForward(tailSeqNum uint64) error {
 			}
 		}
 		if !objectLog.hasCachedObjectView(obj.name) {
-			objectLog.cacheObjectView(env, obj.view)
+			objectLog.cacheObjectView(obj, obj.view)
 		}
 	}
 	return nil
 }
 
 func (obj *ObjectRef) syncToBackward(tailSeqNum uint64) error {
+	if obj.view == nil && FLAGS_CheckpointInterval > 0 {
+		if found, err := obj.syncFromCheckpoint(tailSeqNum); err != nil {
+			return err
+		} else if found {
+			return nil
+		}
+	}
 	tag := objectLogTag(obj.nameHash)
 	env := obj.env
 	objectLogs := make([]*ObjectLogEntry, 0, 4)
@@ -340,7 +395,7 @@ func (obj *ObjectRef) syncToBackward(tailSeqNum uint64) error {
 				continue
 			}
 		}
-		view = objectLog.loadCachedObjectView(obj.name)
+		view = objectLog.loadCachedObjectView(obj)
 		if view == nil {
 			objectLogs = append(objectLogs, objectLog)
 		} else {
@@ -371,12 +426,158 @@ func (obj *ObjectRef) syncToBackward(tailSeqNum uint64) error {
 				view.applyWriteOp(op)
 			}
 		}
-		objectLog.cacheObjectView(env, view)
+		objectLog.cacheObjectView(obj, view)
 	}
 	obj.view = view
+	obj.maybeSetCheckpoint(len(objectLogs))
 	return nil
 }
 
+// syncFromCheckpoint loads the object view from the latest checkpoint before
+// tailSeqNum, then replays logs after it. Returns false if there is no checkpoint.
+func (obj *ObjectRef) syncFromCheckpoint(tailSeqNum uint64) (bool, error) {
+	tag := objectLogTag(obj.nameHash)
+	env := obj.env
+	querySeqNum := tailSeqNum
+	if querySeqNum != protocol.MaxLogSeqnum {
+		querySeqNum -= 1
+	}
+	checkpoint, err := env.faasEnv.SharedLogReadCheckpoint(env.faasCtx, tag, querySeqNum)
+	if err != nil {
+		return false, newRuntimeError(err.Error())
+	}
+	if checkpoint == nil {
+		return false, nil
+	}
+	base := decodeCheckpoint(obj.name, checkpoint)
+	if base == nil {
+		return false, nil
+	}
+	obj.checkpoint = base
+	view := base.Clone()
+
+	// Seqnums of the tail are known, thus logs can be fetched in parallel
+	logEntries := make([]*types.LogEntry, len(checkpoint.TailSeqNums))
+	errs := make([]error, len(checkpoint.TailSeqNums))
+	var wg sync.WaitGroup
+	for i, seqNum := range checkpoint.TailSeqNums {
+		wg.Add(1)
+		go func(i int, seqNum uint64) {
+			defer wg.Done()
+			logEntries[i], errs[i] = env.faasEnv.SharedLogReadNext(env.faasCtx, tag, seqNum)
+		}(i, seqNum)
+	}
+	wg.Wait()
+	for i, logEntry := range logEntries {
+		if errs[i] != nil {
+			return false, newRuntimeError(errs[i].Error())
+		}
+		if logEntry == nil || logEntry.SeqNum >= tailSeqNum {
+			break
+		}
+		objectLog := decodeLogEntry(logEntry)
+		if !objectLog.withinWriteSet(obj.name) {
+			continue
+		}
+		if objectLog.LogType == LOG_TxnCommit {
+			if committed, err := objectLog.checkTxnCommitResult(env); err != nil {
+				return false, err
+			} else if !committed {
+				continue
+			}
+		}
+		view.nextSeqNum = objectLog.seqNum + 1
+		for _, op := range objectLog.Ops {
+			if op.ObjName == obj.name {
+				view.applyWriteOp(op)
+			}
+		}
+		if !objectLog.hasCachedObjectView(obj.name) {
+			objectLog.cacheObjectView(obj, view)
+		}
+	}
+	obj.view = view
+	if !checkpoint.TailComplete {
+		if err := obj.syncToForward(tailSeqNum); err != nil {
+			return true, err
+		}
+	}
+	obj.maybeSetCheckpoint(len(checkpoint.TailSeqNums))
+	return true, nil
+}
+
+// maybeSetCheckpoint registers the current object view as a checkpoint, if
+// numReplayed logs have been replayed to build it
+func (obj *ObjectRef) maybeSetCheckpoint(numReplayed int) {
+	if FLAGS_CheckpointInterval <= 0 || numReplayed < FLAGS_CheckpointInterval {
+		return
+	}
+	if obj.view == nil || obj.view.nextSeqNum == 0 {
+		return
+	}
+	// Objects with the same name hash share the log tag, thus checkpoints
+	// record the object name
+	encoded := encodeAuxData(map[string]interface{}{
+		"n": obj.name,
+		"c": obj.view.contents.Data(),
+	})
+	if len(encoded) > protocol.MessageInlineDataSize/2 {
+		// Leave room for the tail in responses of checkpoint reads
+		return
+	}
+	tag := objectLogTag(obj.nameHash)
+	err := obj.env.faasEnv.SharedLogSetCheckpoint(obj.env.faasCtx, tag, obj.view.nextSeqNum-1, encoded)
+	if err != nil {
+		log.Printf("[WARN] Failed to set checkpoint for object %s: %v", obj.name, err)
+		return
+	}
+	obj.checkpoint = obj.view.Clone()
+}
+
+// decodeCheckpoint returns nil if the checkpoint is invalid or belongs to
+// another object, in which case the object view has to be rebuilt by replay
+func decodeCheckpoint(objName string, checkpoint *types.CheckpointEntry) *ObjectView {
+	decoded, _, err := decodeAuxData(checkpoint.Data)
+	if err != nil || decoded == nil {
+		log.Printf("[WARN] Invalid checkpoint of object %s (seqnum %#016x): %v",
+			objName, checkpoint.SeqNum, err)
+		return nil
+	}
+	if name, ok := decoded["n"].(string); !ok || name != objName {
+		return nil
+	}
+	contents, ok := decoded["c"]
+	if !ok {
+		log.Printf("[WARN] Checkpoint of object %s (seqnum %#016x) has no contents",
+			objName, checkpoint.SeqNum)
+		return nil
+	}
+	return &ObjectView{
+		name:       objName,
+		nextSeqNum: checkpoint.SeqNum + 1,
+		contents:   gabs.Wrap(contents),
+	}
+}
+
+// loadCheckpoint returns the checkpoint at `seqNum`, which is the base of
+// delta-encoded object views. Returns nil if it is no longer available.
+func (obj *ObjectRef) loadCheckpoint(seqNum uint64) *ObjectView {
+	if obj.checkpoint != nil && obj.checkpoint.nextSeqNum == seqNum+1 {
+		return obj.checkpoint
+	}
+	tag := objectLogTag(obj.nameHash)
+	checkpoint, err := obj.env.faasEnv.SharedLogReadCheckpoint(obj.env.faasCtx, tag, seqNum)
+	if err != nil || checkpoint == nil || checkpoint.SeqNum != seqNum {
+		return nil
+	}
+	base := decodeCheckpoint(obj.name, checkpoint)
+	if base == nil {
+		return nil
+	}
+	obj.checkpoint = base
+	return obj.checkpoint
+}
+
 func (obj *ObjectRef) appendNormalOpLog(ops []*WriteOp) (uint64 /* seqNum */, error) {
 	if len(ops) == 0 {
 		panic("Empty Ops for NormalOp log")
@@ -385,12 +586,8 @@ func (obj *ObjectRef) appendNormalOpLog(ops []*WriteOp) (uint64 /* seqNum */, er
 		LogType: LOG_NormalOp,
 		Ops:     ops,
 	}
-	encoded, err := json.Marshal(logEntry)
-	if err != nil {
-		panic(err)
-	}
 	tags := []uint64{objectLogTag(obj.nameHash)}
-	seqNum, err := obj.env.faasEnv.SharedLogAppend(obj.env.faasCtx, tags, common.CompressData(encoded))
+	seqNum, err := obj.env.faasEnv.SharedLogAppend(obj.env.faasCtx, tags, EncodeObjectLogEntry(logEntry))
 	if err != nil {
 		return 0, newRuntimeError(err.Error())
 	} else {
@@ -404,12 +601,8 @@ func (obj *ObjectRef) appendWriteLog(op *WriteOp) (uint64 /* seqNum */, error) {
 
 func (env *envImpl) appendTxnBeginLog() (uint64 /* seqNum */, error) {
 	logEntry := &ObjectLogEntry{LogType: LOG_TxnBegin}
-	encoded, err := json.Marshal(logEntry)
-	if err != nil {
-		panic(err)
-	}
 	tags := []uint64{common.TxnMetaLogTag}
-	seqNum, err := env.faasEnv.SharedLogAppend(env.faasCtx, tags, common.CompressData(encoded))
+	seqNum, err := env.faasEnv.SharedLogAppend(env.faasCtx, tags, EncodeObjectLogEntry(logEntry))
 	if err != nil {
 		return 0, newRuntimeError(err.Error())
 	} else {
@@ -419,24 +612,23 @@ func (env *envImpl) appendTxnBeginLog() (uint64 /* seqNum */, error) {
 }
 
 func (env *envImpl) setLogAuxData(seqNum uint64, data interface{}) error {
-	encoded, err := json.Marshal(data)
-	if err != nil {
-		panic(err)
-	}
-	compressed := common.CompressData(encoded)
+	return env.setLogAuxDataEncoded(seqNum, encodeAuxData(data))
+}
+
+func (env *envImpl) setLogAuxDataEncoded(seqNum uint64, encoded []byte) error {
 	if FLAGS_RedisForAuxData {
 		key := fmt.Sprintf("%#016x", seqNum)
-		result := redisClient.Set(context.Background(), key, compressed, 0)
+		result := redisClient.Set(context.Background(), key, encoded, 0)
 		if result.Err() != nil {
 			log.Fatalf("[FATAL] Failed to set AuxData in Redis: %v", result.Err())
 		}
 		return nil
 	}
-	err = env.faasEnv.SharedLogSetAuxData(env.faasCtx, seqNum, compressed)
+	err := env.faasEnv.SharedLogSetAuxData(env.faasCtx, seqNum, encoded)
 	if err != nil {
 		return newRuntimeError(err.Error())
 	} else {
-		// log.Printf("[DEBUG] Set AuxData for log (seqNum=%#016x): contents=%s", seqNum, string(encoded))
+		// log.Printf("[DEBUG] Set AuxData for log (seqNum=%#016x): size=%d", seqNum, len(encoded))
 		return nil
 	}
 }
@@ -19,8 +19,10 @@ type ObjectRef struct {
 	name     string
 	nameHash uint64
 	view     *ObjectView
-	multiCtx *multiContext
-	txnCtx   *txnContext
+	// Last checkpoint read or registered, base of delta-encoded views
+	checkpoint *ObjectView
+	multiCtx   *multiContext
+	txnCtx     *txnContext
 }
 
 func (env *envImpl) Object(name string) *ObjectRef {
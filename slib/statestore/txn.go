@@ -2,10 +2,10 @@ package statestore
 
 import (
 	"context"
-	"encoding/json"
 
 	"cs.utexas.edu/zjia/faas/slib/common"
 
+	"cs.utexas.edu/zjia/faas/protocol"
 	"cs.utexas.edu/zjia/faas/types"
 )
 
@@ -33,11 +33,8 @@ func CreateTxnEnv(ctx context.Context, faasEnv types.Environment) (Env, error) {
 
 func CreateReadOnlyTxnEnv(ctx context.Context, faasEnv types.Environment) (Env, error) {
 	env := CreateEnv(ctx, faasEnv).(*envImpl)
-	if tail, err := faasEnv.SharedLogCheckTail(ctx, 0 /* tag */); err == nil {
-		seqNum := uint64(0)
-		if tail != nil {
-			seqNum = tail.SeqNum + 1
-		}
+	// Pin a snapshot of the log, which includes all logs before seqNum
+	if _, seqNum, err := faasEnv.SharedLogSnapshotRead(ctx, nil, nil, protocol.InvalidLogSeqnum); err == nil {
 		env.txnCtx = &txnContext{
 			active:   true,
 			readonly: true,
@@ -64,12 +61,8 @@ func (env *envImpl) TxnAbort() error {
 		LogType: LOG_TxnAbort,
 		TxnId:   ctx.id,
 	}
-	encoded, err := json.Marshal(logEntry)
-	if err != nil {
-		panic(err)
-	}
 	tags := []uint64{common.TxnMetaLogTag, txnHistoryLogTag(ctx.id)}
-	if _, err := env.faasEnv.SharedLogAppend(env.faasCtx, tags, common.CompressData(encoded)); err == nil {
+	if _, err := env.faasEnv.SharedLogAppend(env.faasCtx, tags, EncodeObjectLogEntry(&logEntry)); err == nil {
 		return nil
 	} else {
 		return newRuntimeError(err.Error())
@@ -92,15 +85,11 @@ func (env *envImpl) TxnCommit() (bool /* committed */, error) {
 		Ops:     ctx.ops,
 		TxnId:   ctx.id,
 	}
-	encoded, err := json.Marshal(objectLog)
-	if err != nil {
-		panic(err)
-	}
 	tags := []uint64{common.TxnMetaLogTag, txnHistoryLogTag(ctx.id)}
 	for _, op := range ctx.ops {
 		tags = append(tags, objectLogTag(common.NameHash(op.ObjName)))
 	}
-	seqNum, err := env.faasEnv.SharedLogAppend(env.faasCtx, tags, common.CompressData(encoded))
+	seqNum, err := env.faasEnv.SharedLogAppend(env.faasCtx, tags, EncodeObjectLogEntry(objectLog))
 	if err != nil {
 		return false, newRuntimeError(err.Error())
 	}
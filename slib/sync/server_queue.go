@@ -0,0 +1,66 @@
+package sync
+
+import (
+	"context"
+	"fmt"
+
+	"cs.utexas.edu/zjia/faas/slib/common"
+
+	"cs.utexas.edu/zjia/faas/types"
+)
+
+// ServerQueue has the same interface as Queue, but its consumer cursor is
+// kept by the engine, thus each pop is one shared log op. The two queues
+// are not compatible with each other.
+type ServerQueue struct {
+	ctx context.Context
+	env types.Environment
+
+	name string
+	tag  uint64
+}
+
+func serverQueueLogTag(nameHash uint64) uint64 {
+	return (nameHash << common.LogTagReserveBits) + common.ServerQueueLogTagLowBits
+}
+
+func NewServerQueue(ctx context.Context, env types.Environment, name string) (*ServerQueue, error) {
+	return &ServerQueue{
+		ctx:  ctx,
+		env:  env,
+		name: name,
+		tag:  serverQueueLogTag(common.NameHash(name)),
+	}, nil
+}
+
+func (q *ServerQueue) Push(payload string) error {
+	if len(payload) == 0 {
+		return fmt.Errorf("Payload cannot be empty")
+	}
+	_, err := q.env.SharedLogAppend(q.ctx, []uint64{q.tag}, []byte(payload))
+	return err
+}
+
+func (q *ServerQueue) Pop() (string /* payload */, error) {
+	logEntry, err := q.env.SharedLogQueuePop(q.ctx, q.tag)
+	if err != nil {
+		return "", err
+	}
+	if logEntry == nil {
+		return "", kQueueEmptyError
+	}
+	return string(logEntry.Data), nil
+}
+
+// PopBlocking waits at most one second at the engine. `ctx` of the
+// queue should not be done before, otherwise the popped payload is lost.
+func (q *ServerQueue) PopBlocking() (string /* payload */, error) {
+	logEntry, err := q.env.SharedLogQueuePopBlock(q.ctx, q.tag)
+	if err != nil {
+		return "", err
+	}
+	if logEntry == nil {
+		return "", kQueueTimeoutError
+	}
+	return string(logEntry.Data), nil
+}
@@ -0,0 +1,173 @@
+#include "base/init.h"
+#include "base/common.h"
+#include "common/time.h"
+#include "log/bulk_sync.h"
+#include "log/db.h"
+#include "log/utils.h"
+#include "utils/bits.h"
+#include "utils/fs.h"
+
+#include <random>
+
+ABSL_FLAG(std::string, db_path, "/tmp/bench_bulk_sync", "");
+ABSL_FLAG(size_t, num_entries, 200000, "Number of log entries in the source DB");
+ABSL_FLAG(size_t, entry_size, 1024, "Size of log data in bytes");
+ABSL_FLAG(size_t, num_engines, 4, "Number of engines log entries come from");
+ABSL_FLAG(size_t, parallelism, 8, "Max number of outstanding chunks");
+ABSL_FLAG(double, drop_rate, 0.01,
+          "Fraction of responses dropped, which are failed by request timeout");
+
+using namespace faas;
+
+static constexpr uint32_t kLogSpaceId = 0x00010001;
+static constexpr uint16_t kSourceStorageId = 1;
+// The planner runs on a logical clock, advanced by one per round of requests
+static constexpr int64_t kRequestTimeout = 4;
+
+// Builds the payload of a BULK_SYNC_OK response as the source storage does,
+// holding log entries from `engine_id` within [start, end)
+static std::string ServeChunk(log::RocksDBBackend* source_db, uint16_t engine_id,
+                              uint32_t start, uint32_t end, uint32_t* count) {
+    std::vector<uint32_t> keys(end - start);
+    std::iota(keys.begin(), keys.end(), start);
+    std::string payload;
+    *count = 0;
+    source_db->MultiGetPinned(
+        kLogSpaceId, keys,
+        [&] (size_t index, std::span<const char> data) {
+            log::LogMetaData metadata;
+            log::UserTagVec user_tags;
+            std::span<const char> log_data;
+            CHECK(log_utils::ParseLogEntryInPlace(data, &metadata, &user_tags, &log_data));
+            if (bits::HighHalf64(metadata.localid) != engine_id) {
+                return;
+            }
+            uint32_t size = gsl::narrow_cast<uint32_t>(data.size());
+            payload.append(reinterpret_cast<const char*>(&keys[index]), sizeof(uint32_t));
+            payload.append(reinterpret_cast<const char*>(&size), sizeof(uint32_t));
+            payload.append(data.data(), data.size());
+            (*count)++;
+        }
+    );
+    return payload;
+}
+
+// Copies all log entries from `source_db` into a new target DB in chunks of
+// `chunk_entries`, then verifies the target holds the same bytes
+static void RunSync(log::RocksDBBackend* source_db, size_t chunk_entries) {
+    size_t num_entries = absl::GetFlag(FLAGS_num_entries);
+    size_t num_engines = absl::GetFlag(FLAGS_num_engines);
+    size_t parallelism = absl::GetFlag(FLAGS_parallelism);
+    std::string target_path = absl::GetFlag(FLAGS_db_path) + "_target";
+    if (fs_utils::Exists(target_path)) {
+        fs_utils::RemoveDirectoryRecursively(target_path);
+    }
+    auto target_db = std::make_unique<log::RocksDBBackend>(target_path);
+    target_db->InstallLogSpace(kLogSpaceId);
+
+    // Every dropped response costs one retry round, as there is only one source
+    log::BulkSyncPlanner planner(chunk_entries, /* max_retries= */ num_entries,
+                                 /* retry_interval_us= */ 0, kRequestTimeout);
+    for (size_t i = 1; i <= num_engines; i++) {
+        planner.AddTask(kLogSpaceId, gsl::narrow_cast<uint16_t>(i), { kSourceStorageId });
+    }
+    std::mt19937_64 rng(42);
+    std::bernoulli_distribution drop(absl::GetFlag(FLAGS_drop_rate));
+    std::vector<log::BulkSyncPlanner::Entry> entries;
+    absl::flat_hash_map<uint32_t, uint32_t> synced_positions;
+    size_t num_copied = 0;
+    size_t num_bytes = 0;
+    size_t num_dropped = 0;
+    size_t num_expired = 0;
+    int64_t now = 0;
+    int64_t start_timestamp = GetMonotonicMicroTimestamp();
+    while (planner.CheckStatus(&synced_positions, &num_copied)
+               == log::BulkSyncPlanner::kInProgress) {
+        num_expired += planner.ExpireChunks(now);
+        std::vector<log::BulkSyncPlanner::Request> requests;
+        while (planner.num_inflight() < parallelism) {
+            auto request = planner.NextRequest(now);
+            if (!request.has_value()) {
+                break;
+            }
+            requests.push_back(*request);
+        }
+        for (const log::BulkSyncPlanner::Request& request : requests) {
+            uint32_t end = std::min(request.end, gsl::narrow_cast<uint32_t>(num_entries));
+            uint32_t count;
+            std::string payload = ServeChunk(source_db, request.engine_id,
+                                             request.start, end, &count);
+            if (drop(rng)) {
+                num_dropped++;
+                continue;
+            }
+            CHECK(log::BulkSyncPlanner::ParsePayload(STRING_AS_SPAN(payload), count, &entries));
+            for (const auto& [seqnum_lowhalf, data] : entries) {
+                target_db->Put(kLogSpaceId, seqnum_lowhalf, data);
+            }
+            planner.OnChunkReceived(request.task_idx, request.start, end,
+                                    gsl::narrow_cast<uint32_t>(num_entries), entries.size());
+            num_bytes += payload.size();
+        }
+        now++;
+    }
+    double elapsed = (GetMonotonicMicroTimestamp() - start_timestamp) * 1e-6;
+    CHECK_EQ(planner.CheckStatus(&synced_positions, &num_copied), log::BulkSyncPlanner::kDone);
+    CHECK_EQ(num_copied, num_entries);
+    CHECK_EQ(synced_positions.at(kLogSpaceId), num_entries);
+
+    // Every log entry in the target DB must match the source byte by byte
+    for (size_t i = 0; i < num_entries; i++) {
+        uint32_t key = gsl::narrow_cast<uint32_t>(i);
+        auto expected = source_db->Get(kLogSpaceId, key);
+        auto copied = target_db->Get(kLogSpaceId, key);
+        CHECK(expected.has_value());
+        CHECK(copied.has_value()) << "Log entry " << i << " not copied";
+        CHECK(*expected == *copied) << "Log entry " << i << " corrupted";
+    }
+    LOG(INFO) << fmt::format("chunk_entries={}: copied {} log entries ({} bytes) in {:.3f}s, "
+                             "{:.1f} MB/s, {:.0f} entries/s, {} responses dropped, "
+                             "{} chunks expired",
+                             chunk_entries, num_copied, num_bytes, elapsed,
+                             num_bytes / std::max(elapsed, 1e-6) / (1 << 20),
+                             num_copied / std::max(elapsed, 1e-6),
+                             num_dropped, num_expired);
+    target_db.reset();
+    fs_utils::RemoveDirectoryRecursively(target_path);
+}
+
+int main(int argc, char* argv[]) {
+    base::InitMain(argc, argv);
+
+    std::string source_path = absl::GetFlag(FLAGS_db_path) + "_source";
+    if (fs_utils::Exists(source_path)) {
+        fs_utils::RemoveDirectoryRecursively(source_path);
+    }
+    auto source_db = std::make_unique<log::RocksDBBackend>(source_path);
+    source_db->InstallLogSpace(kLogSpaceId);
+    size_t num_entries = absl::GetFlag(FLAGS_num_entries);
+    size_t num_engines = absl::GetFlag(FLAGS_num_engines);
+    CHECK_GT(num_engines, 0U);
+    for (size_t i = 0; i < num_entries; i++) {
+        uint32_t seqnum_lowhalf = gsl::narrow_cast<uint32_t>(i);
+        uint16_t engine_id = gsl::narrow_cast<uint16_t>(i % num_engines + 1);
+        log::LogEntryProto log_entry;
+        log_entry.set_user_logspace(1);
+        log_entry.set_seqnum(bits::JoinTwo32(kLogSpaceId, seqnum_lowhalf));
+        log_entry.set_localid(bits::JoinTwo32(engine_id, seqnum_lowhalf));
+        log_entry.add_user_tags(i + 1);
+        log_entry.set_data(std::string(absl::GetFlag(FLAGS_entry_size),
+                                       static_cast<char>('a' + i % 26)));
+        std::string serialized;
+        CHECK(log_entry.SerializeToString(&serialized));
+        source_db->Put(kLogSpaceId, seqnum_lowhalf, STRING_AS_SPAN(serialized));
+    }
+
+    for (size_t chunk_entries : {64, 256, 1024}) {
+        RunSync(source_db.get(), chunk_entries);
+    }
+
+    source_db.reset();
+    fs_utils::RemoveDirectoryRecursively(source_path);
+    return 0;
+}
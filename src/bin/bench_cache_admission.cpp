@@ -0,0 +1,90 @@
+#include "base/init.h"
+#include "base/common.h"
+#include "common/time.h"
+#include "log/cache.h"
+#include "log/flags.h"
+#include "utils/bench.h"
+
+#include <random>
+
+ABSL_FLAG(size_t, num_keys, 100000, "Number of distinct log entries of point reads");
+ABSL_FLAG(size_t, num_ops, 1000000, "Number of point reads");
+ABSL_FLAG(size_t, scan_interval, 10000, "Number of point reads between two scans");
+ABSL_FLAG(size_t, scan_length, 20000, "Number of log entries read by each scan");
+ABSL_FLAG(size_t, log_size, 1024, "Size of each log entry");
+ABSL_FLAG(int, cache_cap_mb, 16, "");
+
+using namespace faas;
+
+// Point reads follow Zipf-like popularity, interleaved with scans, each of
+// which reads a range of log entries never read before, as a full replay
+// of a large tag. Reads are followed by Put on misses, as reads from storage.
+static void RunWithPolicy(const std::string& policy) {
+    absl::SetFlag(&FLAGS_slog_cache_policy, policy);
+    log::LRUCache cache(absl::GetFlag(FLAGS_cache_cap_mb));
+
+    size_t num_keys = absl::GetFlag(FLAGS_num_keys);
+    size_t num_ops = absl::GetFlag(FLAGS_num_ops);
+    size_t scan_interval = absl::GetFlag(FLAGS_scan_interval);
+    size_t scan_length = absl::GetFlag(FLAGS_scan_length);
+    std::mt19937 rng(42);
+    std::vector<double> weights(num_keys);
+    for (size_t i = 0; i < num_keys; i++) {
+        weights[i] = 1.0 / static_cast<double>(i + 1);
+    }
+    std::discrete_distribution<size_t> key_dist(weights.begin(), weights.end());
+    std::string log_data(absl::GetFlag(FLAGS_log_size), 'x');
+
+    auto read = [&] (uint64_t seqnum) -> bool {
+        if (cache.Get(seqnum).has_value()) {
+            return true;
+        }
+        log::LogMetaData metadata = {
+            .user_logspace = 0,
+            .seqnum = seqnum,
+            .localid = 0,
+            .num_tags = 0,
+            .data_size = log_data.size()
+        };
+        cache.Put(metadata, std::span<const uint64_t>(), STRING_AS_SPAN(log_data));
+        return false;
+    };
+
+    uint64_t next_scan_seqnum = num_keys + 1;
+    size_t point_hits = 0;
+    size_t scan_reads = 0;
+    size_t scan_hits = 0;
+    bench_utils::Samples<int32_t> get_time(num_ops);
+    for (size_t i = 0; i < num_ops; i++) {
+        if (scan_interval > 0 && i > 0 && i % scan_interval == 0) {
+            for (size_t j = 0; j < scan_length; j++) {
+                scan_reads++;
+                if (read(next_scan_seqnum++)) {
+                    scan_hits++;
+                }
+            }
+        }
+        uint64_t seqnum = key_dist(rng) + 1;
+        int64_t start_timestamp = GetMonotonicNanoTimestamp();
+        if (read(seqnum)) {
+            point_hits++;
+        }
+        get_time.Add(gsl::narrow_cast<int32_t>(GetMonotonicNanoTimestamp() - start_timestamp));
+    }
+
+    LOG(INFO) << fmt::format("policy={}: point read hit_rate={:.2f}%, "
+                             "scan reads={}, scan hit_rate={:.2f}%",
+                             policy, static_cast<double>(point_hits) / num_ops * 100,
+                             scan_reads,
+                             static_cast<double>(scan_hits) / std::max<size_t>(scan_reads, 1) * 100);
+    get_time.ReportStatistics("Point read time (ns)");
+}
+
+int main(int argc, char* argv[]) {
+    base::InitMain(argc, argv);
+
+    RunWithPolicy("lru");
+    RunWithPolicy("tinylfu");
+
+    return 0;
+}
@@ -0,0 +1,136 @@
+#include "base/init.h"
+#include "base/common.h"
+#include "common/protocol.h"
+#include "common/time.h"
+#include "utils/bench.h"
+
+#include <random>
+
+ABSL_FLAG(size_t, num_reads, 10000, "Number of simulated cold reads of the object");
+ABSL_FLAG(size_t, checkpoint_interval, 64,
+          "Number of log entries replayed before registering a checkpoint");
+ABSL_FLAG(size_t, max_checkpoints, 8, "Checkpoints kept per tag, same as Index");
+ABSL_FLAG(size_t, max_tail_size, 64, "Max tail returned with checkpoint, same as Index");
+ABSL_FLAG(int64_t, ipc_latency_us, 10,
+          "Latency of one shared log op between function and engine");
+ABSL_FLAG(int64_t, storage_read_latency_us, 100,
+          "Latency of reading one log entry (or checkpoint) from storage");
+
+using namespace faas;
+
+// Seqnums of one tag and its checkpoints, same as Index::PerSpaceIndex
+struct SimObjectIndex {
+    std::vector<uint32_t> seqnums;
+    std::map<uint64_t, uint16_t> checkpoints;
+
+    void AddCheckpoint(uint64_t seqnum, size_t max_checkpoints) {
+        checkpoints[seqnum] = 0;
+        if (checkpoints.size() > max_checkpoints) {
+            checkpoints.erase(checkpoints.begin());
+        }
+    }
+
+    // Returns false if not found
+    bool FindCheckpoint(uint64_t query_seqnum, uint64_t* seqnum) const {
+        auto iter = checkpoints.upper_bound(query_seqnum);
+        if (iter == checkpoints.begin()) {
+            return false;
+        }
+        *seqnum = (--iter)->first;
+        return true;
+    }
+
+    // Returns false if there are more than `max_size` seqnums
+    bool FindRange(uint64_t start_seqnum, uint64_t end_seqnum, size_t max_size,
+                   std::vector<uint64_t>* results) const {
+        auto iter = absl::c_upper_bound(seqnums, start_seqnum,
+                                        [] (uint64_t lhs, uint32_t rhs) { return lhs < rhs; });
+        for (; iter != seqnums.end() && *iter <= end_seqnum; iter++) {
+            if (results->size() >= max_size) {
+                return false;
+            }
+            results->push_back(*iter);
+        }
+        return true;
+    }
+};
+
+static void RunWithHistoryLength(size_t history_length) {
+    size_t checkpoint_interval = absl::GetFlag(FLAGS_checkpoint_interval);
+    size_t max_tail_size = absl::GetFlag(FLAGS_max_tail_size);
+    int64_t op_latency = absl::GetFlag(FLAGS_ipc_latency_us)
+                       + absl::GetFlag(FLAGS_storage_read_latency_us);
+    std::mt19937 rng(42);
+    // Log entries of the object are interleaved with ones of other objects
+    std::uniform_int_distribution<uint32_t> gap_dist(1, 16);
+    SimObjectIndex index;
+    uint32_t seqnum = 0;
+    for (size_t i = 0; i < history_length; i++) {
+        seqnum += gap_dist(rng);
+        index.seqnums.push_back(seqnum);
+        if ((i + 1) % checkpoint_interval == 0) {
+            index.AddCheckpoint(seqnum, absl::GetFlag(FLAGS_max_checkpoints));
+        }
+    }
+
+    // Reads happen at random positions among the last checkpoint interval
+    std::uniform_int_distribution<size_t> offset_dist(0, checkpoint_interval - 1);
+    bench_utils::Samples<int32_t> replay_latency(1 << 20);
+    bench_utils::Samples<int32_t> checkpoint_latency(1 << 20);
+    bench_utils::Samples<int32_t> lookup_time(1 << 20);
+    std::vector<uint64_t> tail;
+    size_t num_reads = absl::GetFlag(FLAGS_num_reads);
+    size_t num_incomplete = 0;
+    for (size_t i = 0; i < num_reads; i++) {
+        size_t num_entries = history_length - offset_dist(rng);
+        uint64_t query_seqnum = index.seqnums[num_entries - 1];
+
+        // Serial ReadPrev from the tail, each depending on the previous one
+        int64_t latency = gsl::narrow_cast<int64_t>(num_entries) * op_latency;
+        replay_latency.Add(gsl::narrow_cast<int32_t>(latency));
+
+        // One READ_CHECKPOINT, then tail log entries are read in parallel
+        int64_t start_timestamp = GetMonotonicNanoTimestamp();
+        uint64_t checkpoint_seqnum = protocol::kInvalidLogSeqNum;
+        bool found = index.FindCheckpoint(query_seqnum, &checkpoint_seqnum);
+        tail.clear();
+        bool tail_complete = found && index.FindRange(checkpoint_seqnum, query_seqnum,
+                                                      max_tail_size, &tail);
+        int64_t elapsed = GetMonotonicNanoTimestamp() - start_timestamp;
+        lookup_time.Add(gsl::narrow_cast<int32_t>(elapsed));
+        latency = op_latency + elapsed / 1000;
+        if (!found) {
+            latency += gsl::narrow_cast<int64_t>(num_entries) * op_latency;
+        } else {
+            if (!tail.empty()) {
+                latency += op_latency;
+            }
+            if (!tail_complete) {
+                // Remaining log entries are replayed with serial ReadNext
+                num_incomplete++;
+                uint64_t last_seqnum = tail.empty() ? checkpoint_seqnum : tail.back();
+                tail.clear();
+                index.FindRange(last_seqnum, query_seqnum, history_length, &tail);
+                latency += gsl::narrow_cast<int64_t>(tail.size()) * op_latency;
+            }
+        }
+        checkpoint_latency.Add(gsl::narrow_cast<int32_t>(latency));
+    }
+
+    LOG(INFO) << fmt::format("History of {} log entries, checkpoint_interval={}, "
+                             "incomplete tails={:.1f}%", history_length, checkpoint_interval,
+                             100.0 * num_incomplete / num_reads);
+    replay_latency.ReportStatistics("Full replay latency (us)");
+    checkpoint_latency.ReportStatistics("Checkpoint + tail replay latency (us)");
+    lookup_time.ReportStatistics("Time finding checkpoint and tail in index (ns)");
+}
+
+int main(int argc, char* argv[]) {
+    base::InitMain(argc, argv);
+
+    for (size_t history_length = 1000; history_length <= 1000000; history_length *= 10) {
+        RunWithHistoryLength(history_length);
+    }
+
+    return 0;
+}
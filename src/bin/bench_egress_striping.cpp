@@ -0,0 +1,183 @@
+#include "base/init.h"
+#include "base/common.h"
+#include "base/thread.h"
+#include "common/time.h"
+#include "common/protocol.h"
+#include "server/io_worker.h"
+#include "server/egress_hub.h"
+#include "utils/io.h"
+#include "utils/socket.h"
+
+#include <sys/socket.h>
+#include <netinet/in.h>
+
+ABSL_FLAG(size_t, max_streams, 8, "Run with 1, 2, 4, ... up to this number of streams");
+ABSL_FLAG(size_t, payload_bytesize, 1024, "Payload size of each message");
+ABSL_FLAG(size_t, flush_bytesize, 1 << 20, "Total size of messages in each flush");
+ABSL_FLAG(size_t, num_flushes, 2048, "Number of flushes to send");
+ABSL_FLAG(size_t, max_inflight_flushes, 4,
+          "Stop sending new flushes when EgressHub queue depth exceeds this many flushes");
+
+using namespace faas;
+
+using protocol::SharedLogMessage;
+using server::IOWorker;
+using server::EgressHub;
+
+static constexpr size_t kIOWorkerBufferSize = 65536;
+
+struct BenchState {
+    EgressHub* hub;
+    std::span<const char> flush;
+    size_t message_size;
+    size_t num_flushes;
+    size_t sent_flushes;
+    size_t total_bytes;
+    std::atomic<size_t> received_bytes;
+    std::atomic<size_t> received_messages;
+    absl::Notification all_received;
+};
+
+// Runs on the IOWorker's event loop. Each invocation queues one flush worth
+// of messages, which EgressHub sends (and stripes) at the end of this event
+// loop iteration.
+static void SendNextFlush(IOWorker* io_worker, BenchState* state) {
+    size_t max_queue_depth = state->flush.size() * absl::GetFlag(FLAGS_max_inflight_flushes);
+    if (state->hub->queue_depth() >= max_queue_depth) {
+        io_worker->ScheduleTimer(state->hub, absl::Microseconds(50), [io_worker, state] () {
+            SendNextFlush(io_worker, state);
+        });
+        return;
+    }
+    for (size_t offset = 0; offset < state->flush.size(); offset += state->message_size) {
+        state->hub->SendMessage(state->flush.subspan(offset, state->message_size));
+    }
+    state->sent_flushes++;
+    if (state->sent_flushes < state->num_flushes) {
+        io_worker->ScheduleFunction(state->hub, [io_worker, state] () {
+            SendNextFlush(io_worker, state);
+        });
+    }
+}
+
+// Parses stripes like IngressConnection with striping enabled
+static void Receiver(int sockfd, BenchState* state) {
+    std::vector<char> payload;
+    while (true) {
+        protocol::StripeHeader stripe_header;
+        bool eof = false;
+        if (!io_utils::RecvMessage(sockfd, &stripe_header, &eof)) {
+            CHECK(eof);
+            break;
+        }
+        size_t stripe_remaining_size = stripe_header.size;
+        while (stripe_remaining_size > 0) {
+            SharedLogMessage message;
+            CHECK(io_utils::RecvMessage(sockfd, &message, nullptr));
+            payload.resize(message.payload_size);
+            CHECK(io_utils::RecvData(sockfd, payload.data(), payload.size(), nullptr));
+            state->received_messages.fetch_add(1);
+            size_t message_size = sizeof(SharedLogMessage) + payload.size();
+            CHECK_GE(stripe_remaining_size, message_size);
+            stripe_remaining_size -= message_size;
+            if (state->received_bytes.fetch_add(message_size) + message_size
+                    == state->total_bytes) {
+                state->all_received.Notify();
+            }
+        }
+    }
+}
+
+static void RunWithStreams(size_t num_streams, std::span<const char> flush,
+                           size_t message_size) {
+    uint16_t port;
+    int listen_fd = utils::TcpSocketBindArbitraryPort("127.0.0.1", &port);
+    CHECK(listen_fd != -1);
+    PCHECK(listen(listen_fd, gsl::narrow_cast<int>(num_streams)) == 0);
+    struct sockaddr_in addr;
+    CHECK(utils::ResolveTcpAddr(&addr, fmt::format("127.0.0.1:{}", port)));
+
+    IOWorker io_worker("Bench", kIOWorkerBufferSize);
+    int pipe_fds[2] = { -1, -1 };
+    PCHECK(socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, pipe_fds) == 0);
+    io_worker.Start(pipe_fds[1]);
+
+    // Same as ServerBase::RegisterConnection
+    auto hub = std::make_unique<EgressHub>(0, &addr, num_streams);
+    hub->EnableStriping();
+    hub->set_id(0);
+    EgressHub* hub_ptr = hub.get();
+    PCHECK(write(pipe_fds[0], &hub_ptr, __FAAS_PTR_SIZE) == __FAAS_PTR_SIZE);
+
+    BenchState state;
+    state.hub = hub.get();
+    state.flush = flush;
+    state.message_size = message_size;
+    state.num_flushes = absl::GetFlag(FLAGS_num_flushes);
+    state.sent_flushes = 0;
+    state.total_bytes = flush.size() * state.num_flushes;
+    state.received_bytes.store(0);
+    state.received_messages.store(0);
+
+    std::vector<std::unique_ptr<base::Thread>> threads;
+    for (size_t i = 0; i < num_streams; i++) {
+        int recv_fd = accept4(listen_fd, nullptr, nullptr, SOCK_CLOEXEC);
+        PCHECK(recv_fd != -1);
+        threads.emplace_back(new base::Thread(
+            fmt::format("Receiver-{}", i),
+            [recv_fd, &state] () {
+                Receiver(recv_fd, &state);
+                PCHECK(close(recv_fd) == 0);
+            }
+        ));
+        threads.back()->Start();
+    }
+    // Let EgressHub mark all connections ready, otherwise early flushes
+    // are striped over fewer connections
+    absl::SleepFor(absl::Milliseconds(100));
+
+    int64_t start_timestamp = GetMonotonicMicroTimestamp();
+    io_worker.ScheduleFunction(hub.get(), [&io_worker, &state] () {
+        SendNextFlush(&io_worker, &state);
+    });
+    state.all_received.WaitForNotification();
+    int64_t elapsed_time = GetMonotonicMicroTimestamp() - start_timestamp;
+
+    LOG(INFO) << fmt::format("streams={}: {:.1f} MB/s, {:.1f} K messages/s, elapsed {} ms",
+                             num_streams,
+                             static_cast<double>(state.total_bytes) / elapsed_time,
+                             static_cast<double>(state.received_messages.load())
+                                 / elapsed_time * 1e3,
+                             elapsed_time / 1000);
+
+    // Closing the hub closes its sockets, which lets receivers see EOF
+    io_worker.ScheduleStop();
+    io_worker.WaitForFinish();
+    for (const auto& thread : threads) {
+        thread->Join();
+    }
+    PCHECK(close(pipe_fds[0]) == 0);
+    PCHECK(close(listen_fd) == 0);
+}
+
+int main(int argc, char* argv[]) {
+    base::InitMain(argc, argv);
+
+    size_t message_size = sizeof(SharedLogMessage) + absl::GetFlag(FLAGS_payload_bytesize);
+    size_t num_messages = std::max<size_t>(
+        1, absl::GetFlag(FLAGS_flush_bytesize) / message_size);
+    std::vector<char> flush(num_messages * message_size, 0);
+    for (size_t i = 0; i < num_messages; i++) {
+        SharedLogMessage* message = reinterpret_cast<SharedLogMessage*>(
+            flush.data() + i * message_size);
+        message->op_type = static_cast<uint16_t>(protocol::SharedLogOpType::REPLICATE);
+        message->payload_size = gsl::narrow_cast<uint32_t>(
+            absl::GetFlag(FLAGS_payload_bytesize));
+    }
+
+    for (size_t n = 1; n <= absl::GetFlag(FLAGS_max_streams); n *= 2) {
+        RunWithStreams(n, VECTOR_AS_CHAR_SPAN(flush), message_size);
+    }
+
+    return 0;
+}
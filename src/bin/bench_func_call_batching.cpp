@@ -0,0 +1,113 @@
+#include "base/init.h"
+#include "base/common.h"
+#include "base/thread.h"
+#include "common/time.h"
+#include "common/protocol.h"
+#include "utils/io.h"
+#include "utils/bench.h"
+
+ABSL_FLAG(size_t, num_calls, 200000, "Number of no-op function calls");
+ABSL_FLAG(size_t, input_size, 16, "Size of inline input of each call");
+ABSL_FLAG(size_t, max_batch_size, 16, "Run with batch size 1, 2, 4, ... up to this value");
+
+using namespace faas;
+
+using protocol::FuncCall;
+using protocol::FuncCallHelper;
+using protocol::Message;
+using protocol::MessageHelper;
+
+// Simulated FuncWorker running a no-op function, which reads dispatch messages
+// from `input_fd` and writes completions to `output_fd`, similar to the Go
+// worker library
+static void FuncWorkerMain(int input_fd, int output_fd) {
+    Message message;
+    std::vector<Message> responses;
+    while (io_utils::RecvMessage(input_fd, &message, nullptr)) {
+        responses.clear();
+        auto run_func = [&responses] (const Message& dispatch_func_call_message) {
+            FuncCall func_call = MessageHelper::GetFuncCall(dispatch_func_call_message);
+            responses.push_back(MessageHelper::NewFuncCallComplete(func_call, 0));
+        };
+        if (MessageHelper::IsFuncCallBatch(message)) {
+            MessageHelper::ForEachInFuncCallBatch(message, run_func);
+        } else {
+            run_func(message);
+        }
+        CHECK(io_utils::SendData(
+            output_fd, reinterpret_cast<const char*>(responses.data()),
+            responses.size() * sizeof(Message)));
+    }
+}
+
+static void RunWithBatchSize(size_t batch_size) {
+    size_t num_calls = absl::GetFlag(FLAGS_num_calls);
+    std::string input(absl::GetFlag(FLAGS_input_size), 'x');
+    int dispatch_pipe[2];
+    int completion_pipe[2];
+    PCHECK(pipe(dispatch_pipe) == 0);
+    PCHECK(pipe(completion_pipe) == 0);
+    base::Thread worker_thread("FuncWorker", [&] () {
+        FuncWorkerMain(dispatch_pipe[0], completion_pipe[1]);
+    });
+    worker_thread.Start();
+
+    bench_utils::Samples<int32_t> round_trip_time(num_calls);
+    uint32_t next_call_id = 0;
+    size_t completed_calls = 0;
+    int64_t start_timestamp = GetMonotonicMicroTimestamp();
+    // All calls are queued from the beginning, so every dispatch takes a full
+    // batch, same as Dispatcher::DispatchPendingFuncCall under queueing
+    while (completed_calls < num_calls) {
+        Message batch_message = MessageHelper::NewDispatchFuncCallBatch(1);
+        size_t n = 0;
+        while (n < batch_size && completed_calls + n < num_calls) {
+            Message message = MessageHelper::NewDispatchFuncCall(
+                FuncCallHelper::New(/* func_id= */ 1, /* client_id= */ 0, next_call_id++));
+            MessageHelper::SetInlineData(&message, input);
+            if (n > 0 && static_cast<size_t>(batch_message.payload_size)
+                           + MessageHelper::FuncCallBatchEntrySize(message)
+                         > MESSAGE_INLINE_DATA_SIZE) {
+                break;
+            }
+            if (batch_size == 1) {
+                batch_message = message;
+            } else {
+                MessageHelper::AppendToFuncCallBatch(&batch_message, message);
+            }
+            n++;
+        }
+        int64_t dispatch_timestamp = GetMonotonicMicroTimestamp();
+        batch_message.send_timestamp = dispatch_timestamp;
+        CHECK(io_utils::SendMessage(dispatch_pipe[1], batch_message));
+        for (size_t i = 0; i < n; i++) {
+            Message response;
+            CHECK(io_utils::RecvMessage(completion_pipe[0], &response, nullptr));
+            CHECK(MessageHelper::IsFuncCallComplete(response));
+            round_trip_time.Add(gsl::narrow_cast<int32_t>(
+                GetMonotonicMicroTimestamp() - dispatch_timestamp));
+        }
+        completed_calls += n;
+    }
+    int64_t elapsed_time = GetMonotonicMicroTimestamp() - start_timestamp;
+
+    PCHECK(close(dispatch_pipe[1]) == 0);
+    worker_thread.Join();
+    PCHECK(close(dispatch_pipe[0]) == 0);
+    PCHECK(close(completion_pipe[0]) == 0);
+    PCHECK(close(completion_pipe[1]) == 0);
+
+    LOG(INFO) << fmt::format("batch_size={}: {:.1f} K calls/s",
+                             batch_size, static_cast<double>(num_calls) / elapsed_time * 1e3);
+    round_trip_time.ReportStatistics("Dispatch to completion time (us)");
+}
+
+int main(int argc, char* argv[]) {
+    base::InitMain(argc, argv);
+
+    for (size_t n = 1; n <= absl::GetFlag(FLAGS_max_batch_size); n *= 2) {
+        RunWithBatchSize(n);
+    }
+
+    return 0;
+}
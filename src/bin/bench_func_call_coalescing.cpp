@@ -0,0 +1,172 @@
+#include "base/init.h"
+#include "base/common.h"
+#include "base/thread.h"
+#include "common/time.h"
+#include "utils/bench.h"
+#include "utils/hash.h"
+#include "utils/random.h"
+
+ABSL_FLAG(size_t, num_workers, 8, "Number of simulated FuncWorkers");
+ABSL_FLAG(size_t, num_bursts, 20, "Number of request bursts");
+ABSL_FLAG(size_t, burst_size, 1000, "Number of calls in each burst");
+ABSL_FLAG(size_t, num_distinct_inputs, 10, "Number of distinct inputs in each burst");
+ABSL_FLAG(size_t, input_size, 64, "Size of each input");
+ABSL_FLAG(absl::Duration, processing_time, absl::Microseconds(200),
+          "Processing time of each call");
+
+using namespace faas;
+
+// Simulated Dispatcher with a fixed pool of workers. With coalescing enabled,
+// calls identical to an in-flight call attach to it (same as
+// Dispatcher::TryCoalesceFuncCall) and complete together with it.
+class SimulatedDispatcher {
+public:
+    SimulatedDispatcher(size_t num_workers, bool coalesce_calls)
+        : coalesce_calls_(coalesce_calls), stopped_(false),
+          executed_calls_(0), coalesced_calls_(0), completed_calls_(0),
+          latency_(1 << 20) {
+        for (size_t i = 0; i < num_workers; i++) {
+            workers_.emplace_back(new base::Thread(
+                fmt::format("Worker-{}", i), absl::bind_front(&SimulatedDispatcher::WorkerMain, this)));
+        }
+        for (const auto& worker : workers_) {
+            worker->Start();
+        }
+    }
+
+    ~SimulatedDispatcher() {
+        {
+            absl::MutexLock lk(&mu_);
+            stopped_ = true;
+            cv_.SignalAll();
+        }
+        for (const auto& worker : workers_) {
+            worker->Join();
+        }
+    }
+
+    void NewCall(const std::string& input) {
+        absl::MutexLock lk(&mu_);
+        int64_t timestamp = GetMonotonicMicroTimestamp();
+        uint64_t input_hash = hash::xxHash64(STRING_AS_SPAN(input));
+        if (coalesce_calls_ && inflight_calls_.contains(input_hash)
+                && inflight_calls_[input_hash].input == input) {
+            inflight_calls_[input_hash].coalesced_timestamps.push_back(timestamp);
+            coalesced_calls_++;
+            return;
+        }
+        if (coalesce_calls_ && !inflight_calls_.contains(input_hash)) {
+            inflight_calls_[input_hash].input = input;
+        }
+        pending_calls_.push(std::make_pair(input_hash, timestamp));
+        cv_.Signal();
+    }
+
+    void WaitForCompletion(size_t num_calls) {
+        absl::MutexLock lk(&mu_);
+        while (completed_calls_ < num_calls) {
+            cv_.Wait(&mu_);
+        }
+    }
+
+    void Report(int64_t elapsed_time) {
+        absl::MutexLock lk(&mu_);
+        LOG(INFO) << fmt::format("coalesce_calls={}: {:.1f} K calls/s, executed={}, coalesced={}",
+                                 coalesce_calls_,
+                                 static_cast<double>(completed_calls_) / elapsed_time * 1e3,
+                                 executed_calls_, coalesced_calls_);
+        latency_.ReportStatistics("Call latency (us)");
+    }
+
+private:
+    struct InflightCall {
+        std::string          input;
+        std::vector<int64_t> coalesced_timestamps;
+    };
+
+    bool coalesce_calls_;
+    absl::Mutex mu_;
+    absl::CondVar cv_;
+    bool stopped_ ABSL_GUARDED_BY(mu_);
+    std::queue<std::pair</* input_hash */ uint64_t, /* timestamp */ int64_t>>
+        pending_calls_ ABSL_GUARDED_BY(mu_);
+    absl::flat_hash_map</* input_hash */ uint64_t, InflightCall>
+        inflight_calls_ ABSL_GUARDED_BY(mu_);
+    size_t executed_calls_ ABSL_GUARDED_BY(mu_);
+    size_t coalesced_calls_ ABSL_GUARDED_BY(mu_);
+    size_t completed_calls_ ABSL_GUARDED_BY(mu_);
+    bench_utils::Samples<int32_t> latency_ ABSL_GUARDED_BY(mu_);
+    std::vector<std::unique_ptr<base::Thread>> workers_;
+
+    void WorkerMain() {
+        absl::Duration processing_time = absl::GetFlag(FLAGS_processing_time);
+        while (true) {
+            uint64_t input_hash;
+            int64_t timestamp;
+            {
+                absl::MutexLock lk(&mu_);
+                while (!stopped_ && pending_calls_.empty()) {
+                    cv_.Wait(&mu_);
+                }
+                if (stopped_) {
+                    return;
+                }
+                std::tie(input_hash, timestamp) = pending_calls_.front();
+                pending_calls_.pop();
+            }
+            absl::SleepFor(processing_time);
+            {
+                absl::MutexLock lk(&mu_);
+                int64_t current_timestamp = GetMonotonicMicroTimestamp();
+                executed_calls_++;
+                completed_calls_++;
+                latency_.Add(gsl::narrow_cast<int32_t>(current_timestamp - timestamp));
+                if (coalesce_calls_ && inflight_calls_.contains(input_hash)) {
+                    for (int64_t coalesced_timestamp :
+                            inflight_calls_[input_hash].coalesced_timestamps) {
+                        completed_calls_++;
+                        latency_.Add(gsl::narrow_cast<int32_t>(
+                            current_timestamp - coalesced_timestamp));
+                    }
+                    inflight_calls_.erase(input_hash);
+                }
+                cv_.SignalAll();
+            }
+        }
+    }
+
+    DISALLOW_COPY_AND_ASSIGN(SimulatedDispatcher);
+};
+
+static void RunBench(bool coalesce_calls) {
+    size_t burst_size = absl::GetFlag(FLAGS_burst_size);
+    size_t num_bursts = absl::GetFlag(FLAGS_num_bursts);
+    std::vector<std::string> inputs;
+    for (size_t i = 0; i < absl::GetFlag(FLAGS_num_distinct_inputs); i++) {
+        std::string input(absl::GetFlag(FLAGS_input_size), 'x');
+        memcpy(input.data(), &i, std::min(input.size(), sizeof(size_t)));
+        inputs.push_back(std::move(input));
+    }
+
+    SimulatedDispatcher dispatcher(absl::GetFlag(FLAGS_num_workers), coalesce_calls);
+    int64_t start_timestamp = GetMonotonicMicroTimestamp();
+    for (size_t i = 0; i < num_bursts; i++) {
+        for (size_t j = 0; j < burst_size; j++) {
+            size_t idx = gsl::narrow_cast<size_t>(
+                utils::GetRandomInt(0, gsl::narrow_cast<int>(inputs.size())));
+            dispatcher.NewCall(inputs[idx]);
+        }
+        dispatcher.WaitForCompletion((i + 1) * burst_size);
+    }
+    int64_t elapsed_time = GetMonotonicMicroTimestamp() - start_timestamp;
+    dispatcher.Report(elapsed_time);
+}
+
+int main(int argc, char* argv[]) {
+    base::InitMain(argc, argv);
+
+    RunBench(/* coalesce_calls= */ false);
+    RunBench(/* coalesce_calls= */ true);
+
+    return 0;
+}
@@ -0,0 +1,94 @@
+#include "base/init.h"
+#include "base/common.h"
+#include "common/time.h"
+#include "utils/bench.h"
+
+#include <random>
+
+ABSL_FLAG(size_t, num_entries, 1000000, "Number of log entries in the simulated index");
+ABSL_FLAG(size_t, num_tags, 1000, "Number of distinct tags");
+ABSL_FLAG(size_t, num_queries, 10000, "Number of count queries");
+ABSL_FLAG(int64_t, read_latency_us, 200,
+          "Latency of reading one log entry, for estimating counting by scanning");
+
+using namespace faas;
+
+using SeqnumVec = std::vector<uint32_t>;
+
+// Same as Index::PerSpaceIndex::Count
+static uint32_t IndexCount(const SeqnumVec& seqnums, uint32_t start, uint32_t end) {
+    auto first = absl::c_lower_bound(seqnums, start);
+    auto last = std::upper_bound(first, seqnums.end(), end);
+    return gsl::narrow_cast<uint32_t>(last - first);
+}
+
+// Counting with READ_NEXT, which takes one index lookup and one log read
+// for every entry in the range
+static uint32_t ScanCount(const SeqnumVec& seqnums, uint32_t start, uint32_t end,
+                          size_t* entries_read) {
+    uint32_t count = 0;
+    uint32_t seqnum = start;
+    while (true) {
+        auto iter = absl::c_lower_bound(seqnums, seqnum);
+        if (iter == seqnums.end() || *iter > end) {
+            break;
+        }
+        (*entries_read)++;
+        count++;
+        seqnum = *iter + 1;
+    }
+    return count;
+}
+
+int main(int argc, char* argv[]) {
+    base::InitMain(argc, argv);
+
+    size_t num_entries = absl::GetFlag(FLAGS_num_entries);
+    size_t num_tags = absl::GetFlag(FLAGS_num_tags);
+    size_t num_queries = absl::GetFlag(FLAGS_num_queries);
+    std::mt19937 rng(42);
+    // Zipf-like tag popularity, so that both hot and cold tags are queried
+    std::vector<double> weights(num_tags);
+    for (size_t i = 0; i < num_tags; i++) {
+        weights[i] = 1.0 / static_cast<double>(i + 1);
+    }
+    std::discrete_distribution<size_t> tag_dist(weights.begin(), weights.end());
+    std::vector<SeqnumVec> seqnums_by_tag(num_tags);
+    for (size_t i = 0; i < num_entries; i++) {
+        seqnums_by_tag[tag_dist(rng)].push_back(gsl::narrow_cast<uint32_t>(i));
+    }
+
+    std::uniform_int_distribution<uint32_t> seqnum_dist(
+        0, gsl::narrow_cast<uint32_t>(num_entries - 1));
+    bench_utils::Samples<int32_t> index_count_time(1 << 20);
+    bench_utils::Samples<int32_t> scan_count_time(1 << 20);
+    size_t entries_read = 0;
+    for (size_t i = 0; i < num_queries; i++) {
+        const SeqnumVec& seqnums = seqnums_by_tag[tag_dist(rng)];
+        uint32_t start = seqnum_dist(rng);
+        uint32_t end = seqnum_dist(rng);
+        if (start > end) {
+            std::swap(start, end);
+        }
+        int64_t start_timestamp = GetMonotonicNanoTimestamp();
+        uint32_t count = IndexCount(seqnums, start, end);
+        index_count_time.Add(gsl::narrow_cast<int32_t>(
+            GetMonotonicNanoTimestamp() - start_timestamp));
+        start_timestamp = GetMonotonicNanoTimestamp();
+        uint32_t scanned_count = ScanCount(seqnums, start, end, &entries_read);
+        scan_count_time.Add(gsl::narrow_cast<int32_t>(
+            GetMonotonicNanoTimestamp() - start_timestamp));
+        CHECK_EQ(count, scanned_count);
+    }
+
+    index_count_time.ReportStatistics("COUNT op index time (ns)");
+    scan_count_time.ReportStatistics("Scanning index time, excluding log reads (ns)");
+    double avg_entries_read = static_cast<double>(entries_read) / num_queries;
+    LOG(INFO) << fmt::format("Scanning reads {:.1f} log entries per query, "
+                             "est. {:.1f}ms per query with read_latency={}us",
+                             avg_entries_read,
+                             avg_entries_read * absl::GetFlag(FLAGS_read_latency_us) / 1e3,
+                             absl::GetFlag(FLAGS_read_latency_us));
+
+    return 0;
+}
@@ -0,0 +1,224 @@
+#include "base/init.h"
+#include "base/common.h"
+#include "common/time.h"
+
+#include <random>
+
+ABSL_FLAG(size_t, num_entries, 1000000, "Number of log entries in the simulated index");
+ABSL_FLAG(size_t, num_tags, 4, "Number of query tags");
+ABSL_FLAG(double, tag_density, 0.1, "Probability of a log entry carrying each query tag");
+ABSL_FLAG(int64_t, read_latency_us, 200,
+          "Latency of reading one log entry, for estimating client-side filtering");
+
+using namespace faas;
+
+using SeqnumVec = std::vector<uint32_t>;
+
+// Same as GallopSearch in log/index.cpp
+template<class Iter, class Pred>
+Iter GallopSearch(Iter first, Iter last, Pred pred) {
+    size_t step = 1;
+    while (static_cast<size_t>(last - first) > step) {
+        Iter probe = first + step;
+        if (!pred(*probe)) {
+            return std::partition_point(first, probe, pred);
+        }
+        first = probe + 1;
+        step *= 2;
+    }
+    return std::partition_point(first, last, pred);
+}
+
+// Same as Index::PerSpaceIndex::IntersectNext, with positions kept across
+// calls as successive ReadNext queries move forward
+static bool IntersectNext(const std::vector<const SeqnumVec*>& tag_seqnums,
+                          std::vector<SeqnumVec::const_iterator>* iters,
+                          uint32_t candidate, uint32_t* result) {
+    size_t num_matched = 0;
+    size_t i = 0;
+    while (num_matched < tag_seqnums.size()) {
+        auto iter = GallopSearch((*iters)[i], tag_seqnums[i]->cend(),
+                                 [candidate] (uint32_t seqnum) {
+                                     return seqnum < candidate;
+                                 });
+        if (iter == tag_seqnums[i]->cend()) {
+            return false;
+        }
+        (*iters)[i] = iter;
+        if (*iter == candidate) {
+            num_matched++;
+        } else {
+            candidate = *iter;
+            num_matched = 1;
+        }
+        i = (i + 1) % tag_seqnums.size();
+    }
+    *result = candidate;
+    return true;
+}
+
+static bool FindNext(const SeqnumVec& seqnums, uint32_t query_seqnum, uint32_t* result) {
+    auto iter = absl::c_lower_bound(seqnums, query_seqnum);
+    if (iter == seqnums.end()) {
+        return false;
+    }
+    *result = *iter;
+    return true;
+}
+
+struct Result {
+    size_t  matched;
+    size_t  entries_read;
+    int64_t index_time_ns;
+};
+
+static void ReportResult(std::string_view name, const Result& result) {
+    int64_t read_latency_us = absl::GetFlag(FLAGS_read_latency_us);
+    LOG(INFO) << fmt::format("{}: matched={}, entries_read={}, index_time={:.1f}ms "
+                             "({:.1f}ns per matched entry), est. read time={:.1f}s",
+                             name, result.matched, result.entries_read,
+                             static_cast<double>(result.index_time_ns) / 1e6,
+                             static_cast<double>(result.index_time_ns)
+                                 / std::max<size_t>(result.matched, 1),
+                             static_cast<double>(result.entries_read * read_latency_us) / 1e6);
+}
+
+// Multi-tag READ_NEXT_MT queries with AND semantics: only matching entries are read
+static Result MultiTagAnd(const std::vector<SeqnumVec>& seqnums_by_tag) {
+    std::vector<const SeqnumVec*> tag_seqnums;
+    for (const SeqnumVec& seqnums : seqnums_by_tag) {
+        tag_seqnums.push_back(&seqnums);
+    }
+    absl::c_sort(tag_seqnums, [] (const SeqnumVec* lhs, const SeqnumVec* rhs) {
+        return lhs->size() < rhs->size();
+    });
+    std::vector<SeqnumVec::const_iterator> iters;
+    for (const SeqnumVec* seqnums : tag_seqnums) {
+        iters.push_back(seqnums->begin());
+    }
+    Result result = { .matched = 0, .entries_read = 0, .index_time_ns = 0 };
+    int64_t start_timestamp = GetMonotonicNanoTimestamp();
+    uint32_t seqnum = 0;
+    uint32_t found;
+    while (IntersectNext(tag_seqnums, &iters, seqnum, &found)) {
+        result.matched++;
+        result.entries_read++;
+        seqnum = found + 1;
+    }
+    result.index_time_ns = GetMonotonicNanoTimestamp() - start_timestamp;
+    return result;
+}
+
+// Client-side filtering for AND semantics: read every entry of the first
+// tag, and check the other tags of each entry read
+static Result FilterAnd(const std::vector<SeqnumVec>& seqnums_by_tag,
+                        const std::vector<absl::flat_hash_set<uint32_t>>& tag_sets) {
+    Result result = { .matched = 0, .entries_read = 0, .index_time_ns = 0 };
+    int64_t start_timestamp = GetMonotonicNanoTimestamp();
+    uint32_t seqnum = 0;
+    uint32_t found;
+    while (FindNext(seqnums_by_tag[0], seqnum, &found)) {
+        result.entries_read++;
+        bool matched = true;
+        for (size_t i = 1; i < tag_sets.size(); i++) {
+            if (!tag_sets[i].contains(found)) {
+                matched = false;
+                break;
+            }
+        }
+        if (matched) {
+            result.matched++;
+        }
+        seqnum = found + 1;
+    }
+    result.index_time_ns = GetMonotonicNanoTimestamp() - start_timestamp;
+    return result;
+}
+
+// Multi-tag READ_NEXT_MT queries with OR semantics
+static Result MultiTagOr(const std::vector<SeqnumVec>& seqnums_by_tag) {
+    Result result = { .matched = 0, .entries_read = 0, .index_time_ns = 0 };
+    int64_t start_timestamp = GetMonotonicNanoTimestamp();
+    uint32_t seqnum = 0;
+    while (true) {
+        bool found = false;
+        uint32_t min_seqnum = 0;
+        for (const SeqnumVec& seqnums : seqnums_by_tag) {
+            uint32_t tmp;
+            if (FindNext(seqnums, seqnum, &tmp) && (!found || tmp < min_seqnum)) {
+                min_seqnum = tmp;
+                found = true;
+            }
+        }
+        if (!found) {
+            break;
+        }
+        result.matched++;
+        result.entries_read++;
+        seqnum = min_seqnum + 1;
+    }
+    result.index_time_ns = GetMonotonicNanoTimestamp() - start_timestamp;
+    return result;
+}
+
+// Client-side filtering for OR semantics: read every entry, and check its tags
+static Result FilterOr(const SeqnumVec& all_seqnums,
+                       const std::vector<absl::flat_hash_set<uint32_t>>& tag_sets) {
+    Result result = { .matched = 0, .entries_read = 0, .index_time_ns = 0 };
+    int64_t start_timestamp = GetMonotonicNanoTimestamp();
+    uint32_t seqnum = 0;
+    uint32_t found;
+    while (FindNext(all_seqnums, seqnum, &found)) {
+        result.entries_read++;
+        for (const auto& tag_set : tag_sets) {
+            if (tag_set.contains(found)) {
+                result.matched++;
+                break;
+            }
+        }
+        seqnum = found + 1;
+    }
+    result.index_time_ns = GetMonotonicNanoTimestamp() - start_timestamp;
+    return result;
+}
+
+int main(int argc, char* argv[]) {
+    base::InitMain(argc, argv);
+
+    size_t num_entries = absl::GetFlag(FLAGS_num_entries);
+    size_t num_tags = absl::GetFlag(FLAGS_num_tags);
+    CHECK_GE(num_tags, 2U);
+    std::mt19937 rng(42);
+    std::bernoulli_distribution has_tag(absl::GetFlag(FLAGS_tag_density));
+    SeqnumVec all_seqnums;
+    std::vector<SeqnumVec> seqnums_by_tag(num_tags);
+    std::vector<absl::flat_hash_set<uint32_t>> tag_sets(num_tags);
+    for (size_t i = 0; i < num_entries; i++) {
+        uint32_t seqnum = gsl::narrow_cast<uint32_t>(i);
+        all_seqnums.push_back(seqnum);
+        for (size_t j = 0; j < num_tags; j++) {
+            if (has_tag(rng)) {
+                seqnums_by_tag[j].push_back(seqnum);
+                tag_sets[j].insert(seqnum);
+            }
+        }
+    }
+
+    for (size_t n = 2; n <= num_tags; n++) {
+        std::vector<SeqnumVec> tags(seqnums_by_tag.begin(), seqnums_by_tag.begin() + n);
+        std::vector<absl::flat_hash_set<uint32_t>> sets(tag_sets.begin(), tag_sets.begin() + n);
+        LOG(INFO) << fmt::format("{} query tags", n);
+        Result multi_tag_and = MultiTagAnd(tags);
+        Result filter_and = FilterAnd(tags, sets);
+        CHECK_EQ(multi_tag_and.matched, filter_and.matched);
+        ReportResult("AND multi-tag query", multi_tag_and);
+        ReportResult("AND client-side filtering", filter_and);
+        Result multi_tag_or = MultiTagOr(tags);
+        Result filter_or = FilterOr(all_seqnums, sets);
+        CHECK_EQ(multi_tag_or.matched, filter_or.matched);
+        ReportResult("OR multi-tag query", multi_tag_or);
+        ReportResult("OR client-side filtering", filter_or);
+    }
+
+    return 0;
+}
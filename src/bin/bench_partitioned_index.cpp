@@ -0,0 +1,152 @@
+#include "base/init.h"
+#include "base/common.h"
+#include "common/time.h"
+#include "utils/bench.h"
+#include "utils/hash.h"
+
+#include <random>
+
+ABSL_FLAG(size_t, num_entries, 2000000, "Number of log entries in the simulated index");
+ABSL_FLAG(size_t, num_tags, 100000, "Number of distinct tags");
+ABSL_FLAG(size_t, tags_per_entry, 2, "Number of tags of each log entry");
+ABSL_FLAG(size_t, index_replicas, 3, "Number of index engines of the physical log");
+ABSL_FLAG(size_t, num_queries, 100000, "Number of tag queries");
+ABSL_FLAG(int64_t, hop_latency_us, 50,
+          "Latency of one engine-to-engine hop, for estimating query latency");
+
+using namespace faas;
+
+// Same layout as Index::PerSpaceIndex
+struct SimIndex {
+    absl::flat_hash_map</* seqnum */ uint32_t, uint16_t> engine_ids;
+    std::vector<uint32_t> seqnums;
+    absl::flat_hash_map</* tag */ uint64_t, std::vector<uint32_t>> seqnums_by_tag;
+
+    void Add(uint32_t seqnum, std::span<const uint64_t> tags) {
+        engine_ids[seqnum] = 0;
+        seqnums.push_back(seqnum);
+        for (uint64_t tag : tags) {
+            seqnums_by_tag[tag].push_back(seqnum);
+        }
+    }
+
+    bool FindPrev(uint64_t tag, uint32_t query_seqnum, uint32_t* result) const {
+        auto iter = seqnums_by_tag.find(tag);
+        if (iter == seqnums_by_tag.end()) {
+            return false;
+        }
+        const std::vector<uint32_t>& tag_seqnums = iter->second;
+        auto seqnum_iter = absl::c_upper_bound(tag_seqnums, query_seqnum);
+        if (seqnum_iter == tag_seqnums.begin()) {
+            return false;
+        }
+        *result = *(--seqnum_iter);
+        return true;
+    }
+
+    // Estimated from container capacities, where each slot of a swiss table
+    // takes one control byte besides the slot itself
+    size_t MemoryUsage() const {
+        size_t total = engine_ids.capacity() * (sizeof(std::pair<uint32_t, uint16_t>) + 1);
+        total += seqnums.capacity() * sizeof(uint32_t);
+        total += seqnums_by_tag.capacity()
+               * (sizeof(std::pair<uint64_t, std::vector<uint32_t>>) + 1);
+        for (const auto& [tag, tag_seqnums] : seqnums_by_tag) {
+            total += tag_seqnums.capacity() * sizeof(uint32_t);
+        }
+        return total;
+    }
+};
+
+// Same as View::Sequencer::GetIndexEngineNodeForTag
+static size_t PartitionOf(uint64_t tag, size_t num_partitions) {
+    return hash::xxHash64(tag) % num_partitions;
+}
+
+int main(int argc, char* argv[]) {
+    base::InitMain(argc, argv);
+
+    size_t num_entries = absl::GetFlag(FLAGS_num_entries);
+    size_t num_tags = absl::GetFlag(FLAGS_num_tags);
+    size_t tags_per_entry = absl::GetFlag(FLAGS_tags_per_entry);
+    size_t num_partitions = absl::GetFlag(FLAGS_index_replicas);
+    std::mt19937 rng(42);
+    // Zipf-like tag popularity
+    std::vector<double> weights(num_tags);
+    for (size_t i = 0; i < num_tags; i++) {
+        weights[i] = 1.0 / static_cast<double>(i + 1);
+    }
+    std::discrete_distribution<uint64_t> tag_dist(weights.begin(), weights.end());
+
+    SimIndex full_index;
+    std::vector<SimIndex> partitions(num_partitions);
+    std::vector<uint64_t> tags(tags_per_entry);
+    std::vector<uint64_t> partition_tags;
+    for (size_t i = 0; i < num_entries; i++) {
+        uint32_t seqnum = gsl::narrow_cast<uint32_t>(i);
+        for (size_t j = 0; j < tags_per_entry; j++) {
+            tags[j] = tag_dist(rng) + 1;
+        }
+        full_index.Add(seqnum, tags);
+        // Same as PartitionIndexData in log/storage_base.cpp
+        for (size_t p = 0; p < num_partitions; p++) {
+            partition_tags.clear();
+            for (uint64_t tag : tags) {
+                if (PartitionOf(tag, num_partitions) == p) {
+                    partition_tags.push_back(tag);
+                }
+            }
+            partitions[p].Add(seqnum, partition_tags);
+        }
+    }
+
+    size_t full_memory = full_index.MemoryUsage();
+    size_t max_partition_memory = 0;
+    for (const SimIndex& partition : partitions) {
+        max_partition_memory = std::max(max_partition_memory, partition.MemoryUsage());
+    }
+    LOG(INFO) << fmt::format("Memory per index engine: replicated={:.1f}MB, "
+                             "partitioned={:.1f}MB (max of {} partitions)",
+                             static_cast<double>(full_memory) / (1 << 20),
+                             static_cast<double>(max_partition_memory) / (1 << 20),
+                             num_partitions);
+
+    std::uniform_int_distribution<uint32_t> seqnum_dist(
+        0, gsl::narrow_cast<uint32_t>(num_entries - 1));
+    size_t num_queries = absl::GetFlag(FLAGS_num_queries);
+    bench_utils::Samples<int32_t> full_query_time(1 << 20);
+    bench_utils::Samples<int32_t> partition_query_time(1 << 20);
+    size_t remote_queries = 0;
+    for (size_t i = 0; i < num_queries; i++) {
+        uint64_t tag = tag_dist(rng) + 1;
+        uint32_t query_seqnum = seqnum_dist(rng);
+        uint32_t result = 0;
+        uint32_t partition_result = 0;
+        int64_t start_timestamp = GetMonotonicNanoTimestamp();
+        bool found = full_index.FindPrev(tag, query_seqnum, &result);
+        full_query_time.Add(gsl::narrow_cast<int32_t>(
+            GetMonotonicNanoTimestamp() - start_timestamp));
+        start_timestamp = GetMonotonicNanoTimestamp();
+        size_t p = PartitionOf(tag, num_partitions);
+        bool partition_found = partitions[p].FindPrev(tag, query_seqnum, &partition_result);
+        partition_query_time.Add(gsl::narrow_cast<int32_t>(
+            GetMonotonicNanoTimestamp() - start_timestamp));
+        CHECK_EQ(found, partition_found);
+        CHECK_EQ(result, partition_result);
+        // Queries made on an index engine are local with replicated index,
+        // but need one more hop unless the engine owns the partition
+        if (p != i % num_partitions) {
+            remote_queries++;
+        }
+    }
+    full_query_time.ReportStatistics("Replicated index lookup time (ns)");
+    partition_query_time.ReportStatistics("Partitioned index lookup time (ns)");
+    double remote_ratio = static_cast<double>(remote_queries) / num_queries;
+    LOG(INFO) << fmt::format("Partitioned index: {:.1f}% queries from index engines are remote, "
+                             "est. {:.1f}us added per query with hop_latency={}us",
+                             remote_ratio * 100,
+                             remote_ratio * 2 * absl::GetFlag(FLAGS_hop_latency_us),
+                             absl::GetFlag(FLAGS_hop_latency_us));
+
+    return 0;
+}
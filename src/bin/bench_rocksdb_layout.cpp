@@ -0,0 +1,97 @@
+#include "base/init.h"
+#include "base/common.h"
+#include "common/flags.h"
+#include "common/time.h"
+#include "log/db.h"
+#include "utils/bits.h"
+#include "utils/fs.h"
+#include "utils/bench.h"
+
+#include <random>
+
+ABSL_DECLARE_FLAG(size_t, rocksdb_shared_column_families);
+
+ABSL_FLAG(std::string, db_path, "/tmp/bench_rocksdb_layout", "");
+ABSL_FLAG(size_t, num_entries, 200000, "Number of log entries written");
+ABSL_FLAG(size_t, num_reads, 100000, "Number of log entries read after writes");
+ABSL_FLAG(size_t, entry_size, 256, "Size of log entries in bytes");
+ABSL_FLAG(size_t, shared_column_families, 4,
+          "Number of column families of the consolidated layout");
+
+using namespace faas;
+
+static void RunWithLayout(size_t num_logspaces, size_t num_shared_cfs) {
+    std::string db_path = absl::GetFlag(FLAGS_db_path);
+    if (fs_utils::Exists(db_path)) {
+        fs_utils::RemoveDirectoryRecursively(db_path);
+    }
+    absl::SetFlag(&FLAGS_rocksdb_shared_column_families, num_shared_cfs);
+    auto db = std::make_unique<log::RocksDBBackend>(db_path);
+
+    // Log spaces of consecutive views, each with 4 physical logs
+    std::vector<uint32_t> logspaces;
+    for (size_t i = 0; i < num_logspaces; i++) {
+        uint32_t logspace_id = bits::JoinTwo16(gsl::narrow_cast<uint16_t>(i / 4),
+                                               gsl::narrow_cast<uint16_t>(i % 4 + 1));
+        db->InstallLogSpace(logspace_id);
+        logspaces.push_back(logspace_id);
+    }
+
+    std::mt19937_64 rng(42);
+    std::uniform_int_distribution<size_t> pick_logspace(0, num_logspaces - 1);
+    std::string data(absl::GetFlag(FLAGS_entry_size), 'x');
+    std::vector<uint32_t> next_keys(num_logspaces, 0);
+    size_t num_entries = absl::GetFlag(FLAGS_num_entries);
+    int64_t start_timestamp = GetMonotonicMicroTimestamp();
+    for (size_t i = 0; i < num_entries; i++) {
+        size_t idx = pick_logspace(rng);
+        db->Put(logspaces[idx], next_keys[idx]++, STRING_AS_SPAN(data));
+    }
+    int64_t write_elapsed = GetMonotonicMicroTimestamp() - start_timestamp;
+    uint64_t memory_usage = db->GetMemoryUsage();
+
+    size_t num_reads = absl::GetFlag(FLAGS_num_reads);
+    size_t num_found = 0;
+    bench_utils::Samples<int32_t> read_time(num_reads);
+    for (size_t i = 0; i < num_reads; i++) {
+        size_t idx = pick_logspace(rng);
+        // One of four reads is for a key not written
+        uint32_t key = gsl::narrow_cast<uint32_t>(rng() % (next_keys[idx] / 3 * 4 + 1));
+        start_timestamp = GetMonotonicNanoTimestamp();
+        if (db->Get(logspaces[idx], key).has_value()) {
+            num_found++;
+        }
+        read_time.Add(gsl::narrow_cast<int32_t>(GetMonotonicNanoTimestamp() - start_timestamp));
+    }
+
+    start_timestamp = GetMonotonicMicroTimestamp();
+    for (uint32_t logspace_id : logspaces) {
+        db->RemoveLogSpace(logspace_id);
+    }
+    int64_t remove_elapsed = GetMonotonicMicroTimestamp() - start_timestamp;
+
+    LOG(INFO) << fmt::format("logspaces={}, layout={}: write throughput={:.0f} entries/s, "
+                             "memtables and table readers={:.1f}MB, found={}/{}, "
+                             "remove all log spaces takes {:.1f}ms",
+                             num_logspaces,
+                             num_shared_cfs == 0 ? "per-logspace"
+                                                 : fmt::format("{}-shared", num_shared_cfs),
+                             num_entries / (write_elapsed * 1e-6),
+                             memory_usage / 1048576.0, num_found, num_reads,
+                             remove_elapsed * 1e-3);
+    read_time.ReportStatistics("Get time (ns)");
+
+    db.reset();
+    fs_utils::RemoveDirectoryRecursively(db_path);
+}
+
+int main(int argc, char* argv[]) {
+    base::InitMain(argc, argv);
+
+    for (size_t num_logspaces : {10, 100, 1000}) {
+        RunWithLayout(num_logspaces, /* num_shared_cfs= */ 0);
+        RunWithLayout(num_logspaces, absl::GetFlag(FLAGS_shared_column_families));
+    }
+
+    return 0;
+}
@@ -0,0 +1,113 @@
+#include "base/init.h"
+#include "base/common.h"
+#include "common/protocol.h"
+#include "common/time.h"
+#include "utils/bench.h"
+
+#include <random>
+
+ABSL_FLAG(size_t, num_objects, 10000, "Number of objects, each with its own tag");
+ABSL_FLAG(size_t, num_appends, 2000000, "Number of log entries appended before transactions");
+ABSL_FLAG(size_t, objects_per_txn, 4, "Number of objects read by each transaction");
+ABSL_FLAG(size_t, num_txns, 100000, "Number of simulated read-only transactions");
+ABSL_FLAG(int64_t, ipc_latency_us, 10,
+          "Latency of one shared log op between function and engine");
+ABSL_FLAG(int64_t, hop_latency_us, 50,
+          "Latency of one engine-to-engine hop, taken by reads using remote index");
+ABSL_FLAG(double, remote_index_ratio, 0.67,
+          "Ratio of reads using remote index, e.g. 2/3 with 3 index engines");
+
+using namespace faas;
+
+// Per-tag seqnums, same as Index::PerSpaceIndex
+struct SimIndex {
+    std::vector<std::vector<uint32_t>> seqnums_by_tag;
+
+    explicit SimIndex(size_t num_tags) : seqnums_by_tag(num_tags) {}
+
+    void Add(uint32_t seqnum, uint64_t tag) {
+        seqnums_by_tag[tag].push_back(seqnum);
+    }
+
+    // Returns kInvalidLogSeqNum if not found
+    uint64_t FindPrev(uint64_t tag, uint64_t query_seqnum) const {
+        const std::vector<uint32_t>& seqnums = seqnums_by_tag[tag];
+        auto iter = absl::c_upper_bound(seqnums, query_seqnum,
+                                        [] (uint64_t lhs, uint32_t rhs) { return lhs < rhs; });
+        if (iter == seqnums.begin()) {
+            return protocol::kInvalidLogSeqNum;
+        }
+        return *(--iter);
+    }
+};
+
+int main(int argc, char* argv[]) {
+    base::InitMain(argc, argv);
+
+    size_t num_objects = absl::GetFlag(FLAGS_num_objects);
+    size_t num_appends = absl::GetFlag(FLAGS_num_appends);
+    size_t objects_per_txn = absl::GetFlag(FLAGS_objects_per_txn);
+    int64_t ipc_latency = absl::GetFlag(FLAGS_ipc_latency_us);
+    int64_t index_latency = 2 * absl::GetFlag(FLAGS_hop_latency_us);
+    std::mt19937 rng(42);
+    // Zipf-like object popularity
+    std::vector<double> weights(num_objects);
+    for (size_t i = 0; i < num_objects; i++) {
+        weights[i] = 1.0 / static_cast<double>(i + 1);
+    }
+    std::discrete_distribution<uint64_t> object_dist(weights.begin(), weights.end());
+
+    SimIndex index(num_objects);
+    for (size_t i = 0; i < num_appends; i++) {
+        index.Add(gsl::narrow_cast<uint32_t>(i), object_dist(rng));
+    }
+
+    // Snapshots are pinned at random positions of the log
+    std::uniform_int_distribution<uint64_t> snapshot_dist(1, num_appends);
+    std::bernoulli_distribution remote_index(absl::GetFlag(FLAGS_remote_index_ratio));
+    bench_utils::Samples<int32_t> per_object_latency(1 << 20);
+    bench_utils::Samples<int32_t> snapshot_latency(1 << 20);
+    bench_utils::Samples<int32_t> resolve_time(1 << 20);
+    std::vector<uint64_t> tags(objects_per_txn);
+    std::vector<uint64_t> results(objects_per_txn);
+    size_t num_txns = absl::GetFlag(FLAGS_num_txns);
+    for (size_t i = 0; i < num_txns; i++) {
+        for (size_t j = 0; j < objects_per_txn; j++) {
+            tags[j] = object_dist(rng);
+        }
+        uint64_t snapshot = snapshot_dist(rng);
+
+        // One CheckTail to pin the snapshot, then one ReadPrev per object
+        int64_t latency = 0;
+        for (size_t j = 0; j <= objects_per_txn; j++) {
+            latency += ipc_latency + (remote_index(rng) ? index_latency : 0);
+        }
+        for (size_t j = 0; j < objects_per_txn; j++) {
+            results[j] = index.FindPrev(tags[j], snapshot - 1);
+        }
+        per_object_latency.Add(gsl::narrow_cast<int32_t>(latency));
+
+        // One READ_SNAPSHOT, whose sub-reads are resolved in parallel
+        bool any_remote = false;
+        for (size_t j = 0; j < objects_per_txn; j++) {
+            any_remote |= remote_index(rng);
+        }
+        int64_t start_timestamp = GetMonotonicNanoTimestamp();
+        for (size_t j = 0; j < objects_per_txn; j++) {
+            CHECK_EQ(index.FindPrev(tags[j], snapshot - 1), results[j]);
+        }
+        int64_t elapsed = GetMonotonicNanoTimestamp() - start_timestamp;
+        resolve_time.Add(gsl::narrow_cast<int32_t>(elapsed));
+        latency = ipc_latency + (any_remote ? index_latency : 0) + elapsed / 1000;
+        snapshot_latency.Add(gsl::narrow_cast<int32_t>(latency));
+    }
+
+    LOG(INFO) << fmt::format("Transactions reading {} objects, ipc_latency={}us, "
+                             "hop_latency={}us", objects_per_txn, ipc_latency,
+                             absl::GetFlag(FLAGS_hop_latency_us));
+    per_object_latency.ReportStatistics("CheckTail + per-object ReadPrev latency (us)");
+    snapshot_latency.ReportStatistics("READ_SNAPSHOT latency (us)");
+    resolve_time.ReportStatistics("Time resolving reads of one snapshot (ns)");
+
+    return 0;
+}
@@ -0,0 +1,76 @@
+#include "base/init.h"
+#include "base/common.h"
+#include "common/time.h"
+#include "log/db.h"
+#include "utils/bits.h"
+#include "utils/fs.h"
+
+#include <random>
+
+ABSL_FLAG(std::string, db_path, "/tmp/bench_storage_multiget", "");
+ABSL_FLAG(size_t, num_entries, 200000, "Number of log entries in DB");
+ABSL_FLAG(size_t, num_reads, 200000, "Number of simulated storage reads");
+ABSL_FLAG(size_t, entry_size, 1024, "Size of log entries in bytes");
+
+using namespace faas;
+
+static constexpr uint32_t kLogSpaceId = 0x00010001;
+
+// Issues reads of random log entries in batches of `batch_size`, as coalesced
+// reads of one event loop iteration, where batch size 1 means not coalesced.
+// Returns reads per second.
+static double RunReads(log::RocksDBBackend* db, size_t batch_size) {
+    size_t num_entries = absl::GetFlag(FLAGS_num_entries);
+    size_t num_reads = absl::GetFlag(FLAGS_num_reads);
+    std::mt19937_64 rng(42);
+    std::uniform_int_distribution<uint32_t> pick_key(
+        0, gsl::narrow_cast<uint32_t>(num_entries - 1));
+    std::vector<uint32_t> keys(batch_size);
+    size_t num_found = 0;
+    int64_t start_timestamp = GetMonotonicMicroTimestamp();
+    for (size_t i = 0; i < num_reads; i += batch_size) {
+        for (size_t j = 0; j < batch_size; j++) {
+            keys[j] = pick_key(rng);
+        }
+        if (batch_size == 1) {
+            db->GetPinned(kLogSpaceId, keys[0],
+                          [&num_found] (std::span<const char> value) { num_found++; });
+        } else {
+            db->MultiGetPinned(kLogSpaceId, keys,
+                               [&num_found] (size_t index, std::span<const char> value) {
+                                   num_found++;
+                               });
+        }
+    }
+    int64_t elapsed = GetMonotonicMicroTimestamp() - start_timestamp;
+    CHECK_GE(num_found, num_reads);
+    return num_found / (elapsed * 1e-6);
+}
+
+int main(int argc, char* argv[]) {
+    base::InitMain(argc, argv);
+
+    std::string db_path = absl::GetFlag(FLAGS_db_path);
+    if (fs_utils::Exists(db_path)) {
+        fs_utils::RemoveDirectoryRecursively(db_path);
+    }
+    auto db = std::make_unique<log::RocksDBBackend>(db_path);
+    db->InstallLogSpace(kLogSpaceId);
+    std::string data(absl::GetFlag(FLAGS_entry_size), 'x');
+    size_t num_entries = absl::GetFlag(FLAGS_num_entries);
+    for (size_t i = 0; i < num_entries; i++) {
+        db->Put(kLogSpaceId, gsl::narrow_cast<uint32_t>(i), STRING_AS_SPAN(data));
+    }
+
+    double baseline = RunReads(db.get(), /* batch_size= */ 1);
+    LOG(INFO) << fmt::format("Get: {:.0f} reads/s", baseline);
+    for (size_t batch_size : {4, 16, 64, 256}) {
+        double throughput = RunReads(db.get(), batch_size);
+        LOG(INFO) << fmt::format("MultiGet with batch_size={}: {:.0f} reads/s, {:.2f}x of Get",
+                                 batch_size, throughput, throughput / baseline);
+    }
+
+    db.reset();
+    fs_utils::RemoveDirectoryRecursively(db_path);
+    return 0;
+}
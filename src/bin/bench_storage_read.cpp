@@ -0,0 +1,105 @@
+#include "base/init.h"
+#include "base/common.h"
+#include "common/time.h"
+#include "log/db.h"
+#include "log/utils.h"
+#include "utils/bits.h"
+#include "utils/fs.h"
+#include "utils/bench.h"
+
+#include <random>
+
+ABSL_FLAG(std::string, db_path, "/tmp/bench_storage_read", "");
+ABSL_FLAG(size_t, num_entries, 100000, "Number of log entries in DB");
+ABSL_FLAG(size_t, num_reads, 200000, "Number of simulated storage reads");
+ABSL_FLAG(size_t, num_tags, 2, "Number of tags of each log entry");
+
+using namespace faas;
+
+static constexpr uint32_t kLogSpaceId = 0x00010001;
+
+// Simulates storage reads from DB, where `pinned` reads parse log entries in
+// place, otherwise they are read as std::string and parsed by protobuf.
+// Log data is finally copied into `message_buffer`, as for sending responses.
+static void RunReads(log::RocksDBBackend* db, size_t data_size, bool pinned) {
+    size_t num_entries = absl::GetFlag(FLAGS_num_entries);
+    size_t num_reads = absl::GetFlag(FLAGS_num_reads);
+    std::mt19937_64 rng(42);
+    std::uniform_int_distribution<uint32_t> pick_key(
+        0, gsl::narrow_cast<uint32_t>(num_entries - 1));
+    std::vector<char> message_buffer(data_size);
+    bench_utils::Samples<int32_t> read_time(num_reads);
+    size_t bytes_copied = 0;
+    for (size_t i = 0; i < num_reads; i++) {
+        uint32_t key = pick_key(rng);
+        int64_t start_timestamp = GetMonotonicNanoTimestamp();
+        if (pinned) {
+            bool found = db->GetPinned(
+                kLogSpaceId, key,
+                [&] (std::span<const char> value) {
+                    log::LogMetaData metadata;
+                    log::UserTagVec user_tags;
+                    std::span<const char> log_data;
+                    CHECK(log_utils::ParseLogEntryInPlace(value, &metadata,
+                                                          &user_tags, &log_data));
+                    memcpy(message_buffer.data(), log_data.data(), log_data.size());
+                    bytes_copied += log_data.size();
+                }
+            );
+            CHECK(found);
+        } else {
+            auto value = db->Get(kLogSpaceId, key);
+            CHECK(value.has_value());
+            bytes_copied += value->size();
+            log::LogEntryProto log_entry;
+            CHECK(log_entry.ParseFromString(*value));
+            bytes_copied += log_entry.data().size();
+            memcpy(message_buffer.data(), log_entry.data().data(), log_entry.data().size());
+            bytes_copied += log_entry.data().size();
+        }
+        read_time.Add(gsl::narrow_cast<int32_t>(GetMonotonicNanoTimestamp() - start_timestamp));
+    }
+    LOG(INFO) << fmt::format("data_size={}, {}: bytes copied per read={:.1f}",
+                             data_size, pinned ? "pinned and parsed in place"
+                                               : "std::string and ParseFromString",
+                             static_cast<double>(bytes_copied) / num_reads);
+    read_time.ReportStatistics("Read time (ns)");
+}
+
+static void RunWithDataSize(size_t data_size) {
+    std::string db_path = absl::GetFlag(FLAGS_db_path);
+    if (fs_utils::Exists(db_path)) {
+        fs_utils::RemoveDirectoryRecursively(db_path);
+    }
+    auto db = std::make_unique<log::RocksDBBackend>(db_path);
+    db->InstallLogSpace(kLogSpaceId);
+    size_t num_entries = absl::GetFlag(FLAGS_num_entries);
+    for (size_t i = 0; i < num_entries; i++) {
+        uint32_t seqnum_lowhalf = gsl::narrow_cast<uint32_t>(i);
+        log::LogEntryProto log_entry;
+        log_entry.set_user_logspace(1);
+        log_entry.set_seqnum(bits::JoinTwo32(kLogSpaceId, seqnum_lowhalf));
+        log_entry.set_localid(bits::JoinTwo32(1, seqnum_lowhalf));
+        for (size_t j = 0; j < absl::GetFlag(FLAGS_num_tags); j++) {
+            log_entry.add_user_tags(i * 16 + j + 1);
+        }
+        log_entry.set_data(std::string(data_size, 'x'));
+        std::string serialized;
+        CHECK(log_entry.SerializeToString(&serialized));
+        db->Put(kLogSpaceId, seqnum_lowhalf, STRING_AS_SPAN(serialized));
+    }
+    RunReads(db.get(), data_size, /* pinned= */ false);
+    RunReads(db.get(), data_size, /* pinned= */ true);
+    db.reset();
+    fs_utils::RemoveDirectoryRecursively(db_path);
+}
+
+int main(int argc, char* argv[]) {
+    base::InitMain(argc, argv);
+
+    for (size_t data_size : {64, 256, 1024}) {
+        RunWithDataSize(data_size);
+    }
+
+    return 0;
+}
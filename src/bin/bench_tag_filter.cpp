@@ -0,0 +1,74 @@
+#include "base/init.h"
+#include "base/common.h"
+#include "common/time.h"
+#include "log/tag_filter.h"
+#include "utils/bench.h"
+
+#include <random>
+
+ABSL_FLAG(size_t, num_tags, 100000, "Number of tags with log entries");
+ABSL_FLAG(size_t, num_reads, 1000000, "Number of simulated reads");
+ABSL_FLAG(double, absent_ratio, 0.3,
+          "Ratio of reads for tags without log entries, e.g. new statestore objects");
+ABSL_FLAG(int64_t, remote_query_latency_us, 100,
+          "Latency of one remote index query, for estimating latency saved");
+
+using namespace faas;
+
+static void RunWithFilterBits(size_t num_bits) {
+    size_t num_tags = absl::GetFlag(FLAGS_num_tags);
+    size_t num_reads = absl::GetFlag(FLAGS_num_reads);
+    std::mt19937_64 rng(42);
+    log::TagFilter filter(num_bits);
+    // Tags in [1, num_tags] have log entries
+    for (uint64_t tag = 1; tag <= num_tags; tag++) {
+        filter.Add(/* user_logspace= */ 0, tag);
+    }
+    std::string data;
+    filter.Serialize(&data);
+    log::TagFilter copied_filter(STRING_AS_SPAN(data));
+
+    std::bernoulli_distribution is_absent(absl::GetFlag(FLAGS_absent_ratio));
+    std::uniform_int_distribution<uint64_t> existing_tag(1, num_tags);
+    std::uniform_int_distribution<uint64_t> absent_tag(num_tags + 1, ~uint64_t{0});
+    bench_utils::Samples<int32_t> lookup_time(1 << 20);
+    size_t num_absent = 0;
+    size_t num_ruled_out = 0;
+    for (size_t i = 0; i < num_reads; i++) {
+        bool absent = is_absent(rng);
+        uint64_t tag = absent ? absent_tag(rng) : existing_tag(rng);
+        int64_t start_timestamp = GetMonotonicNanoTimestamp();
+        bool may_contain = copied_filter.MayContain(/* user_logspace= */ 0, tag);
+        lookup_time.Add(gsl::narrow_cast<int32_t>(GetMonotonicNanoTimestamp() - start_timestamp));
+        // No false negatives
+        CHECK(may_contain || absent);
+        if (absent) {
+            num_absent++;
+            if (!may_contain) {
+                num_ruled_out++;
+            }
+        }
+    }
+
+    double fp_rate = static_cast<double>(num_absent - num_ruled_out)
+                   / std::max<size_t>(num_absent, 1);
+    double avoided_ratio = static_cast<double>(num_ruled_out) / num_reads;
+    LOG(INFO) << fmt::format("filter_size={}KB ({:.1f} bits per tag): false_positive={:.2f}%, "
+                             "remote queries avoided={:.1f}% of reads, "
+                             "est. {:.1f}us saved per read",
+                             data.size() / 1024,
+                             static_cast<double>(num_bits) / num_tags,
+                             fp_rate * 100, avoided_ratio * 100,
+                             avoided_ratio * absl::GetFlag(FLAGS_remote_query_latency_us));
+    lookup_time.ReportStatistics("TagFilter::MayContain time (ns)");
+}
+
+int main(int argc, char* argv[]) {
+    base::InitMain(argc, argv);
+
+    for (size_t num_bits = size_t{1} << 18; num_bits <= (size_t{1} << 22); num_bits *= 2) {
+        RunWithFilterBits(num_bits);
+    }
+
+    return 0;
+}
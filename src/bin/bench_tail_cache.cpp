@@ -0,0 +1,83 @@
+#include "base/init.h"
+#include "base/common.h"
+#include "common/time.h"
+#include "log/cache.h"
+#include "utils/bench.h"
+
+#include <random>
+
+ABSL_FLAG(size_t, num_tags, 100000, "Number of distinct tags");
+ABSL_FLAG(size_t, num_ops, 1000000, "Number of simulated appends and tail reads");
+ABSL_FLAG(double, append_ratio, 0.2, "Ratio of appends among all ops");
+ABSL_FLAG(size_t, log_size, 256, "Size of each log entry");
+ABSL_FLAG(int64_t, read_latency_us, 200,
+          "Latency of reading one log entry from storage, for estimating latency saved");
+
+using namespace faas;
+
+static void RunWithMaxTags(size_t max_tags) {
+    size_t num_tags = absl::GetFlag(FLAGS_num_tags);
+    size_t num_ops = absl::GetFlag(FLAGS_num_ops);
+    std::mt19937 rng(42);
+    // Zipf-like tag popularity, as in statestore objects and sync primitives
+    std::vector<double> weights(num_tags);
+    for (size_t i = 0; i < num_tags; i++) {
+        weights[i] = 1.0 / static_cast<double>(i + 1);
+    }
+    std::discrete_distribution<size_t> tag_dist(weights.begin(), weights.end());
+    std::bernoulli_distribution is_append(absl::GetFlag(FLAGS_append_ratio));
+
+    log::TailCache tail_cache(max_tags);
+    std::string log_data(absl::GetFlag(FLAGS_log_size), 'x');
+    // Tail seqnum of each tag, as returned by index lookups
+    std::vector<uint64_t> tail_seqnums(num_tags, log::kInvalidLogSeqNum);
+    uint64_t next_seqnum = 1;
+    size_t num_reads = 0;
+    size_t num_hits = 0;
+    bench_utils::Samples<int32_t> get_time(num_ops);
+    for (size_t i = 0; i < num_ops; i++) {
+        size_t idx = tag_dist(rng);
+        uint64_t tag = idx + 1;
+        if (is_append(rng) || tail_seqnums[idx] == log::kInvalidLogSeqNum) {
+            log::LogMetaData metadata = {
+                .user_logspace = 0,
+                .seqnum = next_seqnum,
+                .localid = 0,
+                .num_tags = 1,
+                .data_size = log_data.size()
+            };
+            tail_cache.Put(metadata, std::span<const uint64_t>(&tag, 1),
+                           STRING_AS_SPAN(log_data));
+            tail_seqnums[idx] = next_seqnum++;
+            continue;
+        }
+        num_reads++;
+        int64_t start_timestamp = GetMonotonicNanoTimestamp();
+        auto log_entry = tail_cache.Get(/* user_logspace= */ 0, tag, tail_seqnums[idx]);
+        get_time.Add(gsl::narrow_cast<int32_t>(GetMonotonicNanoTimestamp() - start_timestamp));
+        if (log_entry.has_value()) {
+            DCHECK_EQ(log_entry->metadata.seqnum, tail_seqnums[idx]);
+            num_hits++;
+        }
+    }
+
+    double hit_rate = static_cast<double>(num_hits) / std::max<size_t>(num_reads, 1);
+    LOG(INFO) << fmt::format("max_tags={}: tail_reads={}, hit_rate={:.2f}%, "
+                             "est. storage read time saved={:.1f}s ({:.1f}us per tail read)",
+                             max_tags, num_reads, hit_rate * 100,
+                             static_cast<double>(num_hits * absl::GetFlag(FLAGS_read_latency_us)) / 1e6,
+                             hit_rate * absl::GetFlag(FLAGS_read_latency_us));
+    get_time.ReportStatistics("TailCache::Get time (ns)");
+}
+
+int main(int argc, char* argv[]) {
+    base::InitMain(argc, argv);
+
+    size_t num_tags = absl::GetFlag(FLAGS_num_tags);
+    for (size_t max_tags = 1024; max_tags < num_tags; max_tags *= 4) {
+        RunWithMaxTags(max_tags);
+    }
+    RunWithMaxTags(num_tags + 1);
+
+    return 0;
+}
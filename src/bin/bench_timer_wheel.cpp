@@ -0,0 +1,184 @@
+#include "base/init.h"
+#include "base/common.h"
+#include "common/time.h"
+#include "utils/bench.h"
+#include "utils/timerfd.h"
+#include "server/timer_wheel.h"
+
+#include <random>
+
+ABSL_FLAG(size_t, num_timers, 100000, "Number of one-shot timers");
+ABSL_FLAG(size_t, num_periodic_timers, 1000, "Number of periodic timers");
+ABSL_FLAG(size_t, num_timerfds, 1000, "Number of timerfds for the timerfd baseline");
+ABSL_FLAG(absl::Duration, max_delay, absl::Seconds(10), "Maximum delay of one-shot timers");
+ABSL_FLAG(absl::Duration, simulated_duration, absl::Seconds(10),
+          "Simulated duration for periodic timers");
+ABSL_FLAG(int64_t, tick_us, 100, "Tick of the timer wheel");
+ABSL_FLAG(double, cancel_ratio, 0.5, "Ratio of one-shot timers cancelled before expiry");
+
+using namespace faas;
+
+struct Result {
+    double add_ns;
+    double cancel_ns;
+    double expire_ns;
+    size_t fired;
+};
+
+static void ReportResult(std::string_view name, const Result& result) {
+    LOG(INFO) << fmt::format("{}: add={:.1f}ns, cancel={:.1f}ns, expire={:.1f}ns per timer, "
+                             "fired={}", name, result.add_ns, result.cancel_ns,
+                             result.expire_ns, result.fired);
+}
+
+static std::vector<int64_t> GenerateDelays(size_t n) {
+    std::mt19937_64 rng(42);
+    int64_t max_delay_us = absl::ToInt64Microseconds(absl::GetFlag(FLAGS_max_delay));
+    std::uniform_int_distribution<int64_t> dist(1, max_delay_us);
+    std::vector<int64_t> delays(n);
+    for (size_t i = 0; i < n; i++) {
+        delays[i] = dist(rng);
+    }
+    return delays;
+}
+
+static Result BenchTimerWheel(const std::vector<int64_t>& delays, size_t n_cancel) {
+    int64_t tick_us = absl::GetFlag(FLAGS_tick_us);
+    int64_t now_us = 0;
+    server::TimerWheel timer_wheel(tick_us, now_us);
+    size_t fired = 0;
+    std::vector<uint64_t> timer_ids(delays.size());
+
+    int64_t start_timestamp = GetMonotonicNanoTimestamp();
+    for (size_t i = 0; i < delays.size(); i++) {
+        timer_ids[i] = timer_wheel.AddTimer(now_us, absl::Microseconds(delays[i]),
+                                            [&fired] () { fired++; });
+    }
+    int64_t add_time = GetMonotonicNanoTimestamp() - start_timestamp;
+
+    start_timestamp = GetMonotonicNanoTimestamp();
+    for (size_t i = 0; i < n_cancel; i++) {
+        CHECK(timer_wheel.CancelTimer(timer_ids[i]));
+    }
+    int64_t cancel_time = GetMonotonicNanoTimestamp() - start_timestamp;
+
+    start_timestamp = GetMonotonicNanoTimestamp();
+    while (timer_wheel.num_timers() > 0) {
+        now_us = timer_wheel.NextDeadline();
+        timer_wheel.Advance(now_us);
+    }
+    int64_t expire_time = GetMonotonicNanoTimestamp() - start_timestamp;
+    CHECK_EQ(fired, delays.size() - n_cancel);
+
+    return Result {
+        .add_ns = static_cast<double>(add_time) / delays.size(),
+        .cancel_ns = n_cancel > 0 ? static_cast<double>(cancel_time) / n_cancel : 0.0,
+        .expire_ns = fired > 0 ? static_cast<double>(expire_time) / fired : 0.0,
+        .fired = fired
+    };
+}
+
+// Binary heap with lazy cancellation, as a baseline
+static Result BenchHeap(const std::vector<int64_t>& delays, size_t n_cancel) {
+    using HeapEntry = std::pair</* expiry */ int64_t, /* timer_id */ uint64_t>;
+    std::priority_queue<HeapEntry, std::vector<HeapEntry>, std::greater<HeapEntry>> heap;
+    absl::flat_hash_map</* timer_id */ uint64_t, std::function<void()>> callbacks;
+    size_t fired = 0;
+
+    int64_t start_timestamp = GetMonotonicNanoTimestamp();
+    for (size_t i = 0; i < delays.size(); i++) {
+        heap.push(std::make_pair(delays[i], uint64_t{i}));
+        callbacks[i] = [&fired] () { fired++; };
+    }
+    int64_t add_time = GetMonotonicNanoTimestamp() - start_timestamp;
+
+    start_timestamp = GetMonotonicNanoTimestamp();
+    for (size_t i = 0; i < n_cancel; i++) {
+        CHECK(callbacks.erase(i) > 0);
+    }
+    int64_t cancel_time = GetMonotonicNanoTimestamp() - start_timestamp;
+
+    start_timestamp = GetMonotonicNanoTimestamp();
+    while (!heap.empty()) {
+        uint64_t timer_id = heap.top().second;
+        heap.pop();
+        if (callbacks.contains(timer_id)) {
+            callbacks[timer_id]();
+            callbacks.erase(timer_id);
+        }
+    }
+    int64_t expire_time = GetMonotonicNanoTimestamp() - start_timestamp;
+    CHECK_EQ(fired, delays.size() - n_cancel);
+
+    return Result {
+        .add_ns = static_cast<double>(add_time) / delays.size(),
+        .cancel_ns = n_cancel > 0 ? static_cast<double>(cancel_time) / n_cancel : 0.0,
+        .expire_ns = fired > 0 ? static_cast<double>(expire_time) / fired : 0.0,
+        .fired = fired
+    };
+}
+
+static void BenchPeriodicTimers() {
+    size_t n = absl::GetFlag(FLAGS_num_periodic_timers);
+    int64_t tick_us = absl::GetFlag(FLAGS_tick_us);
+    int64_t duration_us = absl::ToInt64Microseconds(absl::GetFlag(FLAGS_simulated_duration));
+    std::mt19937_64 rng(42);
+    std::uniform_int_distribution<int64_t> dist(1, 100);
+
+    int64_t now_us = 0;
+    server::TimerWheel timer_wheel(tick_us, now_us);
+    size_t fired = 0;
+    for (size_t i = 0; i < n; i++) {
+        // Intervals are multiples of 1ms, similar to cut and progress timers
+        absl::Duration interval = absl::Milliseconds(dist(rng));
+        timer_wheel.AddPeriodicTimer(now_us, interval, interval, [&fired] () { fired++; });
+    }
+    bench_utils::Samples<int32_t> advance_time(1 << 20);
+    size_t loop_count = 0;
+    int64_t start_timestamp = GetMonotonicNanoTimestamp();
+    while (now_us < duration_us) {
+        now_us = timer_wheel.NextDeadline();
+        int64_t ts = GetMonotonicNanoTimestamp();
+        timer_wheel.Advance(now_us);
+        advance_time.Add(gsl::narrow_cast<int32_t>(GetMonotonicNanoTimestamp() - ts));
+        loop_count++;
+    }
+    int64_t elapsed_time = GetMonotonicNanoTimestamp() - start_timestamp;
+    LOG(INFO) << fmt::format("Periodic timers: n={}, fired={}, wakeups={}, {:.1f}ns per fire",
+                             n, fired, loop_count,
+                             static_cast<double>(elapsed_time) / std::max<size_t>(fired, 1));
+    advance_time.ReportStatistics("Advance time (ns)");
+}
+
+// One timerfd per timer, which is how server::Timer used to work
+static void BenchTimerFd() {
+    size_t n = absl::GetFlag(FLAGS_num_timerfds);
+    std::vector<int> fds(n);
+    int64_t start_timestamp = GetMonotonicNanoTimestamp();
+    for (size_t i = 0; i < n; i++) {
+        fds[i] = io_utils::CreateTimerFd();
+        PCHECK(fds[i] != -1);
+        CHECK(io_utils::SetupTimerFdOneTime(fds[i], absl::GetFlag(FLAGS_max_delay)));
+    }
+    int64_t elapsed_time = GetMonotonicNanoTimestamp() - start_timestamp;
+    for (int fd : fds) {
+        PCHECK(close(fd) == 0);
+    }
+    LOG(INFO) << fmt::format("timerfd: n={}, create and arm={:.1f}ns per timer",
+                             n, static_cast<double>(elapsed_time) / std::max<size_t>(n, 1));
+}
+
+int main(int argc, char* argv[]) {
+    base::InitMain(argc, argv);
+
+    size_t n = absl::GetFlag(FLAGS_num_timers);
+    size_t n_cancel = gsl::narrow_cast<size_t>(n * absl::GetFlag(FLAGS_cancel_ratio));
+    std::vector<int64_t> delays = GenerateDelays(n);
+
+    ReportResult("TimerWheel", BenchTimerWheel(delays, n_cancel));
+    ReportResult("BinaryHeap", BenchHeap(delays, n_cancel));
+    BenchPeriodicTimers();
+    BenchTimerFd();
+
+    return 0;
+}
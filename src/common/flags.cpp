@@ -11,6 +11,16 @@ ABSL_FLAG(int, socket_listen_backlog, 64, "Backlog for listen");
 ABSL_FLAG(bool, tcp_enable_reuseport, false, "Enable SO_REUSEPORT");
 ABSL_FLAG(bool, tcp_enable_nodelay, true, "Enable TCP_NODELAY");
 ABSL_FLAG(bool, tcp_enable_keepalive, true, "Enable TCP keep-alive");
+ABSL_FLAG(size_t, egress_hub_queue_limit_bytes, 0,
+          "Per-hub limit of queued egress bytes, beyond which the hub is "
+          "considered congested. 0 means no limit.");
+ABSL_FLAG(double, egress_hub_queue_resume_ratio, 0.5,
+          "Congested egress hub recovers when its queue drops below "
+          "this ratio of the limit.");
+ABSL_FLAG(bool, egress_hub_enable_striping, false,
+          "Split large flushes of shared log EgressHubs across all their connections");
+ABSL_FLAG(size_t, egress_hub_stripe_min_bytes, 65536,
+          "Minimal size of each stripe when splitting a flush");
 
 ABSL_FLAG(std::string, zookeeper_host, "localhost:2181", "ZooKeeper host");
 ABSL_FLAG(std::string, zookeeper_root_path, "/faas", "Root path for all znodes");
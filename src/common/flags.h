@@ -19,6 +19,10 @@ ABSL_DECLARE_FLAG(int, socket_listen_backlog);
 ABSL_DECLARE_FLAG(bool, tcp_enable_reuseport);
 ABSL_DECLARE_FLAG(bool, tcp_enable_nodelay);
 ABSL_DECLARE_FLAG(bool, tcp_enable_keepalive);
+ABSL_DECLARE_FLAG(size_t, egress_hub_queue_limit_bytes);
+ABSL_DECLARE_FLAG(double, egress_hub_queue_resume_ratio);
+ABSL_DECLARE_FLAG(bool, egress_hub_enable_striping);
+ABSL_DECLARE_FLAG(size_t, egress_hub_stripe_min_bytes);
 
 ABSL_DECLARE_FLAG(std::string, zookeeper_host);
 ABSL_DECLARE_FLAG(std::string, zookeeper_root_path);
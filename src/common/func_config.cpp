@@ -105,6 +105,11 @@ bool FuncConfig::Load(std::string_view json_contents) {
             }
             entry->allow_http_get = false;
             entry->qs_as_input = false;
+            entry->coalesce_calls = false;
+            if (item.contains("coalesceCalls") && item.at("coalesceCalls").get<bool>()) {
+                LOG(INFO) << "Coalescing of identical calls enabled for " << func_name;
+                entry->coalesce_calls = true;
+            }
             entry->is_grpc_service = false;
             if (StartsWith(func_name, "grpc:")) {
                 std::string_view service_name = StripPrefix(func_name, "grpc:");
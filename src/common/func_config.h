@@ -21,6 +21,7 @@ public:
         uint32_t default_logspace;
         bool allow_http_get;
         bool qs_as_input;
+        bool coalesce_calls;
         bool is_grpc_service;
         std::string grpc_service_name;
         std::vector<std::string> grpc_methods;
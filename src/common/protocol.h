@@ -85,20 +85,30 @@ enum class MessageType : uint16_t {
 };
 
 enum class SharedLogOpType : uint16_t {
-    INVALID     = 0x00,
-    APPEND      = 0x01,  // FuncWorker to Engine
-    READ_NEXT   = 0x02,  // FuncWorker to Engine, Engine to Index
-    READ_PREV   = 0x03,  // FuncWorker to Engine, Engine to Index
-    TRIM        = 0x04,  // FuncWorker to Engine, Engine to Sequencer
-    SET_AUXDATA = 0x05,  // FuncWorker to Engine, Engine to Storage
-    READ_NEXT_B = 0x06,  // FuncWorker to Engine, Engine to Index
-    READ_AT     = 0x10,  // Index to Storage
-    REPLICATE   = 0x11,  // Engine to Storage
-    INDEX_DATA  = 0x12,  // Engine to Index
-    SHARD_PROG  = 0x13,  // Storage to Sequencer
-    METALOGS    = 0x14,  // Sequencer to Sequencer, Engine, Storage, Index
-    META_PROG   = 0x15,  // Sequencer to Sequencer
-    RESPONSE    = 0x20
+    INVALID      = 0x00,
+    APPEND       = 0x01,  // FuncWorker to Engine
+    READ_NEXT    = 0x02,  // FuncWorker to Engine, Engine to Index
+    READ_PREV    = 0x03,  // FuncWorker to Engine, Engine to Index
+    TRIM         = 0x04,  // FuncWorker to Engine, Engine to Sequencer
+    SET_AUXDATA  = 0x05,  // FuncWorker to Engine, Engine to Storage
+    READ_NEXT_B  = 0x06,  // FuncWorker to Engine, Engine to Index
+    READ_NEXT_MT = 0x07,  // FuncWorker to Engine, Engine to Index
+    READ_PREV_MT = 0x08,  // FuncWorker to Engine, Engine to Index
+    COUNT        = 0x09,  // FuncWorker to Engine, Engine to Index
+    READ_SNAPSHOT = 0x0A, // FuncWorker to Engine
+    SET_CHECKPOINT  = 0x0B,  // FuncWorker to Engine, Engine to Storage
+    READ_CHECKPOINT = 0x0C,  // FuncWorker to Engine, Engine to Index, Index to Storage
+    QUEUE_POP       = 0x0D,  // FuncWorker to Engine, Engine to Engine
+    QUEUE_POP_B     = 0x0E,  // FuncWorker to Engine, Engine to Engine
+    READ_AT      = 0x10,  // Index to Storage
+    REPLICATE    = 0x11,  // Engine to Storage
+    INDEX_DATA   = 0x12,  // Engine to Index
+    SHARD_PROG   = 0x13,  // Storage to Sequencer
+    METALOGS     = 0x14,  // Sequencer to Sequencer, Engine, Storage, Index
+    META_PROG    = 0x15,  // Sequencer to Sequencer
+    TAG_FILTER   = 0x16,  // Index to Engine
+    BULK_SYNC    = 0x17,  // Storage to Storage
+    RESPONSE     = 0x20
 };
 
 enum class SharedLogResultType : uint16_t {
@@ -109,6 +119,10 @@ enum class SharedLogResultType : uint16_t {
     TRIM_OK     = 0x22,
     LOCALID     = 0x23,
     AUXDATA_OK  = 0x24,
+    COUNT_OK    = 0x25,
+    SNAPSHOT_OK = 0x26,
+    CHECKPOINT_OK = 0x27,
+    BULK_SYNC_OK  = 0x28,
     // Error results
     BAD_ARGS    = 0x30,
     DISCARDED   = 0x31,  // Log to append is discarded
@@ -124,6 +138,41 @@ constexpr uint64_t kInvalidLogSeqNum  = std::numeric_limits<uint64_t>::max();
 constexpr uint32_t kFuncWorkerUseEngineSocketFlag = (1 << 0);
 constexpr uint32_t kUseFifoForNestedCallFlag      = (1 << 1);
 constexpr uint32_t kAsyncInvokeFuncFlag           = (1 << 2);
+// Set in FUNC_WORKER_HANDSHAKE by workers accepting batched calls, and in
+// DISPATCH_FUNC_CALL messages that carry a batch of calls
+constexpr uint32_t kFuncCallBatchFlag             = (1 << 3);
+// Set in READ_NEXT_MT and READ_PREV_MT requests for matching log entries
+// with all query tags, instead of any of them
+constexpr uint32_t kLogReadMatchAllTagsFlag       = (1 << 4);
+
+// READ_SNAPSHOT resolves `log_num_tags` READ_PREV reads against the same
+// snapshot of the log. Inline data of the request holds query tags, followed
+// by seqnum bounds of these reads, and `log_seqnum` is the snapshot to read
+// (from a previous SNAPSHOT_OK), or kInvalidLogSeqNum for a new snapshot.
+// SNAPSHOT_OK responses set `log_seqnum` to the snapshot, which includes all
+// and only log entries with smaller seqnums, and hold seqnums of found log
+// entries (kInvalidLogSeqNum if not found) in inline data.
+
+// SET_CHECKPOINT registers inline data as the checkpoint of materialized
+// state of `log_tag`, as of `log_seqnum`. READ_CHECKPOINT finds the latest
+// checkpoint of `log_tag` at or before `log_seqnum`. Its CHECKPOINT_OK
+// response sets `log_seqnum` to the seqnum of the checkpoint, and holds
+// `log_num_tags` seqnums of log entries with `log_tag` after the checkpoint
+// (the tail), followed by checkpoint data in inline data.
+// Set in CHECKPOINT_OK responses if the tail includes all log entries up to
+// the queried seqnum
+constexpr uint32_t kLogCheckpointTailCompleteFlag = (1 << 5);
+// Set in COUNT requests that only check if any log entry matches. The index
+// stops at the first view with a match, so `log_count` of the COUNT_OK
+// response is only meaningful as zero or non-zero.
+constexpr uint32_t kLogCountExistsFlag            = (1 << 6);
+
+// QUEUE_POP reads the first log entry with `log_tag` after the consumer
+// cursor of the queue, and moves the cursor past it. Cursors are kept by
+// the engine node serving pops of the queue tag (see View::Sequencer::
+// GetQueueEngineNodeForTag). Push is a plain APPEND with the queue tag.
+// QUEUE_POP_B waits for new log entries, until Index::kBlockingQueryTimeout.
+// Responses are the same as READ_NEXT.
 
 struct Message {
     struct {
@@ -141,6 +190,7 @@ struct Message {
         } __attribute__ ((packed));
         uint64_t log_seqnum;          // [8:16]  Used in SHARED_LOG_OP
         uint64_t log_localid;         // [8:16]  Used in SHARED_LOG_OP
+        uint64_t log_count;           // [8:16]  Used in SHARED_LOG_OP (COUNT_OK)
     };
     int64_t send_timestamp;       // [16:24]
     int32_t payload_size;         // [24:28] Used in HANDSHAKE_RESPONSE, INVOKE_FUNC,
@@ -162,7 +212,7 @@ struct Message {
     uint64_t log_tag;             // [40:48]
     uint64_t log_client_data;     // [48:56] will be preserved for response to clients
 
-    uint64_t _8_padding_8_;
+    uint64_t log_end_seqnum;      // [56:64] Used in SHARED_LOG_OP (COUNT)
 
     char inline_data[__FAAS_MESSAGE_SIZE - __FAAS_CACHE_LINE_SIZE]
         __attribute__ ((aligned (__FAAS_CACHE_LINE_SIZE)));
@@ -172,6 +222,15 @@ struct Message {
 #define MESSAGE_INLINE_DATA_SIZE (__FAAS_MESSAGE_SIZE - MESSAGE_HEADER_SIZE)
 static_assert(sizeof(Message) == __FAAS_MESSAGE_SIZE, "Unexpected Message size");
 
+// Inline data of a batched DISPATCH_FUNC_CALL message is a sequence of
+// entries, each followed by its inline input padded to 8 bytes
+struct FuncCallBatchEntry {
+    FuncCall func_call;
+    int32_t  payload_size;    // Negative for input stored in shm
+    uint32_t _4_padding_4_;
+};
+static_assert(sizeof(FuncCallBatchEntry) == 16, "Unexpected FuncCallBatchEntry size");
+
 enum class ConnType : uint16_t {
     GATEWAY_TO_ENGINE      = 0,
     ENGINE_TO_GATEWAY      = 1,
@@ -182,7 +241,8 @@ enum class ConnType : uint16_t {
     ENGINE_TO_STORAGE      = 6,   // Replicate, aux data
     STORAGE_TO_ENGINE      = 7,   // Read result
     SEQUENCER_TO_STORAGE   = 8,   // Meta log
-    STORAGE_TO_SEQUENCER   = 9    // Meta log propagation
+    STORAGE_TO_SEQUENCER   = 9,   // Meta log propagation
+    STORAGE_TO_STORAGE     = 10   // Bulk sync
 };
 
 struct HandshakeMessage {
@@ -192,15 +252,44 @@ struct HandshakeMessage {
 
 static_assert(sizeof(HandshakeMessage) == 4, "Unexpected HandshakeMessage size");
 
-inline std::string EncodeHandshakeMessage(ConnType type, uint16_t src_node_id = 0) {
+// Set in conn_type of HandshakeMessage by senders with striping enabled.
+// Receivers unaware of striping reject such connections as invalid types,
+// instead of misparsing stripe headers as messages.
+constexpr uint16_t kStripedConnTypeFlag = (1 << 15);
+
+inline std::string EncodeHandshakeMessage(ConnType type, uint16_t src_node_id = 0,
+                                          bool striped = false) {
+    uint16_t conn_type = static_cast<uint16_t>(type);
+    if (striped) {
+        conn_type |= kStripedConnTypeFlag;
+    }
     HandshakeMessage message = {
-        .conn_type = static_cast<uint16_t>(type),
+        .conn_type = conn_type,
         .src_node_id = src_node_id, 
     };
     return std::string(reinterpret_cast<const char*>(&message),
                        sizeof(HandshakeMessage));
 }
 
+inline ConnType GetConnType(const HandshakeMessage& handshake) {
+    return static_cast<ConnType>(handshake.conn_type & ~kStripedConnTypeFlag);
+}
+
+inline bool IsStripedConn(const HandshakeMessage& handshake) {
+    return (handshake.conn_type & kStripedConnTypeFlag) != 0;
+}
+
+// On striped connections, messages are sent in stripes, each prefixed by
+// StripeHeader. Stripes of the same EgressHub are numbered consecutively
+// across all its connections, so that receivers can restore the sending
+// order if they need to. Connections without striping carry bare messages.
+struct StripeHeader {
+    uint32_t seqnum;
+    uint32_t size;   // Total size of messages in this stripe
+} __attribute__ ((packed));
+
+static_assert(sizeof(StripeHeader) == 8, "Unexpected StripeHeader size");
+
 struct GatewayMessage {
     struct {
         uint16_t message_type : 4;
@@ -219,7 +308,27 @@ struct GatewayMessage {
 
 static_assert(sizeof(GatewayMessage) == 16, "Unexpected GatewayMessage size");
 
-constexpr uint16_t kReadInitialFlag = (1 << 0);
+constexpr uint16_t kReadInitialFlag      = (1 << 0);
+constexpr uint16_t kReadMatchAllTagsFlag = (1 << 1);
+// Set in reads of READ_SNAPSHOT, whose READ_OK responses carry only seqnums
+constexpr uint16_t kReadSeqnumOnlyFlag   = (1 << 2);
+// Set in READ_CHECKPOINT requests to storage nodes, and in `response_flags`
+// of their CHECKPOINT_OK responses, if the tail after the checkpoint is complete
+constexpr uint16_t kCheckpointTailCompleteFlag = (1 << 3);
+// Set in COUNT requests of existence checks, see kLogCountExistsFlag
+constexpr uint16_t kCountExistsFlag = (1 << 4);
+// Set in SET_CHECKPOINT messages of queue cursors, whose payload has
+// (user_logspace, tag, seqnum) triples of uint64_t. Also set in READ_CHECKPOINT
+// requests to storage nodes for the cursor of `query_tag`, whose CHECKPOINT_OK
+// responses carry the cursor as seqnum, or EMPTY if not stored.
+constexpr uint16_t kQueueCursorFlag = (1 << 5);
+
+// Flags in `response_flags` of RESPONSE messages, as `flags` shares
+// the field with `op_result`
+constexpr uint16_t kReadTailCacheHitFlag = (1 << 0);  // Set on READ_OK responses
+
+constexpr uint16_t kTagFilterFinalizedFlag = (1 << 0);
+constexpr uint16_t kTagFilterDeltaFlag     = (1 << 1);
 
 struct SharedLogMessage {
     uint16_t op_type;         // [0:2]
@@ -241,8 +350,9 @@ struct SharedLogMessage {
     };
 
     union {
-        uint32_t metalog_position; // [16:20] (only used by META_PROG)
+        uint32_t metalog_position; // [16:20] (only used by META_PROG and TAG_FILTER)
         uint32_t user_logspace;    // [16:20]
+        uint32_t source_engine_id; // [16:20] (only used by BULK_SYNC and BULK_SYNC_OK)
     };
 
     union {
@@ -251,18 +361,24 @@ struct SharedLogMessage {
             uint16_t prev_view_id;
             uint16_t prev_engine_id;
         } __attribute__ ((packed));
+        uint32_t count;           // [20:24] (only used by COUNT and COUNT_OK)
+        uint32_t prev_metalog_position;  // [20:24] (only used by TAG_FILTER)
     };
     union {
         uint64_t query_tag;   // [24:32]
         struct {
-            uint16_t num_tags;      // [24:26]
-            uint16_t aux_data_size; // [26:28]
+            uint16_t num_tags;       // [24:26]
+            uint16_t aux_data_size;  // [26:28]
+            uint16_t response_flags; // [28:30] (only used by RESPONSE)
 
-            uint32_t _5_padding_5_;
+            uint16_t _5_padding_5_;
         } __attribute__ ((packed));
     };
 
-    uint64_t user_metalog_progress;  // [32:40]
+    union {
+        uint64_t user_metalog_progress;  // [32:40]
+        uint64_t persisted_seqnum;       // [32:40] (only used by BULK_SYNC_OK)
+    };
 
     union {
         uint64_t localid;       // [40:48]
@@ -271,12 +387,23 @@ struct SharedLogMessage {
     };
     uint64_t client_data;       // [48:56]
 
-    uint64_t prev_found_seqnum; // [56:64]
+    union {
+        uint64_t prev_found_seqnum; // [56:64]
+        uint64_t end_seqnum;        // [56:64] (only used by COUNT)
+    };
 
 } __attribute__ (( packed, aligned(__FAAS_CACHE_LINE_SIZE) ));
 
 static_assert(sizeof(SharedLogMessage) == 64, "Unexpected SharedLogMessage size");
 
+// BULK_SYNC requests log entries of `logspace_id` within seqnums
+// [query_seqnum, end_seqnum), which are stored from engine `source_engine_id`.
+// BULK_SYNC_OK responses keep these fields, except that `end_seqnum` is
+// clipped to `persisted_seqnum`, the position before which the responding
+// storage has flushed all log entries into DB. Their payload holds `count`
+// log entries, each as [seqnum_lowhalf (uint32_t)][size (uint32_t)] followed
+// by the serialized LogEntryProto.
+
 class MessageHelper {
 public:
     static bool IsLauncherHandshake(const Message& message) {
@@ -315,6 +442,10 @@ public:
         return static_cast<MessageType>(message.message_type) == MessageType::SHARED_LOG_OP;
     }
 
+    static bool IsFuncCallBatch(const Message& message) {
+        return IsDispatchFuncCall(message) && (message.flags & kFuncCallBatchFlag) != 0;
+    }
+
     static void SetFuncCall(Message* message, const FuncCall& func_call) {
         message->func_id = func_call.func_id;
         message->method_id = func_call.method_id;
@@ -374,6 +505,59 @@ public:
         return EMPTY_CHAR_SPAN;
     }
 
+    // Space needed in a batched DISPATCH_FUNC_CALL message
+    static size_t FuncCallBatchEntrySize(const Message& dispatch_func_call_message) {
+        size_t size = sizeof(FuncCallBatchEntry);
+        if (dispatch_func_call_message.payload_size > 0) {
+            size += bits::AlignUp<size_t>(
+                static_cast<size_t>(dispatch_func_call_message.payload_size), 8);
+        }
+        return size;
+    }
+
+    static void AppendToFuncCallBatch(Message* batch_message,
+                                      const Message& dispatch_func_call_message) {
+        DCHECK(IsFuncCallBatch(*batch_message));
+        DCHECK(IsDispatchFuncCall(dispatch_func_call_message));
+        size_t offset = static_cast<size_t>(batch_message->payload_size);
+        DCHECK_LE(offset + FuncCallBatchEntrySize(dispatch_func_call_message),
+                  size_t{MESSAGE_INLINE_DATA_SIZE});
+        FuncCallBatchEntry entry;
+        entry.func_call = GetFuncCall(dispatch_func_call_message);
+        entry.payload_size = dispatch_func_call_message.payload_size;
+        entry._4_padding_4_ = 0;
+        memcpy(batch_message->inline_data + offset, &entry, sizeof(FuncCallBatchEntry));
+        if (entry.payload_size > 0) {
+            memcpy(batch_message->inline_data + offset + sizeof(FuncCallBatchEntry),
+                   dispatch_func_call_message.inline_data,
+                   static_cast<size_t>(entry.payload_size));
+        }
+        batch_message->payload_size = gsl::narrow_cast<int32_t>(
+            offset + FuncCallBatchEntrySize(dispatch_func_call_message));
+    }
+
+    // Invoke `fn` with a plain DISPATCH_FUNC_CALL message for each call in the batch
+    template<class T>
+    static void ForEachInFuncCallBatch(const Message& batch_message, T fn) {
+        DCHECK(IsFuncCallBatch(batch_message));
+        size_t offset = 0;
+        size_t total_size = static_cast<size_t>(batch_message.payload_size);
+        while (offset + sizeof(FuncCallBatchEntry) <= total_size) {
+            FuncCallBatchEntry entry;
+            memcpy(&entry, batch_message.inline_data + offset, sizeof(FuncCallBatchEntry));
+            Message message = NewDispatchFuncCall(entry.func_call);
+            message.send_timestamp = batch_message.send_timestamp;
+            message.payload_size = entry.payload_size;
+            if (entry.payload_size > 0) {
+                memcpy(message.inline_data,
+                       batch_message.inline_data + offset + sizeof(FuncCallBatchEntry),
+                       static_cast<size_t>(entry.payload_size));
+            }
+            fn(message);
+            offset += FuncCallBatchEntrySize(message);
+        }
+    }
+
     static SharedLogOpType GetSharedLogOpType(const Message& message) {
         return static_cast<SharedLogOpType>(message.log_op);
     }
@@ -441,6 +625,14 @@ public:
         return message;
     }
 
+    static Message NewDispatchFuncCallBatch(uint16_t func_id) {
+        NEW_EMPTY_MESSAGE(message);
+        message.message_type = static_cast<uint16_t>(MessageType::DISPATCH_FUNC_CALL);
+        message.func_id = func_id;
+        message.flags |= kFuncCallBatchFlag;
+        return message;
+    }
+
     static Message NewFuncCallComplete(const FuncCall& func_call, int32_t processing_time) {
         NEW_EMPTY_MESSAGE(message);
         message.message_type = static_cast<uint16_t>(MessageType::FUNC_CALL_COMPLETE);
@@ -573,6 +765,38 @@ public:
         return message;
     }
 
+    static SharedLogMessage NewSetCheckpointMessage(uint32_t logspace_id,
+                                                    uint32_t user_logspace,
+                                                    uint64_t tag, uint64_t seqnum) {
+        NEW_EMPTY_SHAREDLOG_MESSAGE(message);
+        message.op_type = static_cast<uint16_t>(SharedLogOpType::SET_CHECKPOINT);
+        message.logspace_id = logspace_id;
+        message.user_logspace = user_logspace;
+        message.query_tag = tag;
+        message.query_seqnum = seqnum;
+        return message;
+    }
+
+    static SharedLogMessage NewQueueCursorsMessage(uint32_t logspace_id) {
+        NEW_EMPTY_SHAREDLOG_MESSAGE(message);
+        message.op_type = static_cast<uint16_t>(SharedLogOpType::SET_CHECKPOINT);
+        message.flags = kQueueCursorFlag;
+        message.logspace_id = logspace_id;
+        return message;
+    }
+
+    static SharedLogMessage NewReadCheckpointMessage(uint32_t logspace_id,
+                                                     uint32_t user_logspace,
+                                                     uint64_t tag, uint64_t seqnum) {
+        NEW_EMPTY_SHAREDLOG_MESSAGE(message);
+        message.op_type = static_cast<uint16_t>(SharedLogOpType::READ_CHECKPOINT);
+        message.logspace_id = logspace_id;
+        message.user_logspace = user_logspace;
+        message.query_tag = tag;
+        message.query_seqnum = seqnum;
+        return message;
+    }
+
     static SharedLogMessage NewMetaLogsMessage(uint32_t logspace_id) {
         NEW_EMPTY_SHAREDLOG_MESSAGE(message);
         message.op_type = static_cast<uint16_t>(SharedLogOpType::METALOGS);
@@ -602,6 +826,14 @@ public:
         return message;
     }
 
+    static SharedLogMessage NewTagFilterMessage(uint32_t logspace_id, uint32_t position) {
+        NEW_EMPTY_SHAREDLOG_MESSAGE(message);
+        message.op_type = static_cast<uint16_t>(SharedLogOpType::TAG_FILTER);
+        message.logspace_id = logspace_id;
+        message.metalog_position = position;
+        return message;
+    }
+
     static SharedLogMessage NewReadMessage(SharedLogOpType op_type) {
         NEW_EMPTY_SHAREDLOG_MESSAGE(message);
         message.op_type = static_cast<uint16_t>(op_type);
@@ -616,6 +848,17 @@ public:
         return message;
     }
 
+    static SharedLogMessage NewBulkSyncMessage(uint32_t logspace_id, uint16_t engine_id,
+                                               uint32_t start, uint32_t end) {
+        NEW_EMPTY_SHAREDLOG_MESSAGE(message);
+        message.op_type = static_cast<uint16_t>(SharedLogOpType::BULK_SYNC);
+        message.logspace_id = logspace_id;
+        message.source_engine_id = engine_id;
+        message.query_seqnum = bits::JoinTwo32(logspace_id, start);
+        message.end_seqnum = bits::JoinTwo32(logspace_id, end);
+        return message;
+    }
+
     static SharedLogMessage NewResponse(SharedLogResultType result) {
         NEW_EMPTY_SHAREDLOG_MESSAGE(message);
         message.op_type = static_cast<uint16_t>(SharedLogOpType::RESPONSE);
@@ -1,6 +1,7 @@
 #include "engine/dispatcher.h"
 
 #include "ipc/base.h"
+#include "utils/hash.h"
 #include "engine/flags.h"
 #include "engine/engine.h"
 
@@ -15,8 +16,11 @@ using protocol::MessageHelper;
 Dispatcher::Dispatcher(Engine* engine, uint16_t func_id)
     : engine_(engine), func_id_(func_id),
       min_workers_(0), max_workers_(std::numeric_limits<size_t>::max()),
+      coalesce_calls_(false),
       log_header_(fmt::format("Dispatcher[{}]: ", func_id)),
       last_request_worker_timestamp_(-1),
+      coalesced_calls_counter_(stat::Counter::StandardReportCallback(
+          fmt::format("coalesced_calls[{}]", func_id))),
       idle_workers_stat_(stat::StatisticsCollector<uint16_t>::StandardReportCallback(
           fmt::format("idle_workers[{}]", func_id))),
       running_workers_stat_(stat::StatisticsCollector<uint16_t>::StandardReportCallback(
@@ -26,7 +30,9 @@ Dispatcher::Dispatcher(Engine* engine, uint16_t func_id)
       estimated_rps_stat_(stat::StatisticsCollector<float>::StandardReportCallback(
           fmt::format("estimated_rps[{}]", func_id))),
       estimated_concurrency_stat_(stat::StatisticsCollector<float>::StandardReportCallback(
-          fmt::format("estimated_concurrency[{}]", func_id))) {
+          fmt::format("estimated_concurrency[{}]", func_id))),
+      dispatch_batch_size_stat_(stat::StatisticsCollector<uint16_t>::StandardReportCallback(
+          fmt::format("dispatch_batch_size[{}]", func_id))) {
     const FuncConfig::Entry* func_entry = engine_->func_config()->find_by_func_id(func_id);
     DCHECK(func_entry != nullptr);
     func_config_entry_ = func_entry;
@@ -38,6 +44,10 @@ Dispatcher::Dispatcher(Engine* engine, uint16_t func_id)
         max_workers_ = gsl::narrow_cast<size_t>(func_config_entry_->max_workers);
         HLOG(INFO) << "max_workers=" << max_workers_;
     }
+    if (func_config_entry_->coalesce_calls) {
+        coalesce_calls_ = true;
+        HLOG(INFO) << "Coalescing of identical calls enabled";
+    }
 }
 
 Dispatcher::~Dispatcher() {}
@@ -74,10 +84,19 @@ void Dispatcher::OnFuncWorkerDisconnected(FuncWorker* func_worker) {
 }
 
 bool Dispatcher::OnNewFuncCall(const FuncCall& func_call, const FuncCall& parent_func_call,
-                               size_t input_size, std::span<const char> inline_input,
+                               uint32_t logspace, size_t input_size,
+                               std::span<const char> inline_input,
                                bool shm_input) {
     VLOG(1) << "OnNewFuncCall " << FuncCallHelper::DebugString(func_call);
     DCHECK_EQ(func_id_, func_call.func_id);
+    // Only external calls with inline input are coalesced, as outputs of
+    // internal calls are delivered per call (via shm or FIFO)
+    if (coalesce_calls_ && func_call.client_id == 0 && !shm_input) {
+        absl::MutexLock lk(&mu_);
+        if (TryCoalesceFuncCall(func_call, logspace, inline_input)) {
+            return true;
+        }
+    }
     Message* dispatch_func_call_message = message_pool_.Get();
     *dispatch_func_call_message = MessageHelper::NewDispatchFuncCall(func_call);
     if (shm_input) {
@@ -151,10 +170,68 @@ bool Dispatcher::OnFuncCallFailed(const FuncCall& func_call, int32_t dispatch_de
     return true;
 }
 
+void Dispatcher::GrabCoalescedFuncCalls(const FuncCall& func_call,
+                                        std::vector<FuncCall>* coalesced_calls) {
+    if (!coalesce_calls_) {
+        return;
+    }
+    absl::MutexLock lk(&mu_);
+    RemoveCoalescingCall(func_call, coalesced_calls);
+}
+
+bool Dispatcher::TryCoalesceFuncCall(const FuncCall& func_call, uint32_t logspace,
+                                     std::span<const char> input) {
+    // Calls are only equivalent within the same logspace and method
+    uint64_t input_hash = hash::xxHash64(
+        input, /* seed= */ bits::JoinTwo32(logspace, func_call.method_id));
+    if (coalescing_inputs_.contains(input_hash)) {
+        CoalescingCall& call = coalescing_calls_[coalescing_inputs_[input_hash]];
+        if (call.logspace == logspace
+                && call.method_id == func_call.method_id
+                && std::string_view(call.input) == std::string_view(input.data(), input.size())) {
+            VLOG(1) << "Coalesce func_call " << FuncCallHelper::DebugString(func_call);
+            call.coalesced_calls.push_back(func_call);
+            coalesced_calls_counter_.Tick();
+            return true;
+        }
+        // Hash collision, just dispatch it
+        return false;
+    }
+    coalescing_inputs_[input_hash] = func_call.full_call_id;
+    coalescing_calls_[func_call.full_call_id] = CoalescingCall {
+        .input_hash = input_hash,
+        .logspace = logspace,
+        .method_id = func_call.method_id,
+        .input = std::string(input.data(), input.size()),
+        .coalesced_calls = {}
+    };
+    return false;
+}
+
+void Dispatcher::RemoveCoalescingCall(const FuncCall& func_call,
+                                      std::vector<FuncCall>* coalesced_calls) {
+    if (!coalescing_calls_.contains(func_call.full_call_id)) {
+        return;
+    }
+    CoalescingCall& call = coalescing_calls_[func_call.full_call_id];
+    coalescing_inputs_.erase(call.input_hash);
+    if (coalesced_calls != nullptr) {
+        coalesced_calls->insert(coalesced_calls->end(),
+                                call.coalesced_calls.begin(), call.coalesced_calls.end());
+    }
+    coalescing_calls_.erase(func_call.full_call_id);
+}
+
 void Dispatcher::FuncWorkerFinished(FuncWorker* func_worker) {
     uint16_t client_id = func_worker->client_id();
     DCHECK(workers_.contains(client_id));
     DCHECK(running_workers_.contains(client_id));
+    if (running_batches_.contains(client_id)) {
+        if (--running_batches_[client_id] > 0) {
+            return;
+        }
+        running_batches_.erase(client_id);
+    }
     running_workers_.erase(client_id);
     if (!DispatchPendingFuncCall(func_worker)) {
         idle_workers_.push_back(client_id);
@@ -168,9 +245,20 @@ bool Dispatcher::DispatchPendingFuncCall(FuncWorker* func_worker) {
     }
     double average_processing_time = engine_->tracer()->GetAverageProcessingTime(func_id_);
     double max_relative_queueing_delay = absl::GetFlag(FLAGS_max_relative_queueing_delay);
+    size_t max_batch_size = 1;
+    if (func_worker->func_call_batch_supported()) {
+        max_batch_size = std::max<size_t>(1, absl::GetFlag(FLAGS_max_func_call_batch_size));
+    }
+    absl::InlinedVector<Message*, 16> batch;
+    size_t batch_payload_size = 0;
     int64_t current_timestamp = GetMonotonicMicroTimestamp();
-    while (!pending_func_calls_.empty()) {
+    while (!pending_func_calls_.empty() && batch.size() < max_batch_size) {
         PendingFuncCall pending_func_call = pending_func_calls_.front();
+        size_t entry_size = MessageHelper::FuncCallBatchEntrySize(
+            *pending_func_call.dispatch_func_call_message);
+        if (!batch.empty() && batch_payload_size + entry_size > MESSAGE_INLINE_DATA_SIZE) {
+            break;
+        }
         pending_func_calls_.pop();
         Tracer::FuncCallInfo* func_call_info = pending_func_call.func_call_info;
         int64_t queueing_delay;
@@ -183,15 +271,23 @@ bool Dispatcher::DispatchPendingFuncCall(FuncWorker* func_worker) {
         if (func_call.client_id == 0
                 || max_relative_queueing_delay == 0.0
                 || queueing_delay <= max_relative_queueing_delay * average_processing_time) {
-            DispatchFuncCall(func_worker, dispatch_func_call_message);
-            return true;
+            batch.push_back(dispatch_func_call_message);
+            batch_payload_size += entry_size;
         } else {
             message_pool_.Return(dispatch_func_call_message);
             engine_->DiscardFuncCall(func_call);
             engine_->tracer()->DiscardFuncCallInfo(func_call);
         }
     }
-    return false;
+    if (batch.empty()) {
+        return false;
+    }
+    if (batch.size() == 1) {
+        DispatchFuncCall(func_worker, batch[0]);
+    } else {
+        DispatchFuncCallBatch(func_worker, std::span<Message* const>(batch.data(), batch.size()));
+    }
+    return true;
 }
 
 void Dispatcher::DispatchFuncCall(FuncWorker* func_worker, Message* dispatch_func_call_message) {
@@ -206,6 +302,29 @@ void Dispatcher::DispatchFuncCall(FuncWorker* func_worker, Message* dispatch_fun
     message_pool_.Return(dispatch_func_call_message);
 }
 
+void Dispatcher::DispatchFuncCallBatch(FuncWorker* func_worker,
+                                       std::span<Message* const> dispatch_func_call_messages) {
+    uint16_t client_id = func_worker->client_id();
+    DCHECK(workers_.contains(client_id));
+    DCHECK(!running_workers_.contains(client_id));
+    DCHECK_GT(dispatch_func_call_messages.size(), 1U);
+    running_workers_[client_id] = MessageHelper::GetFuncCall(*dispatch_func_call_messages[0]);
+    running_batches_[client_id] = dispatch_func_call_messages.size();
+    Message* batch_message = message_pool_.Get();
+    *batch_message = MessageHelper::NewDispatchFuncCallBatch(func_id_);
+    for (Message* dispatch_func_call_message : dispatch_func_call_messages) {
+        FuncCall func_call = MessageHelper::GetFuncCall(*dispatch_func_call_message);
+        engine_->tracer()->OnFuncCallDispatched(func_call, func_worker);
+        assigned_workers_[func_call.full_call_id] = client_id;
+        MessageHelper::AppendToFuncCallBatch(batch_message, *dispatch_func_call_message);
+        message_pool_.Return(dispatch_func_call_message);
+    }
+    dispatch_batch_size_stat_.AddSample(
+        gsl::narrow_cast<uint16_t>(dispatch_func_call_messages.size()));
+    func_worker->SendMessage(batch_message);
+    message_pool_.Return(batch_message);
+}
+
 FuncWorker* Dispatcher::PickIdleWorker() {
     size_t max_concurrency = DetermineConcurrencyLimit();
     max_concurrency_stat_.AddSample(gsl::narrow_cast<uint32_t>(max_concurrency));
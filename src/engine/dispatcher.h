@@ -24,11 +24,14 @@ public:
     bool OnFuncWorkerConnected(std::shared_ptr<FuncWorker> func_worker);
     void OnFuncWorkerDisconnected(FuncWorker* func_worker);
     bool OnNewFuncCall(const protocol::FuncCall& func_call,
-                       const protocol::FuncCall& parent_func_call,
+                       const protocol::FuncCall& parent_func_call, uint32_t logspace,
                        size_t input_size, std::span<const char> inline_input, bool shm_input);
     bool OnFuncCallCompleted(const protocol::FuncCall& func_call,
                              int32_t processing_time, int32_t dispatch_delay, size_t output_size);
     bool OnFuncCallFailed(const protocol::FuncCall& func_call, int32_t dispatch_delay);
+    // Grab calls coalesced into `func_call`, which should receive its result
+    void GrabCoalescedFuncCalls(const protocol::FuncCall& func_call,
+                                std::vector<protocol::FuncCall>* coalesced_calls);
 
 private:
     Engine* engine_;
@@ -36,6 +39,7 @@ private:
     const FuncConfig::Entry* func_config_entry_;
     size_t min_workers_;
     size_t max_workers_;
+    bool coalesce_calls_;
 
     std::string log_header_;
     utils::ThreadSafeObjectPool<protocol::Message> message_pool_;
@@ -46,6 +50,9 @@ private:
         workers_ ABSL_GUARDED_BY(mu_);
     absl::flat_hash_map</* client_id */ uint16_t, protocol::FuncCall>
         running_workers_ ABSL_GUARDED_BY(mu_);
+    // Workers running a batch of calls, which finish after all calls complete
+    absl::flat_hash_map</* client_id */ uint16_t, /* remaining_calls */ size_t>
+        running_batches_ ABSL_GUARDED_BY(mu_);
     std::vector</* client_id */ uint16_t> idle_workers_ ABSL_GUARDED_BY(mu_);
 
     absl::flat_hash_map</* client_id */ uint16_t, /* request_timestamp */ int64_t>
@@ -61,15 +68,39 @@ private:
     absl::flat_hash_map</* full_call_id */ uint64_t, /* client_id */ uint16_t>
         assigned_workers_ ABSL_GUARDED_BY(mu_);
 
+    // In-flight external calls that identical calls can attach to
+    struct CoalescingCall {
+        uint64_t                        input_hash;
+        uint32_t                        logspace;
+        uint16_t                        method_id;
+        std::string                     input;
+        std::vector<protocol::FuncCall> coalesced_calls;
+    };
+    absl::flat_hash_map</* full_call_id */ uint64_t, CoalescingCall>
+        coalescing_calls_ ABSL_GUARDED_BY(mu_);
+    absl::flat_hash_map</* input_hash */ uint64_t, /* full_call_id */ uint64_t>
+        coalescing_inputs_ ABSL_GUARDED_BY(mu_);
+    stat::Counter coalesced_calls_counter_ ABSL_GUARDED_BY(mu_);
+
     stat::StatisticsCollector<uint16_t> idle_workers_stat_ ABSL_GUARDED_BY(mu_);
     stat::StatisticsCollector<uint16_t> running_workers_stat_ ABSL_GUARDED_BY(mu_);
     stat::StatisticsCollector<uint32_t> max_concurrency_stat_ ABSL_GUARDED_BY(mu_);
     stat::StatisticsCollector<float> estimated_rps_stat_ ABSL_GUARDED_BY(mu_);
     stat::StatisticsCollector<float> estimated_concurrency_stat_ ABSL_GUARDED_BY(mu_);
+    stat::StatisticsCollector<uint16_t> dispatch_batch_size_stat_ ABSL_GUARDED_BY(mu_);
 
     void FuncWorkerFinished(FuncWorker* func_worker) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+    bool TryCoalesceFuncCall(const protocol::FuncCall& func_call, uint32_t logspace,
+                             std::span<const char> input)
+        ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+    void RemoveCoalescingCall(const protocol::FuncCall& func_call,
+                              std::vector<protocol::FuncCall>* coalesced_calls)
+        ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
     void DispatchFuncCall(FuncWorker* func_worker, protocol::Message* dispatch_func_call_message)
         ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+    void DispatchFuncCallBatch(FuncWorker* func_worker,
+                               std::span<protocol::Message* const> dispatch_func_call_messages)
+        ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
     bool DispatchPendingFuncCall(FuncWorker* idle_func_worker) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
     FuncWorker* PickIdleWorker() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
     void UpdateWorkerLoadStat() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
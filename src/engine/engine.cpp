@@ -289,13 +289,13 @@ void Engine::HandleInvokeFuncMessage(const Message& message) {
         if (message.payload_size < 0) {
             success = dispatcher->OnNewFuncCall(
                 func_call, is_async ? protocol::kInvalidFuncCall : parent_func_call,
-                /* input_size= */ gsl::narrow_cast<size_t>(-message.payload_size),
+                /* logspace= */ 0, /* input_size= */ gsl::narrow_cast<size_t>(-message.payload_size),
                 EMPTY_CHAR_SPAN, /* shm_input= */ true);
             
         } else {
             success = dispatcher->OnNewFuncCall(
                 func_call, is_async ? protocol::kInvalidFuncCall : parent_func_call,
-                /* input_size= */ gsl::narrow_cast<size_t>(message.payload_size),
+                /* logspace= */ 0, /* input_size= */ gsl::narrow_cast<size_t>(message.payload_size),
                 MessageHelper::GetInlineData(message), /* shm_input= */ false);
         }
     }
@@ -368,14 +368,20 @@ void Engine::HandleFuncCallCompleteMessage(const Message& message) {
                 ipc::GetFuncCallOutputShmName(func_call.full_call_id));
             if (output_region == nullptr) {
                 ExternalFuncCallFailed(func_call);
+                FinishCoalescedFuncCalls(dispatcher, func_call, /* success= */ false);
             } else {
                 output_region->EnableRemoveOnDestruction();
                 ExternalFuncCallCompleted(func_call, output_region->to_span(),
                                           message.processing_time);
+                FinishCoalescedFuncCalls(dispatcher, func_call, /* success= */ true,
+                                         output_region->to_span(), message.processing_time);
             }
         } else {
             ExternalFuncCallCompleted(func_call, MessageHelper::GetInlineData(message),
                                       message.processing_time);
+            FinishCoalescedFuncCalls(dispatcher, func_call, /* success= */ true,
+                                     MessageHelper::GetInlineData(message),
+                                     message.processing_time);
         }
     } else if (is_async_call) {
         if (message.payload_size < 0) {
@@ -424,6 +430,7 @@ void Engine::HandleFuncCallFailedMessage(const Message& message) {
     }
     if (func_call.client_id == 0) {
         ExternalFuncCallFailed(func_call);
+        FinishCoalescedFuncCalls(dispatcher, func_call, /* success= */ false);
     } else if (is_async_call) {
         HLOG_F(WARNING, "Async call of func {} failed", uint16_t{func_call.func_id});
     } else if (!use_fifo_for_nested_call_) {
@@ -483,11 +490,11 @@ void Engine::OnExternalFuncCall(const FuncCall& func_call, uint32_t logspace,
     bool ret = false;
     if (input.size() <= MESSAGE_INLINE_DATA_SIZE) {
         ret = dispatcher->OnNewFuncCall(
-            func_call, protocol::kInvalidFuncCall,
+            func_call, protocol::kInvalidFuncCall, logspace,
             input.size(), /* inline_input= */ input, /* shm_input= */ false);
     } else {
         ret = dispatcher->OnNewFuncCall(
-            func_call, protocol::kInvalidFuncCall,
+            func_call, protocol::kInvalidFuncCall, logspace,
             input.size(), /* inline_input= */ EMPTY_CHAR_SPAN, /* shm_input= */ true);
     }
     if (!ret) {
@@ -562,6 +569,23 @@ void Engine::ExternalFuncCallFailed(const FuncCall& func_call, int status_code)
     SendGatewayMessage(message);
 }
 
+void Engine::FinishCoalescedFuncCalls(Dispatcher* dispatcher, const FuncCall& func_call,
+                                      bool success, std::span<const char> output,
+                                      int32_t processing_time) {
+    std::vector<FuncCall> coalesced_calls;
+    dispatcher->GrabCoalescedFuncCalls(func_call, &coalesced_calls);
+    for (const FuncCall& coalesced_call : coalesced_calls) {
+        if (enable_shared_log_) {
+            DCHECK_NOTNULL(shared_log_engine_)->OnFuncCallCompleted(coalesced_call);
+        }
+        if (success) {
+            ExternalFuncCallCompleted(coalesced_call, output, processing_time);
+        } else {
+            ExternalFuncCallFailed(coalesced_call);
+        }
+    }
+}
+
 Dispatcher* Engine::GetOrCreateDispatcher(uint16_t func_id) {
     absl::MutexLock lk(&mu_);
     Dispatcher* dispatcher = GetOrCreateDispatcherLocked(func_id);
@@ -640,10 +664,13 @@ void Engine::CreateGatewayIngressConn(int sockfd) {
 }
 
 void Engine::CreateSharedLogIngressConn(int sockfd, protocol::ConnType type,
-                                        uint16_t src_node_id) {
+                                        uint16_t src_node_id, bool striped) {
     int conn_type_id = ServerBase::GetIngressConnTypeId(type, src_node_id);
     auto connection = std::make_unique<IngressConnection>(
         conn_type_id, sockfd, sizeof(SharedLogMessage));
+    if (striped) {
+        connection->EnableStriping();
+    }
     connection->SetMessageFullSizeCallback(
         &IngressConnection::SharedLogMessageFullSizeCallback);
     connection->SetNewMessageCallback(
@@ -659,16 +686,22 @@ void Engine::CreateSharedLogIngressConn(int sockfd, protocol::ConnType type,
 
 void Engine::OnRemoteMessageConn(const protocol::HandshakeMessage& handshake,
                                  int sockfd) {
-    protocol::ConnType type = static_cast<protocol::ConnType>(handshake.conn_type);
+    protocol::ConnType type = protocol::GetConnType(handshake);
     switch (type) {
     case protocol::ConnType::GATEWAY_TO_ENGINE:
+        if (protocol::IsStripedConn(handshake)) {
+            HLOG(ERROR) << "Gateway connections do not support striping";
+            close(sockfd);
+            break;
+        }
         CreateGatewayIngressConn(sockfd);
         break;
     case protocol::ConnType::SEQUENCER_TO_ENGINE:
     case protocol::ConnType::STORAGE_TO_ENGINE:
     case protocol::ConnType::SLOG_ENGINE_TO_ENGINE:
         if (enable_shared_log_) {
-            CreateSharedLogIngressConn(sockfd, type, handshake.src_node_id);
+            CreateSharedLogIngressConn(sockfd, type, handshake.src_node_id,
+                                       protocol::IsStripedConn(handshake));
             break;
         }
         ABSL_FALLTHROUGH_INTENDED;
@@ -705,6 +738,12 @@ bool Engine::SendSharedLogMessage(protocol::ConnType conn_type, uint16_t dst_nod
     return true;
 }
 
+bool Engine::IsEgressHubCongested(protocol::ConnType conn_type, uint16_t dst_node_id) {
+    EgressHub* hub = CurrentIOWorkerChecked()->PickConnectionAs<EgressHub>(
+        ServerBase::GetEgressHubTypeId(conn_type, dst_node_id));
+    return hub != nullptr && hub->congested();
+}
+
 EgressHub* Engine::CreateEgressHub(protocol::ConnType conn_type,
                                    uint16_t dst_node_id, IOWorker* io_worker) {
     struct sockaddr_in addr;
@@ -716,9 +755,21 @@ EgressHub* Engine::CreateEgressHub(protocol::ConnType conn_type,
         ServerBase::GetEgressHubTypeId(conn_type, dst_node_id),
         &addr, absl::GetFlag(FLAGS_message_conn_per_worker));
     uint16_t src_node_id = node_id_;
+    bool striped = absl::GetFlag(FLAGS_egress_hub_enable_striping);
+    if (striped) {
+        egress_hub->EnableStriping();
+    }
     egress_hub->SetHandshakeMessageCallback(
-        [conn_type, src_node_id] (std::string* handshake) {
-            *handshake = protocol::EncodeHandshakeMessage(conn_type, src_node_id);
+        [conn_type, src_node_id, striped] (std::string* handshake) {
+            *handshake = protocol::EncodeHandshakeMessage(conn_type, src_node_id, striped);
+        }
+    );
+    egress_hub->SetBackpressureCallback(
+        [this, conn_type, dst_node_id] (bool congested) {
+            // EgressHub already logs the congestion event
+            HVLOG_F(1, "EgressHub (conn_type {}, dst_node {}) {}",
+                    static_cast<uint16_t>(conn_type), dst_node_id,
+                    congested ? "becomes congested" : "recovers from congestion");
         }
     );
     RegisterConnection(io_worker, egress_hub.get());
@@ -121,7 +121,7 @@ private:
 
     void CreateGatewayIngressConn(int sockfd);
     void CreateSharedLogIngressConn(int sockfd, protocol::ConnType type,
-                                    uint16_t src_node_id);
+                                    uint16_t src_node_id, bool striped);
 
     void OnNewLocalIpcConn(int sockfd);
     void OnLocalIpcConnClosed(MessageConnection* conn);
@@ -131,6 +131,8 @@ private:
                               std::span<const char> payload1 = EMPTY_CHAR_SPAN,
                               std::span<const char> payload2 = EMPTY_CHAR_SPAN,
                               std::span<const char> payload3 = EMPTY_CHAR_SPAN);
+    // Check the EgressHub of current IOWorker
+    bool IsEgressHubCongested(protocol::ConnType conn_type, uint16_t dst_node_id);
     server::EgressHub* CreateEgressHub(protocol::ConnType conn_type,
                                        uint16_t dst_node_id,
                                        server::IOWorker* io_worker);
@@ -151,6 +153,9 @@ private:
     void ExternalFuncCallCompleted(const protocol::FuncCall& func_call,
                                    std::span<const char> output, int32_t processing_time);
     void ExternalFuncCallFailed(const protocol::FuncCall& func_call, int status_code = 0);
+    void FinishCoalescedFuncCalls(Dispatcher* dispatcher, const protocol::FuncCall& func_call,
+                                  bool success, std::span<const char> output = EMPTY_CHAR_SPAN,
+                                  int32_t processing_time = 0);
     void AsyncFuncCallFinished(AsyncFuncCall async_call, bool success,
                                bool shm_output, std::span<const char> inline_output);
 
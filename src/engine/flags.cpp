@@ -14,6 +14,8 @@ ABSL_FLAG(double, expected_concurrency_coef, 1.0, "");
 ABSL_FLAG(int, min_worker_request_interval_ms, 200, "");
 ABSL_FLAG(bool, always_request_worker_if_possible, false, "");
 ABSL_FLAG(bool, disable_concurrency_limiter, false, "");
+ABSL_FLAG(size_t, max_func_call_batch_size, 1,
+          "Maximum number of queued calls sent to a FuncWorker in one message");
 
 ABSL_FLAG(double, instant_rps_p_norm, 1.0, "");
 ABSL_FLAG(double, instant_rps_ema_alpha, 0.001, "");
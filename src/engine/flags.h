@@ -16,6 +16,7 @@ ABSL_DECLARE_FLAG(double, expected_concurrency_coef);
 ABSL_DECLARE_FLAG(int, min_worker_request_interval_ms);
 ABSL_DECLARE_FLAG(bool, always_request_worker_if_possible);
 ABSL_DECLARE_FLAG(bool, disable_concurrency_limiter);
+ABSL_DECLARE_FLAG(size_t, max_func_call_batch_size);
 
 ABSL_DECLARE_FLAG(double, instant_rps_p_norm);
 ABSL_DECLARE_FLAG(double, instant_rps_ema_alpha);
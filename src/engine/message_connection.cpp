@@ -17,7 +17,7 @@ using protocol::MessageHelper;
 MessageConnection::MessageConnection(Engine* engine, int sockfd)
     : server::ConnectionBase(kMessageConnectionTypeId),
       engine_(engine), io_worker_(nullptr), state_(kCreated),
-      func_id_(0), client_id_(0), handshake_done_(false),
+      func_id_(0), client_id_(0), handshake_flags_(0), handshake_done_(false),
       sockfd_(sockfd), pipe_for_write_fd_(-1),
       log_header_("MessageConnection[Handshaking]: ") {
 }
@@ -155,6 +155,7 @@ void MessageConnection::RecvHandshakeMessage() {
     DCHECK(io_worker_->WithinMyEventLoopThread());
     Message* message = reinterpret_cast<Message*>(message_buffer_.data());
     func_id_ = message->func_id;
+    handshake_flags_ = message->flags;
     if (MessageHelper::IsLauncherHandshake(*message)) {
         client_id_ = 0;
         log_header_ = fmt::format("LauncherConnection[{}]: ", func_id_);
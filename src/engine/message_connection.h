@@ -24,6 +24,7 @@ public:
     bool handshake_done() const { return handshake_done_; }
     bool is_launcher_connection() const { return client_id_ == 0; }
     bool is_func_worker_connection() const { return client_id_ > 0; }
+    uint32_t handshake_flags() const { return handshake_flags_; }
 
     void Start(server::IOWorker* io_worker) override;
     void ScheduleClose() override;
@@ -39,6 +40,7 @@ private:
     State state_;
     uint16_t func_id_;
     uint16_t client_id_;
+    uint32_t handshake_flags_;
     bool handshake_done_;
 
     std::optional<int> sockfd_;
@@ -141,6 +141,8 @@ bool WorkerManager::RequestNewFuncWorkerInternal(MessageConnection* launcher_con
 FuncWorker::FuncWorker(MessageConnection* message_connection)
     : func_id_(message_connection->func_id()),
       client_id_(message_connection->client_id()),
+      func_call_batch_supported_(
+          (message_connection->handshake_flags() & protocol::kFuncCallBatchFlag) != 0),
       message_connection_(message_connection->ref_self()) {}
 
 FuncWorker::~FuncWorker() {}
@@ -47,6 +47,7 @@ public:
 
     uint16_t func_id() const { return func_id_; }
     uint16_t client_id() const { return client_id_; }
+    bool func_call_batch_supported() const { return func_call_batch_supported_; }
 
     // Must be thread-safe
     void SendMessage(protocol::Message* message);
@@ -54,6 +55,7 @@ public:
 private:
     uint16_t func_id_;
     uint16_t client_id_;
+    bool func_call_batch_supported_;
     std::shared_ptr<server::ConnectionBase> message_connection_;
 
     DISALLOW_COPY_AND_ASSIGN(FuncWorker);
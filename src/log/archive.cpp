@@ -0,0 +1,380 @@
+#include "log/archive.h"
+
+#include "common/time.h"
+#include "utils/bits.h"
+#include "utils/fs.h"
+#include "utils/io.h"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+
+__BEGIN_THIRD_PARTY_HEADERS
+#include <zstd.h>
+__END_THIRD_PARTY_HEADERS
+
+#define log_header_ "LogArchive: "
+
+namespace faas {
+namespace log {
+
+namespace {
+// Raw size of blocks, which are compressed individually
+constexpr size_t   kBlockSize        = 64 * 1024;
+constexpr int      kCompressionLevel = 3;
+constexpr uint32_t kSegmentMagic     = 0x4c474152;  // "LGAR"
+// Index offset (uint64_t) and magic (uint32_t) at the end of segment files
+constexpr size_t   kTrailerSize      = sizeof(uint64_t) + sizeof(uint32_t);
+
+template<class T>
+inline void AppendValue(std::string* buffer, T value) {
+    buffer->append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template<class T>
+inline T ReadValue(const char* ptr) {
+    T value;
+    memcpy(&value, ptr, sizeof(T));
+    return value;
+}
+
+bool ReadFully(int fd, char* buf, size_t size, uint64_t offset) {
+    while (size > 0) {
+        ssize_t nread = pread(fd, buf, size, gsl::narrow_cast<off_t>(offset));
+        if (nread <= 0) {
+            return false;
+        }
+        buf += nread;
+        size -= gsl::narrow_cast<size_t>(nread);
+        offset += gsl::narrow_cast<uint64_t>(nread);
+    }
+    return true;
+}
+
+// Makes renames within the directory durable
+bool SyncDirectory(std::string_view path) {
+    auto fd = fs_utils::Open(path, O_RDONLY | O_DIRECTORY);
+    if (!fd.has_value()) {
+        return false;
+    }
+    bool success = fsync(*fd) == 0;
+    PCHECK(close(*fd) == 0) << "Failed to close directory";
+    return success;
+}
+}  // namespace
+
+LogArchive::LogArchive(std::string_view archive_dir)
+    : archive_dir_(archive_dir),
+      tiered_bytes_counter_(stat::Counter::StandardReportCallback(
+          "storage_tiered_bytes")),
+      archived_bytes_counter_(stat::Counter::StandardReportCallback(
+          "storage_archived_bytes")),
+      read_delay_stat_(stat::StatisticsCollector<int32_t>::StandardReportCallback(
+          "storage_archive_read_delay")) {
+    if (!fs_utils::IsDirectory(archive_dir_)) {
+        CHECK(fs_utils::MakeDirectory(archive_dir_))
+            << "Failed to create archive directory " << archive_dir_;
+    }
+}
+
+LogArchive::~LogArchive() {
+    absl::MutexLock lk(&mu_);
+    for (const auto& [logspace_id, segments] : segments_) {
+        for (const auto& [start, segment] : segments) {
+            PCHECK(close(segment->fd) == 0) << "Failed to close archive file";
+        }
+    }
+}
+
+void LogArchive::LoadSegments() {
+    std::vector<std::string> names;
+    CHECK(fs_utils::ListDirectory(archive_dir_, &names))
+        << "Failed to list archive directory " << archive_dir_;
+    size_t num_segments = 0;
+    for (const std::string& name : names) {
+        unsigned int logspace_id, start, end;
+        char suffix[8];
+        if (sscanf(name.c_str(), "%08x-%08x-%08x.%7s", &logspace_id, &start, &end, suffix) != 4) {
+            continue;
+        }
+        if (std::string_view(suffix) == "seg.tmp") {
+            HLOG_F(INFO, "Remove incomplete archive file {}", name);
+            fs_utils::Remove(fs_utils::JoinPath(archive_dir_, name));
+            continue;
+        }
+        if (std::string_view(suffix) != "seg") {
+            continue;
+        }
+        auto segment = OpenSegment(fs_utils::JoinPath(archive_dir_, name), start, end);
+        if (segment == nullptr) {
+            HLOG_F(ERROR, "Skip invalid archive file {}", name);
+            continue;
+        }
+        AddSegment(logspace_id, std::move(segment));
+        {
+            absl::MutexLock lk(&mu_);
+            loaded_segments_[logspace_id].emplace_back(start, end);
+        }
+        num_segments++;
+    }
+    HLOG_F(INFO, "Load {} archived segments", num_segments);
+}
+
+std::vector<uint32_t> LogArchive::GetLogSpacesWithLoadedSegments() {
+    absl::ReaderMutexLock lk(&mu_);
+    std::vector<uint32_t> logspace_ids;
+    for (const auto& [logspace_id, ranges] : loaded_segments_) {
+        logspace_ids.push_back(logspace_id);
+    }
+    return logspace_ids;
+}
+
+std::vector<std::pair<uint32_t, uint32_t>> LogArchive::PollLoadedSegments(uint32_t logspace_id) {
+    absl::MutexLock lk(&mu_);
+    auto node = loaded_segments_.extract(logspace_id);
+    if (node.empty()) {
+        return {};
+    }
+    return std::move(node.mapped());
+}
+
+uint32_t LogArchive::GetArchivedPosition(uint32_t logspace_id) {
+    absl::ReaderMutexLock lk(&mu_);
+    if (!segments_.contains(logspace_id) || segments_.at(logspace_id).empty()) {
+        return 0;
+    }
+    return segments_.at(logspace_id).rbegin()->second->end;
+}
+
+bool LogArchive::WriteSegment(uint32_t logspace_id, uint32_t start, uint32_t end,
+                              std::span<const Entry> entries) {
+    // Written to a temporary file first, so that archive files are complete
+    // once they appear
+    std::string file_path = GetSegmentFilePath(logspace_id, start, end);
+    std::string tmp_file_path = file_path + ".tmp";
+    auto fd = fs_utils::Create(tmp_file_path);
+    if (!fd.has_value()) {
+        return false;
+    }
+    std::vector<uint32_t> block_first_keys;
+    std::vector<uint64_t> block_offsets { 0 };
+    std::string block;
+    std::string compressed;
+    size_t raw_bytes = 0;
+    auto write_block = [&] () -> bool {
+        compressed.resize(ZSTD_compressBound(block.size()));
+        size_t size = ZSTD_compress(compressed.data(), compressed.size(),
+                                    block.data(), block.size(), kCompressionLevel);
+        if (ZSTD_isError(size)) {
+            HLOG_F(ERROR, "Failed to compress block: {}", ZSTD_getErrorName(size));
+            return false;
+        }
+        if (!io_utils::WriteData(*fd, std::span<const char>(compressed.data(), size))) {
+            PLOG(ERROR) << "Failed to write archive file";
+            return false;
+        }
+        block_offsets.push_back(block_offsets.back() + size);
+        block.clear();
+        return true;
+    };
+    bool success = true;
+    for (const auto& [seqnum_lowhalf, data] : entries) {
+        DCHECK(start <= seqnum_lowhalf && seqnum_lowhalf < end);
+        if (block.empty()) {
+            block_first_keys.push_back(seqnum_lowhalf);
+        }
+        AppendValue<uint32_t>(&block, seqnum_lowhalf);
+        AppendValue<uint32_t>(&block, gsl::narrow_cast<uint32_t>(data.size()));
+        block.append(data);
+        raw_bytes += data.size();
+        if (block.size() >= kBlockSize && !write_block()) {
+            success = false;
+            break;
+        }
+    }
+    if (success && !block.empty()) {
+        success = write_block();
+    }
+    if (success) {
+        std::string index;
+        AppendValue<uint32_t>(&index, gsl::narrow_cast<uint32_t>(block_first_keys.size()));
+        for (uint32_t key : block_first_keys) {
+            AppendValue<uint32_t>(&index, key);
+        }
+        for (uint64_t offset : block_offsets) {
+            AppendValue<uint64_t>(&index, offset);
+        }
+        AppendValue<uint64_t>(&index, block_offsets.back());
+        AppendValue<uint32_t>(&index, kSegmentMagic);
+        success = io_utils::WriteData(*fd, STRING_AS_SPAN(index)) && fsync(*fd) == 0;
+    }
+    PCHECK(close(*fd) == 0) << "Failed to close archive file";
+    if (!success || rename(tmp_file_path.c_str(), file_path.c_str()) != 0) {
+        PLOG_F(ERROR, "Failed to write archive file {}", file_path);
+        fs_utils::Remove(tmp_file_path);
+        return false;
+    }
+    // Log entries are deleted from DB after this returns, thus the archive
+    // file must survive crashes by then
+    if (!SyncDirectory(archive_dir_)) {
+        PLOG_F(ERROR, "Failed to sync archive directory {}", archive_dir_);
+        fs_utils::Remove(file_path);
+        return false;
+    }
+
+    auto segment = OpenSegment(file_path, start, end);
+    if (segment == nullptr) {
+        return false;
+    }
+    AddSegment(logspace_id, std::move(segment));
+    HLOG_F(INFO, "Archive log space {} in [{}, {}): {} entries, "
+                 "{} bytes compressed into {} bytes",
+           bits::HexStr0x(logspace_id), bits::HexStr0x(start), bits::HexStr0x(end),
+           entries.size(), raw_bytes, block_offsets.back());
+    if (raw_bytes > 0) {
+        absl::MutexLock lk(&stat_mu_);
+        tiered_bytes_counter_.Tick(gsl::narrow_cast<int>(raw_bytes));
+        archived_bytes_counter_.Tick(gsl::narrow_cast<int>(block_offsets.back()));
+    }
+    return true;
+}
+
+bool LogArchive::Get(uint32_t logspace_id, uint32_t seqnum_lowhalf, const ValueCallback& fn) {
+    const Segment* segment = FindSegment(logspace_id, seqnum_lowhalf);
+    if (segment == nullptr) {
+        return false;
+    }
+    auto iter = absl::c_upper_bound(segment->block_first_keys, seqnum_lowhalf);
+    if (iter == segment->block_first_keys.begin()) {
+        return false;
+    }
+    int64_t start_timestamp = GetMonotonicMicroTimestamp();
+    size_t block_idx = gsl::narrow_cast<size_t>(
+        std::distance(segment->block_first_keys.begin(), iter) - 1);
+    uint64_t offset = segment->block_offsets[block_idx];
+    size_t compressed_size = segment->block_offsets[block_idx + 1] - offset;
+    std::string compressed(compressed_size, '\0');
+    if (!ReadFully(segment->fd, compressed.data(), compressed_size, offset)) {
+        PLOG(ERROR) << "Failed to read archive file";
+        return false;
+    }
+    unsigned long long raw_size = ZSTD_getFrameContentSize(compressed.data(), compressed_size);
+    if (raw_size == ZSTD_CONTENTSIZE_UNKNOWN || raw_size == ZSTD_CONTENTSIZE_ERROR) {
+        HLOG(ERROR) << "Invalid block of archive file";
+        return false;
+    }
+    std::string block(raw_size, '\0');
+    size_t size = ZSTD_decompress(block.data(), block.size(),
+                                  compressed.data(), compressed_size);
+    if (ZSTD_isError(size)) {
+        HLOG_F(ERROR, "Failed to decompress block: {}", ZSTD_getErrorName(size));
+        return false;
+    }
+    bool found = false;
+    const char* ptr = block.data();
+    const char* block_end = block.data() + size;
+    while (ptr + 2 * sizeof(uint32_t) <= block_end) {
+        uint32_t key = ReadValue<uint32_t>(ptr);
+        uint32_t data_size = ReadValue<uint32_t>(ptr + sizeof(uint32_t));
+        ptr += 2 * sizeof(uint32_t);
+        if (key == seqnum_lowhalf) {
+            fn(std::span<const char>(ptr, data_size));
+            found = true;
+            break;
+        }
+        ptr += data_size;
+    }
+    absl::MutexLock lk(&stat_mu_);
+    read_delay_stat_.AddSample(gsl::narrow_cast<int32_t>(
+        GetMonotonicMicroTimestamp() - start_timestamp));
+    return found;
+}
+
+std::string LogArchive::GetSegmentFilePath(uint32_t logspace_id,
+                                           uint32_t start, uint32_t end) const {
+    return fs_utils::JoinPath(archive_dir_, fmt::format("{}-{}-{}.seg", bits::HexStr(logspace_id),
+                                                        bits::HexStr(start), bits::HexStr(end)));
+}
+
+std::unique_ptr<LogArchive::Segment> LogArchive::OpenSegment(std::string_view file_path,
+                                                             uint32_t start, uint32_t end) {
+    auto fd = fs_utils::Open(file_path, O_RDONLY);
+    if (!fd.has_value()) {
+        return nullptr;
+    }
+    auto segment = std::make_unique<Segment>();
+    segment->start = start;
+    segment->end = end;
+    segment->fd = *fd;
+    auto close_on_error = gsl::finally([&segment, fd] {
+        if (segment == nullptr) {
+            PCHECK(close(*fd) == 0) << "Failed to close archive file";
+        }
+    });
+    struct stat statbuf;
+    if (fstat(*fd, &statbuf) != 0 || gsl::narrow_cast<size_t>(statbuf.st_size) < kTrailerSize) {
+        segment.reset();
+        return nullptr;
+    }
+    uint64_t file_size = gsl::narrow_cast<uint64_t>(statbuf.st_size);
+    char trailer[kTrailerSize];
+    if (!ReadFully(*fd, trailer, kTrailerSize, file_size - kTrailerSize)
+            || ReadValue<uint32_t>(trailer + sizeof(uint64_t)) != kSegmentMagic) {
+        segment.reset();
+        return nullptr;
+    }
+    uint64_t index_offset = ReadValue<uint64_t>(trailer);
+    if (index_offset + sizeof(uint32_t) + kTrailerSize > file_size) {
+        segment.reset();
+        return nullptr;
+    }
+    std::string index(file_size - kTrailerSize - index_offset, '\0');
+    if (!ReadFully(*fd, index.data(), index.size(), index_offset)) {
+        segment.reset();
+        return nullptr;
+    }
+    size_t num_blocks = ReadValue<uint32_t>(index.data());
+    if (index.size() != sizeof(uint32_t) + num_blocks * sizeof(uint32_t)
+                                         + (num_blocks + 1) * sizeof(uint64_t)) {
+        segment.reset();
+        return nullptr;
+    }
+    const char* ptr = index.data() + sizeof(uint32_t);
+    for (size_t i = 0; i < num_blocks; i++, ptr += sizeof(uint32_t)) {
+        segment->block_first_keys.push_back(ReadValue<uint32_t>(ptr));
+    }
+    for (size_t i = 0; i <= num_blocks; i++, ptr += sizeof(uint64_t)) {
+        segment->block_offsets.push_back(ReadValue<uint64_t>(ptr));
+    }
+    return segment;
+}
+
+void LogArchive::AddSegment(uint32_t logspace_id, std::unique_ptr<Segment> segment) {
+    absl::MutexLock lk(&mu_);
+    auto& segments = segments_[logspace_id];
+    uint32_t start = segment->start;
+    if (segments.count(start) > 0) {
+        HLOG_F(WARNING, "Segment of log space {} starting at {} already exists",
+               bits::HexStr0x(logspace_id), bits::HexStr0x(start));
+        PCHECK(close(segment->fd) == 0) << "Failed to close archive file";
+        return;
+    }
+    segments[start] = std::move(segment);
+}
+
+const LogArchive::Segment* LogArchive::FindSegment(uint32_t logspace_id,
+                                                   uint32_t seqnum_lowhalf) {
+    absl::ReaderMutexLock lk(&mu_);
+    if (!segments_.contains(logspace_id)) {
+        return nullptr;
+    }
+    const auto& segments = segments_.at(logspace_id);
+    auto iter = segments.upper_bound(seqnum_lowhalf);
+    if (iter == segments.begin()) {
+        return nullptr;
+    }
+    const Segment* segment = std::prev(iter)->second.get();
+    return seqnum_lowhalf < segment->end ? segment : nullptr;
+}
+
+}  // namespace log
+}  // namespace faas
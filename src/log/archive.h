@@ -0,0 +1,79 @@
+#pragma once
+
+#include "log/common.h"
+#include "common/stat.h"
+
+namespace faas {
+namespace log {
+
+// Immutable archive files of cold log entries, in a directory usually on a
+// slower disk. Each file holds one segment, i.e. a range of seqnums of a log
+// space, as zstd-compressed blocks followed by a sparse index, which keeps
+// the first seqnum and the offset of each block.
+class LogArchive {
+public:
+    explicit LogArchive(std::string_view archive_dir);
+    ~LogArchive();
+
+    // Loads sparse indices of existing archive files, and removes temporary
+    // files left by crashes
+    void LoadSegments();
+    // Log entries of loaded segments may remain in DB, if a crash happened
+    // before they were deleted. Returns log spaces with loaded segments not
+    // yet polled, and PollLoadedSegments returns [start, end) of them.
+    std::vector<uint32_t> GetLogSpacesWithLoadedSegments();
+    std::vector<std::pair<uint32_t, uint32_t>> PollLoadedSegments(uint32_t logspace_id);
+
+    // Segments of a log space are archived in order, thus all seqnums
+    // before the returned one are archived
+    uint32_t GetArchivedPosition(uint32_t logspace_id);
+
+    // `entries` are serialized log entries within [start, end), sorted by
+    // seqnum_lowhalf. Log spaces may not have all seqnums stored.
+    using Entry = std::pair</* seqnum_lowhalf */ uint32_t, std::string>;
+    bool WriteSegment(uint32_t logspace_id, uint32_t start, uint32_t end,
+                      std::span<const Entry> entries);
+
+    // Calls `fn` with the serialized log entry, which is only valid within
+    // `fn`. Returns false if not archived.
+    using ValueCallback = std::function<void(std::span<const char>)>;
+    bool Get(uint32_t logspace_id, uint32_t seqnum_lowhalf, const ValueCallback& fn);
+
+private:
+    std::string archive_dir_;
+
+    struct Segment {
+        uint32_t start;
+        uint32_t end;
+        int      fd;
+        // First seqnum_lowhalf of each block, and offsets of blocks, with
+        // the end of the last block appended
+        std::vector<uint32_t> block_first_keys;
+        std::vector<uint64_t> block_offsets;
+    };
+
+    absl::Mutex mu_;
+    // Segments are never removed, thus pointers to them remain valid
+    absl::flat_hash_map</* logspace_id */ uint32_t,
+                        std::map</* start */ uint32_t, std::unique_ptr<Segment>>>
+        segments_ ABSL_GUARDED_BY(mu_);
+    absl::flat_hash_map</* logspace_id */ uint32_t,
+                        std::vector<std::pair</* start */ uint32_t, /* end */ uint32_t>>>
+        loaded_segments_ ABSL_GUARDED_BY(mu_);
+
+    absl::Mutex stat_mu_;
+    stat::Counter tiered_bytes_counter_                  ABSL_GUARDED_BY(stat_mu_);
+    stat::Counter archived_bytes_counter_                ABSL_GUARDED_BY(stat_mu_);
+    stat::StatisticsCollector<int32_t> read_delay_stat_  ABSL_GUARDED_BY(stat_mu_);
+
+    std::string GetSegmentFilePath(uint32_t logspace_id, uint32_t start, uint32_t end) const;
+    std::unique_ptr<Segment> OpenSegment(std::string_view file_path,
+                                         uint32_t start, uint32_t end);
+    void AddSegment(uint32_t logspace_id, std::unique_ptr<Segment> segment);
+    const Segment* FindSegment(uint32_t logspace_id, uint32_t seqnum_lowhalf);
+
+    DISALLOW_COPY_AND_ASSIGN(LogArchive);
+};
+
+}  // namespace log
+}  // namespace faas
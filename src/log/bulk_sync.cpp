@@ -0,0 +1,234 @@
+#include "log/bulk_sync.h"
+
+#include "utils/bits.h"
+
+#define log_header_ "BulkSync: "
+
+namespace faas {
+namespace log {
+
+BulkSyncPlanner::BulkSyncPlanner(size_t chunk_entries, size_t max_retries,
+                                 int64_t retry_interval_us, int64_t request_timeout_us)
+    : chunk_entries_(chunk_entries),
+      max_retries_(max_retries),
+      retry_interval_us_(retry_interval_us),
+      request_timeout_us_(request_timeout_us),
+      next_task_(0),
+      num_inflight_(0) {
+    CHECK_GT(chunk_entries, 0U);
+    CHECK_GT(request_timeout_us, 0);
+}
+
+BulkSyncPlanner::~BulkSyncPlanner() {}
+
+void BulkSyncPlanner::AddTask(uint32_t logspace_id, uint16_t engine_id,
+                              std::vector<uint16_t> source_storages) {
+    DCHECK(!source_storages.empty());
+    tasks_.push_back(Task {
+        .logspace_id     = logspace_id,
+        .engine_id       = engine_id,
+        .source_storages = std::move(source_storages),
+        .next_source     = 0,
+        .num_retries     = 0,
+        .retry_timestamp = 0,
+        .target_position = std::nullopt,
+        .next_position   = 0,
+        .failed_chunks   = {},
+        .inflight_chunks = {},
+        .num_entries     = 0,
+        .failed          = false
+    });
+}
+
+bool BulkSyncPlanner::HasLogSpace(uint32_t logspace_id) const {
+    return absl::c_any_of(tasks_, [logspace_id] (const Task& task) {
+        return task.logspace_id == logspace_id;
+    });
+}
+
+uint32_t BulkSyncPlanner::ChunkEnd(const Task& task, uint32_t start) const {
+    size_t end = std::min<size_t>(size_t{start} + chunk_entries_,
+                                  std::numeric_limits<uint32_t>::max());
+    if (task.target_position.has_value()) {
+        end = std::min<size_t>(end, *task.target_position);
+    }
+    return gsl::narrow_cast<uint32_t>(end);
+}
+
+std::optional<BulkSyncPlanner::Request> BulkSyncPlanner::NextRequest(int64_t now) {
+    for (size_t i = 0; i < tasks_.size(); i++) {
+        size_t task_idx = (next_task_++) % tasks_.size();
+        Task& task = tasks_[task_idx];
+        if (task.failed || now < task.retry_timestamp) {
+            continue;
+        }
+        std::optional<uint32_t> start;
+        if (!task.target_position.has_value()) {
+            // The first request learns the target position
+            if (task.inflight_chunks.empty()) {
+                start = task.next_position;
+            }
+        } else if (!task.failed_chunks.empty()) {
+            start = task.failed_chunks.back();
+            task.failed_chunks.pop_back();
+        } else if (task.next_position < *task.target_position) {
+            start = task.next_position;
+            task.next_position = ChunkEnd(task, task.next_position);
+        }
+        if (!start.has_value()) {
+            continue;
+        }
+        uint16_t storage_id = task.source_storages[task.next_source];
+        bool inserted = task.inflight_chunks.emplace(*start, InflightChunk {
+            .storage_id      = storage_id,
+            .issue_timestamp = now
+        }).second;
+        DCHECK(inserted);
+        num_inflight_++;
+        return Request {
+            .task_idx    = task_idx,
+            .storage_id  = storage_id,
+            .logspace_id = task.logspace_id,
+            .engine_id   = task.engine_id,
+            .start       = *start,
+            .end         = ChunkEnd(task, *start)
+        };
+    }
+    return std::nullopt;
+}
+
+bool BulkSyncPlanner::OnChunkReceived(size_t task_idx, uint32_t start, uint32_t end,
+                                      uint32_t persisted_position, size_t num_entries) {
+    Task& task = tasks_.at(task_idx);
+    if (!task.inflight_chunks.erase(start)) {
+        HLOG_F(WARNING, "Chunk of log space {} starting at {} is not in flight, "
+                        "maybe already expired", bits::HexStr0x(task.logspace_id), start);
+        return false;
+    }
+    DCHECK_GT(num_inflight_, 0U);
+    num_inflight_--;
+    DCHECK_LE(start, end);
+    if (!task.target_position.has_value()) {
+        task.target_position = persisted_position;
+        task.next_position = end;
+    } else if (end < ChunkEnd(task, start)) {
+        // The source has not flushed the rest of the chunk yet
+        task.failed_chunks.push_back(end);
+    }
+    task.num_entries += num_entries;
+    return true;
+}
+
+void BulkSyncPlanner::OnChunkFailed(size_t task_idx, uint16_t storage_id,
+                                    uint32_t start, int64_t now) {
+    Task& task = tasks_.at(task_idx);
+    auto iter = task.inflight_chunks.find(start);
+    if (iter == task.inflight_chunks.end() || iter->second.storage_id != storage_id) {
+        // Already expired, or requested again from another storage
+        return;
+    }
+    task.inflight_chunks.erase(iter);
+    DCHECK_GT(num_inflight_, 0U);
+    num_inflight_--;
+    if (task.failed) {
+        return;
+    }
+    if (task.target_position.has_value()) {
+        task.failed_chunks.push_back(start);
+    }
+    if (storage_id != task.source_storages[task.next_source]) {
+        // Already switched away from this storage
+        return;
+    }
+    // Switch to the next source storage for the remaining chunks
+    if (task.next_source + 1 < task.source_storages.size()) {
+        task.next_source++;
+        HLOG_F(WARNING, "Copying log space {} from storage {} failed, switch to storage {}",
+               bits::HexStr0x(task.logspace_id), storage_id,
+               task.source_storages[task.next_source]);
+    } else if (task.num_retries < max_retries_) {
+        task.num_retries++;
+        task.next_source = 0;
+        task.retry_timestamp = now + retry_interval_us_;
+        HLOG_F(WARNING, "Copying log space {} from engine {} failed on all storage nodes, "
+                        "retry {} of {} in {}ms",
+               bits::HexStr0x(task.logspace_id), task.engine_id,
+               task.num_retries, max_retries_, retry_interval_us_ / 1000);
+    } else {
+        HLOG_F(ERROR, "Copying log space {} from engine {} failed after {} retries",
+               bits::HexStr0x(task.logspace_id), task.engine_id, max_retries_);
+        task.failed = true;
+    }
+}
+
+size_t BulkSyncPlanner::ExpireChunks(int64_t now) {
+    size_t num_expired = 0;
+    for (size_t task_idx = 0; task_idx < tasks_.size(); task_idx++) {
+        std::vector<std::pair</* start */ uint32_t, /* storage_id */ uint16_t>> expired;
+        for (const auto& [start, chunk] : tasks_[task_idx].inflight_chunks) {
+            if (now - chunk.issue_timestamp >= request_timeout_us_) {
+                expired.emplace_back(start, chunk.storage_id);
+            }
+        }
+        for (const auto& [start, storage_id] : expired) {
+            HLOG_F(WARNING, "Chunk of log space {} starting at {} from storage {} "
+                            "timed out", bits::HexStr0x(tasks_[task_idx].logspace_id),
+                   start, storage_id);
+            OnChunkFailed(task_idx, storage_id, start, now);
+        }
+        num_expired += expired.size();
+    }
+    return num_expired;
+}
+
+BulkSyncPlanner::Status BulkSyncPlanner::CheckStatus(
+        absl::flat_hash_map<uint32_t, uint32_t>* synced_positions,
+        size_t* num_entries) const {
+    // Copied log spaces are complete, if every task has received all chunks
+    // before its target position
+    synced_positions->clear();
+    *num_entries = 0;
+    bool failed = false;
+    for (const Task& task : tasks_) {
+        if (task.failed) {
+            failed = true;
+            continue;
+        }
+        if (!task.target_position.has_value() || !task.inflight_chunks.empty()
+                || !task.failed_chunks.empty()
+                || task.next_position < *task.target_position) {
+            return kInProgress;
+        }
+        // Different source storages may have flushed to different positions
+        auto [iter, inserted] = synced_positions->emplace(task.logspace_id,
+                                                          *task.target_position);
+        if (!inserted) {
+            iter->second = std::min(iter->second, *task.target_position);
+        }
+        *num_entries += task.num_entries;
+    }
+    return failed ? kFailed : kDone;
+}
+
+bool BulkSyncPlanner::ParsePayload(std::span<const char> payload, size_t count,
+                                   std::vector<Entry>* entries) {
+    entries->clear();
+    const char* ptr = payload.data();
+    const char* payload_end = payload.data() + payload.size();
+    while (ptr + 2 * sizeof(uint32_t) <= payload_end) {
+        uint32_t seqnum_lowhalf;
+        uint32_t size;
+        memcpy(&seqnum_lowhalf, ptr, sizeof(uint32_t));
+        memcpy(&size, ptr + sizeof(uint32_t), sizeof(uint32_t));
+        ptr += 2 * sizeof(uint32_t);
+        if (size > gsl::narrow_cast<size_t>(payload_end - ptr)) {
+            return false;
+        }
+        entries->emplace_back(seqnum_lowhalf, std::span<const char>(ptr, size));
+        ptr += size;
+    }
+    return ptr == payload_end && entries->size() == count;
+}
+
+}  // namespace log
+}  // namespace faas
@@ -0,0 +1,110 @@
+#pragma once
+
+#include "log/common.h"
+
+namespace faas {
+namespace log {
+
+// Plans bulk sync of a storage node, see FLAGS_slog_storage_bulk_sync. For
+// each log space and each of its source engines, a task copies log entries
+// in chunks of seqnums from other storage nodes storing them. The first
+// response of a task tells the persisted position of its source, which
+// becomes the target position of the task.
+//
+// When a chunk fails, the task switches to the next source storage. After
+// all of them fail, the task starts over after `retry_interval_us`, for at
+// most `max_retries` rounds. Chunks in flight for longer than
+// `request_timeout_us` fail the same way, and late responses to them are
+// ignored. Chunks clipped by a source with a smaller persisted position are
+// requested again from where they stop.
+//
+// Not thread-safe. Messaging is left to the caller, so the planner can be
+// driven without a cluster.
+class BulkSyncPlanner {
+public:
+    BulkSyncPlanner(size_t chunk_entries, size_t max_retries, int64_t retry_interval_us,
+                    int64_t request_timeout_us);
+    ~BulkSyncPlanner();
+
+    void AddTask(uint32_t logspace_id, uint16_t engine_id,
+                 std::vector<uint16_t> source_storages);
+
+    size_t num_tasks() const { return tasks_.size(); }
+    size_t num_inflight() const { return num_inflight_; }
+    bool HasLogSpace(uint32_t logspace_id) const;
+
+    // Requests log entries of `logspace_id` within [start, end), which are
+    // stored from `engine_id`
+    struct Request {
+        size_t   task_idx;
+        uint16_t storage_id;
+        uint32_t logspace_id;
+        uint16_t engine_id;
+        uint32_t start;
+        uint32_t end;
+    };
+    // Returns the next request, round-robin among tasks, so that log spaces
+    // and source storages are copied in parallel. Returns std::nullopt if no
+    // task has anything to request at `now`.
+    std::optional<Request> NextRequest(int64_t now);
+
+    // `end` is the end of the chunk, clipped by the persisted position of
+    // the source, which is `persisted_position`. Returns false if the chunk
+    // is not in flight, e.g. already expired, thus ignored.
+    bool OnChunkReceived(size_t task_idx, uint32_t start, uint32_t end,
+                         uint32_t persisted_position, size_t num_entries);
+    // Only failures from the current source of the task switch its source
+    void OnChunkFailed(size_t task_idx, uint16_t storage_id, uint32_t start, int64_t now);
+    // Fails chunks in flight for longer than `request_timeout_us` at `now`,
+    // and returns the number of them
+    size_t ExpireChunks(int64_t now);
+
+    enum Status { kInProgress, kDone, kFailed };
+    // With kDone, `synced_positions` is set to the position of each log
+    // space, before which all log entries are copied
+    Status CheckStatus(absl::flat_hash_map</* logspace_id */ uint32_t, uint32_t>*
+                           synced_positions,
+                       size_t* num_entries) const;
+
+    // Verifies that `payload` of a BULK_SYNC_OK response holds exactly
+    // `count` log entries, and parses them in place
+    using Entry = std::pair</* seqnum_lowhalf */ uint32_t, std::span<const char>>;
+    static bool ParsePayload(std::span<const char> payload, size_t count,
+                             std::vector<Entry>* entries);
+
+private:
+    size_t  chunk_entries_;
+    size_t  max_retries_;
+    int64_t retry_interval_us_;
+    int64_t request_timeout_us_;
+
+    struct InflightChunk {
+        uint16_t storage_id;
+        int64_t  issue_timestamp;
+    };
+
+    struct Task {
+        uint32_t logspace_id;
+        uint16_t engine_id;
+        std::vector<uint16_t> source_storages;
+        size_t   next_source;      // Index of the storage currently copied from
+        size_t   num_retries;
+        int64_t  retry_timestamp;  // No requests before this time
+        std::optional<uint32_t> target_position;
+        uint32_t next_position;    // Start of the next chunk to request
+        std::vector</* start */ uint32_t> failed_chunks;
+        absl::flat_hash_map</* start */ uint32_t, InflightChunk> inflight_chunks;
+        size_t   num_entries;
+        bool     failed;
+    };
+    std::vector<Task> tasks_;
+    size_t next_task_;
+    size_t num_inflight_;
+
+    uint32_t ChunkEnd(const Task& task, uint32_t start) const;
+
+    DISALLOW_COPY_AND_ASSIGN(BulkSyncPlanner);
+};
+
+}  // namespace log
+}  // namespace faas
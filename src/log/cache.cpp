@@ -1,5 +1,13 @@
 #include "log/cache.h"
 
+#include "common/time.h"
+#include "log/flags.h"
+#include "utils/bits.h"
+#include "utils/fs.h"
+#include "utils/hash.h"
+
+#include <fcntl.h>
+
 __BEGIN_THIRD_PARTY_HEADERS
 #include <tkrzw_dbm_cache.h>
 __END_THIRD_PARTY_HEADERS
@@ -7,12 +15,328 @@ __END_THIRD_PARTY_HEADERS
 namespace faas {
 namespace log {
 
-LRUCache::LRUCache(int mem_cap_mb) {
+FileCache::FileCache(std::string_view file_path, int file_cap_mb)
+    : file_path_(file_path),
+      capacity_(uint64_t{gsl::narrow_cast<uint32_t>(file_cap_mb)} << 20),
+      pending_bytes_(0),
+      stopped_(false),
+      writer_thread_("FileCache", absl::bind_front(&FileCache::WriterThreadMain, this)),
+      write_position_(0) {
+    CHECK_GT(file_cap_mb, 0);
+    fd_ = open(file_path_.c_str(), O_CREAT | O_RDWR | O_TRUNC | O_CLOEXEC,
+               __FAAS_FILE_CREAT_MODE);
+    PCHECK(fd_ != -1) << "Failed to open file cache " << file_path_;
+    LOG_F(INFO, "File cache created at {} with capacity {}MB", file_path_, file_cap_mb);
+    writer_thread_.Start();
+}
+
+FileCache::~FileCache() {
+    {
+        absl::MutexLock lk(&pending_mu_);
+        stopped_ = true;
+        pending_cv_.Signal();
+    }
+    writer_thread_.Join();
+    PCHECK(close(fd_) == 0) << "Failed to close file cache";
+    fs_utils::Remove(file_path_);
+}
+
+void FileCache::Put(uint64_t seqnum, std::string data) {
+    if (data.size() > capacity_) {
+        return;
+    }
+    absl::MutexLock lk(&pending_mu_);
+    if (pending_bytes_ + data.size() > kMaxPendingBytes) {
+        // The writer falls behind, and the entry is still in the memory tier
+        return;
+    }
+    pending_bytes_ += data.size();
+    pending_entries_.emplace_back(seqnum, std::move(data));
+    pending_cv_.Signal();
+}
+
+void FileCache::WriterThreadMain() {
+    std::vector<std::pair<uint64_t, std::string>> entries;
+    while (true) {
+        {
+            absl::MutexLock lk(&pending_mu_);
+            while (!stopped_ && pending_entries_.empty()) {
+                pending_cv_.Wait(&pending_mu_);
+            }
+            if (stopped_) {
+                break;
+            }
+            entries.swap(pending_entries_);
+            pending_bytes_ = 0;
+        }
+        for (const auto& [seqnum, data] : entries) {
+            WriteRecord(seqnum, STRING_AS_SPAN(data));
+        }
+        entries.clear();
+    }
+}
+
+void FileCache::WriteRecord(uint64_t seqnum, std::span<const char> data) {
+    uint64_t position;
+    {
+        // Records to be overwritten are removed first, so that readers
+        // never see them. Only this thread writes, thus the file is written
+        // without holding `mu_`.
+        absl::MutexLock lk(&mu_);
+        if (records_.contains(seqnum)) {
+            return;
+        }
+        position = write_position_;
+        if (position % capacity_ + data.size() > capacity_) {
+            // Records never wrap around the end of the file
+            position += capacity_ - position % capacity_;
+        }
+        uint64_t end_position = position + data.size();
+        while (!seqnums_.empty()) {
+            const Record& oldest = records_.at(seqnums_.front());
+            if (oldest.position + capacity_ >= end_position) {
+                break;
+            }
+            records_.erase(seqnums_.front());
+            seqnums_.pop_front();
+        }
+        write_position_ = end_position;
+    }
+    ssize_t nwrite = pwrite(fd_, data.data(), data.size(),
+                            gsl::narrow_cast<off_t>(position % capacity_));
+    if (nwrite != gsl::narrow_cast<ssize_t>(data.size())) {
+        PLOG(ERROR) << "Failed to write file cache";
+        return;
+    }
+    absl::MutexLock lk(&mu_);
+    records_[seqnum] = Record {
+        .position = position,
+        .size     = gsl::narrow_cast<uint32_t>(data.size())
+    };
+    seqnums_.push_back(seqnum);
+}
+
+std::optional<std::string> FileCache::Get(uint64_t seqnum) {
+    absl::ReaderMutexLock lk(&mu_);
+    if (!records_.contains(seqnum)) {
+        return std::nullopt;
+    }
+    const Record& record = records_.at(seqnum);
+    std::string data;
+    data.resize(record.size);
+    ssize_t nread = pread(fd_, data.data(), record.size,
+                          gsl::narrow_cast<off_t>(record.position % capacity_));
+    if (nread != gsl::narrow_cast<ssize_t>(record.size)) {
+        PLOG(ERROR) << "Failed to read file cache";
+        return std::nullopt;
+    }
+    return data;
+}
+
+FrequencySketch::FrequencySketch(size_t num_counters)
+    : num_increments_(0) {
+    size_t num_words = 1;
+    while (num_words * 16 < num_counters) {
+        num_words <<= 1;
+    }
+    table_.assign(num_words, 0);
+    sample_size_ = num_words * 16 * 10;
+}
+
+FrequencySketch::~FrequencySketch() {}
+
+void FrequencySketch::CounterIndices(uint64_t key, size_t* indices) const {
+    uint64_t h = hash::xxHash64(key);
+    uint64_t h1 = bits::LowHalf64(h);
+    uint64_t h2 = bits::HighHalf64(h) | 1;
+    size_t num_counters = table_.size() * 16;
+    for (size_t i = 0; i < kNumHashes; i++) {
+        indices[i] = (h1 + i * h2) % num_counters;
+    }
+}
+
+void FrequencySketch::Increment(uint64_t key) {
+    size_t indices[kNumHashes];
+    CounterIndices(key, indices);
+    for (size_t idx : indices) {
+        uint64_t& word = table_[idx / 16];
+        size_t shift = (idx % 16) * 4;
+        if (((word >> shift) & 0xf) < 0xf) {
+            word += uint64_t{1} << shift;
+        }
+    }
+    if (++num_increments_ >= sample_size_) {
+        Reset();
+    }
+}
+
+uint32_t FrequencySketch::Estimate(uint64_t key) const {
+    size_t indices[kNumHashes];
+    CounterIndices(key, indices);
+    uint32_t result = 0xf;
+    for (size_t idx : indices) {
+        uint64_t word = table_[idx / 16];
+        result = std::min(result, gsl::narrow_cast<uint32_t>((word >> ((idx % 16) * 4)) & 0xf));
+    }
+    return result;
+}
+
+void FrequencySketch::Reset() {
+    for (uint64_t& word : table_) {
+        word = (word >> 1) & 0x7777777777777777ULL;
+    }
+    num_increments_ /= 2;
+}
+
+SLRUCache::SLRUCache(size_t capacity)
+    : window_capacity_(capacity / 100),
+      main_capacity_(capacity - window_capacity_),
+      protected_capacity_(main_capacity_ / 5 * 4),
+      // Assume log entries are no smaller than 256 bytes
+      sketch_(std::max<size_t>(capacity / 256, 4096)),
+      window_size_(0),
+      probation_size_(0),
+      protected_size_(0) {}
+
+SLRUCache::~SLRUCache() {}
+
+void SLRUCache::Put(uint64_t key, std::string data) {
+    if (data.size() > main_capacity_) {
+        return;
+    }
+    absl::MutexLock lk(&mu_);
+    if (entries_.contains(key)) {
+        return;
+    }
+    window_size_ += data.size();
+    window_list_.push_front(key);
+    entries_[key] = Entry {
+        .data     = std::move(data),
+        .segment  = kWindow,
+        .lru_iter = window_list_.begin()
+    };
+    while (window_size_ > window_capacity_) {
+        AdmitFromWindowLocked();
+    }
+}
+
+void SLRUCache::AdmitFromWindowLocked() {
+    DCHECK(!window_list_.empty());
+    uint64_t candidate = window_list_.back();
+    window_list_.pop_back();
+    Entry& entry = entries_.at(candidate);
+    size_t size = entry.data.size();
+    window_size_ -= size;
+    // Victims are checked before evicting any of them, so that a rejected
+    // candidate leaves the main cache untouched
+    std::vector<uint64_t> victims;
+    size_t main_size = probation_size_ + protected_size_;
+    if (main_size + size > main_capacity_) {
+        uint32_t frequency = sketch_.Estimate(candidate);
+        size_t freed_size = 0;
+        auto probation_iter = probation_list_.rbegin();
+        auto protected_iter = protected_list_.rbegin();
+        while (main_size - freed_size + size > main_capacity_) {
+            uint64_t victim;
+            if (probation_iter != probation_list_.rend()) {
+                victim = *(probation_iter++);
+            } else {
+                DCHECK(protected_iter != protected_list_.rend());
+                victim = *(protected_iter++);
+            }
+            if (frequency <= sketch_.Estimate(victim)) {
+                // Not admitted
+                entries_.erase(candidate);
+                return;
+            }
+            victims.push_back(victim);
+            freed_size += entries_.at(victim).data.size();
+        }
+    }
+    for (uint64_t victim : victims) {
+        EvictLocked(victim);
+    }
+    probation_size_ += size;
+    probation_list_.push_front(candidate);
+    entry.segment = kProbation;
+    entry.lru_iter = probation_list_.begin();
+}
+
+std::optional<std::string> SLRUCache::Get(uint64_t key) {
+    absl::MutexLock lk(&mu_);
+    sketch_.Increment(key);
+    auto iter = entries_.find(key);
+    if (iter == entries_.end()) {
+        return std::nullopt;
+    }
+    Entry& entry = iter->second;
+    if (entry.segment == kWindow) {
+        window_list_.splice(window_list_.begin(), window_list_, entry.lru_iter);
+        return entry.data;
+    }
+    if (entry.segment == kProtected) {
+        protected_list_.splice(protected_list_.begin(), protected_list_, entry.lru_iter);
+        return entry.data;
+    }
+    // Promote to the protected segment, which may demote its LRU entries
+    probation_list_.erase(entry.lru_iter);
+    probation_size_ -= entry.data.size();
+    protected_list_.push_front(key);
+    protected_size_ += entry.data.size();
+    entry.segment = kProtected;
+    entry.lru_iter = protected_list_.begin();
+    while (protected_size_ > protected_capacity_ && protected_list_.size() > 1) {
+        uint64_t demoted_key = protected_list_.back();
+        protected_list_.pop_back();
+        Entry& demoted = entries_.at(demoted_key);
+        protected_size_ -= demoted.data.size();
+        probation_list_.push_front(demoted_key);
+        probation_size_ += demoted.data.size();
+        demoted.segment = kProbation;
+        demoted.lru_iter = probation_list_.begin();
+    }
+    return entry.data;
+}
+
+void SLRUCache::EvictLocked(uint64_t key) {
+    auto iter = entries_.find(key);
+    DCHECK(iter != entries_.end());
+    Entry& entry = iter->second;
+    if (entry.segment == kWindow) {
+        window_list_.erase(entry.lru_iter);
+        window_size_ -= entry.data.size();
+    } else if (entry.segment == kProtected) {
+        protected_list_.erase(entry.lru_iter);
+        protected_size_ -= entry.data.size();
+    } else {
+        probation_list_.erase(entry.lru_iter);
+        probation_size_ -= entry.data.size();
+    }
+    entries_.erase(iter);
+}
+
+LRUCache::LRUCache(int mem_cap_mb, std::string_view file_path, int file_cap_mb)
+    : lookup_stat_(stat::CategoryCounter::StandardReportCallback(
+          "log_cache_lookup (0=memory_hit, 1=file_hit, 2=miss)")),
+      memory_read_delay_stat_(stat::StatisticsCollector<int32_t>::StandardReportCallback(
+          "log_cache_memory_read_delay_ns")),
+      file_read_delay_stat_(stat::StatisticsCollector<int32_t>::StandardReportCallback(
+          "log_cache_file_read_delay_ns")) {
     int64_t cap_mem_size = -1;
     if (mem_cap_mb > 0) {
         cap_mem_size = int64_t{mem_cap_mb} << 20;
     }
     dbm_.reset(new tkrzw::CacheDBM(/* cap_rec_num= */ -1, cap_mem_size));
+    std::string policy = absl::GetFlag(FLAGS_slog_cache_policy);
+    if (policy == "tinylfu") {
+        CHECK_GT(mem_cap_mb, 0) << "Cache with tinylfu policy must have capacity";
+        slru_cache_.reset(new SLRUCache(size_t{gsl::narrow_cast<uint32_t>(mem_cap_mb)} << 20));
+    } else if (policy != "lru") {
+        LOG(FATAL) << "Unknown log cache policy: " << policy;
+    }
+    if (!file_path.empty()) {
+        file_cache_.reset(new FileCache(file_path, file_cap_mb));
+    }
 }
 
 LRUCache::~LRUCache() {}
@@ -67,20 +391,69 @@ void LRUCache::Put(const LogMetaData& log_metadata, std::span<const uint64_t> us
                    std::span<const char> log_data) {
     std::string key_str = fmt::format("0_{:016x}", log_metadata.seqnum);
     std::string data = EncodeLogEntry(log_metadata, user_tags, log_data);
-    dbm_->Set(key_str, data, /* overwrite= */ false);
+    // CacheDBM evicts entries silently, thus all entries are written through
+    // to the file tier, which holds the evicted ones as well
+    if (file_cache_ != nullptr) {
+        file_cache_->Put(log_metadata.seqnum, data);
+    }
+    if (slru_cache_ != nullptr) {
+        slru_cache_->Put(log_metadata.seqnum, std::move(data));
+    } else {
+        dbm_->Set(key_str, data, /* overwrite= */ false);
+    }
 }
 
 std::optional<LogEntry> LRUCache::Get(uint64_t seqnum) {
+    int64_t start_timestamp = file_cache_ != nullptr ? GetMonotonicNanoTimestamp() : 0;
     std::string key_str = fmt::format("0_{:016x}", seqnum);
     std::string data;
-    auto status = dbm_->Get(key_str, &data);
-    if (status.IsOK()) {
-        LogEntry log_entry;
-        DecodeLogEntry(std::move(data), &log_entry);
-        DCHECK_EQ(seqnum, log_entry.metadata.seqnum);
-        return log_entry;
+    bool memory_hit = false;
+    if (slru_cache_ != nullptr) {
+        std::optional<std::string> cached_data = slru_cache_->Get(seqnum);
+        if (cached_data.has_value()) {
+            data = std::move(*cached_data);
+            memory_hit = true;
+        }
     } else {
-        return std::nullopt;
+        memory_hit = dbm_->Get(key_str, &data).IsOK();
+    }
+    LookupResult result = kMemoryHit;
+    if (!memory_hit) {
+        std::optional<std::string> file_data;
+        if (file_cache_ != nullptr) {
+            file_data = file_cache_->Get(seqnum);
+        }
+        if (!file_data.has_value()) {
+            RecordLookup(kMiss, start_timestamp);
+            return std::nullopt;
+        }
+        data = std::move(*file_data);
+        // Promote back to the memory tier
+        if (slru_cache_ != nullptr) {
+            slru_cache_->Put(seqnum, data);
+        } else {
+            dbm_->Set(key_str, data, /* overwrite= */ false);
+        }
+        result = kFileHit;
+    }
+    LogEntry log_entry;
+    DecodeLogEntry(std::move(data), &log_entry);
+    DCHECK_EQ(seqnum, log_entry.metadata.seqnum);
+    RecordLookup(result, start_timestamp);
+    return log_entry;
+}
+
+void LRUCache::RecordLookup(LookupResult result, int64_t start_timestamp) {
+    if (file_cache_ == nullptr) {
+        return;
+    }
+    int32_t delay = gsl::narrow_cast<int32_t>(GetMonotonicNanoTimestamp() - start_timestamp);
+    absl::MutexLock lk(&stat_mu_);
+    lookup_stat_.Tick(result);
+    if (result == kMemoryHit) {
+        memory_read_delay_stat_.AddSample(delay);
+    } else if (result == kFileHit) {
+        file_read_delay_stat_.AddSample(delay);
     }
 }
 
@@ -101,5 +474,236 @@ std::optional<std::string> LRUCache::GetAuxData(uint64_t seqnum) {
     }
 }
 
+TailCache::TailCache(size_t max_tags)
+    : max_tags_(max_tags),
+      lookup_stat_(stat::CategoryCounter::StandardReportCallback(
+          "tail_cache_lookup (0=hit, 1=miss, 2=stale)")),
+      hit_read_delay_stat_(stat::StatisticsCollector<int32_t>::StandardReportCallback(
+          "tail_read_delay_cache_hit")),
+      miss_read_delay_stat_(stat::StatisticsCollector<int32_t>::StandardReportCallback(
+          "tail_read_delay_cache_miss")) {
+    DCHECK_GT(max_tags, 0U);
+}
+
+TailCache::~TailCache() {}
+
+void TailCache::Put(const LogMetaData& log_metadata, std::span<const uint64_t> user_tags,
+                    std::span<const char> log_data) {
+    DCHECK_NE(log_metadata.seqnum, kInvalidLogSeqNum);
+    auto log_entry = std::make_shared<LogEntry>();
+    log_entry->metadata = log_metadata;
+    log_entry->user_tags.assign(user_tags.begin(), user_tags.end());
+    log_entry->data.assign(log_data.data(), log_data.size());
+    absl::MutexLock lk(&mu_);
+    PutLocked(Key(log_metadata.user_logspace, kEmptyLogTag), log_metadata.seqnum,
+              log_entry, /* indexed= */ false);
+    for (uint64_t tag : user_tags) {
+        PutLocked(Key(log_metadata.user_logspace, tag), log_metadata.seqnum,
+                  log_entry, /* indexed= */ false);
+    }
+}
+
+void TailCache::UpdateTail(uint32_t user_logspace, std::span<const uint64_t> user_tags,
+                           uint64_t seqnum) {
+    absl::MutexLock lk(&mu_);
+    uint64_t& max_seqnum = max_indexed_seqnums_[user_logspace];
+    max_seqnum = std::max(max_seqnum, seqnum);
+    PutLocked(Key(user_logspace, kEmptyLogTag), seqnum, nullptr, /* indexed= */ true);
+    for (uint64_t tag : user_tags) {
+        PutLocked(Key(user_logspace, tag), seqnum, nullptr, /* indexed= */ true);
+    }
+}
+
+void TailCache::UpdateIndexProgress(uint32_t logspace_id, uint64_t metalog_progress) {
+    absl::MutexLock lk(&mu_);
+    uint64_t& progress = index_progress_[logspace_id];
+    progress = std::max(progress, metalog_progress);
+}
+
+std::optional<LogEntry> TailCache::Get(uint32_t user_logspace, uint64_t tag,
+                                       uint64_t seqnum) {
+    absl::MutexLock lk(&mu_);
+    auto iter = entries_.find(Key(user_logspace, tag));
+    if (iter == entries_.end()) {
+        lookup_stat_.Tick(kMiss);
+        return std::nullopt;
+    }
+    const Entry& entry = iter->second;
+    if (entry.log_entry == nullptr || entry.log_entry->metadata.seqnum != seqnum) {
+        lookup_stat_.Tick(kStale);
+        return std::nullopt;
+    }
+    lookup_stat_.Tick(kHit);
+    lru_list_.splice(lru_list_.end(), lru_list_, entry.lru_iter);
+    return *entry.log_entry;
+}
+
+std::optional<LogEntry> TailCache::GetTail(uint32_t logspace_id, uint32_t user_logspace,
+                                           uint64_t tag, uint64_t max_seqnum,
+                                           uint64_t metalog_progress,
+                                           uint64_t* index_progress) {
+    absl::MutexLock lk(&mu_);
+    // Tails are only complete for log entries covered by the index progress
+    auto progress_iter = index_progress_.find(logspace_id);
+    if (progress_iter == index_progress_.end() || progress_iter->second < metalog_progress) {
+        return std::nullopt;
+    }
+    auto iter = entries_.find(Key(user_logspace, tag));
+    if (iter == entries_.end()) {
+        return std::nullopt;
+    }
+    const Entry& entry = iter->second;
+    if (!entry.complete || entry.log_entry == nullptr || entry.tail_seqnum > max_seqnum) {
+        return std::nullopt;
+    }
+    DCHECK_EQ(entry.log_entry->metadata.seqnum, entry.tail_seqnum);
+    lru_list_.splice(lru_list_.end(), lru_list_, entry.lru_iter);
+    *index_progress = progress_iter->second;
+    return *entry.log_entry;
+}
+
+void TailCache::RecordReadDelay(bool cache_hit, int32_t delay_us) {
+    absl::MutexLock lk(&mu_);
+    if (cache_hit) {
+        hit_read_delay_stat_.AddSample(delay_us);
+    } else {
+        miss_read_delay_stat_.AddSample(delay_us);
+    }
+}
+
+void TailCache::PutLocked(const Key& key, uint64_t seqnum,
+                          std::shared_ptr<const LogEntry> log_entry, bool indexed) {
+    // Index data of newer log entries may have been received while the
+    // tag was not cached, in which case `seqnum` may not be the tail. Only
+    // index data newer than all received so far tells the real tail.
+    bool complete = false;
+    if (indexed) {
+        auto max_seqnum_iter = max_indexed_seqnums_.find(key.first);
+        complete = (max_seqnum_iter != max_indexed_seqnums_.end()
+                    && max_seqnum_iter->second <= seqnum);
+    }
+    auto iter = entries_.find(key);
+    if (iter != entries_.end()) {
+        Entry& entry = iter->second;
+        if (complete && entry.tail_seqnum <= seqnum) {
+            entry.complete = true;
+        }
+        if (entry.tail_seqnum < seqnum) {
+            // Cached data, if any, is no longer the tail
+            entry.tail_seqnum = seqnum;
+            entry.log_entry = std::move(log_entry);
+        } else if (entry.tail_seqnum == seqnum && entry.log_entry == nullptr) {
+            entry.log_entry = std::move(log_entry);
+        }
+        lru_list_.splice(lru_list_.end(), lru_list_, entry.lru_iter);
+        return;
+    }
+    if (entries_.size() >= max_tags_) {
+        RemoveLocked(lru_list_.front());
+    }
+    lru_list_.push_back(key);
+    entries_[key] = Entry {
+        .tail_seqnum = seqnum,
+        .complete    = complete,
+        .log_entry   = std::move(log_entry),
+        .lru_iter    = std::prev(lru_list_.end())
+    };
+}
+
+void TailCache::RemoveLocked(const Key& key) {
+    auto iter = entries_.find(key);
+    DCHECK(iter != entries_.end());
+    lru_list_.erase(iter->second.lru_iter);
+    entries_.erase(iter);
+}
+
+RecentAppendBuffer::RecentAppendBuffer(absl::Duration ttl, size_t max_entries)
+    : ttl_us_(absl::ToInt64Microseconds(ttl)),
+      max_entries_(max_entries),
+      storage_read_avoided_counter_(stat::Counter::StandardReportCallback(
+          "recent_append_storage_read_avoided")) {
+    DCHECK_GT(max_entries, 0U);
+}
+
+RecentAppendBuffer::~RecentAppendBuffer() {}
+
+void RecentAppendBuffer::Put(const LogMetaData& log_metadata,
+                             std::span<const uint64_t> user_tags,
+                             std::span<const char> log_data) {
+    DCHECK_NE(log_metadata.seqnum, kInvalidLogSeqNum);
+    auto log_entry = std::make_shared<LogEntry>();
+    log_entry->metadata = log_metadata;
+    log_entry->user_tags.assign(user_tags.begin(), user_tags.end());
+    log_entry->data.assign(log_data.data(), log_data.size());
+    int64_t current_timestamp = GetMonotonicMicroTimestamp();
+    absl::MutexLock lk(&mu_);
+    RemoveExpiredLocked(current_timestamp);
+    entries_.push_back(Entry {
+        .timestamp = current_timestamp,
+        .log_entry = log_entry
+    });
+    entries_by_tag_[Key(log_metadata.user_logspace, kEmptyLogTag)].push_back(log_entry);
+    for (uint64_t tag : user_tags) {
+        entries_by_tag_[Key(log_metadata.user_logspace, tag)].push_back(log_entry);
+    }
+}
+
+std::optional<LogEntry> RecentAppendBuffer::Get(uint32_t user_logspace, uint64_t tag,
+                                                uint64_t seqnum) {
+    absl::MutexLock lk(&mu_);
+    RemoveExpiredLocked(GetMonotonicMicroTimestamp());
+    const LogEntry* log_entry = FindLocked(Key(user_logspace, tag), seqnum);
+    if (log_entry == nullptr) {
+        return std::nullopt;
+    }
+    storage_read_avoided_counter_.Tick();
+    return *log_entry;
+}
+
+void RecentAppendBuffer::RemoveExpiredLocked(int64_t current_timestamp) {
+    while (!entries_.empty()) {
+        const Entry& entry = entries_.front();
+        if (entries_.size() < max_entries_
+                && current_timestamp - entry.timestamp < ttl_us_) {
+            break;
+        }
+        const LogMetaData& metadata = entry.log_entry->metadata;
+        RemoveFromTagLocked(Key(metadata.user_logspace, kEmptyLogTag), metadata.seqnum);
+        for (uint64_t tag : entry.log_entry->user_tags) {
+            RemoveFromTagLocked(Key(metadata.user_logspace, tag), metadata.seqnum);
+        }
+        entries_.pop_front();
+    }
+}
+
+void RecentAppendBuffer::RemoveFromTagLocked(const Key& key, uint64_t seqnum) {
+    auto iter = entries_by_tag_.find(key);
+    DCHECK(iter != entries_by_tag_.end());
+    std::deque<LogEntryPtr>& tag_entries = iter->second;
+    // Entries expire in the order of appending, so usually the first one
+    auto entry_iter = absl::c_find_if(tag_entries, [seqnum] (const LogEntryPtr& entry) {
+        return entry->metadata.seqnum == seqnum;
+    });
+    DCHECK(entry_iter != tag_entries.end());
+    tag_entries.erase(entry_iter);
+    if (tag_entries.empty()) {
+        entries_by_tag_.erase(iter);
+    }
+}
+
+const LogEntry* RecentAppendBuffer::FindLocked(const Key& key, uint64_t seqnum) {
+    auto iter = entries_by_tag_.find(key);
+    if (iter == entries_by_tag_.end()) {
+        return nullptr;
+    }
+    const std::deque<LogEntryPtr>& tag_entries = iter->second;
+    for (auto entry_iter = tag_entries.rbegin(); entry_iter != tag_entries.rend(); entry_iter++) {
+        if ((*entry_iter)->metadata.seqnum == seqnum) {
+            return entry_iter->get();
+        }
+    }
+    return nullptr;
+}
+
 }  // namespace log
 }  // namespace faas
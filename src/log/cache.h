@@ -1,6 +1,11 @@
 #pragma once
 
 #include "log/common.h"
+#include "common/stat.h"
+#include "base/thread.h"
+
+#include <list>
+#include <deque>
 
 // Forward declarations
 namespace tkrzw { class CacheDBM; }
@@ -8,9 +13,131 @@ namespace tkrzw { class CacheDBM; }
 namespace faas {
 namespace log {
 
+// Second tier of LRUCache on local disk. Encoded log entries are appended
+// to a file of fixed capacity used as a ring buffer, thus the oldest ones
+// are overwritten first. The index is kept in memory, and the file is
+// removed on destruction. Put only queues the entry, which is written to
+// the file by a background thread, so that callers never wait for disk
+// writes. Entries queued beyond kMaxPendingBytes are dropped.
+class FileCache {
+public:
+    FileCache(std::string_view file_path, int file_cap_mb);
+    ~FileCache();
+
+    void Put(uint64_t seqnum, std::string data);
+    std::optional<std::string> Get(uint64_t seqnum);
+
+private:
+    static constexpr size_t kMaxPendingBytes = 64 << 20;
+
+    std::string file_path_;
+    int fd_;
+    uint64_t capacity_;
+
+    absl::Mutex pending_mu_;
+    absl::CondVar pending_cv_;
+    std::vector<std::pair</* seqnum */ uint64_t, std::string>>
+        pending_entries_        ABSL_GUARDED_BY(pending_mu_);
+    size_t pending_bytes_       ABSL_GUARDED_BY(pending_mu_);
+    bool stopped_               ABSL_GUARDED_BY(pending_mu_);
+    base::Thread writer_thread_;
+
+    struct Record {
+        uint64_t position;
+        uint32_t size;
+    };
+
+    absl::Mutex mu_;
+    // Logical position of the next record, where the file offset is
+    // `position % capacity_`
+    uint64_t write_position_ ABSL_GUARDED_BY(mu_);
+    absl::flat_hash_map</* seqnum */ uint64_t, Record> records_ ABSL_GUARDED_BY(mu_);
+    // Seqnums in the order of writing, for removing overwritten records
+    std::deque<uint64_t> seqnums_ ABSL_GUARDED_BY(mu_);
+
+    void WriterThreadMain();
+    void WriteRecord(uint64_t seqnum, std::span<const char> data);
+
+    DISALLOW_COPY_AND_ASSIGN(FileCache);
+};
+
+// Count-min sketch of 4-bit counters, estimating how often keys are
+// accessed recently. All counters are halved after a number of increments
+// proportional to the sketch size, so that old accesses fade out (TinyLFU).
+class FrequencySketch {
+public:
+    explicit FrequencySketch(size_t num_counters);
+    ~FrequencySketch();
+
+    void Increment(uint64_t key);
+    uint32_t Estimate(uint64_t key) const;
+
+private:
+    static constexpr size_t kNumHashes = 4;
+
+    // Each word holds 16 counters
+    std::vector<uint64_t> table_;
+    size_t sample_size_;
+    size_t num_increments_;
+
+    void CounterIndices(uint64_t key, size_t* indices) const;
+    void Reset();
+
+    DISALLOW_COPY_AND_ASSIGN(FrequencySketch);
+};
+
+// Segmented LRU with W-TinyLFU admission. New entries always enter a small
+// LRU window (1% of capacity), so that they have a chance to be read before
+// admission. Entries leaving the window enter the probation segment of the
+// main cache, and are promoted to the protected segment when read again.
+// When the main cache is full, an entry leaving the window replaces LRU
+// entries of the main cache only if it is accessed more frequently than all
+// of them, thus one-off scans cannot flush frequently read entries.
+class SLRUCache {
+public:
+    explicit SLRUCache(size_t capacity);
+    ~SLRUCache();
+
+    void Put(uint64_t key, std::string data);
+    std::optional<std::string> Get(uint64_t key);
+
+private:
+    size_t window_capacity_;
+    size_t main_capacity_;
+    size_t protected_capacity_;
+
+    enum Segment { kWindow, kProbation, kProtected };
+    struct Entry {
+        std::string                   data;
+        Segment                       segment;
+        std::list<uint64_t>::iterator lru_iter;
+    };
+
+    absl::Mutex mu_;
+    FrequencySketch sketch_                      ABSL_GUARDED_BY(mu_);
+    absl::flat_hash_map<uint64_t, Entry> entries_ ABSL_GUARDED_BY(mu_);
+    // Most recently used at the front
+    std::list<uint64_t> window_list_             ABSL_GUARDED_BY(mu_);
+    std::list<uint64_t> probation_list_          ABSL_GUARDED_BY(mu_);
+    std::list<uint64_t> protected_list_          ABSL_GUARDED_BY(mu_);
+    size_t window_size_                          ABSL_GUARDED_BY(mu_);
+    size_t probation_size_                       ABSL_GUARDED_BY(mu_);
+    size_t protected_size_                       ABSL_GUARDED_BY(mu_);
+
+    // Moves the LRU entry of the window into the main cache if admitted,
+    // otherwise drops it
+    void AdmitFromWindowLocked() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+    void EvictLocked(uint64_t key) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+    DISALLOW_COPY_AND_ASSIGN(SLRUCache);
+};
+
 class LRUCache {
 public:
-    explicit LRUCache(int mem_cap_mb);
+    // With non-empty `file_path`, log entries are also written to a FileCache
+    // of `file_cap_mb`, which is checked on misses of the memory tier
+    explicit LRUCache(int mem_cap_mb, std::string_view file_path = std::string_view{},
+                      int file_cap_mb = 0);
     ~LRUCache();
 
     void Put(const LogMetaData& log_metadata, std::span<const uint64_t> user_tags,
@@ -22,9 +149,138 @@ public:
 
 private:
     std::unique_ptr<tkrzw::CacheDBM> dbm_;
+    // With "tinylfu" policy, log entries are kept in `slru_cache_`, while
+    // `dbm_` only keeps auxiliary data
+    std::unique_ptr<SLRUCache> slru_cache_;
+    std::unique_ptr<FileCache> file_cache_;
+
+    absl::Mutex stat_mu_;
+    enum LookupResult { kMemoryHit = 0, kFileHit = 1, kMiss = 2 };
+    stat::CategoryCounter lookup_stat_                  ABSL_GUARDED_BY(stat_mu_);
+    stat::StatisticsCollector<int32_t> memory_read_delay_stat_  ABSL_GUARDED_BY(stat_mu_);
+    stat::StatisticsCollector<int32_t> file_read_delay_stat_    ABSL_GUARDED_BY(stat_mu_);
+
+    // Lookups are only recorded with the file tier, as they otherwise take
+    // `stat_mu_` on every memory hit
+    void RecordLookup(LookupResult result, int64_t start_timestamp);
 
     DISALLOW_COPY_AND_ASSIGN(LRUCache);
 };
 
+// Keeps the tail seqnum of each (user_logspace, tag) known to index engines,
+// together with the tail log entry when this engine has its data, so that
+// reading the tail of a tag (READ_PREV from kMaxLogSeqNum, as issued by
+// CheckTail) can be served without querying the index or reading storage.
+// Tail seqnums come from index data, and log entries come from local appends
+// and storage reads. The number of cached tags is bounded, and the least
+// recently used tag is evicted first.
+class TailCache {
+public:
+    explicit TailCache(size_t max_tags);
+    ~TailCache();
+
+    // `log_metadata.seqnum` must be known. The entry is cached for every tag
+    // in `user_tags` and for kEmptyLogTag, unless newer entries are known.
+    void Put(const LogMetaData& log_metadata, std::span<const uint64_t> user_tags,
+             std::span<const char> log_data);
+    // Index data told us `seqnum` is appended to `user_tags`, which becomes
+    // their tail if newer than the known one
+    void UpdateTail(uint32_t user_logspace, std::span<const uint64_t> user_tags,
+                    uint64_t seqnum);
+    // Index of `logspace_id` has all log entries up to `metalog_progress`,
+    // and their tail seqnums are already passed to UpdateTail
+    void UpdateIndexProgress(uint32_t logspace_id, uint64_t metalog_progress);
+
+    // Only returns the cached entry if its seqnum is `seqnum`, i.e. the one
+    // found by the index
+    std::optional<LogEntry> Get(uint32_t user_logspace, uint64_t tag, uint64_t seqnum);
+    // Returns the tail log entry of `tag` if it is cached, is at or before
+    // `max_seqnum`, and is not older than any log entry within
+    // `metalog_progress`. `index_progress` is set to the index progress
+    // that vouches for the result.
+    std::optional<LogEntry> GetTail(uint32_t logspace_id, uint32_t user_logspace,
+                                    uint64_t tag, uint64_t max_seqnum,
+                                    uint64_t metalog_progress, uint64_t* index_progress);
+
+    void RecordReadDelay(bool cache_hit, int32_t delay_us);
+
+private:
+    size_t max_tags_;
+
+    using Key = std::pair</* user_logspace */ uint32_t, /* tag */ uint64_t>;
+    struct Entry {
+        uint64_t                        tail_seqnum;
+        // Set by UpdateTail, when no newer index data of the tag could have
+        // been received before, so that `tail_seqnum` is the real tail
+        bool                            complete;
+        // Null if this engine does not have data of the tail
+        std::shared_ptr<const LogEntry> log_entry;
+        std::list<Key>::iterator        lru_iter;
+    };
+
+    absl::Mutex mu_;
+    absl::flat_hash_map<Key, Entry> entries_  ABSL_GUARDED_BY(mu_);
+    std::list<Key> lru_list_                  ABSL_GUARDED_BY(mu_);
+    absl::flat_hash_map</* logspace_id */ uint32_t, /* metalog_progress */ uint64_t>
+        index_progress_ ABSL_GUARDED_BY(mu_);
+    // Largest seqnum in index data received for each user logspace
+    absl::flat_hash_map</* user_logspace */ uint32_t, /* seqnum */ uint64_t>
+        max_indexed_seqnums_ ABSL_GUARDED_BY(mu_);
+
+    enum LookupResult { kHit = 0, kMiss = 1, kStale = 2 };
+    stat::CategoryCounter lookup_stat_        ABSL_GUARDED_BY(mu_);
+    stat::StatisticsCollector<int32_t> hit_read_delay_stat_   ABSL_GUARDED_BY(mu_);
+    stat::StatisticsCollector<int32_t> miss_read_delay_stat_  ABSL_GUARDED_BY(mu_);
+
+    // `indexed` is set for tail seqnums from index data
+    void PutLocked(const Key& key, uint64_t seqnum, std::shared_ptr<const LogEntry> log_entry,
+                   bool indexed) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+    void RemoveLocked(const Key& key) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+    DISALLOW_COPY_AND_ASSIGN(TailCache);
+};
+
+// Short-lived buffer of log entries recently appended by this engine, for
+// functions reading their own writes. Entries are indexed by
+// (user_logspace, tag), and expire after `ttl` or when the buffer is full.
+// Only consulted after the index finds a seqnum, as the buffer cannot tell
+// whether older views or other engines hold a better match.
+class RecentAppendBuffer {
+public:
+    RecentAppendBuffer(absl::Duration ttl, size_t max_entries);
+    ~RecentAppendBuffer();
+
+    // `log_metadata.seqnum` must be known
+    void Put(const LogMetaData& log_metadata, std::span<const uint64_t> user_tags,
+             std::span<const char> log_data);
+    std::optional<LogEntry> Get(uint32_t user_logspace, uint64_t tag, uint64_t seqnum);
+
+private:
+    int64_t ttl_us_;
+    size_t max_entries_;
+
+    using Key = std::pair</* user_logspace */ uint32_t, /* tag */ uint64_t>;
+    using LogEntryPtr = std::shared_ptr<const LogEntry>;
+    struct Entry {
+        int64_t     timestamp;
+        LogEntryPtr log_entry;
+    };
+
+    absl::Mutex mu_;
+    std::deque<Entry> entries_                        ABSL_GUARDED_BY(mu_);
+    absl::flat_hash_map<Key, std::deque<LogEntryPtr>>
+        entries_by_tag_                               ABSL_GUARDED_BY(mu_);
+
+    stat::Counter storage_read_avoided_counter_       ABSL_GUARDED_BY(mu_);
+
+    void RemoveExpiredLocked(int64_t current_timestamp) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+    void RemoveFromTagLocked(const Key& key, uint64_t seqnum)
+        ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+    const LogEntry* FindLocked(const Key& key, uint64_t seqnum)
+        ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+    DISALLOW_COPY_AND_ASSIGN(RecentAppendBuffer);
+};
+
 }  // namespace log
 }  // namespace faas
@@ -108,6 +108,7 @@ void Controller::ReconfigView(const Configuration& configuration) {
     view_proto.set_userlog_replicas(gsl::narrow_cast<uint32_t>(userlog_replicas_));
     view_proto.set_index_replicas(gsl::narrow_cast<uint32_t>(index_replicas_));
     view_proto.set_num_phylogs(gsl::narrow_cast<uint32_t>(configuration.num_phylogs));
+    view_proto.set_index_partitioned(absl::GetFlag(FLAGS_slog_index_partitioned));
     for (uint16_t node_id : configuration.sequencer_nodes) {
         view_proto.add_sequencer_nodes(node_id);
     }
@@ -317,6 +318,7 @@ void Controller::InfoCommandHandler() {
         stream << "  UserLogReplica = " << view->userlog_replicas() << "\n";
         stream << "  IndexReplica = " << view->index_replicas() << "\n";
         stream << "  NumPhyLogs = " << view->num_phylogs() << "\n";
+        stream << "  IndexPartitioned = " << view->index_partitioned() << "\n";
         stream << "  Sequencers = [";
         for (uint16_t sequencer_id : view->GetSequencerNodes()) {
             stream << sequencer_id << ", ";
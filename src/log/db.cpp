@@ -1,10 +1,16 @@
 #include "log/db.h"
 
 #include "utils/bits.h"
+#include "utils/hash.h"
 
 __BEGIN_THIRD_PARTY_HEADERS
 
 #include <rocksdb/db.h>
+#include <rocksdb/cache.h>
+#include <rocksdb/filter_policy.h>
+#include <rocksdb/slice_transform.h>
+#include <rocksdb/table.h>
+#include <rocksdb/write_batch.h>
 
 #include <tkrzw_dbm.h>
 #include <tkrzw_dbm_hash.h>
@@ -16,6 +22,9 @@ __END_THIRD_PARTY_HEADERS
 ABSL_FLAG(int, rocksdb_max_background_jobs, 2, "");
 ABSL_FLAG(size_t, rocksdb_block_cache_size_mb, 1024, "");
 ABSL_FLAG(bool, rocksdb_enable_compression, false, "");
+ABSL_FLAG(size_t, rocksdb_shared_column_families, 0,
+          "If non-zero, log spaces share this number of column families, "
+          "instead of having one column family each");
 
 #define ROCKSDB_CHECK_OK(STATUS_VAR, OP_NAME)               \
     do {                                                    \
@@ -38,32 +47,198 @@ ABSL_FLAG(bool, rocksdb_enable_compression, false, "");
 namespace faas {
 namespace log {
 
+namespace {
+// Keys of log entries are 8 hex digits, thus never collide with these ones
+static inline std::string CheckpointKey(uint32_t user_logspace, uint64_t tag, uint64_t seqnum) {
+    return fmt::format("ckpt-{}-{}-{}", bits::HexStr(user_logspace),
+                       bits::HexStr(tag), bits::HexStr(seqnum));
+}
+
+static inline std::string QueueCursorKey(uint32_t user_logspace, uint64_t tag) {
+    return fmt::format("qcursor-{}-{}", bits::HexStr(user_logspace), bits::HexStr(tag));
+}
+
+static inline std::optional<uint64_t> DecodeQueueCursor(std::optional<std::string> data) {
+    if (!data.has_value()) {
+        return std::nullopt;
+    }
+    if (data->size() != sizeof(uint64_t)) {
+        HLOG_F(ERROR, "Invalid size of queue cursor: {}", data->size());
+        return std::nullopt;
+    }
+    uint64_t seqnum;
+    memcpy(&seqnum, data->data(), sizeof(uint64_t));
+    return seqnum;
+}
+
+static constexpr std::string_view kPendingKeyPrefix = "pending-";
+// Sorted right after all pending keys, as '.' follows '-'
+static constexpr std::string_view kPendingKeyLimit = "pending.";
+
+static inline std::string PendingKey(uint64_t localid) {
+    return fmt::format("{}{}", kPendingKeyPrefix, bits::HexStr(localid));
+}
+
+// With shared column families, keys start with the logspace id in 8 hex digits
+static constexpr size_t kLogSpaceKeyPrefixLength = 8;
+
+static inline std::string LogSpaceKeyPrefix(uint32_t logspace_id) {
+    return bits::HexStr(logspace_id);
+}
+
+// Sorted after all keys with the prefix of `logspace_id`, as keys after the
+// prefix consist of hex digits, letters, and '-'
+static inline std::string LogSpaceKeyLimit(uint32_t logspace_id) {
+    return LogSpaceKeyPrefix(logspace_id) + "~";
+}
+
+static void SetCompression(rocksdb::ColumnFamilyOptions* options) {
+    if (absl::GetFlag(FLAGS_rocksdb_enable_compression)) {
+        options->compression = rocksdb::kZSTD;
+    } else {
+        options->compression = rocksdb::kNoCompression;
+    }
+}
+
+static rocksdb::ColumnFamilyOptions LogSpaceColumnFamilyOptions() {
+    rocksdb::ColumnFamilyOptions options;
+    SetCompression(&options);
+    options.OptimizeForPointLookup(
+        absl::GetFlag(FLAGS_rocksdb_block_cache_size_mb));
+    return options;
+}
+
+// Column families of log spaces are named by logspace ids in 8 hex digits
+static bool ParseLogSpaceColumnFamilyName(const std::string& name, uint32_t* logspace_id) {
+    if (name.size() != 8) {
+        return false;
+    }
+    char* end = nullptr;
+    unsigned long parsed = strtoul(name.c_str(), &end, 16);
+    if (end != name.c_str() + name.size()) {
+        return false;
+    }
+    *logspace_id = gsl::narrow_cast<uint32_t>(parsed);
+    return true;
+}
+
+static rocksdb::ColumnFamilyOptions SharedColumnFamilyOptions(
+        std::shared_ptr<rocksdb::Cache> block_cache) {
+    rocksdb::ColumnFamilyOptions options;
+    SetCompression(&options);
+    rocksdb::BlockBasedTableOptions table_options;
+    table_options.block_cache = std::move(block_cache);
+    table_options.data_block_index_type =
+        rocksdb::BlockBasedTableOptions::kDataBlockBinaryAndHash;
+    table_options.filter_policy.reset(rocksdb::NewBloomFilterPolicy(10));
+    // Filters include both prefixes and whole keys, where prefix filters
+    // rule out SST files without keys of the log space
+    table_options.whole_key_filtering = true;
+    options.table_factory.reset(rocksdb::NewBlockBasedTableFactory(table_options));
+    options.prefix_extractor.reset(
+        rocksdb::NewFixedPrefixTransform(kLogSpaceKeyPrefixLength));
+    options.memtable_prefix_bloom_size_ratio = 0.02;
+    options.memtable_whole_key_filtering = true;
+    return options;
+}
+}  // namespace
+
 RocksDBBackend::RocksDBBackend(std::string_view db_path) {
     rocksdb::Options options;
     options.create_if_missing = true;
     options.max_background_jobs = absl::GetFlag(FLAGS_rocksdb_max_background_jobs);
     rocksdb::DB* db;
     HLOG_F(INFO, "Open RocksDB at path {}", db_path);
-    auto status = rocksdb::DB::Open(options, std::string(db_path), &db);
+    size_t num_shared_cfs = absl::GetFlag(FLAGS_rocksdb_shared_column_families);
+    if (num_shared_cfs == 0) {
+        // RocksDB requires opening all existing column families. Those of log
+        // spaces created before restart are registered as installed, and
+        // InstallLogSpace keeps them when views are replayed.
+        std::vector<std::string> cf_names;
+        auto status = rocksdb::DB::ListColumnFamilies(options, std::string(db_path), &cf_names);
+        if (!status.ok()) {
+            // No DB yet
+            cf_names = { rocksdb::kDefaultColumnFamilyName };
+        }
+        std::vector<rocksdb::ColumnFamilyDescriptor> cf_descs;
+        for (const std::string& cf_name : cf_names) {
+            if (cf_name == rocksdb::kDefaultColumnFamilyName) {
+                cf_descs.emplace_back(cf_name, rocksdb::ColumnFamilyOptions());
+            } else {
+                cf_descs.emplace_back(cf_name, LogSpaceColumnFamilyOptions());
+            }
+        }
+        std::vector<rocksdb::ColumnFamilyHandle*> cf_handles;
+        status = rocksdb::DB::Open(options, std::string(db_path), cf_descs, &cf_handles, &db);
+        ROCKSDB_CHECK_OK(status, Open);
+        db_.reset(db);
+        DCHECK_EQ(cf_handles.size(), cf_names.size());
+        absl::MutexLock lk(&mu_);
+        for (size_t i = 0; i < cf_handles.size(); i++) {
+            uint32_t logspace_id;
+            if (!ParseLogSpaceColumnFamilyName(cf_names[i], &logspace_id)) {
+                if (cf_names[i] != rocksdb::kDefaultColumnFamilyName) {
+                    HLOG_F(WARNING, "Unknown column family {}", cf_names[i]);
+                }
+                status = db_->DestroyColumnFamilyHandle(cf_handles[i]);
+                ROCKSDB_CHECK_OK(status, DestroyColumnFamilyHandle);
+                continue;
+            }
+            HLOG_F(INFO, "Reopen log space {}", bits::HexStr0x(logspace_id));
+            column_families_[logspace_id].reset(DCHECK_NOTNULL(cf_handles[i]));
+        }
+        return;
+    }
+    HLOG_F(INFO, "Log spaces share {} column families", num_shared_cfs);
+    options.create_missing_column_families = true;
+    block_cache_ = rocksdb::NewLRUCache(
+        absl::GetFlag(FLAGS_rocksdb_block_cache_size_mb) << 20);
+    std::vector<rocksdb::ColumnFamilyDescriptor> cf_descs;
+    cf_descs.emplace_back(rocksdb::kDefaultColumnFamilyName, rocksdb::ColumnFamilyOptions());
+    for (size_t i = 0; i < num_shared_cfs; i++) {
+        cf_descs.emplace_back(fmt::format("shared-{}", i),
+                              SharedColumnFamilyOptions(block_cache_));
+    }
+    std::vector<rocksdb::ColumnFamilyHandle*> cf_handles;
+    auto status = rocksdb::DB::Open(options, std::string(db_path),
+                                    cf_descs, &cf_handles, &db);
     ROCKSDB_CHECK_OK(status, Open);
     db_.reset(db);
+    DCHECK_EQ(cf_handles.size(), num_shared_cfs + 1);
+    // Default column family is not used
+    status = db_->DestroyColumnFamilyHandle(cf_handles[0]);
+    ROCKSDB_CHECK_OK(status, DestroyColumnFamilyHandle);
+    for (size_t i = 1; i < cf_handles.size(); i++) {
+        shared_cf_handles_.emplace_back(DCHECK_NOTNULL(cf_handles[i]));
+    }
 }
 
 RocksDBBackend::~RocksDBBackend() {}
 
 void RocksDBBackend::InstallLogSpace(uint32_t logspace_id) {
     HLOG_F(INFO, "Install log space {}", bits::HexStr0x(logspace_id));
-    rocksdb::ColumnFamilyOptions options;
-    if (absl::GetFlag(FLAGS_rocksdb_enable_compression)) {
-        options.compression = rocksdb::kZSTD;
-    } else {
-        options.compression = rocksdb::kNoCompression;
+    if (shared_column_families()) {
+        {
+            absl::MutexLock lk(&mu_);
+            DCHECK(!shared_logspaces_.contains(logspace_id));
+            shared_logspaces_.insert(logspace_id);
+        }
+        DeleteStalePending(logspace_id);
+        return;
+    }
+    bool reopened;
+    {
+        absl::MutexLock lk(&mu_);
+        reopened = column_families_.contains(logspace_id);
+    }
+    if (reopened) {
+        // Reopened from a previous run
+        DeleteStalePending(logspace_id);
+        return;
     }
-    options.OptimizeForPointLookup(
-        absl::GetFlag(FLAGS_rocksdb_block_cache_size_mb));
     rocksdb::ColumnFamilyHandle* cf_handle = nullptr;
     auto status = db_->CreateColumnFamily(
-        options, bits::HexStr(logspace_id), &cf_handle);
+        LogSpaceColumnFamilyOptions(), bits::HexStr(logspace_id), &cf_handle);
     ROCKSDB_CHECK_OK(status, CreateColumnFamily);
     {
         absl::MutexLock lk(&mu_);
@@ -72,15 +247,194 @@ void RocksDBBackend::InstallLogSpace(uint32_t logspace_id) {
     }
 }
 
+bool RocksDBBackend::HasLogSpace(uint32_t logspace_id) {
+    return GetCFHandle(logspace_id) != nullptr;
+}
+
 std::optional<std::string> RocksDBBackend::Get(uint32_t logspace_id, uint32_t key) {
+    return GetInternal(logspace_id, bits::HexStr(key));
+}
+
+// Value is pinned in block cache or memtable, instead of copied out
+bool RocksDBBackend::GetPinned(uint32_t logspace_id, uint32_t key, const ValueCallback& fn) {
+    rocksdb::ColumnFamilyHandle* cf_handle = GetCFHandle(logspace_id);
+    if (cf_handle == nullptr) {
+        HLOG_F(WARNING, "Log space {} not created", bits::HexStr0x(logspace_id));
+        return false;
+    }
+    std::string db_key = MakeKey(logspace_id, bits::HexStr(key));
+    rocksdb::PinnableSlice value;
+    auto status = db_->Get(rocksdb::ReadOptions(), cf_handle, db_key, &value);
+    if (status.IsNotFound()) {
+        return false;
+    }
+    ROCKSDB_CHECK_OK(status, Get);
+    fn(std::span<const char>(value.data(), value.size()));
+    return true;
+}
+
+void RocksDBBackend::MultiGetPinned(uint32_t logspace_id, std::span<const uint32_t> keys,
+                                    const MultiValueCallback& fn) {
+    rocksdb::ColumnFamilyHandle* cf_handle = GetCFHandle(logspace_id);
+    if (cf_handle == nullptr) {
+        HLOG_F(WARNING, "Log space {} not created", bits::HexStr0x(logspace_id));
+        return;
+    }
+    size_t num_keys = keys.size();
+    std::vector<std::string> db_keys;
+    db_keys.reserve(num_keys);
+    for (uint32_t key : keys) {
+        db_keys.push_back(MakeKey(logspace_id, bits::HexStr(key)));
+    }
+    std::vector<rocksdb::Slice> key_slices(db_keys.begin(), db_keys.end());
+    std::vector<rocksdb::PinnableSlice> values(num_keys);
+    std::vector<rocksdb::Status> statuses(num_keys);
+    db_->MultiGet(rocksdb::ReadOptions(), cf_handle, num_keys,
+                  key_slices.data(), values.data(), statuses.data());
+    for (size_t i = 0; i < num_keys; i++) {
+        if (statuses[i].IsNotFound()) {
+            continue;
+        }
+        ROCKSDB_CHECK_OK(statuses[i], MultiGet);
+        fn(i, std::span<const char>(values[i].data(), values[i].size()));
+    }
+}
+
+void RocksDBBackend::Put(uint32_t logspace_id, uint32_t key, std::span<const char> data) {
+    PutInternal(logspace_id, bits::HexStr(key), data);
+}
+
+std::optional<std::string> RocksDBBackend::GetCheckpoint(uint32_t logspace_id,
+                                                         uint32_t user_logspace,
+                                                         uint64_t tag, uint64_t seqnum) {
+    return GetInternal(logspace_id, CheckpointKey(user_logspace, tag, seqnum));
+}
+
+void RocksDBBackend::PutCheckpoint(uint32_t logspace_id, uint32_t user_logspace,
+                                   uint64_t tag, uint64_t seqnum,
+                                   std::span<const char> data) {
+    PutInternal(logspace_id, CheckpointKey(user_logspace, tag, seqnum), data);
+}
+
+std::optional<uint64_t> RocksDBBackend::GetQueueCursor(uint32_t logspace_id,
+                                                       uint32_t user_logspace, uint64_t tag) {
+    return DecodeQueueCursor(GetInternal(logspace_id, QueueCursorKey(user_logspace, tag)));
+}
+
+void RocksDBBackend::PutQueueCursors(uint32_t logspace_id, std::span<const uint64_t> cursors) {
+    DCHECK_EQ(cursors.size() % 3, 0U);
+    rocksdb::ColumnFamilyHandle* cf_handle = GetCFHandle(logspace_id);
+    if (cf_handle == nullptr) {
+        HLOG_F(ERROR, "Log space {} not created", bits::HexStr0x(logspace_id));
+        return;
+    }
+    rocksdb::WriteBatch batch;
+    for (size_t i = 0; i + 2 < cursors.size(); i += 3) {
+        std::string key = QueueCursorKey(gsl::narrow_cast<uint32_t>(cursors[i]),
+                                         cursors[i + 1]);
+        batch.Put(cf_handle, MakeKey(logspace_id, key),
+                  rocksdb::Slice(reinterpret_cast<const char*>(&cursors[i + 2]),
+                                 sizeof(uint64_t)));
+    }
+    auto status = db_->Write(rocksdb::WriteOptions(), &batch);
+    ROCKSDB_CHECK_OK(status, Write);
+}
+
+void RocksDBBackend::PutPendingBatch(uint32_t logspace_id,
+                                     std::span<const std::pair<uint64_t, std::string>> entries,
+                                     bool sync) {
+    rocksdb::ColumnFamilyHandle* cf_handle = GetCFHandle(logspace_id);
+    if (cf_handle == nullptr) {
+        // Callers ack these log entries once written, thus cannot go on
+        HLOG_F(FATAL, "Log space {} not created", bits::HexStr0x(logspace_id));
+    }
+    rocksdb::WriteBatch batch;
+    for (const auto& [localid, data] : entries) {
+        batch.Put(cf_handle, MakeKey(logspace_id, PendingKey(localid)), data);
+    }
+    rocksdb::WriteOptions options;
+    options.sync = sync;
+    auto status = db_->Write(options, &batch);
+    ROCKSDB_CHECK_OK(status, Write);
+}
+
+void RocksDBBackend::DeletePending(uint32_t logspace_id, uint64_t localid) {
+    rocksdb::ColumnFamilyHandle* cf_handle = GetCFHandle(logspace_id);
+    if (cf_handle == nullptr) {
+        HLOG_F(ERROR, "Log space {} not created", bits::HexStr0x(logspace_id));
+        return;
+    }
+    auto status = db_->Delete(rocksdb::WriteOptions(), cf_handle,
+                              MakeKey(logspace_id, PendingKey(localid)));
+    ROCKSDB_CHECK_OK(status, Delete);
+}
+
+void RocksDBBackend::DeleteBatch(uint32_t logspace_id, std::span<const uint32_t> keys) {
+    rocksdb::ColumnFamilyHandle* cf_handle = GetCFHandle(logspace_id);
+    if (cf_handle == nullptr) {
+        HLOG_F(ERROR, "Log space {} not created", bits::HexStr0x(logspace_id));
+        return;
+    }
+    // Not DeleteRange, as checkpoint keys can fall into ranges of hex keys
+    rocksdb::WriteBatch batch;
+    for (uint32_t key : keys) {
+        batch.Delete(cf_handle, MakeKey(logspace_id, bits::HexStr(key)));
+    }
+    auto status = db_->Write(rocksdb::WriteOptions(), &batch);
+    ROCKSDB_CHECK_OK(status, Write);
+}
+
+void RocksDBBackend::RemoveLogSpace(uint32_t logspace_id) {
+    HLOG_F(INFO, "Remove log space {}", bits::HexStr0x(logspace_id));
+    if (shared_column_families()) {
+        {
+            absl::MutexLock lk(&mu_);
+            if (!shared_logspaces_.erase(logspace_id)) {
+                HLOG_F(WARNING, "Log space {} not created", bits::HexStr0x(logspace_id));
+                return;
+            }
+        }
+        // Range deletion writes one tombstone, and compactions drop the range
+        auto status = db_->DeleteRange(
+            rocksdb::WriteOptions(), GetSharedCFHandle(logspace_id),
+            LogSpaceKeyPrefix(logspace_id), LogSpaceKeyLimit(logspace_id));
+        ROCKSDB_CHECK_OK(status, DeleteRange);
+        return;
+    }
+    std::unique_ptr<rocksdb::ColumnFamilyHandle> cf_handle;
+    {
+        absl::MutexLock lk(&mu_);
+        if (!column_families_.contains(logspace_id)) {
+            HLOG_F(WARNING, "Log space {} not created", bits::HexStr0x(logspace_id));
+            return;
+        }
+        cf_handle = std::move(column_families_[logspace_id]);
+        column_families_.erase(logspace_id);
+    }
+    auto status = db_->DropColumnFamily(cf_handle.get());
+    ROCKSDB_CHECK_OK(status, DropColumnFamily);
+}
+
+uint64_t RocksDBBackend::GetMemoryUsage() {
+    uint64_t memtable_bytes = 0;
+    uint64_t table_reader_bytes = 0;
+    db_->GetAggregatedIntProperty(rocksdb::DB::Properties::kSizeAllMemTables,
+                                  &memtable_bytes);
+    db_->GetAggregatedIntProperty(rocksdb::DB::Properties::kEstimateTableReadersMem,
+                                  &table_reader_bytes);
+    return memtable_bytes + table_reader_bytes;
+}
+
+std::optional<std::string> RocksDBBackend::GetInternal(uint32_t logspace_id,
+                                                       std::string_view key) {
     rocksdb::ColumnFamilyHandle* cf_handle = GetCFHandle(logspace_id);
     if (cf_handle == nullptr) {
         HLOG_F(WARNING, "Log space {} not created", bits::HexStr0x(logspace_id));
         return std::nullopt;
     }
-    std::string key_str = bits::HexStr(key);
+    std::string db_key = MakeKey(logspace_id, key);
     std::string data;
-    auto status = db_->Get(rocksdb::ReadOptions(), cf_handle, key_str, &data);
+    auto status = db_->Get(rocksdb::ReadOptions(), cf_handle, db_key, &data);
     if (status.IsNotFound()) {
         return std::nullopt;
     }
@@ -88,27 +442,71 @@ std::optional<std::string> RocksDBBackend::Get(uint32_t logspace_id, uint32_t ke
     return data;
 }
 
-void RocksDBBackend::Put(uint32_t logspace_id, uint32_t key, std::span<const char> data) {
+void RocksDBBackend::PutInternal(uint32_t logspace_id, std::string_view key,
+                                 std::span<const char> data) {
     rocksdb::ColumnFamilyHandle* cf_handle = GetCFHandle(logspace_id);
     if (cf_handle == nullptr) {
         HLOG_F(ERROR, "Log space {} not created", bits::HexStr0x(logspace_id));
         return;
     }
-    std::string key_str = bits::HexStr(key);
+    std::string db_key = MakeKey(logspace_id, key);
     auto status = db_->Put(
-        rocksdb::WriteOptions(), cf_handle,
-        key_str, rocksdb::Slice(data.data(), data.size()));
+        rocksdb::WriteOptions(), cf_handle, db_key,
+        rocksdb::Slice(data.data(), data.size()));
     ROCKSDB_CHECK_OK(status, Put);
 }
 
+void RocksDBBackend::DeleteStalePending(uint32_t logspace_id) {
+    rocksdb::ColumnFamilyHandle* cf_handle = DCHECK_NOTNULL(GetCFHandle(logspace_id));
+    std::string begin_key = MakeKey(logspace_id, kPendingKeyPrefix);
+    std::string end_key = MakeKey(logspace_id, kPendingKeyLimit);
+    size_t count = 0;
+    {
+        std::unique_ptr<rocksdb::Iterator> iter(
+            db_->NewIterator(rocksdb::ReadOptions(), cf_handle));
+        for (iter->Seek(begin_key);
+                iter->Valid() && iter->key().compare(end_key) < 0; iter->Next()) {
+            count++;
+        }
+        ROCKSDB_CHECK_OK(iter->status(), Seek);
+    }
+    if (count == 0) {
+        return;
+    }
+    HLOG_F(WARNING, "Delete {} pending log entries of log space {} left by a previous run",
+           count, bits::HexStr0x(logspace_id));
+    auto status = db_->DeleteRange(rocksdb::WriteOptions(), cf_handle, begin_key, end_key);
+    ROCKSDB_CHECK_OK(status, DeleteRange);
+}
+
 rocksdb::ColumnFamilyHandle* RocksDBBackend::GetCFHandle(uint32_t logspace_id) {
     absl::ReaderMutexLock lk(&mu_);
+    if (shared_column_families()) {
+        if (!shared_logspaces_.contains(logspace_id)) {
+            return nullptr;
+        }
+        return GetSharedCFHandle(logspace_id);
+    }
     if (!column_families_.contains(logspace_id)) {
         return nullptr;
     }
     return column_families_.at(logspace_id).get();
 }
 
+rocksdb::ColumnFamilyHandle* RocksDBBackend::GetSharedCFHandle(uint32_t logspace_id) {
+    size_t idx = hash::xxHash64(logspace_id) % shared_cf_handles_.size();
+    return shared_cf_handles_.at(idx).get();
+}
+
+std::string RocksDBBackend::MakeKey(uint32_t logspace_id, std::string_view key) {
+    if (!shared_column_families()) {
+        return std::string(key);
+    }
+    std::string db_key = LogSpaceKeyPrefix(logspace_id);
+    db_key.append(key.data(), key.size());
+    return db_key;
+}
+
 TkrzwDBMBackend::TkrzwDBMBackend(Type type, std::string_view db_path)
     : type_(type),
       db_path_(db_path) {}
@@ -162,17 +560,134 @@ void TkrzwDBMBackend::InstallLogSpace(uint32_t logspace_id) {
         DCHECK(!dbs_.contains(logspace_id));
         dbs_[logspace_id].reset(DCHECK_NOTNULL(db_ptr));
     }
+    DeleteStalePending(db_ptr, logspace_id);
+}
+
+bool TkrzwDBMBackend::HasLogSpace(uint32_t logspace_id) {
+    return GetDBM(logspace_id) != nullptr;
 }
 
 std::optional<std::string> TkrzwDBMBackend::Get(uint32_t logspace_id, uint32_t key) {
+    return GetInternal(logspace_id, bits::HexStr(key));
+}
+
+bool TkrzwDBMBackend::GetPinned(uint32_t logspace_id, uint32_t key, const ValueCallback& fn) {
+    auto data = GetInternal(logspace_id, bits::HexStr(key));
+    if (!data.has_value()) {
+        return false;
+    }
+    fn(STRING_AS_SPAN(*data));
+    return true;
+}
+
+void TkrzwDBMBackend::MultiGetPinned(uint32_t logspace_id, std::span<const uint32_t> keys,
+                                     const MultiValueCallback& fn) {
+    tkrzw::DBM* dbm = GetDBM(logspace_id);
+    if (dbm == nullptr) {
+        HLOG_F(WARNING, "Log space {} not created", bits::HexStr0x(logspace_id));
+        return;
+    }
+    std::vector<std::string> db_keys;
+    db_keys.reserve(keys.size());
+    for (uint32_t key : keys) {
+        db_keys.push_back(bits::HexStr(key));
+    }
+    std::vector<std::string_view> key_views(db_keys.begin(), db_keys.end());
+    std::map<std::string, std::string> records = dbm->GetMulti(key_views);
+    for (size_t i = 0; i < db_keys.size(); i++) {
+        if (auto iter = records.find(db_keys[i]); iter != records.end()) {
+            fn(i, STRING_AS_SPAN(iter->second));
+        }
+    }
+}
+
+void TkrzwDBMBackend::Put(uint32_t logspace_id, uint32_t key, std::span<const char> data) {
+    PutInternal(logspace_id, bits::HexStr(key), data);
+}
+
+std::optional<std::string> TkrzwDBMBackend::GetCheckpoint(uint32_t logspace_id,
+                                                          uint32_t user_logspace,
+                                                          uint64_t tag, uint64_t seqnum) {
+    return GetInternal(logspace_id, CheckpointKey(user_logspace, tag, seqnum));
+}
+
+void TkrzwDBMBackend::PutCheckpoint(uint32_t logspace_id, uint32_t user_logspace,
+                                    uint64_t tag, uint64_t seqnum,
+                                    std::span<const char> data) {
+    PutInternal(logspace_id, CheckpointKey(user_logspace, tag, seqnum), data);
+}
+
+std::optional<uint64_t> TkrzwDBMBackend::GetQueueCursor(uint32_t logspace_id,
+                                                        uint32_t user_logspace, uint64_t tag) {
+    return DecodeQueueCursor(GetInternal(logspace_id, QueueCursorKey(user_logspace, tag)));
+}
+
+void TkrzwDBMBackend::PutQueueCursors(uint32_t logspace_id, std::span<const uint64_t> cursors) {
+    DCHECK_EQ(cursors.size() % 3, 0U);
+    tkrzw::DBM* dbm = GetDBM(logspace_id);
+    if (dbm == nullptr) {
+        HLOG_F(ERROR, "Log space {} not created", bits::HexStr0x(logspace_id));
+        return;
+    }
+    for (size_t i = 0; i + 2 < cursors.size(); i += 3) {
+        std::string key = QueueCursorKey(gsl::narrow_cast<uint32_t>(cursors[i]),
+                                         cursors[i + 1]);
+        std::string_view data(reinterpret_cast<const char*>(&cursors[i + 2]), sizeof(uint64_t));
+        auto status = dbm->Set(key, data);
+        TKRZW_CHECK_OK(status, Set);
+    }
+}
+
+void TkrzwDBMBackend::PutPendingBatch(uint32_t logspace_id,
+                                      std::span<const std::pair<uint64_t, std::string>> entries,
+                                      bool sync) {
+    tkrzw::DBM* dbm = GetDBM(logspace_id);
+    if (dbm == nullptr) {
+        HLOG_F(FATAL, "Log space {} not created", bits::HexStr0x(logspace_id));
+    }
+    for (const auto& [localid, data] : entries) {
+        auto status = dbm->Set(PendingKey(localid), data);
+        TKRZW_CHECK_OK(status, Set);
+    }
+    if (sync) {
+        auto status = dbm->Synchronize(/* hard= */ true);
+        TKRZW_CHECK_OK(status, Synchronize);
+    }
+}
+
+void TkrzwDBMBackend::DeletePending(uint32_t logspace_id, uint64_t localid) {
+    tkrzw::DBM* dbm = GetDBM(logspace_id);
+    if (dbm == nullptr) {
+        HLOG_F(FATAL, "Log space {} not created", bits::HexStr0x(logspace_id));
+    }
+    auto status = dbm->Remove(PendingKey(localid));
+    if (status != tkrzw::Status::NOT_FOUND_ERROR) {
+        TKRZW_CHECK_OK(status, Remove);
+    }
+}
+
+void TkrzwDBMBackend::DeleteBatch(uint32_t logspace_id, std::span<const uint32_t> keys) {
+    tkrzw::DBM* dbm = GetDBM(logspace_id);
+    if (dbm == nullptr) {
+        HLOG_F(FATAL, "Log space {} not created", bits::HexStr0x(logspace_id));
+    }
+    for (uint32_t key : keys) {
+        auto status = dbm->Remove(bits::HexStr(key));
+        if (status != tkrzw::Status::NOT_FOUND_ERROR) {
+            TKRZW_CHECK_OK(status, Remove);
+        }
+    }
+}
+
+std::optional<std::string> TkrzwDBMBackend::GetInternal(uint32_t logspace_id,
+                                                        std::string_view key) {
     tkrzw::DBM* dbm = GetDBM(logspace_id);
     if (dbm == nullptr) {
         HLOG_F(WARNING, "Log space {} not created", bits::HexStr0x(logspace_id));
         return std::nullopt;
     }
-    std::string key_str = bits::HexStr(key);
     std::string data;
-    auto status = dbm->Get(key_str, &data);
+    auto status = dbm->Get(key, &data);
     if (status.IsOK()) {
         return data;
     } else {
@@ -180,16 +695,47 @@ std::optional<std::string> TkrzwDBMBackend::Get(uint32_t logspace_id, uint32_t k
     }
 }
 
-void TkrzwDBMBackend::Put(uint32_t logspace_id, uint32_t key, std::span<const char> data) {
+void TkrzwDBMBackend::PutInternal(uint32_t logspace_id, std::string_view key,
+                                  std::span<const char> data) {
     tkrzw::DBM* dbm = GetDBM(logspace_id);
     if (dbm == nullptr) {
         HLOG_F(FATAL, "Log space {} not created", bits::HexStr0x(logspace_id));
     }
-    std::string key_str = bits::HexStr(key);
-    auto status = dbm->Set(key_str, std::string_view(data.data(), data.size()));
+    auto status = dbm->Set(key, std::string_view(data.data(), data.size()));
     TKRZW_CHECK_OK(status, Set);
 }
 
+void TkrzwDBMBackend::DeleteStalePending(tkrzw::DBM* dbm, uint32_t logspace_id) {
+    // Only tree and skip DBMs are ordered, otherwise scan all keys
+    bool ordered = (type_ != kHashDBM);
+    std::vector<std::string> keys;
+    std::unique_ptr<tkrzw::DBM::Iterator> iter = dbm->MakeIterator();
+    // Get() fails once the iterator passes the last record
+    if (ordered) {
+        iter->Jump(kPendingKeyPrefix);
+    } else {
+        iter->First();
+    }
+    std::string key;
+    while (iter->Get(&key).IsOK()) {
+        if (absl::StartsWith(key, kPendingKeyPrefix)) {
+            keys.push_back(key);
+        } else if (ordered) {
+            break;
+        }
+        iter->Next();
+    }
+    if (keys.empty()) {
+        return;
+    }
+    HLOG_F(WARNING, "Delete {} pending log entries of log space {} left by a previous run",
+           keys.size(), bits::HexStr0x(logspace_id));
+    for (const std::string& pending_key : keys) {
+        auto status = dbm->Remove(pending_key);
+        TKRZW_CHECK_OK(status, Remove);
+    }
+}
+
 tkrzw::DBM* TkrzwDBMBackend::GetDBM(uint32_t logspace_id) {
     absl::ReaderMutexLock lk(&mu_);
     if (!dbs_.contains(logspace_id)) {
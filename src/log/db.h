@@ -3,7 +3,7 @@
 #include "log/common.h"
 
 // Forward declarations
-namespace rocksdb { class DB; class ColumnFamilyHandle; }
+namespace rocksdb { class DB; class ColumnFamilyHandle; class Cache; }
 namespace tkrzw { class DBM; }
 
 namespace faas {
@@ -14,27 +14,108 @@ public:
     virtual ~DBInterface() {}
 
     virtual void InstallLogSpace(uint32_t logspace_id) = 0;
+    virtual bool HasLogSpace(uint32_t logspace_id) = 0;
     virtual std::optional<std::string> Get(uint32_t logspace_id, uint32_t key) = 0;
+    // Calls `fn` with the value, which is only valid within `fn`. Returns false
+    // if not found. Backends avoid copying the value if possible.
+    using ValueCallback = std::function<void(std::span<const char>)>;
+    virtual bool GetPinned(uint32_t logspace_id, uint32_t key, const ValueCallback& fn) = 0;
+    // Batched lookups of `keys`, where `fn` is called with indices of found keys
+    using MultiValueCallback = std::function<void(size_t /* index */, std::span<const char>)>;
+    virtual void MultiGetPinned(uint32_t logspace_id, std::span<const uint32_t> keys,
+                                const MultiValueCallback& fn) = 0;
     virtual void Put(uint32_t logspace_id, uint32_t key, std::span<const char> data) = 0;
+
+    // Checkpoints of materialized state share the DB of their log space, under
+    // keys not colliding with keys of log entries
+    virtual std::optional<std::string> GetCheckpoint(uint32_t logspace_id,
+                                                     uint32_t user_logspace,
+                                                     uint64_t tag, uint64_t seqnum) = 0;
+    virtual void PutCheckpoint(uint32_t logspace_id, uint32_t user_logspace,
+                               uint64_t tag, uint64_t seqnum,
+                               std::span<const char> data) = 0;
+
+    // Consumer cursors of queues, one key per (user_logspace, tag), are
+    // also stored apart from log entries. `cursors` has (user_logspace, tag,
+    // seqnum) triples as in payloads of queue cursor messages, which are
+    // written in one batch.
+    virtual std::optional<uint64_t> GetQueueCursor(uint32_t logspace_id,
+                                                   uint32_t user_logspace, uint64_t tag) = 0;
+    virtual void PutQueueCursors(uint32_t logspace_id, std::span<const uint64_t> cursors) = 0;
+
+    // Log entries not ordered yet are stored under their localids, also not
+    // colliding with keys of log entries. With `sync` set, returns after
+    // all `entries` are durable. As shard progress is not persisted, pending
+    // log entries left by a previous run cannot be ordered again, and are
+    // deleted when their log spaces are installed.
+    virtual void PutPendingBatch(uint32_t logspace_id,
+                                 std::span<const std::pair</* localid */ uint64_t,
+                                                           std::string>> entries,
+                                 bool sync) = 0;
+    virtual void DeletePending(uint32_t logspace_id, uint64_t localid) = 0;
+
+    // Deletes log entries of `keys`, after they are moved to archive files
+    virtual void DeleteBatch(uint32_t logspace_id, std::span<const uint32_t> keys) = 0;
 };
 
+// With FLAGS_rocksdb_shared_column_families set, log spaces share a fixed
+// number of column families, instead of having one column family each. Keys
+// are then prefixed with the logspace id, and both prefix and whole key
+// bloom filters are used for lookups. Otherwise, column families of log
+// spaces from previous runs are reopened, and count as installed.
 class RocksDBBackend final : public DBInterface {
 public:
     explicit RocksDBBackend(std::string_view db_path);
     ~RocksDBBackend();
 
+    bool shared_column_families() const { return !shared_cf_handles_.empty(); }
+
     void InstallLogSpace(uint32_t logspace_id) override;
+    bool HasLogSpace(uint32_t logspace_id) override;
     std::optional<std::string> Get(uint32_t logspace_id, uint32_t key) override;
+    bool GetPinned(uint32_t logspace_id, uint32_t key, const ValueCallback& fn) override;
+    void MultiGetPinned(uint32_t logspace_id, std::span<const uint32_t> keys,
+                        const MultiValueCallback& fn) override;
     void Put(uint32_t logspace_id, uint32_t key, std::span<const char> data) override;
+    std::optional<std::string> GetCheckpoint(uint32_t logspace_id, uint32_t user_logspace,
+                                             uint64_t tag, uint64_t seqnum) override;
+    void PutCheckpoint(uint32_t logspace_id, uint32_t user_logspace,
+                       uint64_t tag, uint64_t seqnum, std::span<const char> data) override;
+    std::optional<uint64_t> GetQueueCursor(uint32_t logspace_id, uint32_t user_logspace,
+                                           uint64_t tag) override;
+    void PutQueueCursors(uint32_t logspace_id, std::span<const uint64_t> cursors) override;
+    void PutPendingBatch(uint32_t logspace_id,
+                         std::span<const std::pair<uint64_t, std::string>> entries,
+                         bool sync) override;
+    void DeletePending(uint32_t logspace_id, uint64_t localid) override;
+    void DeleteBatch(uint32_t logspace_id, std::span<const uint32_t> keys) override;
+
+    // Removes all data of the log space, by dropping its column family or
+    // deleting the range of its key prefix. No reads or writes of the log
+    // space can be ongoing.
+    void RemoveLogSpace(uint32_t logspace_id);
+
+    // Bytes used by memtables and table readers
+    uint64_t GetMemoryUsage();
 
 private:
     std::unique_ptr<rocksdb::DB> db_;
+    std::shared_ptr<rocksdb::Cache> block_cache_;
+    std::vector<std::unique_ptr<rocksdb::ColumnFamilyHandle>> shared_cf_handles_;
+
     absl::Mutex mu_;
     absl::flat_hash_map</* logspace_id */ uint32_t,
                         std::unique_ptr<rocksdb::ColumnFamilyHandle>>
         column_families_ ABSL_GUARDED_BY(mu_);
+    absl::flat_hash_set</* logspace_id */ uint32_t>
+        shared_logspaces_ ABSL_GUARDED_BY(mu_);
 
     rocksdb::ColumnFamilyHandle* GetCFHandle(uint32_t logspace_id);
+    rocksdb::ColumnFamilyHandle* GetSharedCFHandle(uint32_t logspace_id);
+    void DeleteStalePending(uint32_t logspace_id);
+    std::string MakeKey(uint32_t logspace_id, std::string_view key);
+    std::optional<std::string> GetInternal(uint32_t logspace_id, std::string_view key);
+    void PutInternal(uint32_t logspace_id, std::string_view key, std::span<const char> data);
 
     DISALLOW_COPY_AND_ASSIGN(RocksDBBackend);
 };
@@ -46,8 +127,24 @@ public:
     ~TkrzwDBMBackend();
 
     void InstallLogSpace(uint32_t logspace_id) override;
+    bool HasLogSpace(uint32_t logspace_id) override;
     std::optional<std::string> Get(uint32_t logspace_id, uint32_t key) override;
+    bool GetPinned(uint32_t logspace_id, uint32_t key, const ValueCallback& fn) override;
+    void MultiGetPinned(uint32_t logspace_id, std::span<const uint32_t> keys,
+                        const MultiValueCallback& fn) override;
     void Put(uint32_t logspace_id, uint32_t key, std::span<const char> data) override;
+    std::optional<std::string> GetCheckpoint(uint32_t logspace_id, uint32_t user_logspace,
+                                             uint64_t tag, uint64_t seqnum) override;
+    void PutCheckpoint(uint32_t logspace_id, uint32_t user_logspace,
+                       uint64_t tag, uint64_t seqnum, std::span<const char> data) override;
+    std::optional<uint64_t> GetQueueCursor(uint32_t logspace_id, uint32_t user_logspace,
+                                           uint64_t tag) override;
+    void PutQueueCursors(uint32_t logspace_id, std::span<const uint64_t> cursors) override;
+    void PutPendingBatch(uint32_t logspace_id,
+                         std::span<const std::pair<uint64_t, std::string>> entries,
+                         bool sync) override;
+    void DeletePending(uint32_t logspace_id, uint64_t localid) override;
+    void DeleteBatch(uint32_t logspace_id, std::span<const uint32_t> keys) override;
 
 private:
     Type type_;
@@ -59,6 +156,9 @@ private:
         dbs_ ABSL_GUARDED_BY(mu_);
 
     tkrzw::DBM* GetDBM(uint32_t logspace_id);
+    void DeleteStalePending(tkrzw::DBM* dbm, uint32_t logspace_id);
+    std::optional<std::string> GetInternal(uint32_t logspace_id, std::string_view key);
+    void PutInternal(uint32_t logspace_id, std::string_view key, std::span<const char> data);
 
     DISALLOW_COPY_AND_ASSIGN(TkrzwDBMBackend);
 };
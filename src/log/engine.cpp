@@ -15,11 +15,26 @@ using protocol::SharedLogMessageHelper;
 using protocol::SharedLogOpType;
 using protocol::SharedLogResultType;
 
+namespace {
+// Categories of tag_filter_stat_
+enum TagFilterLookupCategory {
+    kTagAbsent            = 0,
+    kTagMayExist          = 1,
+    kTagMayExistButEmpty  = 2,  // Upper bound of false positives
+    kTagFilterUnavailable = 3
+};
+}  // namespace
+
 Engine::Engine(engine::Engine* engine)
     : EngineBase(engine),
       log_header_(fmt::format("LogEngine[{}-N]: ", my_node_id())),
       current_view_(nullptr),
-      current_view_active_(false) {}
+      current_view_active_(false),
+      tag_filter_full_sync_timestamp_(0),
+      tag_filter_stat_(stat::CategoryCounter::StandardReportCallback(
+          "tag_filter_lookup (0=absent, 1=may_exist, 2=may_exist_but_empty, 3=unavailable)")),
+      remote_query_avoided_stat_(stat::Counter::StandardReportCallback(
+          "tag_filter_remote_query_avoided")) {}
 
 Engine::~Engine() {}
 
@@ -174,6 +189,12 @@ void Engine::HandleLocalAppend(LocalOp* op) {
             return;
         }
         view = current_view_;
+        if (ReplicationCongested(view)) {
+            // Client will back off and retry discarded appends
+            HVLOG(1) << "Replication to storage nodes is congested, discard this append";
+            FinishLocalOpWithFailure(op, SharedLogResultType::DISCARDED);
+            return;
+        }
         uint32_t logspace_id = view->LogSpaceIdentifier(op->user_logspace);
         log_metadata.seqnum = bits::JoinTwo32(logspace_id, 0);
         auto producer_ptr = producer_collection_.GetLogSpaceChecked(logspace_id);
@@ -193,21 +214,38 @@ void Engine::HandleLocalTrim(LocalOp* op) {
 void Engine::HandleLocalRead(LocalOp* op) {
     DCHECK(  op->type == SharedLogOpType::READ_NEXT
           || op->type == SharedLogOpType::READ_PREV
-          || op->type == SharedLogOpType::READ_NEXT_B);
-    HVLOG_F(1, "Handle local read: op_id={}, logspace={}, tag={}, seqnum={}",
-            op->id, op->user_logspace, op->query_tag, bits::HexStr0x(op->seqnum));
+          || op->type == SharedLogOpType::READ_NEXT_B
+          || op->type == SharedLogOpType::READ_NEXT_MT
+          || op->type == SharedLogOpType::READ_PREV_MT
+          || op->type == SharedLogOpType::COUNT
+          || op->type == SharedLogOpType::READ_CHECKPOINT);
+    HVLOG_F(1, "Handle local read: op_id={}, logspace={}, tag={}, num_tags={}, seqnum={}",
+            op->id, op->user_logspace, op->query_tag, op->user_tags.size(),
+            bits::HexStr0x(op->seqnum));
     onging_reads_.PutChecked(op->id, op);
+    std::span<const uint64_t> query_tags = op->user_tags.empty()
+        ? std::span<const uint64_t>(&op->query_tag, 1)
+        : VECTOR_AS_SPAN(op->user_tags);
     const View::Sequencer* sequencer_node = nullptr;
     LockablePtr<Index> index_ptr;
+    bool same_index_partition = true;
+    uint32_t logspace_id = 0;
     {
         absl::ReaderMutexLock view_lk(&view_mu_);
         ONHOLD_IF_SEEN_FUTURE_VIEW(op);
-        uint32_t logspace_id = current_view_->LogSpaceIdentifier(op->user_logspace);
+        logspace_id = current_view_->LogSpaceIdentifier(op->user_logspace);
         sequencer_node = current_view_->GetSequencerNode(bits::LowHalf32(logspace_id));
-        if (sequencer_node->IsIndexEngineNode(my_node_id())) {
+        same_index_partition = sequencer_node->InSameIndexPartition(query_tags);
+        if (sequencer_node->IsIndexEngineNodeForTags(my_node_id(), query_tags)) {
             index_ptr = index_collection_.GetLogSpaceChecked(logspace_id);
         }
     }
+    if (!same_index_partition) {
+        HLOG(ERROR) << "Query tags of multi-tag read are in different index partitions";
+        onging_reads_.RemoveChecked(op->id);
+        FinishLocalOpWithFailure(op, SharedLogResultType::BAD_ARGS);
+        return;
+    }
     bool use_local_index = true;
     if (absl::GetFlag(FLAGS_slog_engine_force_remote_index)) {
         use_local_index = false;
@@ -218,7 +256,42 @@ void Engine::HandleLocalRead(LocalOp* op) {
             use_local_index = false;
         }
     }
+    uint64_t empty_metalog_progress = 0;
+    if (TagFilterRulesOutRead(op, /* remote_index= */ index_ptr == nullptr || !use_local_index,
+                              &empty_metalog_progress)) {
+        HVLOG_F(1, "Tag filter shows no log entries for read: op_id={}", op->id);
+        onging_reads_.RemoveChecked(op->id);
+        FinishLocalOpWithFailure(op, SharedLogResultType::EMPTY, empty_metalog_progress);
+        return;
+    }
     if (index_ptr != nullptr && use_local_index) {
+        uint64_t index_progress = 0;
+        std::optional<LogEntry> tail_log_entry = TailCacheGetTail(op, logspace_id,
+                                                                  &index_progress);
+        if (tail_log_entry.has_value()) {
+            // Tail cache has the tail of the query tag, which is also what
+            // the local index would find
+            uint64_t seqnum = tail_log_entry->metadata.seqnum;
+            HVLOG_F(1, "Tail cache has the tail (seqnum {}) for read: op_id={}",
+                    bits::HexStr0x(seqnum), op->id);
+            IndexQueryResult query_result = {
+                .state = IndexQueryResult::kFound,
+                .metalog_progress = index_progress,
+                .next_view_id = 0,
+                .original_query = BuildIndexQuery(op),
+                .found_result = {
+                    .view_id = log_utils::GetViewId(seqnum),
+                    .engine_id = gsl::narrow_cast<uint16_t>(
+                        bits::HighHalf64(tail_log_entry->metadata.localid)),
+                    .seqnum = seqnum,
+                    .count = 0
+                },
+                .tail_seqnums = {},
+                .tail_complete = false
+            };
+            ProcessIndexFoundResult(query_result);
+            return;
+        }
         // Use local index
         IndexQuery query = BuildIndexQuery(op);
         Index::QueryResultVec query_results;
@@ -233,7 +306,8 @@ void Engine::HandleLocalRead(LocalOp* op) {
                    "will send request to remote engine node",
                 DCHECK_NOTNULL(sequencer_node)->node_id());
         SharedLogMessage request = BuildReadRequestMessage(op);
-        bool send_success = SendIndexReadRequest(DCHECK_NOTNULL(sequencer_node), &request);
+        bool send_success = SendIndexReadRequest(DCHECK_NOTNULL(sequencer_node), &request,
+                                                 VECTOR_AS_CHAR_SPAN(op->user_tags));
         if (!send_success) {
             onging_reads_.RemoveChecked(op->id);
             FinishLocalOpWithFailure(op, SharedLogResultType::DATA_LOST);
@@ -262,6 +336,124 @@ void Engine::HandleLocalSetAuxData(LocalOp* op) {
     }
 }
 
+void Engine::HandleLocalSetCheckpoint(LocalOp* op) {
+    DCHECK(op->type == SharedLogOpType::SET_CHECKPOINT);
+    HVLOG_F(1, "Handle local checkpoint: op_id={}, logspace={}, tag={}, seqnum={}, size={}",
+            op->id, op->user_logspace, op->query_tag, bits::HexStr0x(op->seqnum),
+            op->data.length());
+    const View* view = nullptr;
+    uint32_t logspace_id;
+    {
+        absl::ReaderMutexLock view_lk(&view_mu_);
+        if (!current_view_active_) {
+            HLOG(WARNING) << "Current view not active";
+            FinishLocalOpWithFailure(op, SharedLogResultType::DISCARDED);
+            return;
+        }
+        view = current_view_;
+        // Checkpoints are registered in the index of the current view, thus
+        // cannot be of log entries from future views
+        if (op->seqnum == kInvalidLogSeqNum
+                || log_utils::GetViewId(op->seqnum) > view->id()) {
+            HLOG_F(ERROR, "Invalid seqnum of checkpoint: {}", bits::HexStr0x(op->seqnum));
+            FinishLocalOpWithFailure(op, SharedLogResultType::BAD_ARGS);
+            return;
+        }
+        logspace_id = view->LogSpaceIdentifier(op->user_logspace);
+    }
+    ReplicateCheckpoint(view, logspace_id, op->user_logspace, op->query_tag,
+                        op->seqnum, op->data.to_span());
+    // Same as auxiliary data, checkpoints become durable asynchronously
+    Message response = MessageHelper::NewSharedLogOpSucceeded(
+        SharedLogResultType::CHECKPOINT_OK, op->seqnum);
+    FinishLocalOpWithResponse(op, &response, /* metalog_progress= */ 0);
+}
+
+void Engine::HandleLocalSnapshotRead(LocalOp* op) {
+    DCHECK(op->type == SharedLogOpType::READ_SNAPSHOT);
+    HVLOG_F(1, "Handle local snapshot read: op_id={}, logspace={}, num_reads={}, snapshot={}",
+            op->id, op->user_logspace, op->user_tags.size(), bits::HexStr0x(op->seqnum));
+    uint64_t metalog_progress = 0;
+    uint64_t snapshot_seqnum = kInvalidLogSeqNum;
+    {
+        absl::MutexLock snapshot_lk(&snapshot_mu_);
+        absl::ReaderMutexLock view_lk(&view_mu_);
+        ONHOLD_IF_SEEN_FUTURE_VIEW(op);
+        if (!current_view_active_) {
+            HLOG(WARNING) << "Current view not active";
+            FinishLocalOpWithFailure(op, SharedLogResultType::DISCARDED);
+            return;
+        }
+        // The snapshot is pinned at the position of the local producer, where
+        // all log entries below `seqnum_position` are ordered
+        uint32_t logspace_id = current_view_->LogSpaceIdentifier(op->user_logspace);
+        auto producer_ptr = producer_collection_.GetLogSpaceChecked(logspace_id);
+        {
+            auto locked_producer = producer_ptr.Lock();
+            metalog_progress = bits::JoinTwo32(logspace_id, locked_producer->metalog_position());
+            snapshot_seqnum = locked_producer->seqnum_position();
+        }
+        bool snapshot_ahead = (op->seqnum != kInvalidLogSeqNum && op->seqnum > snapshot_seqnum);
+        if (snapshot_ahead && bits::HighHalf64(op->seqnum) != logspace_id) {
+            HLOG_F(ERROR, "Snapshot to read is not in current log space: snapshot={}",
+                   bits::HexStr0x(op->seqnum));
+            FinishLocalOpWithFailure(op, SharedLogResultType::BAD_ARGS);
+            return;
+        }
+        if (snapshot_ahead || metalog_progress < op->metalog_progress) {
+            HVLOG_F(1, "Snapshot read waits for metalog progress {}",
+                    bits::HexStr0x(op->metalog_progress));
+            pending_snapshot_reads_.push_back(op);
+            return;
+        }
+    }
+    if (op->seqnum != kInvalidLogSeqNum) {
+        snapshot_seqnum = op->seqnum;
+    }
+    op->seqnum = snapshot_seqnum;
+    op->metalog_progress = metalog_progress;
+    IssueSnapshotSubReads(op);
+}
+
+void Engine::HandleLocalQueuePop(LocalOp* op) {
+    DCHECK(op->type == SharedLogOpType::QUEUE_POP || op->type == SharedLogOpType::QUEUE_POP_B);
+    HVLOG_F(1, "Handle local queue pop: op_id={}, logspace={}, tag={}, blocking={}",
+            op->id, op->user_logspace, op->query_tag,
+            op->type == SharedLogOpType::QUEUE_POP_B);
+    if (op->query_tag == kEmptyLogTag || op->query_tag == kInvalidLogTag) {
+        HLOG_F(ERROR, "Invalid tag of queue: {}", op->query_tag);
+        FinishLocalOpWithFailure(op, SharedLogResultType::BAD_ARGS);
+        return;
+    }
+    const View::Sequencer* sequencer_node = nullptr;
+    uint16_t view_id = 0;
+    {
+        absl::ReaderMutexLock view_lk(&view_mu_);
+        ONHOLD_IF_SEEN_FUTURE_VIEW(op);
+        view_id = current_view_->id();
+        uint32_t logspace_id = current_view_->LogSpaceIdentifier(op->user_logspace);
+        sequencer_node = current_view_->GetSequencerNode(bits::LowHalf32(logspace_id));
+    }
+    if (sequencer_node->GetQueueEngineNodeForTag(op->query_tag) == my_node_id()) {
+        ServeQueuePop(op, view_id);
+        return;
+    }
+    HVLOG_F(1, "Send queue pop to engine {}",
+            sequencer_node->GetQueueEngineNodeForTag(op->query_tag));
+    onging_reads_.PutChecked(op->id, op);
+    SharedLogMessage request = SharedLogMessageHelper::NewReadMessage(op->type);
+    request.origin_node_id = my_node_id();
+    request.hop_times = 1;
+    request.client_data = op->id;
+    request.user_logspace = op->user_logspace;
+    request.query_tag = op->query_tag;
+    request.user_metalog_progress = op->metalog_progress;
+    if (!SendQueuePopRequest(sequencer_node, &request)) {
+        onging_reads_.RemoveChecked(op->id);
+        FinishLocalOpWithFailure(op, SharedLogResultType::DATA_LOST);
+    }
+}
+
 #undef ONHOLD_IF_SEEN_FUTURE_VIEW
 
 // Start handlers for remote messages
@@ -287,18 +479,23 @@ void Engine::HandleLocalSetAuxData(LocalOp* op) {
         }                                                           \
     } while (0)
 
-void Engine::HandleRemoteRead(const SharedLogMessage& request) {
+void Engine::HandleRemoteRead(const SharedLogMessage& request,
+                              std::span<const char> payload) {
     SharedLogOpType op_type = SharedLogMessageHelper::GetOpType(request);
     DCHECK(  op_type == SharedLogOpType::READ_NEXT
           || op_type == SharedLogOpType::READ_PREV
-          || op_type == SharedLogOpType::READ_NEXT_B);
+          || op_type == SharedLogOpType::READ_NEXT_B
+          || op_type == SharedLogOpType::READ_NEXT_MT
+          || op_type == SharedLogOpType::READ_PREV_MT
+          || op_type == SharedLogOpType::COUNT
+          || op_type == SharedLogOpType::READ_CHECKPOINT);
     LockablePtr<Index> index_ptr;
     {
         absl::ReaderMutexLock view_lk(&view_mu_);
-        ONHOLD_IF_FROM_FUTURE_VIEW(request, EMPTY_CHAR_SPAN);
+        ONHOLD_IF_FROM_FUTURE_VIEW(request, payload);
         index_ptr = index_collection_.GetLogSpaceChecked(request.logspace_id);
     }
-    IndexQuery query = BuildIndexQuery(request);
+    IndexQuery query = BuildIndexQuery(request, payload);
     Index::QueryResultVec query_results;
     {
         auto locked_index = index_ptr.Lock();
@@ -308,6 +505,33 @@ void Engine::HandleRemoteRead(const SharedLogMessage& request) {
     ProcessIndexQueryResults(query_results);
 }
 
+void Engine::HandleRemoteQueuePop(const SharedLogMessage& request,
+                                  std::span<const char> payload) {
+    DCHECK(  SharedLogMessageHelper::GetOpType(request) == SharedLogOpType::QUEUE_POP
+          || SharedLogMessageHelper::GetOpType(request) == SharedLogOpType::QUEUE_POP_B);
+    uint16_t view_id = 0;
+    bool serving_queue = false;
+    {
+        absl::ReaderMutexLock view_lk(&view_mu_);
+        ONHOLD_IF_FROM_FUTURE_VIEW(request, payload);
+        view_id = current_view_->id();
+        uint32_t logspace_id = current_view_->LogSpaceIdentifier(request.user_logspace);
+        const View::Sequencer* sequencer_node = current_view_->GetSequencerNode(
+            bits::LowHalf32(logspace_id));
+        serving_queue = (sequencer_node->GetQueueEngineNodeForTag(request.query_tag)
+                         == my_node_id());
+    }
+    LocalOp* op = NewRemoteQueuePopOp(request);
+    if (!serving_queue) {
+        // The origin engine is in an older view
+        HLOG_F(WARNING, "Not serving pops of queue with tag {} in view {}",
+               request.query_tag, view_id);
+        FinishLocalOpWithFailure(op, SharedLogResultType::DATA_LOST);
+        return;
+    }
+    ServeQueuePop(op, view_id);
+}
+
 void Engine::OnRecvNewMetaLogs(const SharedLogMessage& message,
                                std::span<const char> payload) {
     DCHECK(SharedLogMessageHelper::GetOpType(message) == SharedLogOpType::METALOGS);
@@ -329,17 +553,28 @@ void Engine::OnRecvNewMetaLogs(const SharedLogMessage& message,
         }
         if (current_view_->GetEngineNode(my_node_id())->HasIndexFor(message.sequencer_id)) {
             auto index_ptr = index_collection_.GetLogSpaceChecked(message.logspace_id);
+            uint64_t index_progress = 0;
             {
                 auto locked_index = index_ptr.Lock();
                 for (const MetaLogProto& metalog_proto : metalogs_proto.metalogs()) {
                     locked_index->ProvideMetaLog(metalog_proto);
                 }
                 locked_index->PollQueryResults(&query_results);
+                index_progress = locked_index->index_metalog_progress();
             }
+            TailCacheUpdateIndexProgress(message.logspace_id, index_progress);
         }
     }
     ProcessAppendResults(append_results);
     ProcessIndexQueryResults(query_results);
+    std::vector<LocalOp*> snapshot_reads;
+    {
+        absl::MutexLock snapshot_lk(&snapshot_mu_);
+        snapshot_reads.swap(pending_snapshot_reads_);
+    }
+    for (LocalOp* op : snapshot_reads) {
+        HandleLocalSnapshotRead(op);
+    }
 }
 
 void Engine::OnRecvNewIndexData(const SharedLogMessage& message,
@@ -364,12 +599,16 @@ void Engine::OnRecvNewIndexData(const SharedLogMessage& message,
             HLOG_F(FATAL, "This node is not index node for log space {}",
                    bits::HexStr0x(message.logspace_id));
         }
+        TailCacheUpdate(index_data_proto);
         auto index_ptr = index_collection_.GetLogSpaceChecked(message.logspace_id);
+        uint64_t index_progress = 0;
         {
             auto locked_index = index_ptr.Lock();
             locked_index->ProvideIndexData(index_data_proto);
             locked_index->PollQueryResults(&query_results);
+            index_progress = locked_index->index_metalog_progress();
         }
+        TailCacheUpdateIndexProgress(message.logspace_id, index_progress);
     }
     ProcessIndexQueryResults(query_results);
 }
@@ -382,8 +621,11 @@ void Engine::OnRecvResponse(const SharedLogMessage& message,
     DCHECK(SharedLogMessageHelper::GetOpType(message) == SharedLogOpType::RESPONSE);
     SharedLogResultType result = SharedLogMessageHelper::GetResultType(message);
     if (    result == SharedLogResultType::READ_OK
+         || result == SharedLogResultType::COUNT_OK
+         || result == SharedLogResultType::CHECKPOINT_OK
          || result == SharedLogResultType::EMPTY
-         || result == SharedLogResultType::DATA_LOST) {
+         || result == SharedLogResultType::DATA_LOST
+         || result == SharedLogResultType::BAD_ARGS) {
         uint64_t op_id = message.client_data;
         LocalOp* op;
         if (!onging_reads_.Poll(op_id, &op)) {
@@ -393,6 +635,13 @@ void Engine::OnRecvResponse(const SharedLogMessage& message,
         if (result == SharedLogResultType::READ_OK) {
             uint64_t seqnum = bits::JoinTwo32(message.logspace_id, message.seqnum_lowhalf);
             HVLOG_F(1, "Receive remote read response for log (seqnum {})", bits::HexStr0x(seqnum));
+            if (op->seqnum_only()) {
+                // Response to sub-read of READ_SNAPSHOT carries no log data
+                Message response = MessageHelper::NewSharedLogOpSucceeded(
+                    SharedLogResultType::READ_OK, seqnum);
+                FinishLocalOpWithResponse(op, &response, message.user_metalog_progress);
+                return;
+            }
             std::span<const uint64_t> user_tags;
             std::span<const char> log_data;
             std::span<const char> aux_data;
@@ -402,20 +651,66 @@ void Engine::OnRecvResponse(const SharedLogMessage& message,
                 response.log_aux_data_size = gsl::narrow_cast<uint16_t>(aux_data.size());
                 MessageHelper::AppendInlineData(&response, aux_data);
             }
+            TailCacheRecordReadDelay(
+                op, (message.response_flags & protocol::kReadTailCacheHitFlag) != 0);
+            // Responses of queue pops carry no localid of the log entry
+            bool cache_log_entry = (op->type != SharedLogOpType::QUEUE_POP
+                                    && op->type != SharedLogOpType::QUEUE_POP_B);
             FinishLocalOpWithResponse(op, &response, message.user_metalog_progress);
+            if (!cache_log_entry) {
+                return;
+            }
             // Put the received log entry into log cache
             LogMetaData log_metadata = log_utils::GetMetaDataFromMessage(message);
             LogCachePut(log_metadata, user_tags, log_data);
             if (aux_data.size() > 0) {
                 LogCachePutAuxData(seqnum, aux_data);
             }
+        } else if (result == SharedLogResultType::COUNT_OK) {
+            Message response = MessageHelper::NewSharedLogOpSucceeded(
+                SharedLogResultType::COUNT_OK);
+            response.log_count = message.count;
+            FinishLocalOpWithResponse(op, &response, message.user_metalog_progress);
+        } else if (result == SharedLogResultType::CHECKPOINT_OK) {
+            uint64_t seqnum = bits::JoinTwo32(message.logspace_id, message.seqnum_lowhalf);
+            size_t num_tail_seqnums = message.num_tags;
+            DCHECK_GE(payload.size(), num_tail_seqnums * sizeof(uint64_t));
+            std::span<const char> data = payload.subspan(num_tail_seqnums * sizeof(uint64_t));
+            bool tail_complete =
+                (message.response_flags & protocol::kCheckpointTailCompleteFlag) != 0;
+            if (data.size() > MESSAGE_INLINE_DATA_SIZE) {
+                HLOG_F(ERROR, "Checkpoint (seqnum {}) too large: size={}",
+                       bits::HexStr0x(seqnum), data.size());
+                FinishLocalOpWithFailure(op, SharedLogResultType::DATA_LOST);
+                return;
+            }
+            // Drop the end of the tail if not fit, readers then replay from
+            // the last seqnum in the tail
+            size_t max_tail_size = (MESSAGE_INLINE_DATA_SIZE - data.size()) / sizeof(uint64_t);
+            if (num_tail_seqnums > max_tail_size) {
+                num_tail_seqnums = max_tail_size;
+                tail_complete = false;
+            }
+            Message response = MessageHelper::NewSharedLogOpSucceeded(
+                SharedLogResultType::CHECKPOINT_OK, seqnum);
+            response.log_num_tags = gsl::narrow_cast<uint16_t>(num_tail_seqnums);
+            if (tail_complete) {
+                response.flags |= protocol::kLogCheckpointTailCompleteFlag;
+            }
+            MessageHelper::AppendInlineData(
+                &response, payload.subspan(0, num_tail_seqnums * sizeof(uint64_t)));
+            MessageHelper::AppendInlineData(&response, data);
+            FinishLocalOpWithResponse(op, &response, message.user_metalog_progress);
         } else if (result == SharedLogResultType::EMPTY) {
+            TagFilterRecordEmptyRead(op);
             FinishLocalOpWithFailure(
                 op, SharedLogResultType::EMPTY, message.user_metalog_progress);
         } else if (result == SharedLogResultType::DATA_LOST) {
             HLOG_F(WARNING, "Receive DATA_LOST response for read request: seqnum={}, tag={}",
                    bits::HexStr0x(op->seqnum), op->query_tag);
             FinishLocalOpWithFailure(op, SharedLogResultType::DATA_LOST);
+        } else if (result == SharedLogResultType::BAD_ARGS) {
+            FinishLocalOpWithFailure(op, SharedLogResultType::BAD_ARGS);
         } else {
             UNREACHABLE();
         }
@@ -424,6 +719,305 @@ void Engine::OnRecvResponse(const SharedLogMessage& message,
     }
 }
 
+void Engine::OnRecvTagFilter(const SharedLogMessage& message,
+                             std::span<const char> payload) {
+    DCHECK(SharedLogMessageHelper::GetOpType(message) == SharedLogOpType::TAG_FILTER);
+    HVLOG_F(1, "Receive tag filter of log space {} from engine {}: metalog_position={}",
+            bits::HexStr0x(message.logspace_id), message.origin_node_id,
+            message.metalog_position);
+    UpdateTagFilter(message.logspace_id, message.origin_node_id,
+                    message.metalog_position, message.prev_metalog_position,
+                    (message.flags & protocol::kTagFilterFinalizedFlag) != 0,
+                    (message.flags & protocol::kTagFilterDeltaFlag) != 0, payload);
+}
+
+void Engine::BroadcastTagFilters() {
+    int64_t current_timestamp = GetMonotonicMicroTimestamp();
+    bool full_sync = false;
+    if (current_timestamp >= tag_filter_full_sync_timestamp_ + int64_t{1000} * absl::GetFlag(
+            FLAGS_slog_engine_tag_filter_full_sync_interval_ms)) {
+        full_sync = true;
+        tag_filter_full_sync_timestamp_ = current_timestamp;
+    }
+    std::vector<std::pair</* logspace_id */ uint32_t, Index::TagFilterUpdate>> updates;
+    const View* view = nullptr;
+    {
+        absl::ReaderMutexLock view_lk(&view_mu_);
+        if (current_view_ == nullptr) {
+            return;
+        }
+        view = current_view_;
+        auto poll_update = [&updates, full_sync] (uint32_t logspace_id,
+                                                  LockablePtr<Index> index_ptr) {
+            Index::TagFilterUpdate update;
+            auto locked_index = index_ptr.Lock();
+            if (locked_index->PollTagFilterUpdate(full_sync, &update)) {
+                updates.push_back(std::make_pair(logspace_id, std::move(update)));
+            }
+        };
+        index_collection_.ForEachActiveLogSpace(poll_update);
+        index_collection_.ForEachFinalizedLogSpace(poll_update);
+    }
+    for (const auto& [logspace_id, update] : updates) {
+        std::span<const char> data = STRING_AS_SPAN(update.data);
+        UpdateTagFilter(logspace_id, my_node_id(), update.metalog_position,
+                        update.prev_metalog_position, update.finalized, update.delta, data);
+        SharedLogMessage message = SharedLogMessageHelper::NewTagFilterMessage(
+            logspace_id, update.metalog_position);
+        message.prev_metalog_position = update.prev_metalog_position;
+        if (update.finalized) {
+            message.flags |= protocol::kTagFilterFinalizedFlag;
+        }
+        if (update.delta) {
+            message.flags |= protocol::kTagFilterDeltaFlag;
+        }
+        SendTagFilterMessage(view, &message, data);
+    }
+}
+
+void Engine::OnQueuePopRead(LocalOp* op, Message* response, uint64_t metalog_progress) {
+    SharedLogResultType result = MessageHelper::GetSharedLogResultType(*response);
+    HVLOG_F(1, "Queue pop read finished: op_id={}, tag={}, result={:#x}",
+            op->id, op->query_tag, static_cast<uint16_t>(result));
+    auto key = std::make_pair(op->user_logspace, op->query_tag);
+    bool cursor_read = false;
+    {
+        absl::MutexLock queue_lk(&queue_mu_);
+        cursor_read = queues_.at(key).cursor_read_view_id.has_value();
+    }
+    if (cursor_read) {
+        OnQueueCursorRead(op, response);
+        return;
+    }
+    LocalOp* next_op = nullptr;
+    uint64_t next_seqnum = 0;
+    std::deque<LocalOp*> empty_ops;
+    {
+        absl::MutexLock queue_lk(&queue_mu_);
+        QueueState& queue = queues_.at(key);
+        DCHECK(queue.ongoing_pop == op);
+        if (result == SharedLogResultType::READ_OK) {
+            queue.next_seqnum = response->log_seqnum + 1;
+        } else if (result == SharedLogResultType::EMPTY
+                       && op->type == SharedLogOpType::QUEUE_POP_B) {
+            // The queue stays empty since the blocking pop started, thus is
+            // empty for waiting non-blocking pops. Waiting blocking pops
+            // keep waiting until their own timeouts.
+            int64_t current_timestamp = GetMonotonicMicroTimestamp();
+            std::deque<LocalOp*> waiting_pops;
+            for (LocalOp* waiting_op : queue.waiting_pops) {
+                if (waiting_op->type == SharedLogOpType::QUEUE_POP_B
+                        && current_timestamp - waiting_op->start_timestamp
+                               < absl::ToInt64Microseconds(Index::kBlockingQueryTimeout)) {
+                    waiting_pops.push_back(waiting_op);
+                } else {
+                    empty_ops.push_back(waiting_op);
+                }
+            }
+            queue.waiting_pops.swap(waiting_pops);
+        }
+        queue.ongoing_pop = nullptr;
+        if (!queue.waiting_pops.empty()) {
+            next_op = queue.waiting_pops.front();
+            queue.waiting_pops.pop_front();
+            queue.ongoing_pop = next_op;
+            next_seqnum = queue.next_seqnum;
+        }
+    }
+    FinishLocalOpWithResponse(op, response, metalog_progress);
+    for (LocalOp* empty_op : empty_ops) {
+        FinishLocalOpWithFailure(empty_op, SharedLogResultType::EMPTY, metalog_progress);
+    }
+    if (next_op != nullptr) {
+        IssueQueuePopRead(next_op, next_seqnum);
+    }
+}
+
+void Engine::ServeQueuePop(LocalOp* op, uint16_t view_id) {
+    auto key = std::make_pair(op->user_logspace, op->query_tag);
+    uint64_t next_seqnum = 0;
+    bool queue_empty = false;
+    std::optional<uint16_t> cursor_read_view_id;
+    {
+        absl::MutexLock queue_lk(&queue_mu_);
+        QueueState& queue = queues_[key];
+        if (queue.ongoing_pop == nullptr) {
+            if (queue.view_id != view_id) {
+                // This engine may not serve pops of the queue in previous views,
+                // where the cursor is moved by other engines
+                auto cursor = RecoverQueueCursor(op->user_logspace, op->query_tag);
+                if (cursor.has_value()) {
+                    queue.next_seqnum = std::max(queue.next_seqnum, *cursor);
+                } else if (view_id > 0) {
+                    cursor_read_view_id = view_id - 1;
+                    queue.cursor_read_view_id = cursor_read_view_id;
+                }
+                queue.view_id = view_id;
+            }
+            queue.ongoing_pop = op;
+            next_seqnum = queue.next_seqnum;
+        } else if (op->type == SharedLogOpType::QUEUE_POP
+                       && queue.ongoing_pop->type == SharedLogOpType::QUEUE_POP_B) {
+            // The queue stays empty since the ongoing blocking pop started
+            queue_empty = true;
+        } else {
+            queue.waiting_pops.push_back(op);
+            return;
+        }
+    }
+    if (queue_empty) {
+        FinishLocalOpWithFailure(op, SharedLogResultType::EMPTY);
+        return;
+    }
+    if (cursor_read_view_id.has_value()) {
+        IssueQueueCursorRead(op, *cursor_read_view_id);
+        return;
+    }
+    IssueQueuePopRead(op, next_seqnum);
+}
+
+void Engine::IssueQueueCursorRead(LocalOp* op, uint16_t view_id) {
+    const View* view = nullptr;
+    {
+        absl::ReaderMutexLock view_lk(&view_mu_);
+        view = views_.at(view_id);
+    }
+    uint32_t logspace_id = view->LogSpaceIdentifier(op->user_logspace);
+    const View::Sequencer* sequencer_node = view->GetSequencerNode(
+        bits::LowHalf32(logspace_id));
+    uint16_t engine_id = sequencer_node->GetQueueEngineNodeForTag(op->query_tag);
+    HVLOG_F(1, "Read cursor of queue with tag {} from storage nodes of engine {} in view {}",
+            op->query_tag, engine_id, view_id);
+    LocalOp* sub_op = NewQueueCursorReadOp(op);
+    onging_reads_.PutChecked(sub_op->id, sub_op);
+    if (!SendQueueCursorReadRequest(sub_op, view->GetEngineNode(engine_id))) {
+        onging_reads_.RemoveChecked(sub_op->id);
+        FinishLocalOpWithFailure(sub_op, SharedLogResultType::DATA_LOST);
+    }
+}
+
+void Engine::OnQueueCursorRead(LocalOp* op, Message* response) {
+    SharedLogResultType result = MessageHelper::GetSharedLogResultType(*response);
+    auto key = std::make_pair(op->user_logspace, op->query_tag);
+    std::optional<uint16_t> next_view_id;
+    uint64_t next_seqnum = 0;
+    uint16_t view_id = 0;
+    std::deque<LocalOp*> retry_ops;
+    bool failed = false;
+    {
+        absl::MutexLock queue_lk(&queue_mu_);
+        QueueState& queue = queues_.at(key);
+        DCHECK(queue.ongoing_pop == op);
+        DCHECK(queue.cursor_read_view_id.has_value());
+        uint16_t cursor_read_view_id = *queue.cursor_read_view_id;
+        if (result == SharedLogResultType::CHECKPOINT_OK) {
+            HVLOG_F(1, "Recover cursor of queue with tag {} at seqnum {} from view {}",
+                    op->query_tag, bits::HexStr0x(response->log_seqnum),
+                    cursor_read_view_id);
+            queue.next_seqnum = std::max(queue.next_seqnum, response->log_seqnum + 1);
+            queue.cursor_read_view_id.reset();
+        } else if (result == SharedLogResultType::EMPTY) {
+            if (cursor_read_view_id > 0) {
+                next_view_id = cursor_read_view_id - 1;
+                queue.cursor_read_view_id = next_view_id;
+            } else {
+                // No pops of the queue ever persisted a cursor
+                queue.cursor_read_view_id.reset();
+            }
+        } else {
+            // Pops cannot go on without the cursor, or they may return log
+            // entries already popped. The next pop will recover it again.
+            HLOG_F(WARNING, "Failed to read cursor of queue with tag {} in view {}",
+                   op->query_tag, cursor_read_view_id);
+            failed = true;
+            view_id = queue.view_id;
+            queue.cursor_read_view_id.reset();
+            queue.view_id = std::numeric_limits<uint16_t>::max();
+            queue.ongoing_pop = nullptr;
+            retry_ops.swap(queue.waiting_pops);
+        }
+        next_seqnum = queue.next_seqnum;
+    }
+    if (failed) {
+        FinishLocalOpWithFailure(op, SharedLogResultType::DATA_LOST);
+        for (LocalOp* retry_op : retry_ops) {
+            ServeQueuePop(retry_op, view_id);
+        }
+    } else if (next_view_id.has_value()) {
+        IssueQueueCursorRead(op, *next_view_id);
+    } else {
+        IssueQueuePopRead(op, next_seqnum);
+    }
+}
+
+std::optional<uint64_t> Engine::RecoverQueueCursor(uint32_t user_logspace, uint64_t tag) {
+    absl::ReaderMutexLock view_lk(&view_mu_);
+    for (auto iter = views_.rbegin(); iter != views_.rend(); iter++) {
+        uint32_t logspace_id = (*iter)->LogSpaceIdentifier(user_logspace);
+        auto index_ptr = index_collection_.GetLogSpace(logspace_id);
+        if (index_ptr == nullptr) {
+            continue;
+        }
+        uint64_t seqnum = kInvalidLogSeqNum;
+        auto locked_index = index_ptr.Lock();
+        if (locked_index->FindQueueCursor(user_logspace, tag, &seqnum)) {
+            HVLOG_F(1, "Recover cursor of queue with tag {} at seqnum {}",
+                    tag, bits::HexStr0x(seqnum));
+            return seqnum + 1;
+        }
+    }
+    return std::nullopt;
+}
+
+void Engine::PersistQueueCursors() {
+    const View* view = nullptr;
+    {
+        absl::ReaderMutexLock view_lk(&view_mu_);
+        if (current_view_active_) {
+            view = current_view_;
+        }
+    }
+    absl::flat_hash_map</* logspace_id */ uint32_t, std::vector<uint64_t>> cursors;
+    std::vector<LocalOp*> timed_out_ops;
+    int64_t current_timestamp = GetMonotonicMicroTimestamp();
+    {
+        absl::MutexLock queue_lk(&queue_mu_);
+        for (auto& [key, queue] : queues_) {
+            auto iter = std::remove_if(
+                queue.waiting_pops.begin(), queue.waiting_pops.end(),
+                [current_timestamp, &timed_out_ops] (LocalOp* op) {
+                    if (op->type == SharedLogOpType::QUEUE_POP_B
+                            && current_timestamp - op->start_timestamp
+                                   >= absl::ToInt64Microseconds(Index::kBlockingQueryTimeout)) {
+                        timed_out_ops.push_back(op);
+                        return true;
+                    }
+                    return false;
+                });
+            queue.waiting_pops.erase(iter, queue.waiting_pops.end());
+            if (view == nullptr || queue.next_seqnum == queue.persisted_next_seqnum) {
+                continue;
+            }
+            // The cursor is the seqnum of the last popped log entry, which
+            // becomes durable asynchronously
+            const auto& [user_logspace, tag] = key;
+            auto& logspace_cursors = cursors[view->LogSpaceIdentifier(user_logspace)];
+            logspace_cursors.push_back(user_logspace);
+            logspace_cursors.push_back(tag);
+            logspace_cursors.push_back(queue.next_seqnum - 1);
+            queue.persisted_next_seqnum = queue.next_seqnum;
+        }
+    }
+    for (const auto& [logspace_id, logspace_cursors] : cursors) {
+        ReplicateQueueCursors(view, logspace_id, VECTOR_AS_SPAN(logspace_cursors));
+    }
+    for (LocalOp* op : timed_out_ops) {
+        HVLOG_F(1, "Blocking pop of queue with tag {} timed out while waiting",
+                op->query_tag);
+        FinishLocalOpWithFailure(op, SharedLogResultType::EMPTY);
+    }
+}
+
 void Engine::ProcessAppendResults(const LogProducer::AppendResultVec& results) {
     for (const LogProducer::AppendResult& result : results) {
         LocalOp* op = reinterpret_cast<LocalOp*>(result.caller_data);
@@ -432,6 +1026,7 @@ void Engine::ProcessAppendResults(const LogProducer::AppendResultVec& results) {
             log_metadata.seqnum = result.seqnum;
             log_metadata.localid = result.localid;
             LogCachePut(log_metadata, VECTOR_AS_SPAN(op->user_tags), op->data.to_span());
+            RecentAppendPut(log_metadata, VECTOR_AS_SPAN(op->user_tags), op->data.to_span());
             Message response = MessageHelper::NewSharedLogOpSucceeded(
                 SharedLogResultType::APPEND_OK, result.seqnum);
             FinishLocalOpWithResponse(op, &response, result.metalog_progress);
@@ -444,11 +1039,24 @@ void Engine::ProcessAppendResults(const LogProducer::AppendResultVec& results) {
 void Engine::ProcessIndexFoundResult(const IndexQueryResult& query_result) {
     DCHECK(query_result.state == IndexQueryResult::kFound);
     const IndexQuery& query = query_result.original_query;
+    if (query.seqnum_only) {
+        ProcessIndexSeqnumResult(query_result);
+        return;
+    }
     bool local_request = (query.origin_node_id == my_node_id());
     uint64_t seqnum = query_result.found_result.seqnum;
-    if (auto cached_log_entry = LogCacheGet(seqnum); cached_log_entry.has_value()) {
+    std::optional<LogEntry> cached_log_entry = TailCacheGet(query, seqnum);
+    bool tail_cache_hit = cached_log_entry.has_value();
+    if (!tail_cache_hit) {
+        cached_log_entry = RecentAppendGet(query, seqnum);
+    }
+    if (!cached_log_entry.has_value()) {
+        cached_log_entry = LogCacheGet(seqnum);
+    }
+    if (cached_log_entry.has_value()) {
         // Cache hits
-        HVLOG_F(1, "Cache hits for log entry (seqnum {})", bits::HexStr0x(seqnum));
+        HVLOG_F(1, "Cache hits for log entry (seqnum {}, tail_cache_hit={})",
+                bits::HexStr0x(seqnum), tail_cache_hit);
         const LogEntry& log_entry = cached_log_entry.value();
         std::optional<std::string> cached_aux_data = LogCacheGetAuxData(seqnum);
         std::span<const char> aux_data;
@@ -471,6 +1079,9 @@ void Engine::ProcessIndexFoundResult(const IndexQueryResult& query_result) {
             Message response = BuildLocalReadOKResponse(log_entry);
             response.log_aux_data_size = gsl::narrow_cast<uint16_t>(aux_data.size());
             MessageHelper::AppendInlineData(&response, aux_data);
+            if (tail_cache_hit) {
+                TailCacheRecordReadDelay(op, /* cache_hit= */ true);
+            }
             FinishLocalOpWithResponse(op, &response, query_result.metalog_progress);
         } else {
             HVLOG_F(1, "Send read response for log (seqnum {})", bits::HexStr0x(seqnum));
@@ -478,6 +1089,9 @@ void Engine::ProcessIndexFoundResult(const IndexQueryResult& query_result) {
             log_utils::PopulateMetaDataToMessage(log_entry.metadata, &response);
             response.user_metalog_progress = query_result.metalog_progress;
             response.aux_data_size = gsl::narrow_cast<uint16_t>(aux_data.size());
+            if (tail_cache_hit) {
+                response.response_flags |= protocol::kReadTailCacheHitFlag;
+            }
             SendReadResponse(query, &response,
                              VECTOR_AS_CHAR_SPAN(log_entry.user_tags),
                              STRING_AS_SPAN(log_entry.data), aux_data);
@@ -508,14 +1122,87 @@ void Engine::ProcessIndexFoundResult(const IndexQueryResult& query_result) {
     }
 }
 
+void Engine::ProcessIndexCountResult(const IndexQueryResult& query_result) {
+    DCHECK(query_result.state == IndexQueryResult::kFound);
+    const IndexQuery& query = query_result.original_query;
+    DCHECK(query.direction == IndexQuery::kCount);
+    uint32_t count = query_result.found_result.count;
+    if (query.origin_node_id == my_node_id()) {
+        LocalOp* op = onging_reads_.PollChecked(query.client_data);
+        Message response = MessageHelper::NewSharedLogOpSucceeded(
+            SharedLogResultType::COUNT_OK);
+        response.log_count = count;
+        FinishLocalOpWithResponse(op, &response, query_result.metalog_progress);
+    } else {
+        SharedLogMessage response = SharedLogMessageHelper::NewResponse(
+            SharedLogResultType::COUNT_OK);
+        response.user_metalog_progress = query_result.metalog_progress;
+        response.count = count;
+        SendReadResponse(query, &response);
+    }
+}
+
+void Engine::ProcessIndexSeqnumResult(const IndexQueryResult& query_result) {
+    DCHECK(query_result.state == IndexQueryResult::kFound);
+    const IndexQuery& query = query_result.original_query;
+    DCHECK(query.seqnum_only);
+    uint64_t seqnum = query_result.found_result.seqnum;
+    if (query.origin_node_id == my_node_id()) {
+        LocalOp* op = onging_reads_.PollChecked(query.client_data);
+        Message response = MessageHelper::NewSharedLogOpSucceeded(
+            SharedLogResultType::READ_OK, seqnum);
+        FinishLocalOpWithResponse(op, &response, query_result.metalog_progress);
+    } else {
+        SharedLogMessage response = SharedLogMessageHelper::NewReadOkResponse();
+        response.logspace_id = bits::HighHalf64(seqnum);
+        response.seqnum_lowhalf = bits::LowHalf64(seqnum);
+        response.user_metalog_progress = query_result.metalog_progress;
+        SendReadResponse(query, &response);
+    }
+}
+
+void Engine::ProcessIndexCheckpointResult(const IndexQueryResult& query_result) {
+    DCHECK(query_result.state == IndexQueryResult::kFound);
+    const IndexQuery& query = query_result.original_query;
+    DCHECK(query.direction == IndexQuery::kReadCheckpoint);
+    const View::Engine* engine_node = nullptr;
+    {
+        absl::ReaderMutexLock view_lk(&view_mu_);
+        uint16_t view_id = query_result.found_result.view_id;
+        if (view_id < views_.size()) {
+            const View* view = views_.at(view_id);
+            engine_node = view->GetEngineNode(query_result.found_result.engine_id);
+        } else {
+            HLOG_F(FATAL, "Cannot find view {}", view_id);
+        }
+    }
+    // Checkpoint data is never cached, the storage node responds to the
+    // origin engine directly
+    bool success = SendCheckpointReadRequest(query_result, engine_node);
+    if (!success) {
+        HLOG_F(WARNING, "Failed to send checkpoint read request for seqnum {} ",
+               bits::HexStr0x(query_result.found_result.seqnum));
+        if (query.origin_node_id == my_node_id()) {
+            LocalOp* op = onging_reads_.PollChecked(query.client_data);
+            FinishLocalOpWithFailure(op, SharedLogResultType::DATA_LOST);
+        } else {
+            SendReadFailureResponse(query, SharedLogResultType::DATA_LOST);
+        }
+    }
+}
+
 void Engine::ProcessIndexContinueResult(const IndexQueryResult& query_result,
                                         Index::QueryResultVec* more_results) {
     DCHECK(query_result.state == IndexQueryResult::kContinue);
     HVLOG_F(1, "Process IndexContinueResult: next_view_id={}",
             query_result.next_view_id);
     const IndexQuery& query = query_result.original_query;
+    std::span<const uint64_t> query_tags = query.multi_tag()
+        ? VECTOR_AS_SPAN(query.user_tags)
+        : std::span<const uint64_t>(&query.user_tag, 1);
     const View::Sequencer* sequencer_node = nullptr;
     LockablePtr<Index> index_ptr;
+    bool same_index_partition = true;
     {
         absl::ReaderMutexLock view_lk(&view_mu_);
         uint16_t view_id = query_result.next_view_id;
@@ -525,10 +1212,23 @@ void Engine::ProcessIndexContinueResult(const IndexQueryResult& query_result,
         const View* view = views_.at(view_id);
         uint32_t logspace_id = view->LogSpaceIdentifier(query.user_logspace);
         sequencer_node = view->GetSequencerNode(bits::LowHalf32(logspace_id));
-        if (sequencer_node->IsIndexEngineNode(my_node_id())) {
+        same_index_partition = sequencer_node->InSameIndexPartition(query_tags);
+        if (sequencer_node->IsIndexEngineNodeForTags(my_node_id(), query_tags)) {
             index_ptr = index_collection_.GetLogSpaceChecked(logspace_id);
         }
     }
+    if (!same_index_partition) {
+        // Partitions of index engines may change across views
+        HLOG_F(WARNING, "Query tags are in different index partitions of view {}",
+               query_result.next_view_id);
+        if (query.origin_node_id == my_node_id()) {
+            FinishLocalOpWithFailure(
+                onging_reads_.PollChecked(query.client_data), SharedLogResultType::BAD_ARGS);
+        } else {
+            SendReadFailureResponse(query, SharedLogResultType::BAD_ARGS);
+        }
+        return;
+    }
     if (index_ptr != nullptr) {
         HVLOG(1) << "Use local index";
         IndexQuery query = BuildIndexQuery(query_result);
@@ -538,7 +1238,8 @@ void Engine::ProcessIndexContinueResult(const IndexQueryResult& query_result,
     } else {
         HVLOG(1) << "Send to remote index";
         SharedLogMessage request = BuildReadRequestMessage(query_result);
-        bool send_success = SendIndexReadRequest(DCHECK_NOTNULL(sequencer_node), &request);
+        bool send_success = SendIndexReadRequest(DCHECK_NOTNULL(sequencer_node), &request,
+                                                 VECTOR_AS_CHAR_SPAN(query.user_tags));
         if (!send_success) {
             uint32_t logspace_id = bits::JoinTwo16(sequencer_node->view()->id(),
                                                    sequencer_node->node_id());
@@ -554,13 +1255,20 @@ void Engine::ProcessIndexQueryResults(const Index::QueryResultVec& results) {
         const IndexQuery& query = result.original_query;
         switch (result.state) {
         case IndexQueryResult::kFound:
-            ProcessIndexFoundResult(result);
+            if (query.direction == IndexQuery::kCount) {
+                ProcessIndexCountResult(result);
+            } else if (query.direction == IndexQuery::kReadCheckpoint) {
+                ProcessIndexCheckpointResult(result);
+            } else {
+                ProcessIndexFoundResult(result);
+            }
             break;
         case IndexQueryResult::kEmpty:
             if (query.origin_node_id == my_node_id()) {
+                LocalOp* op = onging_reads_.PollChecked(query.client_data);
+                TagFilterRecordEmptyRead(op);
                 FinishLocalOpWithFailure(
-                    onging_reads_.PollChecked(query.client_data),
-                    SharedLogResultType::EMPTY, result.metalog_progress);
+                    op, SharedLogResultType::EMPTY, result.metalog_progress);
             } else {
                 SendReadFailureResponse(
                     query, SharedLogResultType::EMPTY, result.metalog_progress);
@@ -588,22 +1296,186 @@ void Engine::ProcessRequests(const std::vector<SharedLogRequest>& requests) {
     }
 }
 
+void Engine::UpdateTagFilter(uint32_t logspace_id, uint16_t engine_id,
+                             uint32_t metalog_position, uint32_t prev_metalog_position,
+                             bool finalized, bool delta, std::span<const char> data) {
+    auto key = std::make_pair(logspace_id, engine_id);
+    uint64_t metalog_progress = bits::JoinTwo32(logspace_id, metalog_position);
+    if (delta) {
+        absl::MutexLock tag_filter_lk(&tag_filter_mu_);
+        auto iter = tag_filters_.find(key);
+        if (iter == tag_filters_.end() || iter->second->metalog_progress
+                != bits::JoinTwo32(logspace_id, prev_metalog_position)) {
+            // Some updates are missed or reordered, and applying this delta
+            // would lose their bits. Wait for the next full filter.
+            HVLOG_F(1, "Skip tag filter delta of log space {} from engine {}",
+                    bits::HexStr0x(logspace_id), engine_id);
+            return;
+        }
+        TagFilterSnapshot* snapshot = iter->second.get();
+        if (!snapshot->filter.ApplyDelta(data)) {
+            tag_filters_.erase(iter);
+            return;
+        }
+        snapshot->metalog_progress = metalog_progress;
+        snapshot->finalized = finalized;
+        return;
+    }
+    auto snapshot = std::make_unique<TagFilterSnapshot>(metalog_progress, finalized, data);
+    absl::MutexLock tag_filter_lk(&tag_filter_mu_);
+    auto iter = tag_filters_.find(key);
+    if (iter != tag_filters_.end()
+            && iter->second->metalog_progress > snapshot->metalog_progress) {
+        // Filters sent through different connections can be reordered
+        return;
+    }
+    tag_filters_[key] = std::move(snapshot);
+}
+
+bool Engine::TagFilterRulesOutRead(LocalOp* op, bool remote_index,
+                                   uint64_t* metalog_progress) {
+    if (!absl::GetFlag(FLAGS_slog_engine_enable_tag_filter)) {
+        return false;
+    }
+    // Blocking reads wait for future log entries, and kEmptyLogTag matches
+    // all log entries
+    if (    op->type != SharedLogOpType::READ_NEXT
+         && op->type != SharedLogOpType::READ_PREV
+         && op->type != SharedLogOpType::READ_NEXT_MT
+         && op->type != SharedLogOpType::READ_PREV_MT) {
+        return false;
+    }
+    if (op->user_tags.empty() && op->query_tag == kEmptyLogTag) {
+        return false;
+    }
+    std::span<const uint64_t> query_tags = op->user_tags.empty()
+        ? std::span<const uint64_t>(&op->query_tag, 1)
+        : VECTOR_AS_SPAN(op->user_tags);
+    size_t num_absent_tags = 0;
+    bool filter_unavailable = false;
+    uint64_t empty_metalog_progress = op->metalog_progress;
+    absl::ReaderMutexLock view_lk(&view_mu_);
+    absl::ReaderMutexLock tag_filter_lk(&tag_filter_mu_);
+    for (uint64_t tag : query_tags) {
+        // The tag is absent only if absent in indices of all views
+        bool absent = true;
+        for (const View* view : views_) {
+            const TagFilterSnapshot* snapshot = GetTagFilterLocked(
+                view, op->user_logspace, tag, op->metalog_progress);
+            if (snapshot == nullptr) {
+                filter_unavailable = true;
+                absent = false;
+                break;
+            }
+            if (snapshot->filter.MayContain(op->user_logspace, tag)) {
+                absent = false;
+                break;
+            }
+            if (view == current_view_) {
+                empty_metalog_progress = std::max(empty_metalog_progress,
+                                                  snapshot->metalog_progress);
+            }
+        }
+        if (absent) {
+            num_absent_tags++;
+        }
+    }
+    bool ruled_out = (op->user_tags.empty() || op->match_all_tags)
+                   ? num_absent_tags > 0
+                   : num_absent_tags == query_tags.size();
+    absl::MutexLock stat_lk(&tag_filter_stat_mu_);
+    if (ruled_out) {
+        tag_filter_stat_.Tick(kTagAbsent);
+        if (remote_index) {
+            remote_query_avoided_stat_.Tick();
+        }
+        *metalog_progress = empty_metalog_progress;
+        return true;
+    }
+    tag_filter_stat_.Tick(filter_unavailable ? kTagFilterUnavailable : kTagMayExist);
+    op->tag_filter_passed = !filter_unavailable;
+    return false;
+}
+
+const Engine::TagFilterSnapshot* Engine::GetTagFilterLocked(const View* view,
+                                                            uint32_t user_logspace,
+                                                            uint64_t tag,
+                                                            uint64_t metalog_progress) {
+    uint32_t logspace_id = view->LogSpaceIdentifier(user_logspace);
+    const View::Sequencer* sequencer_node = view->GetSequencerNode(
+        bits::LowHalf32(logspace_id));
+    // Indices of past views must be complete, while the index of the current
+    // view must have caught up with `metalog_progress`, as in Index::MakeQuery
+    bool require_finalized = (view != current_view_);
+    bool check_progress = (log_utils::GetViewId(metalog_progress) == view->id());
+    std::span<const uint64_t> tags(&tag, 1);
+    for (uint16_t engine_id : sequencer_node->GetIndexEngineNodes()) {
+        if (!sequencer_node->IsIndexEngineNodeForTags(engine_id, tags)) {
+            continue;
+        }
+        auto iter = tag_filters_.find(std::make_pair(logspace_id, engine_id));
+        if (iter == tag_filters_.end()) {
+            continue;
+        }
+        const TagFilterSnapshot* snapshot = iter->second.get();
+        if (require_finalized && !snapshot->finalized) {
+            continue;
+        }
+        if (check_progress && bits::LowHalf64(snapshot->metalog_progress)
+                                  < bits::LowHalf64(metalog_progress)) {
+            continue;
+        }
+        return snapshot;
+    }
+    return nullptr;
+}
+
+void Engine::TagFilterRecordEmptyRead(LocalOp* op) {
+    if (op->tag_filter_passed) {
+        absl::MutexLock stat_lk(&tag_filter_stat_mu_);
+        tag_filter_stat_.Tick(kTagMayExistButEmpty);
+    }
+}
+
 SharedLogMessage Engine::BuildReadRequestMessage(LocalOp* op) {
     DCHECK(  op->type == SharedLogOpType::READ_NEXT
           || op->type == SharedLogOpType::READ_PREV
-          || op->type == SharedLogOpType::READ_NEXT_B);
+          || op->type == SharedLogOpType::READ_NEXT_B
+          || op->type == SharedLogOpType::READ_NEXT_MT
+          || op->type == SharedLogOpType::READ_PREV_MT
+          || op->type == SharedLogOpType::COUNT
+          || op->type == SharedLogOpType::READ_CHECKPOINT);
     SharedLogMessage request = SharedLogMessageHelper::NewReadMessage(op->type);
     request.origin_node_id = my_node_id();
     request.hop_times = 1;
     request.client_data = op->id;
     request.user_logspace = op->user_logspace;
-    request.query_tag = op->query_tag;
+    if (op->type == SharedLogOpType::READ_NEXT_MT || op->type == SharedLogOpType::READ_PREV_MT) {
+        // Query tags are sent as payload
+        request.num_tags = gsl::narrow_cast<uint16_t>(op->user_tags.size());
+        if (op->match_all_tags) {
+            request.flags |= protocol::kReadMatchAllTagsFlag;
+        }
+    } else {
+        request.query_tag = op->query_tag;
+    }
     request.query_seqnum = op->seqnum;
     request.user_metalog_progress = op->metalog_progress;
     request.flags |= protocol::kReadInitialFlag;
-    request.prev_view_id = 0;
-    request.prev_engine_id = 0;
-    request.prev_found_seqnum = kInvalidLogSeqNum;
+    if (op->seqnum_only()) {
+        request.flags |= protocol::kReadSeqnumOnlyFlag;
+    }
+    if (op->type == SharedLogOpType::COUNT) {
+        request.count = 0;
+        request.end_seqnum = op->end_seqnum;
+        if (op->count_exists) {
+            request.flags |= protocol::kCountExistsFlag;
+        }
+    } else {
+        request.prev_view_id = 0;
+        request.prev_engine_id = 0;
+        request.prev_found_seqnum = kInvalidLogSeqNum;
+    }
     return request;
 }
 
@@ -616,12 +1488,30 @@ SharedLogMessage Engine::BuildReadRequestMessage(const IndexQueryResult& result)
     request.hop_times = query.hop_times + 1;
     request.client_data = query.client_data;
     request.user_logspace = query.user_logspace;
-    request.query_tag = query.user_tag;
+    if (query.multi_tag()) {
+        request.num_tags = gsl::narrow_cast<uint16_t>(query.user_tags.size());
+        if (query.match_all_tags) {
+            request.flags |= protocol::kReadMatchAllTagsFlag;
+        }
+    } else {
+        request.query_tag = query.user_tag;
+    }
     request.query_seqnum = query.query_seqnum;
     request.user_metalog_progress = result.metalog_progress;
-    request.prev_view_id = result.found_result.view_id;
-    request.prev_engine_id = result.found_result.engine_id;
-    request.prev_found_seqnum = result.found_result.seqnum;
+    if (query.seqnum_only) {
+        request.flags |= protocol::kReadSeqnumOnlyFlag;
+    }
+    if (query.direction == IndexQuery::kCount) {
+        request.count = result.found_result.count;
+        request.end_seqnum = query.end_seqnum;
+        if (query.count_exists) {
+            request.flags |= protocol::kCountExistsFlag;
+        }
+    } else {
+        request.prev_view_id = result.found_result.view_id;
+        request.prev_engine_id = result.found_result.engine_id;
+        request.prev_found_seqnum = result.found_result.seqnum;
+    }
     return request;
 }
 
@@ -635,33 +1525,62 @@ IndexQuery Engine::BuildIndexQuery(LocalOp* op) {
         .user_logspace = op->user_logspace,
         .user_tag = op->query_tag,
         .query_seqnum = op->seqnum,
+        .end_seqnum = op->end_seqnum,
+        .count_exists = op->count_exists,
         .metalog_progress = op->metalog_progress,
+        .user_tags = op->user_tags,
+        .match_all_tags = op->match_all_tags,
+        .seqnum_only = op->seqnum_only(),
         .prev_found_result = {
             .view_id = 0,
             .engine_id = 0,
-            .seqnum = kInvalidLogSeqNum
+            .seqnum = kInvalidLogSeqNum,
+            .count = 0
         }
     };
 }
 
-IndexQuery Engine::BuildIndexQuery(const SharedLogMessage& message) {
+IndexQuery Engine::BuildIndexQuery(const SharedLogMessage& message,
+                                   std::span<const char> payload) {
     SharedLogOpType op_type = SharedLogMessageHelper::GetOpType(message);
-    return IndexQuery {
+    bool multi_tag = (op_type == SharedLogOpType::READ_NEXT_MT
+                      || op_type == SharedLogOpType::READ_PREV_MT);
+    bool count_query = (op_type == SharedLogOpType::COUNT);
+    IndexQuery query = {
         .direction = IndexQuery::DirectionFromOpType(op_type),
         .origin_node_id = message.origin_node_id,
         .hop_times = message.hop_times,
-        .initial = (message.flags | protocol::kReadInitialFlag) != 0,
+        .initial = (message.flags & protocol::kReadInitialFlag) != 0,
         .client_data = message.client_data,
         .user_logspace = message.user_logspace,
-        .user_tag = message.query_tag,
+        .user_tag = multi_tag ? kInvalidLogTag : message.query_tag,
         .query_seqnum = message.query_seqnum,
+        .end_seqnum = count_query ? message.end_seqnum : kInvalidLogSeqNum,
+        .count_exists = count_query && (message.flags & protocol::kCountExistsFlag) != 0,
         .metalog_progress = message.user_metalog_progress,
+        .user_tags = {},
+        .match_all_tags = (message.flags & protocol::kReadMatchAllTagsFlag) != 0,
+        .seqnum_only = (message.flags & protocol::kReadSeqnumOnlyFlag) != 0,
         .prev_found_result = IndexFoundResult {
-            .view_id = message.prev_view_id,
-            .engine_id = message.prev_engine_id,
-            .seqnum = message.prev_found_seqnum
+            .view_id = 0,
+            .engine_id = 0,
+            .seqnum = kInvalidLogSeqNum,
+            .count = 0
         }
     };
+    if (count_query) {
+        query.prev_found_result.count = message.count;
+    } else {
+        query.prev_found_result.view_id = message.prev_view_id;
+        query.prev_found_result.engine_id = message.prev_engine_id;
+        query.prev_found_result.seqnum = message.prev_found_seqnum;
+    }
+    if (multi_tag) {
+        DCHECK_EQ(payload.size(), message.num_tags * sizeof(uint64_t));
+        query.user_tags.resize(message.num_tags);
+        memcpy(query.user_tags.data(), payload.data(), payload.size());
+    }
+    return query;
 }
 
 IndexQuery Engine::BuildIndexQuery(const IndexQueryResult& result) {
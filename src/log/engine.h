@@ -32,6 +32,55 @@ private:
     log_utils::FutureRequests       future_requests_;
     log_utils::ThreadedMap<LocalOp> onging_reads_;
 
+    // READ_SNAPSHOT ops waiting for the local producer to catch up with
+    // metalog progress seen by their function calls
+    absl::Mutex snapshot_mu_;
+    std::vector<LocalOp*> pending_snapshot_reads_ ABSL_GUARDED_BY(snapshot_mu_);
+
+    struct TagFilterSnapshot {
+        uint64_t  metalog_progress;
+        bool      finalized;
+        TagFilter filter;
+
+        TagFilterSnapshot(uint64_t metalog_progress, bool finalized,
+                          std::span<const char> data)
+            : metalog_progress(metalog_progress),
+              finalized(finalized),
+              filter(data) {}
+    };
+
+    // Tag filters from index engines, including this one. Reads of filters
+    // take the reader lock, while only updates take the writer lock.
+    absl::Mutex tag_filter_mu_;
+    absl::flat_hash_map<std::pair</* logspace_id */ uint32_t, /* engine_id */ uint16_t>,
+                        std::unique_ptr<TagFilterSnapshot>>
+        tag_filters_                        ABSL_GUARDED_BY(tag_filter_mu_);
+    // Only accessed by the tag filter timer
+    int64_t tag_filter_full_sync_timestamp_;
+
+    absl::Mutex tag_filter_stat_mu_;
+    stat::CategoryCounter tag_filter_stat_  ABSL_GUARDED_BY(tag_filter_stat_mu_);
+    stat::Counter remote_query_avoided_stat_ ABSL_GUARDED_BY(tag_filter_stat_mu_);
+
+    // Queues whose pops are served by this engine. Pops of the same queue
+    // are serialized, each reading the first log entry from the cursor.
+    // Cursors are persisted periodically by PersistQueueCursors, and
+    // recovered from storage nodes if not found in local indices.
+    struct QueueState {
+        uint16_t view_id = std::numeric_limits<uint16_t>::max();  // Where cursor is recovered
+        // Set while the ongoing pop reads the cursor from storage nodes of
+        // the engine serving the queue in this view
+        std::optional<uint16_t> cursor_read_view_id;
+        uint64_t next_seqnum = 0;
+        uint64_t persisted_next_seqnum = 0;
+        LocalOp* ongoing_pop = nullptr;
+        std::deque<LocalOp*> waiting_pops;
+    };
+
+    absl::Mutex queue_mu_;
+    absl::flat_hash_map<std::pair</* user_logspace */ uint32_t, /* tag */ uint64_t>,
+                        QueueState> queues_ ABSL_GUARDED_BY(queue_mu_);
+
     void OnViewCreated(const View* view) override;
     void OnViewFrozen(const View* view) override;
     void OnViewFinalized(const FinalizedView* finalized_view) override;
@@ -40,23 +89,60 @@ private:
     void HandleLocalTrim(LocalOp* op) override;
     void HandleLocalRead(LocalOp* op) override;
     void HandleLocalSetAuxData(LocalOp* op) override;
-
-    void HandleRemoteRead(const protocol::SharedLogMessage& request) override;
+    void HandleLocalSnapshotRead(LocalOp* op) override;
+    void HandleLocalSetCheckpoint(LocalOp* op) override;
+    void HandleLocalQueuePop(LocalOp* op) override;
+
+    void HandleRemoteRead(const protocol::SharedLogMessage& request,
+                          std::span<const char> payload) override;
+    void HandleRemoteQueuePop(const protocol::SharedLogMessage& request,
+                              std::span<const char> payload) override;
     void OnRecvNewMetaLogs(const protocol::SharedLogMessage& message,
                            std::span<const char> payload) override;
     void OnRecvNewIndexData(const protocol::SharedLogMessage& message,
                             std::span<const char> payload) override;
     void OnRecvResponse(const protocol::SharedLogMessage& message,
                         std::span<const char> payload) override;
+    void OnRecvTagFilter(const protocol::SharedLogMessage& message,
+                         std::span<const char> payload) override;
+
+    void BroadcastTagFilters() override;
+    // Also times out blocking pops waiting for their turns
+    void PersistQueueCursors() override;
+
+    void OnQueuePopRead(LocalOp* op, protocol::Message* response,
+                        uint64_t metalog_progress) override;
+    void ServeQueuePop(LocalOp* op, uint16_t view_id);
+    // Returns the seqnum after the latest cursor checkpoint of the queue in
+    // local indices, or std::nullopt if not found
+    std::optional<uint64_t> RecoverQueueCursor(uint32_t user_logspace, uint64_t tag);
+    // Cursor reads go from `view_id` back to older views, until one is found
+    void IssueQueueCursorRead(LocalOp* op, uint16_t view_id);
+    void OnQueueCursorRead(LocalOp* op, protocol::Message* response);
 
     void ProcessAppendResults(const LogProducer::AppendResultVec& results);
     void ProcessIndexQueryResults(const Index::QueryResultVec& results);
     void ProcessRequests(const std::vector<SharedLogRequest>& requests);
 
     void ProcessIndexFoundResult(const IndexQueryResult& query_result);
+    void ProcessIndexCountResult(const IndexQueryResult& query_result);
+    void ProcessIndexSeqnumResult(const IndexQueryResult& query_result);
+    void ProcessIndexCheckpointResult(const IndexQueryResult& query_result);
     void ProcessIndexContinueResult(const IndexQueryResult& query_result,
                                     Index::QueryResultVec* more_results);
 
+    // With `delta`, `data` is applied only to the filter at `prev_metalog_position`
+    void UpdateTagFilter(uint32_t logspace_id, uint16_t engine_id, uint32_t metalog_position,
+                         uint32_t prev_metalog_position, bool finalized, bool delta,
+                         std::span<const char> data);
+    // Returns true if tag filters show that `op` will read nothing, in which
+    // case `metalog_progress` is set for the EMPTY result
+    bool TagFilterRulesOutRead(LocalOp* op, bool remote_index, uint64_t* metalog_progress);
+    const TagFilterSnapshot* GetTagFilterLocked(const View* view, uint32_t user_logspace,
+                                                uint64_t tag, uint64_t metalog_progress)
+        ABSL_SHARED_LOCKS_REQUIRED(view_mu_, tag_filter_mu_);
+    void TagFilterRecordEmptyRead(LocalOp* op);
+
     inline LogMetaData MetaDataFromAppendOp(LocalOp* op) {
         DCHECK(op->type == protocol::SharedLogOpType::APPEND);
         return LogMetaData {
@@ -72,7 +158,8 @@ private:
     protocol::SharedLogMessage BuildReadRequestMessage(const IndexQueryResult& result);
 
     IndexQuery BuildIndexQuery(LocalOp* op);
-    IndexQuery BuildIndexQuery(const protocol::SharedLogMessage& message);
+    IndexQuery BuildIndexQuery(const protocol::SharedLogMessage& message,
+                               std::span<const char> payload);
     IndexQuery BuildIndexQuery(const IndexQueryResult& result);
 
     DISALLOW_COPY_AND_ASSIGN(Engine);
@@ -6,6 +6,7 @@
 #include "server/constants.h"
 #include "engine/engine.h"
 #include "utils/bits.h"
+#include "utils/fs.h"
 
 #define log_header_ "LogEngineBase: "
 
@@ -37,7 +38,23 @@ void EngineBase::Start() {
     SetupTimers();
     // Setup cache
     if (absl::GetFlag(FLAGS_slog_engine_enable_cache)) {
-        log_cache_.emplace(absl::GetFlag(FLAGS_slog_engine_cache_cap_mb));
+        std::string file_cache_dir = absl::GetFlag(FLAGS_slog_engine_file_cache_dir);
+        std::string file_cache_path;
+        if (!file_cache_dir.empty()) {
+            file_cache_path = fs_utils::JoinPath(
+                file_cache_dir, fmt::format("log_cache_{}", node_id_));
+        }
+        log_cache_.emplace(absl::GetFlag(FLAGS_slog_engine_cache_cap_mb),
+                           file_cache_path,
+                           absl::GetFlag(FLAGS_slog_engine_file_cache_cap_mb));
+    }
+    if (absl::GetFlag(FLAGS_slog_engine_enable_tail_cache)) {
+        tail_cache_.emplace(absl::GetFlag(FLAGS_slog_engine_tail_cache_max_tags));
+    }
+    if (absl::GetFlag(FLAGS_slog_engine_recent_append_ttl_ms) > 0) {
+        recent_appends_.emplace(
+            absl::Milliseconds(absl::GetFlag(FLAGS_slog_engine_recent_append_ttl_ms)),
+            absl::GetFlag(FLAGS_slog_engine_recent_append_max_entries));
     }
 }
 
@@ -63,6 +80,18 @@ void EngineBase::SetupZKWatchers() {
 }
 
 void EngineBase::SetupTimers() {
+    if (absl::GetFlag(FLAGS_slog_engine_enable_tag_filter)) {
+        engine_->CreatePeriodicTimer(
+            kSLogTagFilterTimerTypeId,
+            absl::Milliseconds(absl::GetFlag(FLAGS_slog_engine_tag_filter_sync_interval_ms)),
+            [this] () { this->BroadcastTagFilters(); }
+        );
+    }
+    engine_->CreatePeriodicTimer(
+        kSLogQueueCursorTimerTypeId,
+        absl::Milliseconds(absl::GetFlag(FLAGS_slog_engine_queue_cursor_persist_interval_ms)),
+        [this] () { this->PersistQueueCursors(); }
+    );
 }
 
 void EngineBase::OnNewExternalFuncCall(const FuncCall& func_call, uint32_t log_space) {
@@ -111,6 +140,10 @@ void EngineBase::LocalOpHandler(LocalOp* op) {
     case SharedLogOpType::READ_NEXT:
     case SharedLogOpType::READ_PREV:
     case SharedLogOpType::READ_NEXT_B:
+    case SharedLogOpType::READ_NEXT_MT:
+    case SharedLogOpType::READ_PREV_MT:
+    case SharedLogOpType::COUNT:
+    case SharedLogOpType::READ_CHECKPOINT:
         HandleLocalRead(op);
         break;
     case SharedLogOpType::TRIM:
@@ -119,18 +152,142 @@ void EngineBase::LocalOpHandler(LocalOp* op) {
     case SharedLogOpType::SET_AUXDATA:
         HandleLocalSetAuxData(op);
         break;
+    case SharedLogOpType::READ_SNAPSHOT:
+        HandleLocalSnapshotRead(op);
+        break;
+    case SharedLogOpType::SET_CHECKPOINT:
+        HandleLocalSetCheckpoint(op);
+        break;
+    case SharedLogOpType::QUEUE_POP:
+    case SharedLogOpType::QUEUE_POP_B:
+        HandleLocalQueuePop(op);
+        break;
     default:
         UNREACHABLE();
     }
 }
 
+void EngineBase::IssueSnapshotSubReads(LocalOp* op) {
+    DCHECK(op->type == SharedLogOpType::READ_SNAPSHOT);
+    size_t num_reads = op->user_tags.size();
+    DCHECK_EQ(op->seqnum_bounds.size(), num_reads);
+    if (num_reads == 0 || op->seqnum == 0) {
+        // Nothing to read in the snapshot
+        absl::c_fill(op->seqnum_bounds, kInvalidLogSeqNum);
+        FinishSnapshotRead(op);
+        return;
+    }
+    op->sub_read_failure.store(0, std::memory_order_relaxed);
+    op->num_pending_sub_reads.store(num_reads, std::memory_order_release);
+    // `op` can finish as soon as all sub-reads are handled, thus create
+    // all of them first
+    absl::InlinedVector<LocalOp*, 16> sub_ops;
+    for (size_t i = 0; i < num_reads; i++) {
+        LocalOp* sub_op = log_op_pool_.Get();
+        sub_op->id = next_local_op_id_.fetch_add(1, std::memory_order_acq_rel);
+        sub_op->start_timestamp = op->start_timestamp;
+        sub_op->client_id = op->client_id;
+        sub_op->client_data = op->client_data;
+        sub_op->func_call_id = op->func_call_id;
+        sub_op->user_logspace = op->user_logspace;
+        sub_op->metalog_progress = op->metalog_progress;
+        sub_op->type = SharedLogOpType::READ_PREV;
+        // Log entries with seqnum below `op->seqnum` are exactly the snapshot
+        sub_op->seqnum = std::min(op->seqnum_bounds[i], op->seqnum - 1);
+        sub_op->end_seqnum = kInvalidLogSeqNum;
+        sub_op->query_tag = op->user_tags[i];
+        sub_op->match_all_tags = false;
+        sub_op->count_exists = false;
+        sub_op->tag_filter_passed = false;
+        sub_op->origin_node_id = node_id_;
+        sub_op->user_tags.clear();
+        sub_op->data.Reset();
+        sub_op->parent_op = op;
+        sub_op->sub_read_index = i;
+        sub_ops.push_back(sub_op);
+    }
+    for (LocalOp* sub_op : sub_ops) {
+        LocalOpHandler(sub_op);
+    }
+}
+
+void EngineBase::IssueQueuePopRead(LocalOp* op, uint64_t seqnum) {
+    LocalOp* sub_op = NewQueueSubOp(op);
+    sub_op->type = (op->type == SharedLogOpType::QUEUE_POP_B) ? SharedLogOpType::READ_NEXT_B
+                                                              : SharedLogOpType::READ_NEXT;
+    sub_op->seqnum = seqnum;
+    LocalOpHandler(sub_op);
+}
+
+EngineBase::LocalOp* EngineBase::NewQueueCursorReadOp(LocalOp* op) {
+    LocalOp* sub_op = NewQueueSubOp(op);
+    sub_op->type = SharedLogOpType::READ_CHECKPOINT;
+    sub_op->seqnum = kInvalidLogSeqNum;
+    return sub_op;
+}
+
+EngineBase::LocalOp* EngineBase::NewQueueSubOp(LocalOp* op) {
+    DCHECK(op->type == SharedLogOpType::QUEUE_POP || op->type == SharedLogOpType::QUEUE_POP_B);
+    LocalOp* sub_op = log_op_pool_.Get();
+    sub_op->id = next_local_op_id_.fetch_add(1, std::memory_order_acq_rel);
+    sub_op->start_timestamp = op->start_timestamp;
+    sub_op->client_id = op->client_id;
+    sub_op->client_data = op->client_data;
+    sub_op->func_call_id = op->func_call_id;
+    sub_op->user_logspace = op->user_logspace;
+    sub_op->metalog_progress = op->metalog_progress;
+    sub_op->end_seqnum = kInvalidLogSeqNum;
+    sub_op->query_tag = op->query_tag;
+    sub_op->match_all_tags = false;
+    sub_op->count_exists = false;
+    sub_op->tag_filter_passed = false;
+    sub_op->origin_node_id = node_id_;
+    sub_op->user_tags.clear();
+    sub_op->data.Reset();
+    sub_op->parent_op = op;
+    sub_op->sub_read_index = 0;
+    return sub_op;
+}
+
+EngineBase::LocalOp* EngineBase::NewRemoteQueuePopOp(const SharedLogMessage& request) {
+    LocalOp* op = log_op_pool_.Get();
+    op->id = next_local_op_id_.fetch_add(1, std::memory_order_acq_rel);
+    op->start_timestamp = GetMonotonicMicroTimestamp();
+    op->client_id = 0;
+    op->client_data = request.client_data;
+    op->func_call_id = protocol::kInvalidFuncCallId;
+    op->user_logspace = request.user_logspace;
+    op->metalog_progress = request.user_metalog_progress;
+    op->type = SharedLogMessageHelper::GetOpType(request);
+    op->seqnum = kInvalidLogSeqNum;
+    op->end_seqnum = kInvalidLogSeqNum;
+    op->query_tag = request.query_tag;
+    op->match_all_tags = false;
+    op->count_exists = false;
+    op->tag_filter_passed = false;
+    op->origin_node_id = request.origin_node_id;
+    op->user_tags.clear();
+    op->data.Reset();
+    op->parent_op = nullptr;
+    op->seqnum_bounds.clear();
+    return op;
+}
+
 void EngineBase::MessageHandler(const SharedLogMessage& message,
                                 std::span<const char> payload) {
     switch (SharedLogMessageHelper::GetOpType(message)) {
     case SharedLogOpType::READ_NEXT:
     case SharedLogOpType::READ_PREV:
     case SharedLogOpType::READ_NEXT_B:
-        HandleRemoteRead(message);
+    case SharedLogOpType::READ_NEXT_MT:
+    case SharedLogOpType::READ_PREV_MT:
+    case SharedLogOpType::COUNT:
+    case SharedLogOpType::READ_CHECKPOINT:
+        HandleRemoteRead(message, payload);
+        break;
+    case SharedLogOpType::QUEUE_POP:
+    case SharedLogOpType::QUEUE_POP_B:
+        HandleRemoteQueuePop(message, payload);
         break;
     case SharedLogOpType::INDEX_DATA:
         OnRecvNewIndexData(message, payload);
@@ -141,6 +298,9 @@ void EngineBase::MessageHandler(const SharedLogMessage& message,
     case SharedLogOpType::RESPONSE:
         OnRecvResponse(message, payload);
         break;
+    case SharedLogOpType::TAG_FILTER:
+        OnRecvTagFilter(message, payload);
+        break;
     default:
         UNREACHABLE();
     }
@@ -158,6 +318,38 @@ void EngineBase::PopulateLogTagsAndData(const Message& message, LocalOp* op) {
     op->data.AppendData(data.subspan(num_tags * sizeof(uint64_t)));
 }
 
+bool EngineBase::PopulateQueryTags(const Message& message, LocalOp* op) {
+    DCHECK(  op->type == SharedLogOpType::READ_NEXT_MT
+          || op->type == SharedLogOpType::READ_PREV_MT);
+    std::span<const char> data = MessageHelper::GetInlineData(message);
+    size_t num_tags = message.log_num_tags;
+    if (num_tags == 0 || data.size() != num_tags * sizeof(uint64_t)) {
+        return false;
+    }
+    op->user_tags.resize(num_tags);
+    memcpy(op->user_tags.data(), data.data(), num_tags * sizeof(uint64_t));
+    if (absl::c_linear_search(op->user_tags, kEmptyLogTag)) {
+        return false;
+    }
+    op->match_all_tags = (message.flags & protocol::kLogReadMatchAllTagsFlag) != 0;
+    return true;
+}
+
+bool EngineBase::PopulateSnapshotReads(const Message& message, LocalOp* op) {
+    DCHECK(op->type == SharedLogOpType::READ_SNAPSHOT);
+    std::span<const char> data = MessageHelper::GetInlineData(message);
+    size_t num_reads = message.log_num_tags;
+    if (data.size() != 2 * num_reads * sizeof(uint64_t)) {
+        return false;
+    }
+    op->user_tags.resize(num_reads);
+    memcpy(op->user_tags.data(), data.data(), num_reads * sizeof(uint64_t));
+    op->seqnum_bounds.resize(num_reads);
+    memcpy(op->seqnum_bounds.data(), data.data() + num_reads * sizeof(uint64_t),
+           num_reads * sizeof(uint64_t));
+    return true;
+}
+
 void EngineBase::OnMessageFromFuncWorker(const Message& message) {
     protocol::FuncCall func_call = MessageHelper::GetFuncCall(message);
     FnCallContext ctx;
@@ -181,9 +373,16 @@ void EngineBase::OnMessageFromFuncWorker(const Message& message) {
     op->metalog_progress = ctx.metalog_progress;
     op->type = MessageHelper::GetSharedLogOpType(message);
     op->seqnum = kInvalidLogSeqNum;
+    op->end_seqnum = kInvalidLogSeqNum;
     op->query_tag = kInvalidLogTag;
+    op->match_all_tags = false;
+    op->count_exists = false;
+    op->tag_filter_passed = false;
+    op->origin_node_id = node_id_;
     op->user_tags.clear();
     op->data.Reset();
+    op->parent_op = nullptr;
+    op->seqnum_bounds.clear();
 
     switch (op->type) {
     case SharedLogOpType::APPEND:
@@ -195,6 +394,22 @@ void EngineBase::OnMessageFromFuncWorker(const Message& message) {
         op->query_tag = message.log_tag;
         op->seqnum = message.log_seqnum;
         break;
+    case SharedLogOpType::READ_NEXT_MT:
+    case SharedLogOpType::READ_PREV_MT:
+        op->seqnum = message.log_seqnum;
+        if (!PopulateQueryTags(message, op)) {
+            HLOG_F(ERROR, "Invalid query tags in multi-tag read: num_tags={}",
+                   message.log_num_tags);
+            FinishLocalOpWithFailure(op, SharedLogResultType::BAD_ARGS);
+            return;
+        }
+        break;
+    case SharedLogOpType::COUNT:
+        op->query_tag = message.log_tag;
+        op->seqnum = message.log_seqnum;
+        op->end_seqnum = message.log_end_seqnum;
+        op->count_exists = (message.flags & protocol::kLogCountExistsFlag) != 0;
+        break;
     case SharedLogOpType::TRIM:
         op->seqnum = message.log_seqnum;
         break;
@@ -202,6 +417,28 @@ void EngineBase::OnMessageFromFuncWorker(const Message& message) {
         op->seqnum = message.log_seqnum;
         op->data.AppendData(MessageHelper::GetInlineData(message));
         break;
+    case SharedLogOpType::READ_SNAPSHOT:
+        op->seqnum = message.log_seqnum;
+        if (!PopulateSnapshotReads(message, op)) {
+            HLOG_F(ERROR, "Invalid reads in snapshot read: num_tags={}",
+                   message.log_num_tags);
+            FinishLocalOpWithFailure(op, SharedLogResultType::BAD_ARGS);
+            return;
+        }
+        break;
+    case SharedLogOpType::SET_CHECKPOINT:
+        op->query_tag = message.log_tag;
+        op->seqnum = message.log_seqnum;
+        op->data.AppendData(MessageHelper::GetInlineData(message));
+        break;
+    case SharedLogOpType::READ_CHECKPOINT:
+        op->query_tag = message.log_tag;
+        op->seqnum = message.log_seqnum;
+        break;
+    case SharedLogOpType::QUEUE_POP:
+    case SharedLogOpType::QUEUE_POP_B:
+        op->query_tag = message.log_tag;
+        break;
     default:
         HLOG(FATAL) << "Unknown shared log op type: " << message.log_op;
     }
@@ -218,6 +455,13 @@ void EngineBase::OnRecvSharedLogMessage(int conn_type, uint16_t src_node_id,
      || (conn_type == kEngineIngressTypeId && op_type == SharedLogOpType::READ_NEXT)
      || (conn_type == kEngineIngressTypeId && op_type == SharedLogOpType::READ_PREV)
      || (conn_type == kEngineIngressTypeId && op_type == SharedLogOpType::READ_NEXT_B)
+     || (conn_type == kEngineIngressTypeId && op_type == SharedLogOpType::READ_NEXT_MT)
+     || (conn_type == kEngineIngressTypeId && op_type == SharedLogOpType::READ_PREV_MT)
+     || (conn_type == kEngineIngressTypeId && op_type == SharedLogOpType::COUNT)
+     || (conn_type == kEngineIngressTypeId && op_type == SharedLogOpType::READ_CHECKPOINT)
+     || (conn_type == kEngineIngressTypeId && op_type == SharedLogOpType::QUEUE_POP)
+     || (conn_type == kEngineIngressTypeId && op_type == SharedLogOpType::QUEUE_POP_B)
+     || (conn_type == kEngineIngressTypeId && op_type == SharedLogOpType::TAG_FILTER)
      || (conn_type == kStorageIngressTypeId && op_type == SharedLogOpType::INDEX_DATA)
      || op_type == SharedLogOpType::RESPONSE
     ) << fmt::format("Invalid combination: conn_type={:#x}, op_type={:#x}",
@@ -225,6 +469,17 @@ void EngineBase::OnRecvSharedLogMessage(int conn_type, uint16_t src_node_id,
     MessageHandler(message, payload);
 }
 
+bool EngineBase::ReplicationCongested(const View* view) {
+    const View::Engine* engine_node = view->GetEngineNode(node_id_);
+    for (uint16_t storage_id : engine_node->GetStorageNodes()) {
+        if (engine_->IsEgressHubCongested(protocol::ConnType::ENGINE_TO_STORAGE,
+                                          storage_id)) {
+            return true;
+        }
+    }
+    return false;
+}
+
 void EngineBase::ReplicateLogEntry(const View* view, const LogMetaData& log_metadata,
                                    std::span<const uint64_t> user_tags,
                                    std::span<const char> log_data) {
@@ -257,8 +512,48 @@ void EngineBase::PropagateAuxData(const View* view, const LogMetaData& log_metad
     }
 }
 
+void EngineBase::ReplicateCheckpoint(const View* view, uint32_t logspace_id,
+                                     uint32_t user_logspace, uint64_t tag, uint64_t seqnum,
+                                     std::span<const char> data) {
+    SharedLogMessage message = SharedLogMessageHelper::NewSetCheckpointMessage(
+        logspace_id, user_logspace, tag, seqnum);
+    message.origin_node_id = node_id_;
+    message.payload_size = gsl::narrow_cast<uint32_t>(data.size());
+    const View::Engine* engine_node = view->GetEngineNode(node_id_);
+    for (uint16_t storage_id : engine_node->GetStorageNodes()) {
+        engine_->SendSharedLogMessage(protocol::ConnType::ENGINE_TO_STORAGE,
+                                      storage_id, message, data);
+    }
+}
+
+void EngineBase::ReplicateQueueCursors(const View* view, uint32_t logspace_id,
+                                       std::span<const uint64_t> cursors) {
+    SharedLogMessage message = SharedLogMessageHelper::NewQueueCursorsMessage(logspace_id);
+    message.origin_node_id = node_id_;
+    std::span<const char> data(reinterpret_cast<const char*>(cursors.data()),
+                               cursors.size() * sizeof(uint64_t));
+    message.payload_size = gsl::narrow_cast<uint32_t>(data.size());
+    const View::Engine* engine_node = view->GetEngineNode(node_id_);
+    for (uint16_t storage_id : engine_node->GetStorageNodes()) {
+        engine_->SendSharedLogMessage(protocol::ConnType::ENGINE_TO_STORAGE,
+                                      storage_id, message, data);
+    }
+}
+
 void EngineBase::FinishLocalOpWithResponse(LocalOp* op, Message* response,
                                            uint64_t metalog_progress) {
+    if (op->parent_op != nullptr) {
+        if (op->parent_op->type == SharedLogOpType::READ_SNAPSHOT) {
+            FinishSnapshotSubRead(op, *response);
+        } else {
+            FinishQueuePopRead(op, response, metalog_progress);
+        }
+        return;
+    }
+    if (op->origin_node_id != node_id_) {
+        SendQueuePopResponse(op, *response, metalog_progress);
+        return;
+    }
     if (metalog_progress > 0) {
         absl::MutexLock fn_ctx_lk(&fn_ctx_mu_);
         if (fn_call_ctx_.contains(op->func_call_id)) {
@@ -279,9 +574,79 @@ void EngineBase::FinishLocalOpWithFailure(LocalOp* op, SharedLogResultType resul
     FinishLocalOpWithResponse(op, &response, metalog_progress);
 }
 
+void EngineBase::FinishSnapshotSubRead(LocalOp* sub_op, const Message& response) {
+    LocalOp* op = sub_op->parent_op;
+    DCHECK(op->type == SharedLogOpType::READ_SNAPSHOT);
+    uint64_t& read_result = op->seqnum_bounds[sub_op->sub_read_index];
+    SharedLogResultType result = MessageHelper::GetSharedLogResultType(response);
+    if (result == SharedLogResultType::READ_OK) {
+        read_result = response.log_seqnum;
+    } else if (result == SharedLogResultType::EMPTY) {
+        read_result = kInvalidLogSeqNum;
+    } else {
+        op->sub_read_failure.store(static_cast<uint16_t>(result), std::memory_order_relaxed);
+    }
+    log_op_pool_.Return(sub_op);
+    if (op->num_pending_sub_reads.fetch_sub(1, std::memory_order_acq_rel) > 1) {
+        return;
+    }
+    uint16_t failure = op->sub_read_failure.load(std::memory_order_relaxed);
+    if (failure != 0) {
+        FinishLocalOpWithFailure(op, static_cast<SharedLogResultType>(failure));
+    } else {
+        FinishSnapshotRead(op);
+    }
+}
+
+void EngineBase::FinishQueuePopRead(LocalOp* sub_op, Message* response,
+                                    uint64_t metalog_progress) {
+    LocalOp* op = sub_op->parent_op;
+    DCHECK(op->type == SharedLogOpType::QUEUE_POP || op->type == SharedLogOpType::QUEUE_POP_B);
+    log_op_pool_.Return(sub_op);
+    OnQueuePopRead(op, response, metalog_progress);
+}
+
+void EngineBase::SendQueuePopResponse(LocalOp* op, const Message& response,
+                                      uint64_t metalog_progress) {
+    DCHECK(op->type == SharedLogOpType::QUEUE_POP || op->type == SharedLogOpType::QUEUE_POP_B);
+    SharedLogResultType result = MessageHelper::GetSharedLogResultType(response);
+    SharedLogMessage message = SharedLogMessageHelper::NewResponse(result);
+    message.origin_node_id = node_id_;
+    message.client_data = op->client_data;
+    message.user_metalog_progress = metalog_progress;
+    std::span<const char> payload;
+    if (result == SharedLogResultType::READ_OK) {
+        // Same layout as READ_OK responses of remote reads
+        message.logspace_id = bits::HighHalf64(response.log_seqnum);
+        message.user_logspace = op->user_logspace;
+        message.seqnum_lowhalf = bits::LowHalf64(response.log_seqnum);
+        message.num_tags = response.log_num_tags;
+        message.aux_data_size = response.log_aux_data_size;
+        payload = MessageHelper::GetInlineData(response);
+    }
+    message.payload_size = gsl::narrow_cast<uint32_t>(payload.size());
+    bool success = engine_->SendSharedLogMessage(
+        protocol::ConnType::SLOG_ENGINE_TO_ENGINE, op->origin_node_id, message, payload);
+    if (!success) {
+        HLOG_F(WARNING, "Failed to send queue pop response to engine {}", op->origin_node_id);
+    }
+    log_op_pool_.Return(op);
+}
+
+void EngineBase::FinishSnapshotRead(LocalOp* op) {
+    Message response = MessageHelper::NewSharedLogOpSucceeded(
+        SharedLogResultType::SNAPSHOT_OK, op->seqnum);
+    response.log_num_tags = gsl::narrow_cast<uint16_t>(op->seqnum_bounds.size());
+    MessageHelper::AppendInlineData(&response, VECTOR_AS_SPAN(op->seqnum_bounds));
+    FinishLocalOpWithResponse(op, &response, op->metalog_progress);
+}
+
 void EngineBase::LogCachePut(const LogMetaData& log_metadata,
                              std::span<const uint64_t> user_tags,
                              std::span<const char> log_data) {
+    if (tail_cache_.has_value()) {
+        tail_cache_->Put(log_metadata, user_tags, log_data);
+    }
     if (!log_cache_.has_value()) {
         return;
     }
@@ -303,19 +668,106 @@ std::optional<std::string> EngineBase::LogCacheGetAuxData(uint64_t seqnum) {
     return log_cache_.has_value() ? log_cache_->GetAuxData(seqnum) : std::nullopt;
 }
 
+std::optional<LogEntry> EngineBase::TailCacheGet(const IndexQuery& query, uint64_t seqnum) {
+    // Only single-tag READ_PREV queries count as tail reads
+    if (!tail_cache_.has_value()
+            || query.direction != IndexQuery::kReadPrev || query.multi_tag()) {
+        return std::nullopt;
+    }
+    return tail_cache_->Get(query.user_logspace, query.user_tag, seqnum);
+}
+
+std::optional<LogEntry> EngineBase::TailCacheGetTail(LocalOp* op, uint32_t logspace_id,
+                                                     uint64_t* index_progress) {
+    if (!tail_cache_.has_value() || op->type != SharedLogOpType::READ_PREV) {
+        return std::nullopt;
+    }
+    return tail_cache_->GetTail(logspace_id, op->user_logspace, op->query_tag, op->seqnum,
+                                op->metalog_progress, index_progress);
+}
+
+void EngineBase::TailCacheUpdate(const IndexDataProto& index_data) {
+    if (!tail_cache_.has_value()) {
+        return;
+    }
+    const uint64_t* user_tags = index_data.user_tags().data();
+    for (int i = 0; i < index_data.seqnum_halves_size(); i++) {
+        size_t num_tags = index_data.user_tag_sizes(i);
+        uint64_t seqnum = bits::JoinTwo32(index_data.logspace_id(),
+                                          index_data.seqnum_halves(i));
+        tail_cache_->UpdateTail(index_data.user_logspaces(i),
+                                std::span<const uint64_t>(user_tags, num_tags), seqnum);
+        user_tags += num_tags;
+    }
+}
+
+void EngineBase::TailCacheUpdateIndexProgress(uint32_t logspace_id, uint64_t metalog_progress) {
+    if (tail_cache_.has_value()) {
+        tail_cache_->UpdateIndexProgress(logspace_id, metalog_progress);
+    }
+}
+
+void EngineBase::TailCacheRecordReadDelay(LocalOp* op, bool cache_hit) {
+    if (tail_cache_.has_value() && op->type == SharedLogOpType::READ_PREV) {
+        tail_cache_->RecordReadDelay(cache_hit, gsl::narrow_cast<int32_t>(
+            GetMonotonicMicroTimestamp() - op->start_timestamp));
+    }
+}
+
+void EngineBase::RecentAppendPut(const LogMetaData& log_metadata,
+                                 std::span<const uint64_t> user_tags,
+                                 std::span<const char> log_data) {
+    if (recent_appends_.has_value()) {
+        recent_appends_->Put(log_metadata, user_tags, log_data);
+    }
+}
+
+std::optional<LogEntry> EngineBase::RecentAppendGet(const IndexQuery& query, uint64_t seqnum) {
+    if (!recent_appends_.has_value()) {
+        return std::nullopt;
+    }
+    // Every entry is also indexed under kEmptyLogTag
+    uint64_t tag = query.multi_tag() ? kEmptyLogTag : query.user_tag;
+    return recent_appends_->Get(query.user_logspace, tag, seqnum);
+}
+
 bool EngineBase::SendIndexReadRequest(const View::Sequencer* sequencer_node,
-                                      SharedLogMessage* request) {
+                                      SharedLogMessage* request,
+                                      std::span<const char> payload) {
     static constexpr int kMaxRetries = 3;
 
     request->sequencer_id = sequencer_node->node_id();
     request->view_id = sequencer_node->view()->id();
+    request->payload_size = gsl::narrow_cast<uint32_t>(payload.size());
+    // With partitioned index, the index engine node is decided by query tags
+    SharedLogOpType op_type = SharedLogMessageHelper::GetOpType(*request);
+    uint64_t query_tag = kEmptyLogTag;
+    std::span<const uint64_t> query_tags(&query_tag, 1);
+    if (op_type == SharedLogOpType::READ_NEXT_MT || op_type == SharedLogOpType::READ_PREV_MT) {
+        query_tags = std::span<const uint64_t>(
+            reinterpret_cast<const uint64_t*>(payload.data()), payload.size() / sizeof(uint64_t));
+    } else {
+        query_tag = request->query_tag;
+    }
+    const View::NodeIdVec& index_engine_nodes = sequencer_node->GetIndexEngineNodes();
+    bool owned_by_tag = sequencer_node->view()->index_partitioned()
+                     && !query_tags.empty() && query_tags[0] != kEmptyLogTag;
+    if (sequencer_node->IsIndexEngineNodeForTags(node_id_, query_tags)
+            && (owned_by_tag || index_engine_nodes.size() == 1)) {
+        // No other engine node indexes these tags, serve the request as a
+        // remote one from this node
+        HandleRemoteRead(*request, payload);
+        return true;
+    }
     for (int i = 0; i < kMaxRetries; i++) {
-        uint16_t engine_id = sequencer_node->PickIndexEngineNode();
+        uint16_t engine_id = sequencer_node->PickIndexEngineNodeForTags(query_tags);
         if (engine_id == node_id_) {
-            continue;
+            // Round-robin picks another index engine node next time
+            DCHECK(!owned_by_tag);
+            engine_id = sequencer_node->PickIndexEngineNodeForTags(query_tags);
         }
         bool success = engine_->SendSharedLogMessage(
-            protocol::ConnType::SLOG_ENGINE_TO_ENGINE, engine_id, *request);
+            protocol::ConnType::SLOG_ENGINE_TO_ENGINE, engine_id, *request, payload);
         if (success) {
             return true;
         }
@@ -346,6 +798,71 @@ bool EngineBase::SendStorageReadRequest(const IndexQueryResult& result,
     return false;
 }
 
+bool EngineBase::SendCheckpointReadRequest(const IndexQueryResult& result,
+                                           const View::Engine* engine_node) {
+    static constexpr int kMaxRetries = 3;
+    DCHECK(result.state == IndexQueryResult::kFound);
+
+    const IndexQuery& query = result.original_query;
+    SharedLogMessage request = SharedLogMessageHelper::NewReadCheckpointMessage(
+        engine_node->view()->LogSpaceIdentifier(query.user_logspace),
+        query.user_logspace, query.user_tag, result.found_result.seqnum);
+    request.user_metalog_progress = result.metalog_progress;
+    request.origin_node_id = query.origin_node_id;
+    request.hop_times = query.hop_times + 1;
+    request.client_data = query.client_data;
+    if (result.tail_complete) {
+        request.flags |= protocol::kCheckpointTailCompleteFlag;
+    }
+    // Storage node sends back the tail along with checkpoint data
+    std::span<const char> payload = VECTOR_AS_CHAR_SPAN(result.tail_seqnums);
+    request.payload_size = gsl::narrow_cast<uint32_t>(payload.size());
+    for (int i = 0; i < kMaxRetries; i++) {
+        uint16_t storage_id = engine_node->PickStorageNode();
+        bool success = engine_->SendSharedLogMessage(
+            protocol::ConnType::ENGINE_TO_STORAGE, storage_id, request, payload);
+        if (success) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool EngineBase::SendQueueCursorReadRequest(LocalOp* sub_op,
+                                            const View::Engine* engine_node) {
+    static constexpr int kMaxRetries = 3;
+    DCHECK(sub_op->type == SharedLogOpType::READ_CHECKPOINT);
+
+    const View* view = engine_node->view();
+    SharedLogMessage request = SharedLogMessageHelper::NewReadCheckpointMessage(
+        view->LogSpaceIdentifier(sub_op->user_logspace),
+        sub_op->user_logspace, sub_op->query_tag, kInvalidLogSeqNum);
+    request.flags |= protocol::kQueueCursorFlag;
+    request.view_id = view->id();
+    request.origin_node_id = node_id_;
+    request.hop_times = 1;
+    request.client_data = sub_op->id;
+    for (int i = 0; i < kMaxRetries; i++) {
+        uint16_t storage_id = engine_node->PickStorageNode();
+        bool success = engine_->SendSharedLogMessage(
+            protocol::ConnType::ENGINE_TO_STORAGE, storage_id, request);
+        if (success) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool EngineBase::SendQueuePopRequest(const View::Sequencer* sequencer_node,
+                                     SharedLogMessage* request) {
+    request->sequencer_id = sequencer_node->node_id();
+    request->view_id = sequencer_node->view()->id();
+    request->payload_size = 0;
+    uint16_t engine_id = sequencer_node->GetQueueEngineNodeForTag(request->query_tag);
+    return engine_->SendSharedLogMessage(
+        protocol::ConnType::SLOG_ENGINE_TO_ENGINE, engine_id, *request);
+}
+
 void EngineBase::SendReadResponse(const IndexQuery& query,
                                   protocol::SharedLogMessage* response,
                                   std::span<const char> user_tags_payload,
@@ -373,6 +890,22 @@ void EngineBase::SendReadFailureResponse(const IndexQuery& query,
     SendReadResponse(query, &response);
 }
 
+void EngineBase::SendTagFilterMessage(const View* view, SharedLogMessage* message,
+                                      std::span<const char> payload) {
+    message->origin_node_id = node_id_;
+    message->payload_size = gsl::narrow_cast<uint32_t>(payload.size());
+    for (uint16_t engine_id : view->GetEngineNodes()) {
+        if (engine_id == node_id_) {
+            continue;
+        }
+        bool success = engine_->SendSharedLogMessage(
+            protocol::ConnType::SLOG_ENGINE_TO_ENGINE, engine_id, *message, payload);
+        if (!success) {
+            HLOG_F(WARNING, "Failed to send tag filter to engine {}", engine_id);
+        }
+    }
+}
+
 bool EngineBase::SendSequencerMessage(uint16_t sequencer_id,
                                       SharedLogMessage* message,
                                       std::span<const char> payload) {
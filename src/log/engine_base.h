@@ -43,13 +43,22 @@ protected:
     virtual void OnViewFrozen(const View* view) = 0;
     virtual void OnViewFinalized(const FinalizedView* finalized_view) = 0;
 
-    virtual void HandleRemoteRead(const protocol::SharedLogMessage& request) = 0;
+    virtual void HandleRemoteRead(const protocol::SharedLogMessage& request,
+                                  std::span<const char> payload) = 0;
+    virtual void HandleRemoteQueuePop(const protocol::SharedLogMessage& request,
+                                      std::span<const char> payload) = 0;
     virtual void OnRecvNewMetaLogs(const protocol::SharedLogMessage& message,
                                    std::span<const char> payload) = 0;
     virtual void OnRecvNewIndexData(const protocol::SharedLogMessage& message,
                                     std::span<const char> payload) = 0;
     virtual void OnRecvResponse(const protocol::SharedLogMessage& message,
                                 std::span<const char> payload) = 0;
+    virtual void OnRecvTagFilter(const protocol::SharedLogMessage& message,
+                                 std::span<const char> payload) = 0;
+
+    // Called periodically if tag filter is enabled
+    virtual void BroadcastTagFilters() = 0;
+    virtual void PersistQueueCursors() = 0;
 
     void MessageHandler(const protocol::SharedLogMessage& message,
                         std::span<const char> payload);
@@ -62,25 +71,76 @@ protected:
         uint64_t client_data;
         uint64_t metalog_progress;
         uint64_t query_tag;
+        bool match_all_tags;  // For multi-tag reads, whose query tags are in `user_tags`
         uint64_t seqnum;
+        uint64_t end_seqnum;  // For COUNT
+        bool count_exists;    // For COUNT, only check if any log entry matches
         uint64_t func_call_id;
         int64_t start_timestamp;
+        bool tag_filter_passed;  // Tag filter shows query tags may exist
+        // Differs from this node for QUEUE_POP forwarded from other engines,
+        // whose `client_data` is the op id at the origin engine
+        uint16_t origin_node_id;
         UserTagVec user_tags;
         utils::AppendableBuffer data;
+        // For READ_PREV reads issued by READ_SNAPSHOT, and READ_NEXT(_B)
+        // reads issued by QUEUE_POP(_B)
+        LocalOp* parent_op;
+        size_t sub_read_index;
+        // For READ_SNAPSHOT, whose query tags are in `user_tags`
+        std::atomic<size_t> num_pending_sub_reads;
+        std::atomic<uint16_t> sub_read_failure;
+        std::vector<uint64_t> seqnum_bounds;  // Replaced by read results
+
+        // Sub-reads of READ_SNAPSHOT only resolve seqnums of log entries
+        bool seqnum_only() const {
+            return parent_op != nullptr
+                && parent_op->type == protocol::SharedLogOpType::READ_SNAPSHOT;
+        }
     };
 
     virtual void HandleLocalAppend(LocalOp* op) = 0;
     virtual void HandleLocalTrim(LocalOp* op) = 0;
     virtual void HandleLocalRead(LocalOp* op) = 0;
     virtual void HandleLocalSetAuxData(LocalOp* op) = 0;
+    virtual void HandleLocalSnapshotRead(LocalOp* op) = 0;
+    virtual void HandleLocalSetCheckpoint(LocalOp* op) = 0;
+    virtual void HandleLocalQueuePop(LocalOp* op) = 0;
+    // Called with the response of the read issued by IssueQueuePopRead, or
+    // the cursor read issued by NewQueueCursorReadOp
+    virtual void OnQueuePopRead(LocalOp* op, protocol::Message* response,
+                                uint64_t metalog_progress) = 0;
 
     void LocalOpHandler(LocalOp* op);
 
+    // Resolve reads of READ_SNAPSHOT `op` with READ_PREV sub-reads, against
+    // the snapshot pinned in `op->seqnum` and `op->metalog_progress`
+    void IssueSnapshotSubReads(LocalOp* op);
+    // Read the first log entry of the queue of QUEUE_POP(_B) `op` from `seqnum`
+    void IssueQueuePopRead(LocalOp* op, uint64_t seqnum);
+    // Sub-op reading the cursor of the queue of QUEUE_POP(_B) `op` from
+    // storage nodes, see SendQueueCursorReadRequest
+    LocalOp* NewQueueCursorReadOp(LocalOp* op);
+    // QUEUE_POP(_B) forwarded by the origin engine, finished with response
+    // sent back to it
+    LocalOp* NewRemoteQueuePopOp(const protocol::SharedLogMessage& request);
+    LocalOp* NewQueueSubOp(LocalOp* op);
+
+    // True if the egress queue to any storage node of this engine is over
+    // its limit, in which case new appends should be throttled
+    bool ReplicationCongested(const View* view);
     void ReplicateLogEntry(const View* view, const LogMetaData& log_metadata,
                            std::span<const uint64_t> user_tags,
                            std::span<const char> log_data);
     void PropagateAuxData(const View* view, const LogMetaData& log_metadata, 
                           std::span<const char> aux_data);
+    // Send checkpoint to all storage nodes of this engine
+    void ReplicateCheckpoint(const View* view, uint32_t logspace_id, uint32_t user_logspace,
+                             uint64_t tag, uint64_t seqnum, std::span<const char> data);
+    // Send queue cursors of `logspace_id` to all storage nodes of this engine,
+    // as (user_logspace, tag, seqnum) triples
+    void ReplicateQueueCursors(const View* view, uint32_t logspace_id,
+                               std::span<const uint64_t> cursors);
 
     void FinishLocalOpWithResponse(LocalOp* op, protocol::Message* response,
                                    uint64_t metalog_progress);
@@ -93,10 +153,34 @@ protected:
     void LogCachePutAuxData(uint64_t seqnum, std::span<const char> data);
     std::optional<std::string> LogCacheGetAuxData(uint64_t seqnum);
 
+    // Log entries put into log cache also feed tail cache, while tail seqnums
+    // come from index data
+    std::optional<LogEntry> TailCacheGet(const IndexQuery& query, uint64_t seqnum);
+    // Serve tail reads without querying the index, see TailCache::GetTail
+    std::optional<LogEntry> TailCacheGetTail(LocalOp* op, uint32_t logspace_id,
+                                             uint64_t* index_progress);
+    // Must be called before index data is provided to the index
+    void TailCacheUpdate(const IndexDataProto& index_data);
+    void TailCacheUpdateIndexProgress(uint32_t logspace_id, uint64_t metalog_progress);
+    void TailCacheRecordReadDelay(LocalOp* op, bool cache_hit);
+
+    void RecentAppendPut(const LogMetaData& log_metadata, std::span<const uint64_t> user_tags,
+                         std::span<const char> log_data);
+    std::optional<LogEntry> RecentAppendGet(const IndexQuery& query, uint64_t seqnum);
+
     bool SendIndexReadRequest(const View::Sequencer* sequencer_node,
-                              protocol::SharedLogMessage* request);
+                              protocol::SharedLogMessage* request,
+                              std::span<const char> payload = EMPTY_CHAR_SPAN);
     bool SendStorageReadRequest(const IndexQueryResult& result,
                                 const View::Engine* engine_node);
+    bool SendCheckpointReadRequest(const IndexQueryResult& result,
+                                   const View::Engine* engine_node);
+    // Read the cursor persisted by `engine_node`, which served the queue of
+    // `sub_op` in its view
+    bool SendQueueCursorReadRequest(LocalOp* sub_op, const View::Engine* engine_node);
+    // Send to the engine node serving pops of the queue tag
+    bool SendQueuePopRequest(const View::Sequencer* sequencer_node,
+                             protocol::SharedLogMessage* request);
     void SendReadResponse(const IndexQuery& query,
                           protocol::SharedLogMessage* response,
                           std::span<const char> user_tags_payload = EMPTY_CHAR_SPAN,
@@ -105,6 +189,9 @@ protected:
     void SendReadFailureResponse(const IndexQuery& query,
                                  protocol::SharedLogResultType result_type,
                                  uint64_t metalog_progress = 0);
+    // Send to all other engine nodes of `view`
+    void SendTagFilterMessage(const View* view, protocol::SharedLogMessage* message,
+                              std::span<const char> payload);
     bool SendSequencerMessage(uint16_t sequencer_id,
                               protocol::SharedLogMessage* message,
                               std::span<const char> payload = EMPTY_CHAR_SPAN);
@@ -131,11 +218,22 @@ private:
         fn_call_ctx_ ABSL_GUARDED_BY(fn_ctx_mu_);
 
     std::optional<LRUCache> log_cache_;
+    std::optional<TailCache> tail_cache_;
+    std::optional<RecentAppendBuffer> recent_appends_;
 
     void SetupZKWatchers();
     void SetupTimers();
 
     void PopulateLogTagsAndData(const protocol::Message& message, LocalOp* op);
+    bool PopulateQueryTags(const protocol::Message& message, LocalOp* op);
+    bool PopulateSnapshotReads(const protocol::Message& message, LocalOp* op);
+
+    void FinishSnapshotSubRead(LocalOp* sub_op, const protocol::Message& response);
+    void FinishSnapshotRead(LocalOp* op);
+    void FinishQueuePopRead(LocalOp* sub_op, protocol::Message* response,
+                            uint64_t metalog_progress);
+    void SendQueuePopResponse(LocalOp* op, const protocol::Message& response,
+                              uint64_t metalog_progress);
 
     DISALLOW_COPY_AND_ASSIGN(EngineBase);
 };
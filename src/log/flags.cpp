@@ -4,18 +4,107 @@ ABSL_FLAG(int, slog_local_cut_interval_us, 1000, "");
 ABSL_FLAG(int, slog_global_cut_interval_us, 1000, "");
 ABSL_FLAG(size_t, slog_log_space_hash_tokens, 128, "");
 ABSL_FLAG(size_t, slog_num_tail_metalog_entries, 32, "");
+ABSL_FLAG(bool, slog_index_partitioned, false,
+          "Used by controller. If set, index engines of each physical log "
+          "partition tags, instead of all holding the complete index");
 
 ABSL_FLAG(bool, slog_enable_statecheck, false, "");
 ABSL_FLAG(int, slog_statecheck_interval_sec, 10, "");
+ABSL_FLAG(std::string, slog_cache_policy, "lru",
+          "Policy of log cache of engines and storage nodes: \"lru\", or "
+          "\"tinylfu\" for segmented LRU with W-TinyLFU admission, which resists scans");
 
 ABSL_FLAG(bool, slog_engine_force_remote_index, false, "");
 ABSL_FLAG(float, slog_engine_prob_remote_index, 0.0f, "");
 ABSL_FLAG(bool, slog_engine_enable_cache, false, "");
 ABSL_FLAG(int, slog_engine_cache_cap_mb, 1024, "");
+ABSL_FLAG(std::string, slog_engine_file_cache_dir, "",
+          "If set, log cache has a second tier of file in this directory, "
+          "holding log entries evicted from memory");
+ABSL_FLAG(int, slog_engine_file_cache_cap_mb, 8192, "");
 ABSL_FLAG(bool, slog_engine_propagate_auxdata, false, "");
+ABSL_FLAG(bool, slog_engine_enable_tail_cache, false,
+          "If enabled, index engines cache the newest log entry of each tag, "
+          "and serve tail reads from the cache");
+ABSL_FLAG(size_t, slog_engine_tail_cache_max_tags, 65536,
+          "Maximum number of tags with cached tail entries");
+ABSL_FLAG(int, slog_engine_recent_append_ttl_ms, 0,
+          "How long recently appended log entries are kept for reading "
+          "without storage. Zero (the default) disables the buffer");
+ABSL_FLAG(size_t, slog_engine_recent_append_max_entries, 4096,
+          "Maximum number of recently appended log entries kept");
+ABSL_FLAG(bool, slog_engine_enable_tag_filter, false,
+          "If enabled, index engines build filters of existing tags, and send "
+          "them to all engines, which answer reads of absent tags immediately");
+ABSL_FLAG(size_t, slog_engine_tag_filter_bits, size_t{1} << 20,
+          "Number of bits of the tag filter of each physical log space");
+ABSL_FLAG(int, slog_engine_tag_filter_sync_interval_ms, 100,
+          "Interval for index engines to send changed words of tag filters");
+ABSL_FLAG(int, slog_engine_tag_filter_full_sync_interval_ms, 5000,
+          "Interval for index engines to send whole tag filters, for engines "
+          "that missed changes");
+ABSL_FLAG(int, slog_engine_queue_cursor_persist_interval_ms, 100,
+          "Interval for engines to persist cursors of queues they serve");
 
 ABSL_FLAG(int, slog_storage_cache_cap_mb, 1024, "");
 ABSL_FLAG(std::string, slog_storage_backend, "rocksdb",
           "rocskdb, tkrzw_hash, tkrzw_tree, or tkrzw_skip");
-ABSL_FLAG(int, slog_storage_bgthread_interval_ms, 1, "");
+ABSL_FLAG(int, slog_storage_flush_workers, 1,
+          "Number of threads flushing log entries to DB, among which log spaces "
+          "are assigned by hash");
 ABSL_FLAG(size_t, slog_storage_max_live_entries, 65536, "");
+ABSL_FLAG(size_t, slog_storage_memory_only_max_entries, 0,
+          "Max number of log entries kept by a memory-only physical log, beyond "
+          "which new log entries are refused. Zero means no limit");
+ABSL_FLAG(size_t, slog_storage_hot_keys, 65536,
+          "Number of recently read log entries recorded as hot keys, which are "
+          "preloaded into log cache after restart. Zero disables cache warmup");
+ABSL_FLAG(int, slog_storage_hot_keys_dump_interval_s, 60,
+          "Interval of dumping hot keys into DB directory, besides on shutdown");
+ABSL_FLAG(int, slog_storage_warmup_rate, 20000,
+          "Max number of log entries preloaded per second when warming up "
+          "log cache. Zero means no limit");
+ABSL_FLAG(bool, slog_storage_coalesce_db_reads, true,
+          "If enabled, reads from DB within one event loop iteration are "
+          "issued as one batched lookup for each log space");
+ABSL_FLAG(bool, slog_storage_cache_fill_on_read, false,
+          "If enabled, log entries read from DB are also put into log cache, "
+          "which copies their data once more");
+ABSL_FLAG(std::string, slog_storage_durability, "async",
+          "Durability of log entries: memory, async, or fsync");
+ABSL_FLAG(std::string, slog_storage_phylog_durability, "",
+          "Durability of individual physical logs, overriding slog_storage_durability, "
+          "e.g. \"1:fsync,2:memory\", where physical logs are named by sequencer node IDs");
+ABSL_FLAG(int, slog_storage_group_commit_delay_us, 1000,
+          "Max delay of log entries before group commit in fsync mode");
+ABSL_FLAG(size_t, slog_storage_group_commit_max_entries, 256,
+          "Max number of log entries in one group commit");
+ABSL_FLAG(std::string, slog_storage_archive_dir, "",
+          "Directory of archive files, into which cold log entries are moved "
+          "from DB. Empty disables tiering");
+ABSL_FLAG(size_t, slog_storage_tiering_keep_entries, 1048576,
+          "Number of most recently persisted seqnums of each log space kept in DB, "
+          "older log entries are moved into archive files");
+ABSL_FLAG(size_t, slog_storage_tiering_segment_entries, 65536,
+          "Number of seqnums covered by each archive file");
+ABSL_FLAG(int, slog_storage_tiering_interval_s, 60,
+          "Interval of checking for cold log entries to tier");
+ABSL_FLAG(bool, slog_storage_bulk_sync, false,
+          "If enabled, storage copies log entries it should hold from other storage "
+          "nodes on startup. Reads missing copied log entries are held until the "
+          "copy is verified complete. Used when replacing a failed storage node");
+ABSL_FLAG(int, slog_storage_bulk_sync_rate_mb, 100,
+          "Max bandwidth of bulk sync in MB/s. Zero means no limit");
+ABSL_FLAG(size_t, slog_storage_bulk_sync_chunk_entries, 256,
+          "Number of seqnums covered by each bulk sync request");
+ABSL_FLAG(size_t, slog_storage_bulk_sync_parallelism, 8,
+          "Max number of outstanding bulk sync requests, which are spread among "
+          "log spaces and source storage nodes");
+ABSL_FLAG(size_t, slog_storage_bulk_sync_max_retries, 10,
+          "Number of times copying log entries from an engine is retried after "
+          "all source storage nodes fail, before bulk sync gives up");
+ABSL_FLAG(int, slog_storage_bulk_sync_retry_interval_ms, 1000,
+          "Interval before retrying source storage nodes which all failed");
+ABSL_FLAG(int, slog_storage_bulk_sync_request_timeout_ms, 5000,
+          "Bulk sync requests without responses for this long fail, and are "
+          "retried like failed ones");
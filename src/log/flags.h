@@ -6,17 +6,51 @@ ABSL_DECLARE_FLAG(int, slog_local_cut_interval_us);
 ABSL_DECLARE_FLAG(int, slog_global_cut_interval_us);
 ABSL_DECLARE_FLAG(size_t, slog_log_space_hash_tokens);
 ABSL_DECLARE_FLAG(size_t, slog_num_tail_metalog_entries);
+ABSL_DECLARE_FLAG(bool, slog_index_partitioned);
 
 ABSL_DECLARE_FLAG(bool, slog_enable_statecheck);
 ABSL_DECLARE_FLAG(int, slog_statecheck_interval_sec);
+ABSL_DECLARE_FLAG(std::string, slog_cache_policy);
 
 ABSL_DECLARE_FLAG(bool, slog_engine_force_remote_index);
 ABSL_DECLARE_FLAG(float, slog_engine_prob_remote_index);
 ABSL_DECLARE_FLAG(bool, slog_engine_enable_cache);
 ABSL_DECLARE_FLAG(int, slog_engine_cache_cap_mb);
+ABSL_DECLARE_FLAG(std::string, slog_engine_file_cache_dir);
+ABSL_DECLARE_FLAG(int, slog_engine_file_cache_cap_mb);
 ABSL_DECLARE_FLAG(bool, slog_engine_propagate_auxdata);
+ABSL_DECLARE_FLAG(bool, slog_engine_enable_tail_cache);
+ABSL_DECLARE_FLAG(size_t, slog_engine_tail_cache_max_tags);
+ABSL_DECLARE_FLAG(int, slog_engine_recent_append_ttl_ms);
+ABSL_DECLARE_FLAG(size_t, slog_engine_recent_append_max_entries);
+ABSL_DECLARE_FLAG(bool, slog_engine_enable_tag_filter);
+ABSL_DECLARE_FLAG(size_t, slog_engine_tag_filter_bits);
+ABSL_DECLARE_FLAG(int, slog_engine_tag_filter_sync_interval_ms);
+ABSL_DECLARE_FLAG(int, slog_engine_tag_filter_full_sync_interval_ms);
+ABSL_DECLARE_FLAG(int, slog_engine_queue_cursor_persist_interval_ms);
 
 ABSL_DECLARE_FLAG(int, slog_storage_cache_cap_mb);
 ABSL_DECLARE_FLAG(std::string, slog_storage_backend);
-ABSL_DECLARE_FLAG(int, slog_storage_bgthread_interval_ms);
+ABSL_DECLARE_FLAG(int, slog_storage_flush_workers);
 ABSL_DECLARE_FLAG(size_t, slog_storage_max_live_entries);
+ABSL_DECLARE_FLAG(size_t, slog_storage_memory_only_max_entries);
+ABSL_DECLARE_FLAG(size_t, slog_storage_hot_keys);
+ABSL_DECLARE_FLAG(int, slog_storage_hot_keys_dump_interval_s);
+ABSL_DECLARE_FLAG(int, slog_storage_warmup_rate);
+ABSL_DECLARE_FLAG(bool, slog_storage_coalesce_db_reads);
+ABSL_DECLARE_FLAG(bool, slog_storage_cache_fill_on_read);
+ABSL_DECLARE_FLAG(std::string, slog_storage_durability);
+ABSL_DECLARE_FLAG(std::string, slog_storage_phylog_durability);
+ABSL_DECLARE_FLAG(int, slog_storage_group_commit_delay_us);
+ABSL_DECLARE_FLAG(size_t, slog_storage_group_commit_max_entries);
+ABSL_DECLARE_FLAG(std::string, slog_storage_archive_dir);
+ABSL_DECLARE_FLAG(size_t, slog_storage_tiering_keep_entries);
+ABSL_DECLARE_FLAG(size_t, slog_storage_tiering_segment_entries);
+ABSL_DECLARE_FLAG(int, slog_storage_tiering_interval_s);
+ABSL_DECLARE_FLAG(bool, slog_storage_bulk_sync);
+ABSL_DECLARE_FLAG(int, slog_storage_bulk_sync_rate_mb);
+ABSL_DECLARE_FLAG(size_t, slog_storage_bulk_sync_chunk_entries);
+ABSL_DECLARE_FLAG(size_t, slog_storage_bulk_sync_parallelism);
+ABSL_DECLARE_FLAG(size_t, slog_storage_bulk_sync_max_retries);
+ABSL_DECLARE_FLAG(int, slog_storage_bulk_sync_retry_interval_ms);
+ABSL_DECLARE_FLAG(int, slog_storage_bulk_sync_request_timeout_ms);
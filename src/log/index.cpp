@@ -1,5 +1,6 @@
 #include "log/index.h"
 
+#include "log/flags.h"
 #include "log/utils.h"
 
 namespace faas {
@@ -8,11 +9,17 @@ namespace log {
 IndexQuery::ReadDirection IndexQuery::DirectionFromOpType(protocol::SharedLogOpType op_type) {
     switch (op_type) {
     case protocol::SharedLogOpType::READ_NEXT:
+    case protocol::SharedLogOpType::READ_NEXT_MT:
         return IndexQuery::kReadNext;
     case protocol::SharedLogOpType::READ_PREV:
+    case protocol::SharedLogOpType::READ_PREV_MT:
         return IndexQuery::kReadPrev;
     case protocol::SharedLogOpType::READ_NEXT_B:
         return IndexQuery::kReadNextB;
+    case protocol::SharedLogOpType::COUNT:
+        return IndexQuery::kCount;
+    case protocol::SharedLogOpType::READ_CHECKPOINT:
+        return IndexQuery::kReadCheckpoint;
     default:
         UNREACHABLE();
     }
@@ -21,11 +28,17 @@ IndexQuery::ReadDirection IndexQuery::DirectionFromOpType(protocol::SharedLogOpT
 protocol::SharedLogOpType IndexQuery::DirectionToOpType() const {
     switch (direction) {
     case IndexQuery::kReadNext:
-        return protocol::SharedLogOpType::READ_NEXT;
+        return multi_tag() ? protocol::SharedLogOpType::READ_NEXT_MT
+                           : protocol::SharedLogOpType::READ_NEXT;
     case IndexQuery::kReadPrev:
-        return protocol::SharedLogOpType::READ_PREV;
+        return multi_tag() ? protocol::SharedLogOpType::READ_PREV_MT
+                           : protocol::SharedLogOpType::READ_PREV;
     case IndexQuery::kReadNextB:
         return protocol::SharedLogOpType::READ_NEXT_B;
+    case IndexQuery::kCount:
+        return protocol::SharedLogOpType::COUNT;
+    case IndexQuery::kReadCheckpoint:
+        return protocol::SharedLogOpType::READ_CHECKPOINT;
     default:
         UNREACHABLE();
     }
@@ -35,9 +48,16 @@ Index::Index(const View* view, uint16_t sequencer_id)
     : LogSpaceBase(LogSpaceBase::kFullMode, view, sequencer_id),
       indexed_metalog_position_(0),
       data_received_seqnum_position_(0),
-      indexed_seqnum_position_(0) {
+      indexed_seqnum_position_(0),
+      tag_filter_sent_position_(0),
+      tag_filter_sent_finalized_(false),
+      tag_filter_sent_full_(false),
+      tag_filter_delta_after_full_(false) {
     log_header_ = fmt::format("LogIndex[{}-{}]: ", view->id(), sequencer_id);
     state_ = kNormal;
+    if (absl::GetFlag(FLAGS_slog_engine_enable_tag_filter)) {
+        tag_filter_.emplace(absl::GetFlag(FLAGS_slog_engine_tag_filter_bits));
+    }
 }
 
 Index::~Index() {}
@@ -54,6 +74,26 @@ public:
     bool FindNext(uint64_t query_seqnum, uint64_t user_tag,
                   uint64_t* seqnum, uint16_t* engine_id) const;
 
+    // Multi-tag versions, matching log entries with all or any of `user_tags`
+    bool FindPrev(uint64_t query_seqnum, std::span<const uint64_t> user_tags,
+                  bool match_all, uint64_t* seqnum, uint16_t* engine_id) const;
+    bool FindNext(uint64_t query_seqnum, std::span<const uint64_t> user_tags,
+                  bool match_all, uint64_t* seqnum, uint16_t* engine_id) const;
+
+    // Number of log entries with `user_tag` within [start_seqnum, end_seqnum]
+    uint32_t Count(uint64_t start_seqnum, uint64_t end_seqnum, uint64_t user_tag) const;
+    // Seqnums of the first `max_size` log entries with `user_tag` within
+    // (start_seqnum, end_seqnum]. Returns false if there are more.
+    bool FindRange(uint64_t start_seqnum, uint64_t end_seqnum, uint64_t user_tag,
+                   size_t max_size, std::vector<uint64_t>* seqnums) const;
+
+    void AddCheckpoint(uint64_t user_tag, uint64_t seqnum, uint16_t engine_id);
+    bool FindCheckpoint(uint64_t query_seqnum, uint64_t user_tag,
+                        uint64_t* seqnum, uint16_t* engine_id) const;
+
+    void UpdateQueueCursor(uint64_t user_tag, uint64_t seqnum);
+    bool FindQueueCursor(uint64_t user_tag, uint64_t* seqnum) const;
+
 private:
     uint32_t logspace_id_;
     uint32_t user_logspace_;
@@ -62,11 +102,27 @@ private:
     std::vector<uint32_t> seqnums_;
     absl::flat_hash_map</* tag */ uint64_t, std::vector<uint32_t>> seqnums_by_tag_;
 
+    // Checkpoints registered in this view, whose seqnums can be of older views
+    absl::flat_hash_map</* tag */ uint64_t,
+                        std::map</* seqnum */ uint64_t, /* engine_id */ uint16_t>>
+        checkpoints_;
+    // Latest consumer cursors of queues registered in this view
+    absl::flat_hash_map</* tag */ uint64_t, /* seqnum */ uint64_t> queue_cursors_;
+
     bool FindPrev(const std::vector<uint32_t>& seqnums, uint64_t query_seqnum,
                   uint32_t* result_seqnum) const;
     bool FindNext(const std::vector<uint32_t>& seqnums, uint64_t query_seqnum,
                   uint32_t* result_seqnum) const;
 
+    using TagSeqnumsVec = absl::InlinedVector<const std::vector<uint32_t>*, 4>;
+    // Return false if no log entry can match
+    bool GetTagSeqnums(std::span<const uint64_t> user_tags, bool match_all,
+                       TagSeqnumsVec* tag_seqnums) const;
+    bool IntersectPrev(const TagSeqnumsVec& tag_seqnums, uint64_t query_seqnum,
+                       uint32_t* result_seqnum) const;
+    bool IntersectNext(const TagSeqnumsVec& tag_seqnums, uint64_t query_seqnum,
+                       uint32_t* result_seqnum) const;
+
     DISALLOW_COPY_AND_ASSIGN(PerSpaceIndex);
 };
 
@@ -172,8 +228,308 @@ bool Index::PerSpaceIndex::FindNext(const std::vector<uint32_t>& seqnums,
     }
 }
 
+bool Index::PerSpaceIndex::FindPrev(uint64_t query_seqnum,
+                                    std::span<const uint64_t> user_tags, bool match_all,
+                                    uint64_t* seqnum, uint16_t* engine_id) const {
+    TagSeqnumsVec tag_seqnums;
+    if (!GetTagSeqnums(user_tags, match_all, &tag_seqnums)) {
+        return false;
+    }
+    uint32_t seqnum_lowhalf = 0;
+    if (match_all) {
+        if (!IntersectPrev(tag_seqnums, query_seqnum, &seqnum_lowhalf)) {
+            return false;
+        }
+    } else {
+        bool found = false;
+        for (const std::vector<uint32_t>* seqnums : tag_seqnums) {
+            uint32_t tmp;
+            if (FindPrev(*seqnums, query_seqnum, &tmp) && (!found || tmp > seqnum_lowhalf)) {
+                seqnum_lowhalf = tmp;
+                found = true;
+            }
+        }
+        if (!found) {
+            return false;
+        }
+    }
+    DCHECK(engine_ids_.contains(seqnum_lowhalf));
+    *seqnum = bits::JoinTwo32(logspace_id_, seqnum_lowhalf);
+    DCHECK_LE(*seqnum, query_seqnum);
+    *engine_id = engine_ids_.at(seqnum_lowhalf);
+    return true;
+}
+
+bool Index::PerSpaceIndex::FindNext(uint64_t query_seqnum,
+                                    std::span<const uint64_t> user_tags, bool match_all,
+                                    uint64_t* seqnum, uint16_t* engine_id) const {
+    TagSeqnumsVec tag_seqnums;
+    if (!GetTagSeqnums(user_tags, match_all, &tag_seqnums)) {
+        return false;
+    }
+    uint32_t seqnum_lowhalf = 0;
+    if (match_all) {
+        if (!IntersectNext(tag_seqnums, query_seqnum, &seqnum_lowhalf)) {
+            return false;
+        }
+    } else {
+        bool found = false;
+        for (const std::vector<uint32_t>* seqnums : tag_seqnums) {
+            uint32_t tmp;
+            if (FindNext(*seqnums, query_seqnum, &tmp) && (!found || tmp < seqnum_lowhalf)) {
+                seqnum_lowhalf = tmp;
+                found = true;
+            }
+        }
+        if (!found) {
+            return false;
+        }
+    }
+    DCHECK(engine_ids_.contains(seqnum_lowhalf));
+    *seqnum = bits::JoinTwo32(logspace_id_, seqnum_lowhalf);
+    DCHECK_GE(*seqnum, query_seqnum);
+    *engine_id = engine_ids_.at(seqnum_lowhalf);
+    return true;
+}
+
+uint32_t Index::PerSpaceIndex::Count(uint64_t start_seqnum, uint64_t end_seqnum,
+                                     uint64_t user_tag) const {
+    const std::vector<uint32_t>* seqnums = &seqnums_;
+    if (user_tag != kEmptyLogTag) {
+        if (!seqnums_by_tag_.contains(user_tag)) {
+            return 0;
+        }
+        seqnums = &seqnums_by_tag_.at(user_tag);
+    }
+    auto first = absl::c_lower_bound(
+        *seqnums, start_seqnum,
+        [logspace_id = logspace_id_] (uint32_t lhs, uint64_t rhs) {
+            return bits::JoinTwo32(logspace_id, lhs) < rhs;
+        }
+    );
+    auto last = std::upper_bound(
+        first, seqnums->end(), end_seqnum,
+        [logspace_id = logspace_id_] (uint64_t lhs, uint32_t rhs) {
+            return lhs < bits::JoinTwo32(logspace_id, rhs);
+        }
+    );
+    return gsl::narrow_cast<uint32_t>(last - first);
+}
+
+bool Index::PerSpaceIndex::FindRange(uint64_t start_seqnum, uint64_t end_seqnum,
+                                     uint64_t user_tag, size_t max_size,
+                                     std::vector<uint64_t>* seqnums) const {
+    const std::vector<uint32_t>* tag_seqnums = &seqnums_;
+    if (user_tag != kEmptyLogTag) {
+        if (!seqnums_by_tag_.contains(user_tag)) {
+            return true;
+        }
+        tag_seqnums = &seqnums_by_tag_.at(user_tag);
+    }
+    auto iter = absl::c_upper_bound(
+        *tag_seqnums, start_seqnum,
+        [logspace_id = logspace_id_] (uint64_t lhs, uint32_t rhs) {
+            return lhs < bits::JoinTwo32(logspace_id, rhs);
+        }
+    );
+    for (; iter != tag_seqnums->end(); iter++) {
+        uint64_t seqnum = bits::JoinTwo32(logspace_id_, *iter);
+        if (seqnum > end_seqnum) {
+            break;
+        }
+        if (seqnums->size() >= max_size) {
+            return false;
+        }
+        seqnums->push_back(seqnum);
+    }
+    return true;
+}
+
+void Index::PerSpaceIndex::AddCheckpoint(uint64_t user_tag, uint64_t seqnum,
+                                         uint16_t engine_id) {
+    // All storage nodes of the engine register the same checkpoint
+    auto& checkpoints = checkpoints_[user_tag];
+    checkpoints[seqnum] = engine_id;
+    if (checkpoints.size() > kMaxCheckpointsPerTag) {
+        checkpoints.erase(checkpoints.begin());
+    }
+}
+
+bool Index::PerSpaceIndex::FindCheckpoint(uint64_t query_seqnum, uint64_t user_tag,
+                                          uint64_t* seqnum, uint16_t* engine_id) const {
+    auto iter = checkpoints_.find(user_tag);
+    if (iter == checkpoints_.end()) {
+        return false;
+    }
+    const auto& checkpoints = iter->second;
+    auto checkpoint_iter = checkpoints.upper_bound(query_seqnum);
+    if (checkpoint_iter == checkpoints.begin()) {
+        return false;
+    }
+    --checkpoint_iter;
+    *seqnum = checkpoint_iter->first;
+    *engine_id = checkpoint_iter->second;
+    return true;
+}
+
+void Index::PerSpaceIndex::UpdateQueueCursor(uint64_t user_tag, uint64_t seqnum) {
+    // Cursors from a previous owner engine can arrive late
+    auto iter = queue_cursors_.find(user_tag);
+    if (iter == queue_cursors_.end() || iter->second < seqnum) {
+        queue_cursors_[user_tag] = seqnum;
+    }
+}
+
+bool Index::PerSpaceIndex::FindQueueCursor(uint64_t user_tag, uint64_t* seqnum) const {
+    auto iter = queue_cursors_.find(user_tag);
+    if (iter == queue_cursors_.end()) {
+        return false;
+    }
+    *seqnum = iter->second;
+    return true;
+}
+
+bool Index::PerSpaceIndex::GetTagSeqnums(std::span<const uint64_t> user_tags, bool match_all,
+                                         TagSeqnumsVec* tag_seqnums) const {
+    for (uint64_t user_tag : user_tags) {
+        DCHECK_NE(user_tag, kEmptyLogTag);
+        if (!seqnums_by_tag_.contains(user_tag)) {
+            if (match_all) {
+                return false;
+            }
+            continue;
+        }
+        tag_seqnums->push_back(&seqnums_by_tag_.at(user_tag));
+    }
+    if (tag_seqnums->empty()) {
+        return false;
+    }
+    // Intersection starts from the rarest tag, whose seqnums are the most
+    // selective candidates
+    absl::c_sort(*tag_seqnums, [] (const std::vector<uint32_t>* lhs,
+                                   const std::vector<uint32_t>* rhs) {
+        return lhs->size() < rhs->size();
+    });
+    return true;
+}
+
+namespace {
+// Galloping (exponential) search: return the first position in [first, last)
+// not satisfying `pred`, probing from `first` with doubling steps. Cost is
+// logarithmic in the distance to the result, instead of to `last`.
+template<class Iter, class Pred>
+Iter GallopSearch(Iter first, Iter last, Pred pred) {
+    size_t step = 1;
+    while (static_cast<size_t>(last - first) > step) {
+        Iter probe = first + step;
+        if (!pred(*probe)) {
+            return std::partition_point(first, probe, pred);
+        }
+        first = probe + 1;
+        step *= 2;
+    }
+    return std::partition_point(first, last, pred);
+}
+}  // namespace
+
+// Both IntersectPrev and IntersectNext visit tags in a round-robin manner:
+// each tag gallops to the current candidate seqnum, and overshooting makes
+// a new candidate, until all tags agree on the same seqnum
+
+bool Index::PerSpaceIndex::IntersectPrev(const TagSeqnumsVec& tag_seqnums,
+                                         uint64_t query_seqnum,
+                                         uint32_t* result_seqnum) const {
+    uint32_t candidate;
+    if (bits::HighHalf64(query_seqnum) > logspace_id_) {
+        candidate = std::numeric_limits<uint32_t>::max();
+    } else if (bits::HighHalf64(query_seqnum) == logspace_id_) {
+        candidate = bits::LowHalf64(query_seqnum);
+    } else {
+        return false;
+    }
+    absl::InlinedVector<std::vector<uint32_t>::const_reverse_iterator, 4> iters;
+    for (const std::vector<uint32_t>* seqnums : tag_seqnums) {
+        iters.push_back(seqnums->rbegin());
+    }
+    size_t num_matched = 0;
+    size_t i = 0;
+    while (num_matched < tag_seqnums.size()) {
+        auto iter = GallopSearch(iters[i], tag_seqnums[i]->crend(),
+                                 [candidate] (uint32_t seqnum) {
+                                     return seqnum > candidate;
+                                 });
+        if (iter == tag_seqnums[i]->crend()) {
+            return false;
+        }
+        iters[i] = iter;
+        if (*iter == candidate) {
+            num_matched++;
+        } else {
+            candidate = *iter;
+            num_matched = 1;
+        }
+        i = (i + 1) % tag_seqnums.size();
+    }
+    *result_seqnum = candidate;
+    return true;
+}
+
+bool Index::PerSpaceIndex::IntersectNext(const TagSeqnumsVec& tag_seqnums,
+                                         uint64_t query_seqnum,
+                                         uint32_t* result_seqnum) const {
+    uint32_t candidate;
+    if (bits::HighHalf64(query_seqnum) < logspace_id_) {
+        candidate = 0;
+    } else if (bits::HighHalf64(query_seqnum) == logspace_id_) {
+        candidate = bits::LowHalf64(query_seqnum);
+    } else {
+        return false;
+    }
+    absl::InlinedVector<std::vector<uint32_t>::const_iterator, 4> iters;
+    for (const std::vector<uint32_t>* seqnums : tag_seqnums) {
+        iters.push_back(seqnums->begin());
+    }
+    size_t num_matched = 0;
+    size_t i = 0;
+    while (num_matched < tag_seqnums.size()) {
+        auto iter = GallopSearch(iters[i], tag_seqnums[i]->cend(),
+                                 [candidate] (uint32_t seqnum) {
+                                     return seqnum < candidate;
+                                 });
+        if (iter == tag_seqnums[i]->cend()) {
+            return false;
+        }
+        iters[i] = iter;
+        if (*iter == candidate) {
+            num_matched++;
+        } else {
+            candidate = *iter;
+            num_matched = 1;
+        }
+        i = (i + 1) % tag_seqnums.size();
+    }
+    *result_seqnum = candidate;
+    return true;
+}
+
 void Index::ProvideIndexData(const IndexDataProto& index_data) {
     DCHECK_EQ(identifier(), index_data.logspace_id());
+    int num_checkpoints = index_data.checkpoint_tags_size();
+    DCHECK_EQ(num_checkpoints, index_data.checkpoint_user_logspaces_size());
+    DCHECK_EQ(num_checkpoints, index_data.checkpoint_seqnums_size());
+    DCHECK_EQ(num_checkpoints, index_data.checkpoint_engine_ids_size());
+    for (int i = 0; i < num_checkpoints; i++) {
+        GetOrCreateIndex(index_data.checkpoint_user_logspaces(i))->AddCheckpoint(
+            index_data.checkpoint_tags(i), index_data.checkpoint_seqnums(i),
+            gsl::narrow_cast<uint16_t>(index_data.checkpoint_engine_ids(i)));
+    }
+    int num_queue_cursors = index_data.queue_cursor_tags_size();
+    DCHECK_EQ(num_queue_cursors, index_data.queue_cursor_user_logspaces_size());
+    DCHECK_EQ(num_queue_cursors, index_data.queue_cursor_seqnums_size());
+    for (int i = 0; i < num_queue_cursors; i++) {
+        GetOrCreateIndex(index_data.queue_cursor_user_logspaces(i))->UpdateQueueCursor(
+            index_data.queue_cursor_tags(i), index_data.queue_cursor_seqnums(i));
+    }
     int n = index_data.seqnum_halves_size();
     DCHECK_EQ(n, index_data.engine_ids_size());
     DCHECK_EQ(n, index_data.user_logspaces_size());
@@ -255,6 +611,44 @@ void Index::PollQueryResults(QueryResultVec* results) {
     pending_query_results_.clear();
 }
 
+bool Index::FindQueueCursor(uint32_t user_logspace, uint64_t user_tag, uint64_t* seqnum) {
+    if (!index_.contains(user_logspace)) {
+        return false;
+    }
+    return index_.at(user_logspace)->FindQueueCursor(user_tag, seqnum);
+}
+
+bool Index::PollTagFilterUpdate(bool full_sync, TagFilterUpdate* update) {
+    if (!tag_filter_.has_value()) {
+        return false;
+    }
+    // Pending cuts are waiting for index data, even after finalized
+    bool index_finalized = this->finalized() && cuts_.empty();
+    bool changed = (indexed_metalog_position_ != tag_filter_sent_position_
+                    || index_finalized != tag_filter_sent_finalized_);
+    full_sync = full_sync && tag_filter_delta_after_full_;
+    if (!changed && !full_sync && tag_filter_sent_full_) {
+        return false;
+    }
+    update->metalog_position = indexed_metalog_position_;
+    update->finalized = index_finalized;
+    update->prev_metalog_position = tag_filter_sent_position_;
+    // Send the whole filter when the delta is not much smaller
+    update->delta = tag_filter_sent_full_ && !full_sync
+                 && tag_filter_->num_changed_words() * 4 < tag_filter_->num_bits() / 64;
+    if (update->delta) {
+        tag_filter_->SerializeDelta(&update->data);
+        tag_filter_delta_after_full_ = true;
+    } else {
+        tag_filter_->Serialize(&update->data);
+        tag_filter_sent_full_ = true;
+        tag_filter_delta_after_full_ = false;
+    }
+    tag_filter_sent_position_ = indexed_metalog_position_;
+    tag_filter_sent_finalized_ = index_finalized;
+    return true;
+}
+
 void Index::OnMetaLogApplied(const MetaLogProto& meta_log_proto) {
     if (meta_log_proto.type() == MetaLogProto::NEW_LOGS) {
         const auto& new_logs_proto = meta_log_proto.new_logs_proto();
@@ -293,6 +687,11 @@ void Index::AdvanceIndexProgress() {
             const IndexData& index_data = iter->second;
             GetOrCreateIndex(index_data.user_logspace)->Add(
                 seqnum, index_data.engine_id, index_data.user_tags);
+            if (tag_filter_.has_value()) {
+                for (uint64_t tag : index_data.user_tags) {
+                    tag_filter_->Add(index_data.user_logspace, tag);
+                }
+            }
             iter = received_data_.erase(iter);
         }
         DCHECK_GT(end_seqnum, indexed_seqnum_position_);
@@ -347,6 +746,10 @@ void Index::ProcessQuery(const IndexQuery& query) {
         ProcessReadNext(query);
     } else if (query.direction == IndexQuery::kReadPrev) {
         ProcessReadPrev(query);
+    } else if (query.direction == IndexQuery::kCount) {
+        ProcessCount(query);
+    } else if (query.direction == IndexQuery::kReadCheckpoint) {
+        ProcessReadCheckpoint(query);
     }
 }
 
@@ -414,6 +817,78 @@ void Index::ProcessReadPrev(const IndexQuery& query) {
     }
 }
 
+void Index::ProcessCount(const IndexQuery& query) {
+    DCHECK(query.direction == IndexQuery::kCount);
+    HVLOG_F(1, "ProcessCount: seqnum=[{}, {}], logspace={}, tag={}",
+            bits::HexStr0x(query.query_seqnum), bits::HexStr0x(query.end_seqnum),
+            query.user_logspace, query.user_tag);
+    bool valid_range = (query.query_seqnum <= query.end_seqnum);
+    // Initial queries start with a zero count
+    uint32_t count = query.prev_found_result.count;
+    if (valid_range) {
+        count += IndexCount(query);
+    }
+    // Counting continues with older views, which hold the rest of the range,
+    // unless an existence check already found a match
+    IndexQueryResult result;
+    if (valid_range && log_utils::GetViewId(query.query_seqnum) < view_->id()
+            && !(query.count_exists && count > 0)) {
+        result = BuildContinueResult(query, false, 0, 0);
+        HVLOG_F(1, "ProcessCount: ContinueResult: count={}", count);
+    } else {
+        result = BuildFoundResult(query, view_->id(), kInvalidLogSeqNum, 0);
+        HVLOG_F(1, "ProcessCount: FoundResult: count={}", count);
+    }
+    result.found_result.count = count;
+    pending_query_results_.push_back(result);
+}
+
+void Index::ProcessReadCheckpoint(const IndexQuery& query) {
+    DCHECK(query.direction == IndexQuery::kReadCheckpoint);
+    HVLOG_F(1, "ProcessReadCheckpoint: seqnum={}, logspace={}, tag={}",
+            bits::HexStr0x(query.query_seqnum), query.user_logspace, query.user_tag);
+    // `prev_found_result` is invalid for initial queries
+    IndexFoundResult found_result = query.prev_found_result;
+    uint64_t seqnum;
+    uint16_t engine_id;
+    if (IndexFindCheckpoint(query, &seqnum, &engine_id)
+            && (found_result.seqnum == kInvalidLogSeqNum || seqnum > found_result.seqnum)) {
+        found_result = IndexFoundResult {
+            .view_id = view_->id(),
+            .engine_id = engine_id,
+            .seqnum = seqnum,
+            .count = 0
+        };
+    }
+    bool found = (found_result.seqnum != kInvalidLogSeqNum);
+    // Checkpoints registered in older views only cover older log entries,
+    // thus can be better ones only if the current one is of older views
+    if (view_->id() > 0
+            && (!found || log_utils::GetViewId(found_result.seqnum) < view_->id())) {
+        IndexQueryResult result = BuildContinueResult(query, false, 0, 0);
+        result.found_result = found_result;
+        pending_query_results_.push_back(std::move(result));
+        HVLOG(1) << "ProcessReadCheckpoint: ContinueResult";
+        return;
+    }
+    if (!found) {
+        pending_query_results_.push_back(BuildNotFoundResult(query));
+        HVLOG(1) << "ProcessReadCheckpoint: NotFoundResult";
+        return;
+    }
+    IndexQueryResult result = BuildFoundResult(
+        query, found_result.view_id, found_result.seqnum, found_result.engine_id);
+    bool tail_complete = IndexFindCheckpointTail(query, found_result.seqnum,
+                                                 &result.tail_seqnums);
+    // The tail only includes log entries of this view
+    result.tail_complete = tail_complete
+                        && log_utils::GetViewId(found_result.seqnum) == view_->id()
+                        && log_utils::GetViewId(query.query_seqnum) <= view_->id();
+    HVLOG_F(1, "ProcessReadCheckpoint: FoundResult: seqnum={}, tail_size={}",
+            bits::HexStr0x(found_result.seqnum), result.tail_seqnums.size());
+    pending_query_results_.push_back(std::move(result));
+}
+
 bool Index::ProcessBlockingQuery(const IndexQuery& query) {
     DCHECK(query.direction == IndexQuery::kReadNextB && query.initial);
     uint16_t query_view_id = log_utils::GetViewId(query.query_seqnum);
@@ -443,8 +918,12 @@ bool Index::IndexFindNext(const IndexQuery& query, uint64_t* seqnum, uint16_t* e
     if (!index_.contains(query.user_logspace)) {
         return false;
     }
-    return GetOrCreateIndex(query.user_logspace)->FindNext(
-        query.query_seqnum, query.user_tag, seqnum, engine_id);
+    PerSpaceIndex* index = GetOrCreateIndex(query.user_logspace);
+    if (query.multi_tag()) {
+        return index->FindNext(query.query_seqnum, VECTOR_AS_SPAN(query.user_tags),
+                               query.match_all_tags, seqnum, engine_id);
+    }
+    return index->FindNext(query.query_seqnum, query.user_tag, seqnum, engine_id);
 }
 
 bool Index::IndexFindPrev(const IndexQuery& query, uint64_t* seqnum, uint16_t* engine_id) {
@@ -452,10 +931,44 @@ bool Index::IndexFindPrev(const IndexQuery& query, uint64_t* seqnum, uint16_t* e
     if (!index_.contains(query.user_logspace)) {
         return false;
     }
-    return GetOrCreateIndex(query.user_logspace)->FindPrev(
+    PerSpaceIndex* index = GetOrCreateIndex(query.user_logspace);
+    if (query.multi_tag()) {
+        return index->FindPrev(query.query_seqnum, VECTOR_AS_SPAN(query.user_tags),
+                               query.match_all_tags, seqnum, engine_id);
+    }
+    return index->FindPrev(query.query_seqnum, query.user_tag, seqnum, engine_id);
+}
+
+uint32_t Index::IndexCount(const IndexQuery& query) {
+    DCHECK(query.direction == IndexQuery::kCount);
+    if (!index_.contains(query.user_logspace)) {
+        return 0;
+    }
+    return GetOrCreateIndex(query.user_logspace)->Count(
+        query.query_seqnum, query.end_seqnum, query.user_tag);
+}
+
+bool Index::IndexFindCheckpoint(const IndexQuery& query, uint64_t* seqnum,
+                                uint16_t* engine_id) {
+    DCHECK(query.direction == IndexQuery::kReadCheckpoint);
+    if (!index_.contains(query.user_logspace)) {
+        return false;
+    }
+    return GetOrCreateIndex(query.user_logspace)->FindCheckpoint(
         query.query_seqnum, query.user_tag, seqnum, engine_id);
 }
 
+bool Index::IndexFindCheckpointTail(const IndexQuery& query, uint64_t checkpoint_seqnum,
+                                    std::vector<uint64_t>* seqnums) {
+    DCHECK(query.direction == IndexQuery::kReadCheckpoint);
+    if (!index_.contains(query.user_logspace)) {
+        return true;
+    }
+    return GetOrCreateIndex(query.user_logspace)->FindRange(
+        checkpoint_seqnum, query.query_seqnum, query.user_tag,
+        kMaxCheckpointTailSize, seqnums);
+}
+
 IndexQueryResult Index::BuildFoundResult(const IndexQuery& query, uint16_t view_id,
                                          uint64_t seqnum, uint16_t engine_id) {
     return IndexQueryResult {
@@ -467,8 +980,11 @@ IndexQueryResult Index::BuildFoundResult(const IndexQuery& query, uint16_t view_
         .found_result = IndexFoundResult {
             .view_id = view_id,
             .engine_id = engine_id,
-            .seqnum = seqnum
-        }
+            .seqnum = seqnum,
+            .count = 0
+        },
+        .tail_seqnums = {},
+        .tail_complete = false
     };
 }
 
@@ -482,8 +998,11 @@ IndexQueryResult Index::BuildNotFoundResult(const IndexQuery& query) {
         .found_result = IndexFoundResult {
             .view_id = 0,
             .engine_id = 0,
-            .seqnum = kInvalidLogSeqNum
-        }
+            .seqnum = kInvalidLogSeqNum,
+            .count = 0
+        },
+        .tail_seqnums = {},
+        .tail_complete = false
     };
 }
 
@@ -499,8 +1018,11 @@ IndexQueryResult Index::BuildContinueResult(const IndexQuery& query, bool found,
         .found_result = IndexFoundResult {
             .view_id = 0,
             .engine_id = 0,
-            .seqnum = kInvalidLogSeqNum
-        }
+            .seqnum = kInvalidLogSeqNum,
+            .count = 0
+        },
+        .tail_seqnums = {},
+        .tail_complete = false
     };
     if (query.direction == IndexQuery::kReadNextB) {
         result.original_query.direction = IndexQuery::kReadNext;
@@ -512,7 +1034,8 @@ IndexQueryResult Index::BuildContinueResult(const IndexQuery& query, bool found,
         result.found_result = IndexFoundResult {
             .view_id = view_->id(),
             .engine_id = engine_id,
-            .seqnum = seqnum
+            .seqnum = seqnum,
+            .count = 0
         };
     } else if (!query.initial && query.prev_found_result.seqnum != kInvalidLogSeqNum) {
         result.found_result = query.prev_found_result;
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "log/log_space_base.h"
+#include "log/tag_filter.h"
 
 namespace faas {
 namespace log {
@@ -9,10 +10,11 @@ struct IndexFoundResult {
     uint16_t view_id;
     uint16_t engine_id;
     uint64_t seqnum;
+    uint32_t count;  // Number of matched log entries, only used by kCount queries
 };
 
 struct IndexQuery {
-    enum ReadDirection { kReadNext, kReadPrev, kReadNextB };
+    enum ReadDirection { kReadNext, kReadPrev, kReadNextB, kCount, kReadCheckpoint };
     ReadDirection direction;
     uint16_t origin_node_id;
     uint16_t hop_times;
@@ -22,10 +24,24 @@ struct IndexQuery {
     uint32_t user_logspace;
     uint64_t user_tag;
     uint64_t query_seqnum;
+    uint64_t end_seqnum;  // kCount queries count seqnums in [query_seqnum, end_seqnum]
+    bool     count_exists;  // kCount queries stop at the first view with a match
     uint64_t metalog_progress;
 
+    // Non-empty for multi-tag queries (READ_NEXT_MT and READ_PREV_MT), which
+    // match log entries with all (`match_all_tags`) or any of `user_tags`,
+    // in which case `user_tag` is ignored
+    UserTagVec user_tags;
+    bool       match_all_tags;
+
+    // Set for reads of READ_SNAPSHOT, which need seqnums of found log
+    // entries, but not their data
+    bool seqnum_only;
+
     IndexFoundResult prev_found_result;
 
+    bool multi_tag() const { return !user_tags.empty(); }
+
     static ReadDirection DirectionFromOpType(protocol::SharedLogOpType op_type);
     protocol::SharedLogOpType DirectionToOpType() const;
 };
@@ -38,11 +54,20 @@ struct IndexQueryResult {
 
     IndexQuery       original_query;
     IndexFoundResult found_result;
+
+    // For kReadCheckpoint queries, seqnums of log entries after the found
+    // checkpoint, and if they include all log entries up to `query_seqnum`
+    std::vector<uint64_t> tail_seqnums;
+    bool                  tail_complete;
 };
 
 class Index final : public LogSpaceBase {
 public:
     static constexpr absl::Duration kBlockingQueryTimeout = absl::Seconds(1);
+    // Older checkpoints of a tag are dropped
+    static constexpr size_t kMaxCheckpointsPerTag = 8;
+    // Readers replay the rest of a longer tail by themselves
+    static constexpr size_t kMaxCheckpointTailSize = 64;
 
     Index(const View* view, uint16_t sequencer_id);
     ~Index();
@@ -54,6 +79,27 @@ public:
     using QueryResultVec = absl::InlinedVector<IndexQueryResult, 4>;
     void PollQueryResults(QueryResultVec* results);
 
+    // All log entries up to this metalog progress are indexed
+    uint64_t index_metalog_progress() const {
+        return bits::JoinTwo32(identifier(), indexed_metalog_position_);
+    }
+
+    // Find the consumer cursor of the queue of `user_tag` registered in this
+    // index, which is the seqnum of the last popped log entry
+    bool FindQueueCursor(uint32_t user_logspace, uint64_t user_tag, uint64_t* seqnum);
+
+    struct TagFilterUpdate {
+        uint32_t    metalog_position;
+        bool        finalized;  // The filter will not change any more
+        bool        delta;      // `data` only has words changed since the last poll
+        uint32_t    prev_metalog_position;  // Position of the last poll, for deltas
+        std::string data;
+    };
+    // Returns false if tag filter is not enabled, or not changed since the last
+    // poll. With `full_sync`, the whole filter is sent if any delta has been
+    // sent after the last full filter, as receivers may have missed it.
+    bool PollTagFilterUpdate(bool full_sync, TagFilterUpdate* update);
+
 private:
     class PerSpaceIndex;
     absl::flat_hash_map</* user_logspace */ uint32_t,
@@ -80,9 +126,11 @@ private:
     uint32_t data_received_seqnum_position_;
     uint32_t indexed_seqnum_position_;
 
-    uint64_t index_metalog_progress() const {
-        return bits::JoinTwo32(identifier(), indexed_metalog_position_);
-    }
+    std::optional<TagFilter> tag_filter_;
+    uint32_t tag_filter_sent_position_;
+    bool     tag_filter_sent_finalized_;
+    bool     tag_filter_sent_full_;
+    bool     tag_filter_delta_after_full_;
 
     void OnMetaLogApplied(const MetaLogProto& meta_log_proto) override;
     void OnFinalized(uint32_t metalog_position) override;
@@ -92,10 +140,18 @@ private:
     void ProcessQuery(const IndexQuery& query);
     void ProcessReadNext(const IndexQuery& query);
     void ProcessReadPrev(const IndexQuery& query);
+    void ProcessCount(const IndexQuery& query);
+    void ProcessReadCheckpoint(const IndexQuery& query);
     bool ProcessBlockingQuery(const IndexQuery& query);
 
     bool IndexFindNext(const IndexQuery& query, uint64_t* seqnum, uint16_t* engine_id);
     bool IndexFindPrev(const IndexQuery& query, uint64_t* seqnum, uint16_t* engine_id);
+    uint32_t IndexCount(const IndexQuery& query);
+    bool IndexFindCheckpoint(const IndexQuery& query, uint64_t* seqnum, uint16_t* engine_id);
+    // Returns false if there are more than kMaxCheckpointTailSize log entries
+    // after the checkpoint at `checkpoint_seqnum`
+    bool IndexFindCheckpointTail(const IndexQuery& query, uint64_t checkpoint_seqnum,
+                                 std::vector<uint64_t>* seqnums);
 
     IndexQueryResult BuildFoundResult(const IndexQuery& query, uint16_t view_id,
                                       uint64_t seqnum, uint16_t engine_id);
@@ -1,5 +1,6 @@
 #include "log/log_space.h"
 
+#include "common/time.h"
 #include "log/flags.h"
 
 namespace faas {
@@ -199,9 +200,11 @@ void LogProducer::OnFinalized(uint32_t metalog_position) {
     pending_appends_.clear();
 }
 
-LogStorage::LogStorage(uint16_t storage_id, const View* view, uint16_t sequencer_id)
+LogStorage::LogStorage(uint16_t storage_id, const View* view, uint16_t sequencer_id,
+                       Durability durability)
     : LogSpaceBase(LogSpaceBase::kLiteMode, view, sequencer_id),
       storage_node_(view_->GetStorageNode(storage_id)),
+      durability_(durability),
       shard_progrss_dirty_(false),
       persisted_seqnum_position_(0) {
     for (uint16_t engine_id : storage_node_->GetSourceEngineNodes()) {
@@ -227,12 +230,27 @@ bool LogStorage::Store(const LogMetaData& log_metadata, std::span<const uint64_t
                storage_node_->node_id(), engine_id);
         return false;
     }
+    if (durability_ == kMemoryOnly) {
+        size_t max_entries = absl::GetFlag(FLAGS_slog_storage_memory_only_max_entries);
+        size_t num_entries = live_log_entries_.size() + pending_log_entries_.size();
+        if (max_entries > 0 && num_entries >= max_entries) {
+            HLOG_F(ERROR, "Memory-only log space is full with {} log entries, "
+                          "refuse log entry from engine {}", num_entries, engine_id);
+            return false;
+        }
+    }
     pending_log_entries_[localid].reset(new LogEntry {
         .metadata = log_metadata,
         .user_tags = UserTagVec(user_tags.begin(), user_tags.end()),
         .data = std::string(log_data.data(), log_data.size()),
     });
-    AdvanceShardProgress(engine_id);
+    if (durability_ == kFsyncGroupCommit) {
+        // Shard progress will not pass this log entry until it is synced
+        unsynced_queue_.emplace_back(localid, GetMonotonicMicroTimestamp());
+        unsynced_localids_.insert(localid);
+    } else {
+        AdvanceShardProgress(engine_id);
+    }
     return true;
 }
 
@@ -280,10 +298,70 @@ bool LogStorage::GrabLogEntriesForPersistence(
 }
 
 void LogStorage::LogEntriesPersisted(uint64_t new_position) {
-    persisted_seqnum_position_ = new_position;
+    // Bulk sync may have moved the position beyond flushed log entries
+    persisted_seqnum_position_ = std::max(persisted_seqnum_position_, new_position);
     ShrinkLiveEntriesIfNeeded();
 }
 
+bool LogStorage::GrabLogEntriesForSync(
+        std::vector<std::shared_ptr<const LogEntry>>* log_entries,
+        int64_t* oldest_timestamp) {
+    DCHECK_EQ(durability_, kFsyncGroupCommit);
+    if (unsynced_queue_.empty()) {
+        return false;
+    }
+    size_t max_group_size = absl::GetFlag(FLAGS_slog_storage_group_commit_max_entries);
+    int64_t max_delay_us = absl::GetFlag(FLAGS_slog_storage_group_commit_delay_us);
+    int64_t oldest = unsynced_queue_.front().second;
+    if (unsynced_queue_.size() < max_group_size
+            && GetMonotonicMicroTimestamp() - oldest < max_delay_us) {
+        return false;
+    }
+    log_entries->clear();
+    while (!unsynced_queue_.empty() && log_entries->size() < max_group_size) {
+        uint64_t localid = unsynced_queue_.front().first;
+        unsynced_queue_.pop_front();
+        if (!pending_log_entries_.contains(localid)) {
+            // Discarded as the log space is finalized
+            unsynced_localids_.erase(localid);
+            continue;
+        }
+        log_entries->push_back(
+            std::make_shared<const LogEntry>(*pending_log_entries_.at(localid)));
+    }
+    *oldest_timestamp = oldest;
+    return !log_entries->empty();
+}
+
+void LogStorage::LogEntriesSynced(
+        std::span<const std::shared_ptr<const LogEntry>> log_entries) {
+    absl::InlinedVector<uint16_t, 4> engine_ids;
+    for (const auto& log_entry : log_entries) {
+        uint64_t localid = log_entry->metadata.localid;
+        unsynced_localids_.erase(localid);
+        uint16_t engine_id = gsl::narrow_cast<uint16_t>(bits::HighHalf64(localid));
+        if (std::find(engine_ids.begin(), engine_ids.end(), engine_id) == engine_ids.end()) {
+            engine_ids.push_back(engine_id);
+        }
+    }
+    for (uint16_t engine_id : engine_ids) {
+        AdvanceShardProgress(engine_id);
+    }
+}
+
+std::optional<int64_t> LogStorage::NextGroupCommitDeadline() const {
+    if (unsynced_queue_.empty()) {
+        return std::nullopt;
+    }
+    return unsynced_queue_.front().second
+         + absl::GetFlag(FLAGS_slog_storage_group_commit_delay_us);
+}
+
+void LogStorage::PollDiscardedPendingLocalids(std::vector<uint64_t>* localids) {
+    *localids = std::move(discarded_pending_localids_);
+    discarded_pending_localids_.clear();
+}
+
 void LogStorage::PollReadResults(ReadResultVec* results) {
     *results = std::move(pending_read_results_);
     pending_read_results_.clear();
@@ -369,8 +447,16 @@ void LogStorage::OnNewLogs(uint32_t metalog_seqnum,
 void LogStorage::OnFinalized(uint32_t metalog_position) {
     if (!pending_log_entries_.empty()) {
         HLOG_F(WARNING, "{} pending log entries discarded", pending_log_entries_.size());
+        if (durability_ == kFsyncGroupCommit) {
+            // Including ones not synced yet, as their group commit may be ongoing
+            for (const auto& [localid, log_entry] : pending_log_entries_) {
+                discarded_pending_localids_.push_back(localid);
+            }
+        }
         pending_log_entries_.clear();
     }
+    unsynced_queue_.clear();
+    unsynced_localids_.clear();
     if (!pending_read_requests_.empty()) {
         HLOG_F(FATAL, "There are {} pending reads", pending_read_requests_.size());
     }
@@ -378,7 +464,11 @@ void LogStorage::OnFinalized(uint32_t metalog_position) {
 
 void LogStorage::AdvanceShardProgress(uint16_t engine_id) {
     uint32_t current = shard_progrsses_[engine_id];
-    while (pending_log_entries_.contains(bits::JoinTwo32(engine_id, current))) {
+    while (true) {
+        uint64_t localid = bits::JoinTwo32(engine_id, current);
+        if (!pending_log_entries_.contains(localid) || unsynced_localids_.contains(localid)) {
+            break;
+        }
         current++;
     }
     if (current > shard_progrsses_[engine_id]) {
@@ -392,6 +482,10 @@ void LogStorage::AdvanceShardProgress(uint16_t engine_id) {
 }
 
 void LogStorage::ShrinkLiveEntriesIfNeeded() {
+    if (durability_ == kMemoryOnly) {
+        // Evicted log entries cannot be read back from DB
+        return;
+    }
     size_t max_size = absl::GetFlag(FLAGS_slog_storage_max_live_entries);
     while (live_seqnums_.size() > max_size
              && live_seqnums_.front() < persisted_seqnum_position_) {
@@ -84,9 +84,26 @@ private:
 // Used in Storage
 class LogStorage final : public LogSpaceBase {
 public:
-    LogStorage(uint16_t storage_id, const View* view, uint16_t sequencer_id);
+    enum Durability {
+        // Log entries are never written to DB, thus all of them are kept in
+        // memory. New log entries are refused when exceeding
+        // FLAGS_slog_storage_memory_only_max_entries
+        kMemoryOnly,
+        // Log entries are flushed to DB after they are ordered (the default)
+        kAsyncFlush,
+        // Log entries are fsync-ed to DB in groups before storage reports them
+        // in shard progress, thus before they can be ordered
+        kFsyncGroupCommit
+    };
+
+    LogStorage(uint16_t storage_id, const View* view, uint16_t sequencer_id,
+               Durability durability);
     ~LogStorage();
 
+    Durability durability() const { return durability_; }
+    // Log entries before this seqnum are all flushed into DB
+    uint64_t persisted_seqnum_position() const { return persisted_seqnum_position_; }
+
     bool Store(const LogMetaData& log_metadata, std::span<const uint64_t> user_tags,
                std::span<const char> log_data);
     void ReadAt(const protocol::SharedLogMessage& request);
@@ -96,6 +113,21 @@ public:
             uint64_t* new_position) const;
     void LogEntriesPersisted(uint64_t new_position);
 
+    // For kFsyncGroupCommit. Returns false if no group is ready to commit,
+    // i.e. pending log entries not synced are fewer than the max group size,
+    // and the oldest of them has waited less than the max commit delay.
+    // `log_entries` are copies, and `oldest_timestamp` is when the oldest of
+    // them was received.
+    bool GrabLogEntriesForSync(std::vector<std::shared_ptr<const LogEntry>>* log_entries,
+                               int64_t* oldest_timestamp);
+    void LogEntriesSynced(std::span<const std::shared_ptr<const LogEntry>> log_entries);
+    // When the oldest pending log entry not synced reaches the max commit delay,
+    // or std::nullopt if all pending log entries are synced
+    std::optional<int64_t> NextGroupCommitDeadline() const;
+    // Localids of pending log entries discarded by finalization, whose synced
+    // copies have to be removed from DB
+    void PollDiscardedPendingLocalids(std::vector<uint64_t>* localids);
+
     struct ReadResult {
         enum Status { kOK, kLookupDB, kFailed };
         Status status;
@@ -110,6 +142,7 @@ public:
 
 private:
     const View::Storage* storage_node_;
+    Durability durability_;
 
     bool shard_progrss_dirty_;
     absl::flat_hash_map</* engine_id */ uint16_t,
@@ -124,6 +157,11 @@ private:
     absl::flat_hash_map</* localid */ uint64_t,
                         std::unique_ptr<LogEntry>>
         pending_log_entries_;
+    // Pending log entries not synced yet, in the order of receiving
+    std::deque<std::pair</* localid */ uint64_t,
+                         /* received_timestamp */ int64_t>> unsynced_queue_;
+    absl::flat_hash_set</* localid */ uint64_t> unsynced_localids_;
+    std::vector</* localid */ uint64_t> discarded_pending_localids_;
 
     std::multimap</* seqnum */ uint64_t,
                   protocol::SharedLogMessage> pending_read_requests_;
@@ -210,7 +210,7 @@ bool SequencerBase::SendSharedLogMessage(protocol::ConnType conn_type, uint16_t
 
 void SequencerBase::OnRemoteMessageConn(const protocol::HandshakeMessage& handshake,
                                         int sockfd) {
-    protocol::ConnType type = static_cast<protocol::ConnType>(handshake.conn_type);
+    protocol::ConnType type = protocol::GetConnType(handshake);
     uint16_t src_node_id = handshake.src_node_id;
 
     switch (type) {
@@ -229,6 +229,9 @@ void SequencerBase::OnRemoteMessageConn(const protocol::HandshakeMessage& handsh
     int conn_type_id = ServerBase::GetIngressConnTypeId(type, src_node_id);
     auto connection = std::make_unique<IngressConnection>(
         conn_type_id, sockfd, sizeof(SharedLogMessage));
+    if (protocol::IsStripedConn(handshake)) {
+        connection->EnableStriping();
+    }
     connection->SetMessageFullSizeCallback(
         &IngressConnection::SharedLogMessageFullSizeCallback);
     connection->SetNewMessageCallback(
@@ -276,9 +279,13 @@ EgressHub* SequencerBase::CreateEgressHub(protocol::ConnType conn_type,
         ServerBase::GetEgressHubTypeId(conn_type, dst_node_id),
         &addr, absl::GetFlag(FLAGS_message_conn_per_worker));
     uint16_t src_node_id = node_id_;
+    bool striped = absl::GetFlag(FLAGS_egress_hub_enable_striping);
+    if (striped) {
+        egress_hub->EnableStriping();
+    }
     egress_hub->SetHandshakeMessageCallback(
-        [conn_type, src_node_id] (std::string* handshake) {
-            *handshake = protocol::EncodeHandshakeMessage(conn_type, src_node_id);
+        [conn_type, src_node_id, striped] (std::string* handshake) {
+            *handshake = protocol::EncodeHandshakeMessage(conn_type, src_node_id, striped);
         }
     );
     RegisterConnection(io_worker, egress_hub.get());
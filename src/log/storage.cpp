@@ -1,10 +1,10 @@
 #include "log/storage.h"
 
+#include "common/time.h"
 #include "log/flags.h"
 #include "log/utils.h"
 #include "utils/bits.h"
-#include "utils/io.h"
-#include "utils/timerfd.h"
+#include "utils/hash.h"
 
 namespace faas {
 namespace log {
@@ -13,14 +13,59 @@ using protocol::SharedLogMessage;
 using protocol::SharedLogMessageHelper;
 using protocol::SharedLogOpType;
 
+namespace {
+LogStorage::Durability ParseDurability(std::string_view str) {
+    if (str == "memory") {
+        return LogStorage::kMemoryOnly;
+    } else if (str == "async") {
+        return LogStorage::kAsyncFlush;
+    } else if (str == "fsync") {
+        return LogStorage::kFsyncGroupCommit;
+    } else {
+        LOG(FATAL) << "Unknown durability: " << str;
+    }
+}
+}  // namespace
+
 Storage::Storage(uint16_t node_id)
     : StorageBase(node_id),
       log_header_(fmt::format("Storage[{}-N]: ", node_id)),
       current_view_(nullptr),
-      view_finalized_(false) {}
+      view_finalized_(false),
+      default_durability_(ParseDurability(absl::GetFlag(FLAGS_slog_storage_durability))),
+      db_read_batch_size_stat_(stat::StatisticsCollector<uint16_t>::StandardReportCallback(
+          "storage_db_read_batch_size")),
+      cache_lookup_stat_(stat::CategoryCounter::StandardReportCallback(
+          "storage_cache_lookup (0=hit, 1=miss)")),
+      flush_workers_(num_flush_workers()),
+      bulk_sync_done_(!absl::GetFlag(FLAGS_slog_storage_bulk_sync)),
+      bulk_sync_bytes_(0),
+      bulk_sync_start_timestamp_(0),
+      bulk_sync_bytes_counter_(stat::Counter::StandardReportCallback(
+          "storage_bulk_sync_bytes")) {
+    for (size_t i = 0; i < flush_workers_.size(); i++) {
+        flush_workers_[i] = std::make_unique<FlushWorker>(i);
+    }
+    std::string phylog_durability = absl::GetFlag(FLAGS_slog_storage_phylog_durability);
+    for (std::string_view item : absl::StrSplit(phylog_durability, ',', absl::SkipEmpty())) {
+        std::vector<std::string_view> parts = absl::StrSplit(item, ':');
+        int sequencer_id;
+        if (parts.size() != 2 || !absl::SimpleAtoi(parts[0], &sequencer_id)) {
+            HLOG(FATAL) << "Invalid durability of physical log: " << item;
+        }
+        phylog_durability_[gsl::narrow_cast<uint16_t>(sequencer_id)] = ParseDurability(parts[1]);
+    }
+}
 
 Storage::~Storage() {}
 
+Storage::FlushWorker::FlushWorker(size_t worker_id)
+    : stopped(false),
+      async_flush_time_stat(stat::StatisticsCollector<int32_t>::StandardReportCallback(
+          fmt::format("storage_async_flush_time[{}]", worker_id))),
+      fsync_commit_delay_stat(stat::StatisticsCollector<int32_t>::StandardReportCallback(
+          fmt::format("storage_fsync_commit_delay[{}]", worker_id))) {}
+
 void Storage::OnViewCreated(const View* view) {
     DCHECK(zk_session()->WithinMyEventLoopThread());
     HLOG_F(INFO, "New view {} created", view->id());
@@ -37,7 +82,7 @@ void Storage::OnViewCreated(const View* view) {
                     continue;
                 }
                 storage_collection_.InstallLogSpace(std::make_unique<LogStorage>(
-                    my_node_id(), view, sequencer_id));
+                    my_node_id(), view, sequencer_id, GetDurability(sequencer_id)));
             }
         }
         future_requests_.OnNewView(view, contains_myself ? &ready_requests : nullptr);
@@ -45,6 +90,9 @@ void Storage::OnViewCreated(const View* view) {
         view_finalized_ = false;
         log_header_ = fmt::format("Storage[{}-{}]: ", my_node_id(), view->id());
     }
+    if (contains_myself && !bulk_sync_done_.load(std::memory_order_acquire)) {
+        AddBulkSyncTasks(view);
+    }
     if (!ready_requests.empty()) {
         HLOG_F(INFO, "{} requests for the new view", ready_requests.size());
         SomeIOWorker()->ScheduleFunction(
@@ -60,6 +108,7 @@ void Storage::OnViewFinalized(const FinalizedView* finalized_view) {
     HLOG_F(INFO, "View {} finalized", finalized_view->view()->id());
     LogStorage::ReadResultVec results;
     std::vector<IndexDataProto> index_data_vec;
+    std::vector<uint32_t> finalized_logspaces;
     {
         absl::MutexLock view_lk(&view_mu_);
         DCHECK_EQ(finalized_view->view()->id(), current_view_->id());
@@ -68,6 +117,7 @@ void Storage::OnViewFinalized(const FinalizedView* finalized_view) {
             [&, finalized_view] (uint32_t logspace_id,
                                  LockablePtr<LogStorage> storage_ptr) {
                 log_utils::FinalizedLogSpace<LogStorage>(storage_ptr, finalized_view);
+                finalized_logspaces.push_back(logspace_id);
                 auto locked_storage = storage_ptr.Lock();
                 LogStorage::ReadResultVec tmp;
                 locked_storage->PollReadResults(&tmp);
@@ -79,6 +129,9 @@ void Storage::OnViewFinalized(const FinalizedView* finalized_view) {
         );
         view_finalized_ = true;
     }
+    for (uint32_t logspace_id : finalized_logspaces) {
+        NotifyFlushWorker(logspace_id);
+    }
     if (!results.empty()) {
         SomeIOWorker()->ScheduleFunction(
             nullptr, [this, results = std::move(results)] {
@@ -158,6 +211,7 @@ void Storage::HandleReplicateRequest(const SharedLogMessage& message,
     std::span<const char> log_data;
     log_utils::SplitPayloadForMessage(message, payload, &user_tags, &log_data,
                                       /* aux_data= */ nullptr);
+    bool need_sync = false;
     {
         absl::ReaderMutexLock view_lk(&view_mu_);
         ONHOLD_IF_FROM_FUTURE_VIEW(message, payload);
@@ -168,9 +222,14 @@ void Storage::HandleReplicateRequest(const SharedLogMessage& message,
             RETURN_IF_LOGSPACE_FINALIZED(locked_storage);
             if (!locked_storage->Store(metadata, user_tags, log_data)) {
                 HLOG(ERROR) << "Failed to store log entry";
+                return;
             }
+            need_sync = locked_storage->durability() == LogStorage::kFsyncGroupCommit;
         }
     }
+    if (need_sync) {
+        NotifyFlushWorker(message.logspace_id);
+    }
 }
 
 void Storage::OnRecvNewMetaLogs(const SharedLogMessage& message,
@@ -197,6 +256,7 @@ void Storage::OnRecvNewMetaLogs(const SharedLogMessage& message,
             index_data = locked_storage->PollIndexData();
         }
     }
+    NotifyFlushWorker(message.logspace_id);
     ProcessReadResults(results);
     if (index_data.has_value()) {
         SendIndexData(DCHECK_NOTNULL(view), *index_data);
@@ -210,6 +270,109 @@ void Storage::OnRecvLogAuxData(const protocol::SharedLogMessage& message,
     LogCachePutAuxData(seqnum, payload);
 }
 
+void Storage::OnRecvCheckpoint(const protocol::SharedLogMessage& message,
+                               std::span<const char> payload) {
+    DCHECK(SharedLogMessageHelper::GetOpType(message) == SharedLogOpType::SET_CHECKPOINT);
+    const View* view = nullptr;
+    {
+        absl::ReaderMutexLock view_lk(&view_mu_);
+        ONHOLD_IF_FROM_FUTURE_VIEW(message, payload);
+        IGNORE_IF_FROM_PAST_VIEW(message);
+        view = current_view_;
+    }
+    if ((message.flags & protocol::kQueueCursorFlag) != 0) {
+        // Queue cursors are persisted in one batch, so that engines serving
+        // the queues in later views can recover them from DB
+        if (payload.size() % (3 * sizeof(uint64_t)) != 0) {
+            HLOG_F(ERROR, "Invalid size of queue cursors: {}", payload.size());
+            return;
+        }
+        const uint64_t* cursors = reinterpret_cast<const uint64_t*>(payload.data());
+        size_t n = payload.size() / sizeof(uint64_t);
+        PutQueueCursorsToDB(message.logspace_id, std::span<const uint64_t>(cursors, n));
+        IndexDataProto index_data;
+        index_data.set_logspace_id(message.logspace_id);
+        for (size_t i = 0; i < n; i += 3) {
+            index_data.add_queue_cursor_user_logspaces(
+                gsl::narrow_cast<uint32_t>(cursors[i]));
+            index_data.add_queue_cursor_tags(cursors[i + 1]);
+            index_data.add_queue_cursor_seqnums(cursors[i + 2]);
+        }
+        SendIndexData(DCHECK_NOTNULL(view), index_data);
+        return;
+    }
+    // Checkpoints are rare compared with log entries, thus persisted right
+    // away, before registered at index engines
+    HVLOG_F(1, "Store checkpoint of tag {} (seqnum {}): size={}",
+            message.query_tag, bits::HexStr0x(message.query_seqnum), payload.size());
+    PutCheckpointToDB(message.logspace_id, message.user_logspace,
+                      message.query_tag, message.query_seqnum, payload);
+    IndexDataProto index_data;
+    index_data.set_logspace_id(message.logspace_id);
+    index_data.add_checkpoint_user_logspaces(message.user_logspace);
+    index_data.add_checkpoint_tags(message.query_tag);
+    index_data.add_checkpoint_seqnums(message.query_seqnum);
+    index_data.add_checkpoint_engine_ids(message.origin_node_id);
+    SendIndexData(DCHECK_NOTNULL(view), index_data);
+}
+
+void Storage::HandleReadCheckpointRequest(const SharedLogMessage& request,
+                                          std::span<const char> payload) {
+    DCHECK(SharedLogMessageHelper::GetOpType(request) == SharedLogOpType::READ_CHECKPOINT);
+    {
+        absl::ReaderMutexLock view_lk(&view_mu_);
+        ONHOLD_IF_FROM_FUTURE_VIEW(request, payload);
+    }
+    if ((request.flags & protocol::kQueueCursorFlag) != 0) {
+        HandleReadQueueCursorRequest(request);
+        return;
+    }
+    uint64_t seqnum = request.query_seqnum;
+    auto data = GetCheckpointFromDB(request.logspace_id, request.user_logspace,
+                                    request.query_tag, seqnum);
+    if (!data.has_value()) {
+        // Storage nodes of the same engine persist checkpoints independently,
+        // thus this one may not have it yet. Readers will replay the log instead.
+        HLOG_F(WARNING, "Cannot find checkpoint of tag {} (seqnum {})",
+               request.query_tag, bits::HexStr0x(seqnum));
+        SharedLogMessage response = SharedLogMessageHelper::NewResponse(
+            protocol::SharedLogResultType::EMPTY);
+        response.user_metalog_progress = request.user_metalog_progress;
+        SendEngineResponse(request, &response);
+        return;
+    }
+    // Payload of the request holds the tail after the checkpoint
+    SharedLogMessage response = SharedLogMessageHelper::NewResponse(
+        protocol::SharedLogResultType::CHECKPOINT_OK);
+    response.logspace_id = bits::HighHalf64(seqnum);
+    response.seqnum_lowhalf = bits::LowHalf64(seqnum);
+    response.user_metalog_progress = request.user_metalog_progress;
+    response.num_tags = gsl::narrow_cast<uint16_t>(payload.size() / sizeof(uint64_t));
+    if ((request.flags & protocol::kCheckpointTailCompleteFlag) != 0) {
+        response.response_flags |= protocol::kCheckpointTailCompleteFlag;
+    }
+    SendEngineResponse(request, &response, payload, STRING_AS_SPAN(*data));
+}
+
+void Storage::HandleReadQueueCursorRequest(const SharedLogMessage& request) {
+    auto cursor = GetQueueCursorFromDB(request.logspace_id, request.user_logspace,
+                                       request.query_tag);
+    SharedLogMessage response;
+    if (cursor.has_value()) {
+        HVLOG_F(1, "Found cursor of queue with tag {} at seqnum {}",
+                request.query_tag, bits::HexStr0x(*cursor));
+        response = SharedLogMessageHelper::NewResponse(
+            protocol::SharedLogResultType::CHECKPOINT_OK);
+        response.logspace_id = bits::HighHalf64(*cursor);
+        response.seqnum_lowhalf = bits::LowHalf64(*cursor);
+    } else {
+        response = SharedLogMessageHelper::NewResponse(
+            protocol::SharedLogResultType::EMPTY);
+    }
+    response.user_metalog_progress = request.user_metalog_progress;
+    SendEngineResponse(request, &response);
+}
+
 #undef ONHOLD_IF_FROM_FUTURE_VIEW
 #undef IGNORE_IF_FROM_PAST_VIEW
 #undef RETURN_IF_LOGSPACE_FINALIZED
@@ -220,6 +383,7 @@ void Storage::ProcessReadResults(const LogStorage::ReadResultVec& results) {
         SharedLogMessage response;
         switch (result.status) {
         case LogStorage::ReadResult::kOK:
+            RecordHotKey(result.log_entry->metadata.seqnum);
             response = SharedLogMessageHelper::NewReadOkResponse();
             log_utils::PopulateMetaDataToMessage(result.log_entry->metadata, &response);
             DCHECK_EQ(response.logspace_id, request.logspace_id);
@@ -233,6 +397,9 @@ void Storage::ProcessReadResults(const LogStorage::ReadResultVec& results) {
             ProcessReadFromDB(request);
             break;
         case LogStorage::ReadResult::kFailed:
+            if (HoldReadForBulkSync(request)) {
+                break;
+            }
             HLOG_F(ERROR, "Failed to read log data (seqnum={})",
                    bits::HexStr0x(bits::JoinTwo32(request.logspace_id, request.seqnum_lowhalf)));
             response = SharedLogMessageHelper::NewDataLostResponse();
@@ -245,26 +412,134 @@ void Storage::ProcessReadResults(const LogStorage::ReadResultVec& results) {
 }
 
 void Storage::ProcessReadFromDB(const SharedLogMessage& request) {
-    uint64_t seqnum = bits::JoinTwo32(request.logspace_id, request.seqnum_lowhalf);
-    LogEntryProto log_entry;
-    if (auto tmp = GetLogEntryFromDB(seqnum); tmp.has_value()) {
-        log_entry = std::move(*tmp);
-    } else {
-        HLOG_F(ERROR, "Failed to read log data (seqnum={})", bits::HexStr0x(seqnum));
+    server::IOWorker* io_worker = CurrentIOWorker();
+    if (io_worker == nullptr || !absl::GetFlag(FLAGS_slog_storage_coalesce_db_reads)) {
+        ProcessReadsFromDB(request.logspace_id, {&request, 1});
+        return;
+    }
+    bool first_pending = false;
+    {
+        absl::MutexLock lk(&db_read_mu_);
+        std::vector<SharedLogMessage>& pending_reads = pending_db_reads_[io_worker];
+        first_pending = pending_reads.empty();
+        pending_reads.push_back(request);
+    }
+    if (first_pending) {
+        io_worker->ScheduleIdleFunction(
+            nullptr, absl::bind_front(&Storage::ProcessPendingDBReads, this, io_worker));
+    }
+}
+
+void Storage::ProcessPendingDBReads(server::IOWorker* io_worker) {
+    std::vector<SharedLogMessage> pending_reads;
+    {
+        absl::MutexLock lk(&db_read_mu_);
+        pending_reads.swap(pending_db_reads_[io_worker]);
+    }
+    DCHECK(!pending_reads.empty());
+    absl::c_stable_sort(
+        pending_reads,
+        [] (const SharedLogMessage& lhs, const SharedLogMessage& rhs) {
+            return lhs.logspace_id < rhs.logspace_id;
+        }
+    );
+    std::vector<uint16_t> batch_sizes;
+    std::span<const SharedLogMessage> requests(pending_reads.data(), pending_reads.size());
+    while (!requests.empty()) {
+        uint32_t logspace_id = requests[0].logspace_id;
+        size_t batch_size = 1;
+        while (batch_size < requests.size()
+                 && requests[batch_size].logspace_id == logspace_id) {
+            batch_size++;
+        }
+        ProcessReadsFromDB(logspace_id, requests.first(batch_size));
+        batch_sizes.push_back(gsl::narrow_cast<uint16_t>(
+            std::min<size_t>(batch_size, std::numeric_limits<uint16_t>::max())));
+        requests = requests.subspan(batch_size);
+    }
+    absl::MutexLock lk(&db_read_mu_);
+    for (uint16_t batch_size : batch_sizes) {
+        db_read_batch_size_stat_.AddSample(batch_size);
+    }
+}
+
+void Storage::ProcessReadsFromDB(uint32_t logspace_id,
+                                 std::span<const SharedLogMessage> requests) {
+    // Log entries are looked up in log cache first, which is warmed up
+    // with hot keys after restart. Unless FLAGS_slog_storage_cache_fill_on_read
+    // is set, log entries read from DB are not put into log cache.
+    std::vector<size_t> db_read_indices;
+    std::vector<uint32_t> seqnum_lowhalves;
+    for (size_t i = 0; i < requests.size(); i++) {
+        const SharedLogMessage& request = requests[i];
+        DCHECK_EQ(request.logspace_id, logspace_id);
+        uint64_t seqnum = bits::JoinTwo32(logspace_id, request.seqnum_lowhalf);
+        RecordHotKey(seqnum);
+        std::optional<LogEntry> cached_log_entry = LogCacheGet(seqnum);
+        if (!cached_log_entry.has_value()) {
+            db_read_indices.push_back(i);
+            seqnum_lowhalves.push_back(request.seqnum_lowhalf);
+            continue;
+        }
+        SharedLogMessage response = SharedLogMessageHelper::NewReadOkResponse();
+        log_utils::PopulateMetaDataToMessage(cached_log_entry->metadata, &response);
+        DCHECK_EQ(response.logspace_id, request.logspace_id);
+        DCHECK_EQ(response.seqnum_lowhalf, request.seqnum_lowhalf);
+        response.user_metalog_progress = request.user_metalog_progress;
+        SendEngineLogResult(request, &response,
+                            VECTOR_AS_CHAR_SPAN(cached_log_entry->user_tags),
+                            STRING_AS_SPAN(cached_log_entry->data));
+    }
+    {
+        absl::MutexLock lk(&db_read_mu_);
+        if (db_read_indices.size() < requests.size()) {
+            cache_lookup_stat_.Tick(kCacheHit,
+                                    static_cast<int>(requests.size() - db_read_indices.size()));
+        }
+        if (!db_read_indices.empty()) {
+            cache_lookup_stat_.Tick(kCacheMiss, static_cast<int>(db_read_indices.size()));
+        }
+    }
+    if (db_read_indices.empty()) {
+        return;
+    }
+    std::vector<bool> found(db_read_indices.size(), false);
+    bool fill_cache = absl::GetFlag(FLAGS_slog_storage_cache_fill_on_read);
+    // Log data is copied only once, from the DB into the outgoing message
+    ReadLogEntriesFromDB(
+        logspace_id, seqnum_lowhalves,
+        [this, requests, fill_cache, &db_read_indices, &found] (
+                size_t index, const LogMetaData& metadata,
+                std::span<const uint64_t> user_tags, std::span<const char> log_data) {
+            const SharedLogMessage& request = requests[db_read_indices[index]];
+            found[index] = true;
+            if (fill_cache) {
+                LogCachePut(metadata, user_tags, log_data);
+            }
+            SharedLogMessage response = SharedLogMessageHelper::NewReadOkResponse();
+            log_utils::PopulateMetaDataToMessage(metadata, &response);
+            DCHECK_EQ(response.logspace_id, request.logspace_id);
+            DCHECK_EQ(response.seqnum_lowhalf, request.seqnum_lowhalf);
+            response.user_metalog_progress = request.user_metalog_progress;
+            std::span<const char> user_tags_data(
+                reinterpret_cast<const char*>(user_tags.data()),
+                user_tags.size() * sizeof(uint64_t));
+            SendEngineLogResult(request, &response, user_tags_data, log_data);
+        }
+    );
+    for (size_t i = 0; i < db_read_indices.size(); i++) {
+        if (found[i]) {
+            continue;
+        }
+        const SharedLogMessage& request = requests[db_read_indices[i]];
+        if (HoldReadForBulkSync(request)) {
+            continue;
+        }
+        HLOG_F(ERROR, "Failed to read log data (seqnum={})",
+               bits::HexStr0x(bits::JoinTwo32(request.logspace_id, request.seqnum_lowhalf)));
         SharedLogMessage response = SharedLogMessageHelper::NewDataLostResponse();
         SendEngineResponse(request, &response);
-        return;
     }
-    SharedLogMessage response = SharedLogMessageHelper::NewReadOkResponse();
-    log_utils::PopulateMetaDataToMessage(log_entry, &response);
-    DCHECK_EQ(response.logspace_id, request.logspace_id);
-    DCHECK_EQ(response.seqnum_lowhalf, request.seqnum_lowhalf);
-    response.user_metalog_progress = request.user_metalog_progress;
-    std::span<const char> user_tags_data(
-        reinterpret_cast<const char*>(log_entry.user_tags().data()),
-        static_cast<size_t>(log_entry.user_tags().size()) * sizeof(uint64_t));
-    SendEngineLogResult(request, &response, user_tags_data,
-                        STRING_AS_SPAN(log_entry.data()));
 }
 
 void Storage::ProcessRequests(const std::vector<SharedLogRequest>& requests) {
@@ -297,28 +572,6 @@ void Storage::SendEngineLogResult(const protocol::SharedLogMessage& request,
     SendEngineResponse(request, response, tags_data, log_data, aux_data);
 }
 
-void Storage::BackgroundThreadMain() {
-    int timerfd = io_utils::CreateTimerFd();
-    CHECK(timerfd != -1) << "Failed to create timerfd";
-    io_utils::FdUnsetNonblocking(timerfd);
-    absl::Duration interval = absl::Milliseconds(
-        absl::GetFlag(FLAGS_slog_storage_bgthread_interval_ms));
-    CHECK(io_utils::SetupTimerFdPeriodic(timerfd, absl::Milliseconds(100), interval))
-        << "Failed to setup timerfd with interval " << interval;
-    bool running = true;
-    while (running) {
-        uint64_t exp;
-        ssize_t nread = read(timerfd, &exp, sizeof(uint64_t));
-        if (nread < 0) {
-            PLOG(FATAL) << "Failed to read on timerfd";
-        }
-        CHECK_EQ(gsl::narrow_cast<size_t>(nread), sizeof(uint64_t));
-        FlushLogEntries();
-        // TODO: cleanup outdated LogSpace
-        running = state_.load(std::memory_order_acquire) != kStopping;
-    }
-}
-
 void Storage::SendShardProgressIfNeeded() {
     std::vector<std::pair<uint32_t, std::vector<uint32_t>>> progress_to_send;
     {
@@ -348,46 +601,449 @@ void Storage::SendShardProgressIfNeeded() {
     }
 }
 
-void Storage::FlushLogEntries() {
-    std::vector<std::shared_ptr<const LogEntry>> log_entires;
-    std::vector<std::pair<LockablePtr<LogStorage>, uint64_t>> storages;
+void Storage::TierColdLogEntries() {
+    // Only log entries persisted long ago are tiered, as they are unlikely
+    // to be read, and never changed once persisted
+    std::vector<std::pair</* logspace_id */ uint32_t, /* position */ uint32_t>> positions;
     {
         absl::ReaderMutexLock view_lk(&view_mu_);
-        storage_collection_.ForEachActiveLogSpace(
-            [&log_entires, &storages] (uint32_t logspace_id,
-                                       LockablePtr<LogStorage> storage_ptr) {
-                auto locked_storage = storage_ptr.ReaderLock();
-                std::vector<std::shared_ptr<const LogEntry>> tmp;
-                uint64_t new_position;
-                if (locked_storage->GrabLogEntriesForPersistence(&tmp, &new_position)) {
-                    storages.emplace_back(storage_ptr, new_position);
-                    log_entires.insert(log_entires.end(), tmp.begin(), tmp.end());
+        auto collect_fn = [&positions] (uint32_t logspace_id,
+                                        LockablePtr<LogStorage> storage_ptr) {
+            auto locked_storage = storage_ptr.ReaderLock();
+            if (locked_storage->durability() != LogStorage::kMemoryOnly) {
+                positions.emplace_back(
+                    logspace_id,
+                    bits::LowHalf64(locked_storage->persisted_seqnum_position()));
+            }
+        };
+        storage_collection_.ForEachActiveLogSpace(collect_fn);
+        storage_collection_.ForEachFinalizedLogSpace(collect_fn);
+    }
+    size_t keep_entries = absl::GetFlag(FLAGS_slog_storage_tiering_keep_entries);
+    size_t segment_entries = absl::GetFlag(FLAGS_slog_storage_tiering_segment_entries);
+    for (const auto& [logspace_id, persisted_position] : positions) {
+        if (persisted_position <= keep_entries) {
+            continue;
+        }
+        uint32_t tier_end = gsl::narrow_cast<uint32_t>(persisted_position - keep_entries);
+        uint32_t start = GetArchivedPosition(logspace_id);
+        while (start + segment_entries <= tier_end) {
+            if (state_.load(std::memory_order_acquire) == kStopping) {
+                return;
+            }
+            uint32_t end = gsl::narrow_cast<uint32_t>(start + segment_entries);
+            if (!TierLogEntries(logspace_id, start, end)) {
+                break;
+            }
+            start = end;
+        }
+    }
+}
+
+void Storage::HandleBulkSyncRequest(const SharedLogMessage& request) {
+    DCHECK(SharedLogMessageHelper::GetOpType(request) == SharedLogOpType::BULK_SYNC);
+    uint32_t logspace_id = request.logspace_id;
+    std::optional<uint64_t> persisted_position;
+    {
+        absl::ReaderMutexLock view_lk(&view_mu_);
+        auto storage_ptr = storage_collection_.GetLogSpace(logspace_id);
+        if (storage_ptr != nullptr) {
+            auto locked_storage = storage_ptr.ReaderLock();
+            if (locked_storage->durability() != LogStorage::kMemoryOnly) {
+                persisted_position = locked_storage->persisted_seqnum_position();
+            }
+        }
+    }
+    if (!persisted_position.has_value()) {
+        HLOG_F(WARNING, "Cannot serve bulk sync of log space {}", bits::HexStr0x(logspace_id));
+        SharedLogMessage response = SharedLogMessageHelper::NewDataLostResponse();
+        response.logspace_id = logspace_id;
+        response.source_engine_id = request.source_engine_id;
+        response.query_seqnum = request.query_seqnum;
+        response.client_data = request.client_data;
+        SendStorageMessage(request.origin_node_id, &response, EMPTY_CHAR_SPAN);
+        return;
+    }
+    uint32_t start = bits::LowHalf64(request.query_seqnum);
+    uint32_t end = std::max(start, std::min(bits::LowHalf64(request.end_seqnum),
+                                            bits::LowHalf64(*persisted_position)));
+    std::string payload;
+    uint32_t count = 0;
+    if (start < end) {
+        ScanLogEntriesFromDB(
+            logspace_id, start, end,
+            [&request, &payload, &count] (uint32_t seqnum_lowhalf,
+                                          std::span<const char> data) {
+                LogMetaData metadata;
+                UserTagVec user_tags;
+                std::span<const char> log_data;
+                if (!log_utils::ParseLogEntryInPlace(data, &metadata, &user_tags, &log_data)) {
+                    LOG(FATAL) << "Failed to parse LogEntryProto";
+                }
+                if (bits::HighHalf64(metadata.localid) != request.source_engine_id) {
+                    return;
                 }
+                uint32_t size = gsl::narrow_cast<uint32_t>(data.size());
+                payload.append(reinterpret_cast<const char*>(&seqnum_lowhalf), sizeof(uint32_t));
+                payload.append(reinterpret_cast<const char*>(&size), sizeof(uint32_t));
+                payload.append(data.data(), data.size());
+                count++;
             }
         );
     }
+    SharedLogMessage response = SharedLogMessageHelper::NewResponse(
+        protocol::SharedLogResultType::BULK_SYNC_OK);
+    response.logspace_id = logspace_id;
+    response.source_engine_id = request.source_engine_id;
+    response.query_seqnum = request.query_seqnum;
+    response.end_seqnum = bits::JoinTwo32(logspace_id, end);
+    response.persisted_seqnum = *persisted_position;
+    response.count = count;
+    response.client_data = request.client_data;
+    SendStorageMessage(request.origin_node_id, &response, STRING_AS_SPAN(payload));
+}
+
+void Storage::OnRecvBulkSyncResponse(const SharedLogMessage& message,
+                                     std::span<const char> payload) {
+    DCHECK(SharedLogMessageHelper::GetOpType(message) == SharedLogOpType::RESPONSE);
+    uint32_t logspace_id = message.logspace_id;
+    uint32_t start = bits::LowHalf64(message.query_seqnum);
+    bool success = SharedLogMessageHelper::GetResultType(message)
+                       == protocol::SharedLogResultType::BULK_SYNC_OK;
+    // Verify the payload holds all log entries counted by the source storage
+    std::vector<BulkSyncPlanner::Entry> entries;
+    if (success && !BulkSyncPlanner::ParsePayload(payload, message.count, &entries)) {
+        HLOG_F(ERROR, "Corrupted bulk sync response of log space {}",
+               bits::HexStr0x(logspace_id));
+        success = false;
+    }
+    if (success) {
+        for (const auto& [seqnum_lowhalf, data] : entries) {
+            PutSerializedLogEntryToDB(logspace_id, seqnum_lowhalf, data);
+        }
+    }
+    {
+        absl::MutexLock lk(&bulk_sync_mu_);
+        if (!bulk_sync_.has_value() || message.client_data >= bulk_sync_->num_tasks()) {
+            HLOG(ERROR) << "Unknown bulk sync task: " << message.client_data;
+            return;
+        }
+        size_t task_idx = gsl::narrow_cast<size_t>(message.client_data);
+        if (!success) {
+            bulk_sync_->OnChunkFailed(task_idx, message.origin_node_id, start,
+                                      GetMonotonicMicroTimestamp());
+        } else if (bulk_sync_->OnChunkReceived(task_idx, start,
+                                               bits::LowHalf64(message.end_seqnum),
+                                               bits::LowHalf64(message.persisted_seqnum),
+                                               entries.size())) {
+            if (!payload.empty()) {
+                bulk_sync_bytes_ += payload.size();
+                bulk_sync_bytes_counter_.Tick(gsl::narrow_cast<int>(payload.size()));
+            }
+        }
+        FinishBulkSyncIfDone();
+    }
+    IssueBulkSyncRequestsIfNeeded();
+}
+
+void Storage::AddBulkSyncTasks(const View* view) {
+    const View::Storage* storage_node = view->GetStorageNode(my_node_id());
+    absl::MutexLock lk(&bulk_sync_mu_);
+    if (!bulk_sync_.has_value()) {
+        HLOG(INFO) << "Start bulk sync";
+        bulk_sync_.emplace(
+            absl::GetFlag(FLAGS_slog_storage_bulk_sync_chunk_entries),
+            absl::GetFlag(FLAGS_slog_storage_bulk_sync_max_retries),
+            int64_t{absl::GetFlag(FLAGS_slog_storage_bulk_sync_retry_interval_ms)} * 1000,
+            int64_t{absl::GetFlag(FLAGS_slog_storage_bulk_sync_request_timeout_ms)} * 1000);
+        bulk_sync_start_timestamp_ = GetMonotonicMicroTimestamp();
+    }
+    for (uint16_t sequencer_id : view->GetSequencerNodes()) {
+        if (!view->is_active_phylog(sequencer_id)
+                || GetDurability(sequencer_id) == LogStorage::kMemoryOnly) {
+            continue;
+        }
+        uint32_t logspace_id = bits::JoinTwo16(view->id(), sequencer_id);
+        for (uint16_t engine_id : storage_node->GetSourceEngineNodes()) {
+            std::vector<uint16_t> source_storages;
+            for (uint16_t storage_id : view->GetEngineNode(engine_id)->GetStorageNodes()) {
+                if (storage_id != my_node_id()) {
+                    source_storages.push_back(storage_id);
+                }
+            }
+            if (source_storages.empty()) {
+                HLOG_F(WARNING, "No other storage node stores log entries of log space {} "
+                                "from engine {}", bits::HexStr0x(logspace_id), engine_id);
+                continue;
+            }
+            bulk_sync_->AddTask(logspace_id, engine_id, std::move(source_storages));
+        }
+    }
+    // In case there is nothing to copy
+    FinishBulkSyncIfDone();
+}
 
-    if (log_entires.empty()) {
+void Storage::IssueBulkSyncRequestsIfNeeded() {
+    if (bulk_sync_done_.load(std::memory_order_acquire)) {
         return;
     }
-    HVLOG_F(1, "Will flush {} log entries", log_entires.size());
-    for (size_t i = 0; i < log_entires.size(); i++) {
-        PutLogEntryToDB(*log_entires[i]);
+    size_t parallelism = absl::GetFlag(FLAGS_slog_storage_bulk_sync_parallelism);
+    int64_t rate = int64_t{absl::GetFlag(FLAGS_slog_storage_bulk_sync_rate_mb)} << 20;
+    std::vector<BulkSyncPlanner::Request> requests;
+    {
+        absl::MutexLock lk(&bulk_sync_mu_);
+        if (!bulk_sync_.has_value()) {
+            return;
+        }
+        int64_t now = GetMonotonicMicroTimestamp();
+        // Expired chunks are requested again below, unless their task fails
+        if (bulk_sync_->ExpireChunks(now) > 0) {
+            FinishBulkSyncIfDone();
+        }
+        // Requests are issued while received bytes stay within the bandwidth
+        int64_t elapsed = now - bulk_sync_start_timestamp_;
+        auto within_rate = [&, this] () ABSL_EXCLUSIVE_LOCKS_REQUIRED(bulk_sync_mu_) {
+            return rate == 0 || static_cast<double>(bulk_sync_bytes_)
+                                    <= static_cast<double>(rate) * elapsed * 1e-6;
+        };
+        while (bulk_sync_->num_inflight() < parallelism && within_rate()) {
+            auto request = bulk_sync_->NextRequest(now);
+            if (!request.has_value()) {
+                break;
+            }
+            requests.push_back(*request);
+        }
+    }
+    for (const BulkSyncPlanner::Request& request : requests) {
+        SharedLogMessage message = SharedLogMessageHelper::NewBulkSyncMessage(
+            request.logspace_id, request.engine_id, request.start, request.end);
+        message.client_data = request.task_idx;
+        if (!SendStorageMessage(request.storage_id, &message, EMPTY_CHAR_SPAN)) {
+            absl::MutexLock lk(&bulk_sync_mu_);
+            bulk_sync_->OnChunkFailed(request.task_idx, request.storage_id, request.start,
+                                      GetMonotonicMicroTimestamp());
+            FinishBulkSyncIfDone();
+        }
     }
+}
 
+void Storage::FinishBulkSyncIfDone() {
+    if (!bulk_sync_.has_value() || bulk_sync_done_.load(std::memory_order_relaxed)) {
+        return;
+    }
+    absl::flat_hash_map</* logspace_id */ uint32_t, uint32_t> synced_positions;
+    size_t num_entries;
+    BulkSyncPlanner::Status status = bulk_sync_->CheckStatus(&synced_positions, &num_entries);
+    if (status == BulkSyncPlanner::kInProgress) {
+        return;
+    }
+    std::vector<SharedLogMessage> held_reads = std::move(bulk_sync_held_reads_);
+    bulk_sync_held_reads_.clear();
+    bulk_sync_done_.store(true, std::memory_order_release);
+    if (status == BulkSyncPlanner::kFailed) {
+        HLOG_F(ERROR, "Bulk sync failed, this node misses log entries it should hold. "
+                      "{} held reads fail with DATA_LOST", held_reads.size());
+        SomeIOWorker()->ScheduleFunction(
+            nullptr, [this, requests = std::move(held_reads)] () {
+                for (const SharedLogMessage& request : requests) {
+                    SharedLogMessage response = SharedLogMessageHelper::NewDataLostResponse();
+                    SendEngineResponse(request, &response);
+                }
+            }
+        );
+        return;
+    }
+    {
+        absl::ReaderMutexLock view_lk(&view_mu_);
+        for (const auto& [logspace_id, position] : synced_positions) {
+            auto storage_ptr = storage_collection_.GetLogSpace(logspace_id);
+            if (storage_ptr != nullptr) {
+                auto locked_storage = storage_ptr.Lock();
+                locked_storage->LogEntriesPersisted(bits::JoinTwo32(logspace_id, position));
+            }
+        }
+    }
+    double elapsed = (GetMonotonicMicroTimestamp() - bulk_sync_start_timestamp_) * 1e-6;
+    HLOG_F(INFO, "Bulk sync finished: {} log entries of {} log spaces, {} bytes in {:.3f}s, "
+                 "{:.1f} MB/s", num_entries, synced_positions.size(), bulk_sync_bytes_,
+           elapsed, bulk_sync_bytes_ / std::max(elapsed, 1e-6) / (1 << 20));
+    if (!held_reads.empty()) {
+        HLOG_F(INFO, "Retry {} reads held during bulk sync", held_reads.size());
+        SomeIOWorker()->ScheduleFunction(
+            nullptr, [this, requests = std::move(held_reads)] () {
+                for (const SharedLogMessage& request : requests) {
+                    HandleReadAtRequest(request);
+                }
+            }
+        );
+    }
+}
+
+bool Storage::HoldReadForBulkSync(const SharedLogMessage& request) {
+    if (bulk_sync_done_.load(std::memory_order_acquire)) {
+        return false;
+    }
+    absl::MutexLock lk(&bulk_sync_mu_);
+    // Checked again, as held reads are released when bulk sync finishes
+    if (bulk_sync_done_.load(std::memory_order_relaxed)
+            || !bulk_sync_.has_value() || !bulk_sync_->HasLogSpace(request.logspace_id)) {
+        return false;
+    }
+    bulk_sync_held_reads_.push_back(request);
+    return true;
+}
+
+Storage::FlushWorker* Storage::GetFlushWorker(uint32_t logspace_id) {
+    size_t idx = hash::xxHash64(logspace_id) % flush_workers_.size();
+    return flush_workers_[idx].get();
+}
+
+void Storage::NotifyFlushWorker(uint32_t logspace_id) {
+    FlushWorker* worker = GetFlushWorker(logspace_id);
+    int64_t now = GetMonotonicMicroTimestamp();
+    absl::MutexLock lk(&worker->mu);
+    if (worker->ready_logspaces.try_emplace(logspace_id, now).second) {
+        worker->cv.Signal();
+    }
+}
+
+void Storage::StopFlushWorkers() {
+    for (const auto& worker : flush_workers_) {
+        absl::MutexLock lk(&worker->mu);
+        worker->stopped = true;
+        worker->cv.Signal();
+    }
+}
+
+void Storage::FlushWorkerMain(size_t worker_id) {
+    FlushWorker* worker = flush_workers_.at(worker_id).get();
+    // Log spaces with log entries waiting for group commits
+    std::vector<uint32_t> unsynced_logspaces;
+    int64_t next_sync_deadline = std::numeric_limits<int64_t>::max();
+    while (true) {
+        absl::flat_hash_map<uint32_t, int64_t> ready_logspaces;
+        {
+            absl::MutexLock lk(&worker->mu);
+            while (!worker->stopped && worker->ready_logspaces.empty()) {
+                if (unsynced_logspaces.empty()) {
+                    worker->cv.Wait(&worker->mu);
+                    continue;
+                }
+                int64_t now = GetMonotonicMicroTimestamp();
+                if (now >= next_sync_deadline) {
+                    break;
+                }
+                worker->cv.WaitWithTimeout(&worker->mu,
+                                           absl::Microseconds(next_sync_deadline - now));
+            }
+            if (worker->stopped) {
+                break;
+            }
+            ready_logspaces.swap(worker->ready_logspaces);
+        }
+        std::vector<uint32_t> logspaces = std::move(unsynced_logspaces);
+        for (const auto& [logspace_id, timestamp] : ready_logspaces) {
+            if (absl::c_find(logspaces, logspace_id) == logspaces.end()) {
+                logspaces.push_back(logspace_id);
+            }
+        }
+        StorageVec storages;
+        {
+            absl::ReaderMutexLock view_lk(&view_mu_);
+            for (uint32_t logspace_id : logspaces) {
+                auto storage_ptr = storage_collection_.GetLogSpace(logspace_id);
+                if (storage_ptr != nullptr) {
+                    storages.emplace_back(logspace_id, std::move(storage_ptr));
+                }
+            }
+        }
+        unsynced_logspaces.clear();
+        next_sync_deadline = std::numeric_limits<int64_t>::max();
+        for (auto& [logspace_id, storage_ptr] : storages) {
+            if (storage_ptr.ReaderLock()->durability() != LogStorage::kFsyncGroupCommit) {
+                continue;
+            }
+            std::optional<int64_t> deadline = SyncLogEntries(worker, logspace_id, storage_ptr);
+            if (deadline.has_value()) {
+                unsynced_logspaces.push_back(logspace_id);
+                next_sync_deadline = std::min(next_sync_deadline, *deadline);
+            }
+            // After SyncLogEntries, as this worker may have synced some of them
+            std::vector<uint64_t> discarded_localids;
+            storage_ptr.Lock()->PollDiscardedPendingLocalids(&discarded_localids);
+            if (!discarded_localids.empty()) {
+                HVLOG_F(1, "Delete {} discarded pending log entries of log space {}",
+                        discarded_localids.size(), bits::HexStr0x(logspace_id));
+                DeletePendingLogEntriesFromDB(logspace_id, VECTOR_AS_SPAN(discarded_localids));
+            }
+        }
+        FlushLogEntries(worker, storages, ready_logspaces);
+    }
+}
+
+void Storage::FlushLogEntries(FlushWorker* worker, const StorageVec& storages,
+                              const absl::flat_hash_map<uint32_t, int64_t>& ready_timestamps) {
     std::vector<uint32_t> finalized_logspaces;
-    for (auto& [storage_ptr, new_position] : storages) {
-        auto locked_storage = storage_ptr.Lock();
-        locked_storage->LogEntriesPersisted(new_position);
-        if (locked_storage->finalized()
-                && new_position >= locked_storage->seqnum_position()) {
-            finalized_logspaces.push_back(locked_storage->identifier());
+    std::vector<std::shared_ptr<const LogEntry>> log_entries;
+    for (auto [logspace_id, storage_ptr] : storages) {
+        uint64_t new_position;
+        LogStorage::Durability durability;
+        {
+            auto locked_storage = storage_ptr.ReaderLock();
+            if (!locked_storage->GrabLogEntriesForPersistence(&log_entries, &new_position)) {
+                continue;
+            }
+            durability = locked_storage->durability();
+        }
+        HVLOG_F(1, "Will flush {} log entries of log space {}",
+                log_entries.size(), bits::HexStr0x(logspace_id));
+        int64_t start_timestamp = GetMonotonicMicroTimestamp();
+        switch (durability) {
+        case LogStorage::kMemoryOnly:
+            // Not written to DB, but can be trimmed from now on
+            break;
+        case LogStorage::kAsyncFlush:
+            for (const auto& log_entry : log_entries) {
+                PutLogEntryToDB(*log_entry);
+            }
+            worker->async_flush_time_stat.AddSample(gsl::narrow_cast<int32_t>(
+                GetMonotonicMicroTimestamp() - start_timestamp));
+            break;
+        case LogStorage::kFsyncGroupCommit:
+            // Synced log entries are already durable, thus written without sync,
+            // after which their copies under localids are no longer needed
+            for (const auto& log_entry : log_entries) {
+                PutLogEntryToDB(*log_entry);
+                DeletePendingLogEntryFromDB(*log_entry);
+            }
+            break;
+        default:
+            UNREACHABLE();
+        }
+        {
+            auto locked_storage = storage_ptr.Lock();
+            locked_storage->LogEntriesPersisted(new_position);
+            if (locked_storage->finalized()
+                    && new_position >= locked_storage->seqnum_position()) {
+                finalized_logspaces.push_back(logspace_id);
+            }
+        }
+        if (ready_timestamps.contains(logspace_id)) {
+            auto& flush_lag_stat = worker->flush_lag_stats[logspace_id];
+            if (flush_lag_stat == nullptr) {
+                flush_lag_stat.reset(new stat::StatisticsCollector<int32_t>(
+                    stat::StatisticsCollector<int32_t>::StandardReportCallback(
+                        fmt::format("storage_flush_lag[{}]", bits::HexStr0x(logspace_id)))));
+            }
+            flush_lag_stat->AddSample(gsl::narrow_cast<int32_t>(
+                GetMonotonicMicroTimestamp() - ready_timestamps.at(logspace_id)));
         }
     }
 
     if (!finalized_logspaces.empty()) {
         absl::MutexLock view_lk(&view_mu_);
         for (uint32_t logspace_id : finalized_logspaces) {
+            worker->flush_lag_stats.erase(logspace_id);
             if (storage_collection_.FinalizeLogSpace(logspace_id)) {
                 HLOG_F(INFO, "Finalize storage log space {}", bits::HexStr0x(logspace_id));
             } else {
@@ -398,5 +1054,35 @@ void Storage::FlushLogEntries() {
     }
 }
 
+std::optional<int64_t> Storage::SyncLogEntries(FlushWorker* worker, uint32_t logspace_id,
+                                               LockablePtr<LogStorage> storage_ptr) {
+    std::vector<std::shared_ptr<const LogEntry>> log_entries;
+    int64_t oldest_timestamp;
+    while (true) {
+        {
+            auto locked_storage = storage_ptr.Lock();
+            if (!locked_storage->GrabLogEntriesForSync(&log_entries, &oldest_timestamp)) {
+                return locked_storage->NextGroupCommitDeadline();
+            }
+        }
+        HVLOG_F(1, "Will sync {} log entries of log space {}",
+                log_entries.size(), bits::HexStr0x(logspace_id));
+        PutPendingLogEntriesToDB(logspace_id, log_entries, /* sync= */ true);
+        {
+            auto locked_storage = storage_ptr.Lock();
+            locked_storage->LogEntriesSynced(log_entries);
+        }
+        worker->fsync_commit_delay_stat.AddSample(gsl::narrow_cast<int32_t>(
+            GetMonotonicMicroTimestamp() - oldest_timestamp));
+    }
+}
+
+LogStorage::Durability Storage::GetDurability(uint16_t sequencer_id) const {
+    if (phylog_durability_.contains(sequencer_id)) {
+        return phylog_durability_.at(sequencer_id);
+    }
+    return default_durability_;
+}
+
 }  // namespace log
 }  // namespace faas
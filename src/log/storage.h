@@ -1,7 +1,9 @@
 #pragma once
 
+#include "common/stat.h"
 #include "log/storage_base.h"
 #include "log/log_space.h"
+#include "log/bulk_sync.h"
 #include "log/utils.h"
 
 namespace faas {
@@ -23,6 +25,56 @@ private:
 
     log_utils::FutureRequests future_requests_;
 
+    LogStorage::Durability default_durability_;
+    absl::flat_hash_map</* sequencer_id */ uint16_t,
+                        LogStorage::Durability> phylog_durability_;
+
+    absl::Mutex db_read_mu_;
+    // Reads from DB wait until the end of the event loop iteration of their
+    // IO worker, and are then issued in batches for each log space
+    absl::flat_hash_map<server::IOWorker*,
+                        std::vector<protocol::SharedLogMessage>>
+        pending_db_reads_ ABSL_GUARDED_BY(db_read_mu_);
+    stat::StatisticsCollector<uint16_t> db_read_batch_size_stat_ ABSL_GUARDED_BY(db_read_mu_);
+    // Reported periodically, showing how hit rate evolves after cache warmup
+    enum CacheLookupResult { kCacheHit = 0, kCacheMiss = 1 };
+    stat::CategoryCounter cache_lookup_stat_ ABSL_GUARDED_BY(db_read_mu_);
+
+    struct FlushWorker {
+        absl::Mutex   mu;
+        absl::CondVar cv;
+        bool          stopped ABSL_GUARDED_BY(mu);
+        // Log spaces with new log entries to sync or flush, and the time
+        // they were first notified
+        absl::flat_hash_map</* logspace_id */ uint32_t, /* timestamp */ int64_t>
+            ready_logspaces ABSL_GUARDED_BY(mu);
+
+        // Only touched by the worker thread
+        stat::StatisticsCollector<int32_t> async_flush_time_stat;
+        stat::StatisticsCollector<int32_t> fsync_commit_delay_stat;
+        absl::flat_hash_map</* logspace_id */ uint32_t,
+                            std::unique_ptr<stat::StatisticsCollector<int32_t>>>
+            flush_lag_stats;
+
+        explicit FlushWorker(size_t worker_id);
+    };
+    // Log spaces are assigned to flush workers by hash, see GetFlushWorker
+    absl::FixedArray<std::unique_ptr<FlushWorker>> flush_workers_;
+
+    // Bulk sync copies log entries of each source engine of each log space
+    // from another storage node also storing them, see FLAGS_slog_storage_bulk_sync.
+    // Meanwhile, reads missing log entries of synced log spaces are held
+    // until bulk sync finishes.
+    absl::Mutex bulk_sync_mu_;
+    // Set once bulk sync finishes, whether succeeded or failed
+    std::atomic<bool> bulk_sync_done_;
+    std::optional<BulkSyncPlanner> bulk_sync_    ABSL_GUARDED_BY(bulk_sync_mu_);
+    std::vector<protocol::SharedLogMessage>
+        bulk_sync_held_reads_                    ABSL_GUARDED_BY(bulk_sync_mu_);
+    size_t  bulk_sync_bytes_                     ABSL_GUARDED_BY(bulk_sync_mu_);
+    int64_t bulk_sync_start_timestamp_           ABSL_GUARDED_BY(bulk_sync_mu_);
+    stat::Counter bulk_sync_bytes_counter_       ABSL_GUARDED_BY(bulk_sync_mu_);
+
     void OnViewCreated(const View* view) override;
     void OnViewFinalized(const FinalizedView* finalized_view) override;
 
@@ -33,9 +85,21 @@ private:
                            std::span<const char> payload) override;
     void OnRecvLogAuxData(const protocol::SharedLogMessage& message,
                           std::span<const char> payload) override;
+    void OnRecvCheckpoint(const protocol::SharedLogMessage& message,
+                          std::span<const char> payload) override;
+    void HandleReadCheckpointRequest(const protocol::SharedLogMessage& request,
+                                     std::span<const char> payload) override;
+    // READ_CHECKPOINT with kQueueCursorFlag
+    void HandleReadQueueCursorRequest(const protocol::SharedLogMessage& request);
+    void HandleBulkSyncRequest(const protocol::SharedLogMessage& request) override;
+    void OnRecvBulkSyncResponse(const protocol::SharedLogMessage& message,
+                                std::span<const char> payload) override;
 
     void ProcessReadResults(const LogStorage::ReadResultVec& results);
     void ProcessReadFromDB(const protocol::SharedLogMessage& request);
+    void ProcessPendingDBReads(server::IOWorker* io_worker);
+    void ProcessReadsFromDB(uint32_t logspace_id,
+                            std::span<const protocol::SharedLogMessage> requests);
     void ProcessRequests(const std::vector<SharedLogRequest>& requests);
 
     void SendEngineLogResult(const protocol::SharedLogMessage& request,
@@ -43,9 +107,29 @@ private:
                              std::span<const char> tags_data,
                              std::span<const char> log_data);
 
-    void BackgroundThreadMain() override;
     void SendShardProgressIfNeeded() override;
-    void FlushLogEntries();
+    void TierColdLogEntries() override;
+
+    void AddBulkSyncTasks(const View* view);
+    void IssueBulkSyncRequestsIfNeeded() override;
+    void FinishBulkSyncIfDone() ABSL_EXCLUSIVE_LOCKS_REQUIRED(bulk_sync_mu_);
+    // Returns true if the read is held until bulk sync finishes
+    bool HoldReadForBulkSync(const protocol::SharedLogMessage& request);
+
+    FlushWorker* GetFlushWorker(uint32_t logspace_id);
+    void NotifyFlushWorker(uint32_t logspace_id);
+    void FlushWorkerMain(size_t worker_id) override;
+    void StopFlushWorkers() override;
+    using StorageVec = std::vector<std::pair</* logspace_id */ uint32_t,
+                                             LockablePtr<LogStorage>>>;
+    void FlushLogEntries(FlushWorker* worker, const StorageVec& storages,
+                         const absl::flat_hash_map<uint32_t, int64_t>& ready_timestamps);
+    // Returns the deadline of the next group commit, if some log entries
+    // are left not synced
+    std::optional<int64_t> SyncLogEntries(FlushWorker* worker, uint32_t logspace_id,
+                                          LockablePtr<LogStorage> storage_ptr);
+
+    LogStorage::Durability GetDurability(uint16_t sequencer_id) const;
 
     DISALLOW_COPY_AND_ASSIGN(Storage);
 };
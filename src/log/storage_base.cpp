@@ -1,8 +1,11 @@
 #include "log/storage_base.h"
 
+#include "common/time.h"
 #include "log/flags.h"
+#include "log/utils.h"
 #include "server/constants.h"
 #include "utils/fs.h"
+#include "utils/io.h"
 
 #define log_header_ "StorageBase: "
 
@@ -23,7 +26,23 @@ StorageBase::StorageBase(uint16_t node_id)
     : ServerBase(fmt::format("storage_{}", node_id)),
       node_id_(node_id),
       db_(nullptr),
-      background_thread_("BG", [this] { this->BackgroundThreadMain(); }) {}
+      hot_keys_thread_("HotKeys", absl::bind_front(&StorageBase::HotKeysThreadMain, this)),
+      tiering_thread_("Tiering", absl::bind_front(&StorageBase::TieringThreadMain, this)) {
+    int num_flush_workers = absl::GetFlag(FLAGS_slog_storage_flush_workers);
+    CHECK_GT(num_flush_workers, 0);
+    num_flush_workers_ = gsl::narrow_cast<size_t>(num_flush_workers);
+    size_t num_hot_keys = absl::GetFlag(FLAGS_slog_storage_hot_keys);
+    if (num_hot_keys > 0) {
+        size_t num_shards = gsl::narrow_cast<size_t>(
+            std::max(absl::GetFlag(FLAGS_num_io_workers), 1));
+        for (size_t i = 0; i < num_shards; i++) {
+            auto shard = std::make_unique<HotKeyShard>();
+            shard->keys.resize((num_hot_keys + num_shards - 1) / num_shards, 0);
+            shard->next = 0;
+            hot_key_shards_.push_back(std::move(shard));
+        }
+    }
+}
 
 StorageBase::~StorageBase() {}
 
@@ -32,11 +51,26 @@ void StorageBase::StartInternal() {
     SetupZKWatchers();
     SetupTimers();
     log_cache_.emplace(absl::GetFlag(FLAGS_slog_storage_cache_cap_mb));
-    background_thread_.Start();
+    for (size_t i = 0; i < num_flush_workers_; i++) {
+        auto thread = std::make_unique<base::Thread>(
+            fmt::format("Flush-{}", i), absl::bind_front(&StorageBase::FlushWorkerMain, this, i));
+        thread->Start();
+        flush_threads_.push_back(std::move(thread));
+    }
+    hot_keys_thread_.Start();
+    tiering_thread_.Start();
 }
 
 void StorageBase::StopInternal() {
-    background_thread_.Join();
+    StopFlushWorkers();
+    for (const auto& thread : flush_threads_) {
+        thread->Join();
+    }
+    hot_keys_stopped_.Notify();
+    hot_keys_thread_.Join();
+    DumpHotKeys();
+    tiering_stopped_.Notify();
+    tiering_thread_.Join();
 }
 
 void StorageBase::SetupDB() {
@@ -52,6 +86,11 @@ void StorageBase::SetupDB() {
     } else {
         HLOG(FATAL) << "Unknown storage backend: " << db_backend;
     }
+    std::string archive_dir = absl::GetFlag(FLAGS_slog_storage_archive_dir);
+    if (!archive_dir.empty()) {
+        archive_.reset(new LogArchive(archive_dir));
+        archive_->LoadSegments();
+    }
 }
 
 void StorageBase::SetupZKWatchers() {
@@ -64,6 +103,9 @@ void StorageBase::SetupZKWatchers() {
                     db_->InstallLogSpace(bits::JoinTwo16(view->id(), sequencer_id));
                 }
             }
+            if (!view_created_.HasBeenNotified()) {
+                view_created_.Notify();
+            }
         }
     );
     view_watcher_.SetViewFinalizedCallback(
@@ -80,6 +122,13 @@ void StorageBase::SetupTimers() {
         absl::Microseconds(absl::GetFlag(FLAGS_slog_local_cut_interval_us)),
         [this] () { this->SendShardProgressIfNeeded(); }
     );
+    if (absl::GetFlag(FLAGS_slog_storage_bulk_sync)) {
+        CreatePeriodicTimer(
+            kStorageBulkSyncTimerId,
+            absl::Milliseconds(10),
+            [this] () { this->IssueBulkSyncRequestsIfNeeded(); }
+        );
+    }
 }
 
 void StorageBase::MessageHandler(const SharedLogMessage& message,
@@ -97,6 +146,18 @@ void StorageBase::MessageHandler(const SharedLogMessage& message,
     case SharedLogOpType::SET_AUXDATA:
         OnRecvLogAuxData(message, payload);
         break;
+    case SharedLogOpType::SET_CHECKPOINT:
+        OnRecvCheckpoint(message, payload);
+        break;
+    case SharedLogOpType::READ_CHECKPOINT:
+        HandleReadCheckpointRequest(message, payload);
+        break;
+    case SharedLogOpType::BULK_SYNC:
+        HandleBulkSyncRequest(message);
+        break;
+    case SharedLogOpType::RESPONSE:
+        OnRecvBulkSyncResponse(message, payload);
+        break;
     default:
         UNREACHABLE();
     }
@@ -117,16 +178,68 @@ static inline std::string SerializedLogEntry(const LogEntry& log_entry) {
 }
 }  // namespace
 
-std::optional<LogEntryProto> StorageBase::GetLogEntryFromDB(uint64_t seqnum) {
-    auto data = db_->Get(bits::HighHalf64(seqnum), bits::LowHalf64(seqnum));
-    if (!data.has_value()) {
-        return std::nullopt;
+void StorageBase::ReadLogEntriesFromDB(uint32_t logspace_id,
+                                       std::span<const uint32_t> seqnum_lowhalves,
+                                       const LogEntryCallback& fn) {
+    auto parse_fn = [&fn] (size_t index, std::span<const char> data) {
+        LogMetaData metadata;
+        UserTagVec user_tags;
+        std::span<const char> log_data;
+        if (!log_utils::ParseLogEntryInPlace(data, &metadata, &user_tags, &log_data)) {
+            HLOG(FATAL) << "Failed to parse LogEntryProto";
+        }
+        fn(index, metadata, std::span<const uint64_t>(user_tags.data(), user_tags.size()),
+           log_data);
+    };
+    if (archive_ == nullptr) {
+        if (seqnum_lowhalves.size() == 1) {
+            db_->GetPinned(logspace_id, seqnum_lowhalves[0],
+                           [&parse_fn] (std::span<const char> data) { parse_fn(0, data); });
+        } else {
+            db_->MultiGetPinned(logspace_id, seqnum_lowhalves, parse_fn);
+        }
+        return;
     }
-    LogEntryProto log_entry_proto;
-    if (!log_entry_proto.ParseFromString(*data)) {
-        HLOG(FATAL) << "Failed to parse LogEntryProto";
+    absl::FixedArray<bool> found(seqnum_lowhalves.size(), false);
+    db_->MultiGetPinned(
+        logspace_id, seqnum_lowhalves,
+        [&parse_fn, &found] (size_t index, std::span<const char> data) {
+            found[index] = true;
+            parse_fn(index, data);
+        }
+    );
+    // Archive files are written before log entries are removed from DB,
+    // thus log entries missing in DB are either archived or never stored
+    for (size_t i = 0; i < seqnum_lowhalves.size(); i++) {
+        if (!found[i]) {
+            archive_->Get(logspace_id, seqnum_lowhalves[i],
+                          [&parse_fn, i] (std::span<const char> data) { parse_fn(i, data); });
+        }
+    }
+}
+
+void StorageBase::ScanLogEntriesFromDB(uint32_t logspace_id, uint32_t start, uint32_t end,
+                                       const SerializedLogEntryCallback& fn) {
+    DCHECK_LT(start, end);
+    std::vector<uint32_t> keys(end - start);
+    std::iota(keys.begin(), keys.end(), start);
+    absl::FixedArray<bool> found(keys.size(), false);
+    db_->MultiGetPinned(
+        logspace_id, keys,
+        [&keys, &fn, &found] (size_t index, std::span<const char> data) {
+            found[index] = true;
+            fn(keys[index], data);
+        }
+    );
+    if (archive_ == nullptr || start >= archive_->GetArchivedPosition(logspace_id)) {
+        return;
+    }
+    for (size_t i = 0; i < keys.size(); i++) {
+        if (!found[i]) {
+            archive_->Get(logspace_id, keys[i],
+                          [&keys, &fn, i] (std::span<const char> data) { fn(keys[i], data); });
+        }
     }
-    return log_entry_proto;
 }
 
 void StorageBase::PutLogEntryToDB(const LogEntry& log_entry) {
@@ -135,6 +248,83 @@ void StorageBase::PutLogEntryToDB(const LogEntry& log_entry) {
     db_->Put(bits::HighHalf64(seqnum), bits::LowHalf64(seqnum), STRING_AS_SPAN(data));
 }
 
+void StorageBase::PutSerializedLogEntryToDB(uint32_t logspace_id, uint32_t seqnum_lowhalf,
+                                            std::span<const char> data) {
+    db_->Put(logspace_id, seqnum_lowhalf, data);
+}
+
+void StorageBase::PutPendingLogEntriesToDB(
+        uint32_t logspace_id, std::span<const std::shared_ptr<const LogEntry>> log_entries,
+        bool sync) {
+    std::vector<std::pair<uint64_t, std::string>> entries;
+    entries.reserve(log_entries.size());
+    for (const auto& log_entry : log_entries) {
+        entries.emplace_back(log_entry->metadata.localid, SerializedLogEntry(*log_entry));
+    }
+    db_->PutPendingBatch(logspace_id, entries, sync);
+}
+
+void StorageBase::DeletePendingLogEntryFromDB(const LogEntry& log_entry) {
+    db_->DeletePending(bits::HighHalf64(log_entry.metadata.seqnum),
+                       log_entry.metadata.localid);
+}
+
+void StorageBase::DeletePendingLogEntriesFromDB(uint32_t logspace_id,
+                                                std::span<const uint64_t> localids) {
+    for (uint64_t localid : localids) {
+        db_->DeletePending(logspace_id, localid);
+    }
+}
+
+std::optional<std::string> StorageBase::GetCheckpointFromDB(uint32_t logspace_id,
+                                                            uint32_t user_logspace,
+                                                            uint64_t tag, uint64_t seqnum) {
+    return db_->GetCheckpoint(logspace_id, user_logspace, tag, seqnum);
+}
+
+void StorageBase::PutCheckpointToDB(uint32_t logspace_id, uint32_t user_logspace,
+                                    uint64_t tag, uint64_t seqnum,
+                                    std::span<const char> data) {
+    db_->PutCheckpoint(logspace_id, user_logspace, tag, seqnum, data);
+}
+
+std::optional<uint64_t> StorageBase::GetQueueCursorFromDB(uint32_t logspace_id,
+                                                          uint32_t user_logspace,
+                                                          uint64_t tag) {
+    return db_->GetQueueCursor(logspace_id, user_logspace, tag);
+}
+
+void StorageBase::PutQueueCursorsToDB(uint32_t logspace_id,
+                                      std::span<const uint64_t> cursors) {
+    DCHECK_EQ(cursors.size() % 3, 0U);
+    std::vector<uint64_t> new_cursors;
+    new_cursors.reserve(cursors.size());
+    absl::MutexLock lk(&queue_cursor_mu_);
+    for (size_t i = 0; i + 2 < cursors.size(); i += 3) {
+        auto stored = db_->GetQueueCursor(
+            logspace_id, gsl::narrow_cast<uint32_t>(cursors[i]), cursors[i + 1]);
+        if (stored.has_value() && *stored >= cursors[i + 2]) {
+            continue;
+        }
+        new_cursors.insert(new_cursors.end(), cursors.begin() + i, cursors.begin() + i + 3);
+    }
+    if (!new_cursors.empty()) {
+        db_->PutQueueCursors(logspace_id, VECTOR_AS_SPAN(new_cursors));
+    }
+}
+
+void StorageBase::LogCachePut(const LogMetaData& log_metadata,
+                              std::span<const uint64_t> user_tags,
+                              std::span<const char> log_data) {
+    if (log_cache_.has_value()) {
+        log_cache_->Put(log_metadata, user_tags, log_data);
+    }
+}
+
+std::optional<LogEntry> StorageBase::LogCacheGet(uint64_t seqnum) {
+    return log_cache_.has_value() ? log_cache_->Get(seqnum) : std::nullopt;
+}
+
 void StorageBase::LogCachePutAuxData(uint64_t seqnum, std::span<const char> data) {
     if (log_cache_.has_value()) {
         log_cache_->PutAuxData(seqnum, data);
@@ -145,17 +335,304 @@ std::optional<std::string> StorageBase::LogCacheGetAuxData(uint64_t seqnum) {
     return log_cache_.has_value() ? log_cache_->GetAuxData(seqnum) : std::nullopt;
 }
 
+void StorageBase::RecordHotKey(uint64_t seqnum) {
+    if (hot_key_shards_.empty()) {
+        return;
+    }
+    // Each thread sticks to one shard, thus IO workers get distinct shards
+    static std::atomic<size_t> next_thread_shard{0};
+    static thread_local size_t thread_shard = next_thread_shard.fetch_add(1);
+    HotKeyShard* shard = hot_key_shards_[thread_shard % hot_key_shards_.size()].get();
+    absl::MutexLock lk(&shard->mu);
+    shard->keys[shard->next++ % shard->keys.size()] = seqnum;
+}
+
+std::string StorageBase::GetHotKeysFilePath() const {
+    return fs_utils::JoinPath(db_path_, "hot_keys");
+}
+
+void StorageBase::DumpHotKeys() {
+    // Shards are copied out one by one, then interleaved, so that recently
+    // read keys of all shards come first, without duplicates
+    std::vector<std::vector<uint64_t>> shard_keys;
+    for (const auto& shard : hot_key_shards_) {
+        std::vector<uint64_t> keys;
+        {
+            absl::MutexLock lk(&shard->mu);
+            size_t num_keys = std::min(shard->next, shard->keys.size());
+            keys.reserve(num_keys);
+            for (size_t i = 1; i <= num_keys; i++) {
+                keys.push_back(shard->keys[(shard->next - i) % shard->keys.size()]);
+            }
+        }
+        shard_keys.push_back(std::move(keys));
+    }
+    std::vector<uint64_t> seqnums;
+    absl::flat_hash_set<uint64_t> dumped;
+    for (size_t i = 0; ; i++) {
+        bool has_more = false;
+        for (const std::vector<uint64_t>& keys : shard_keys) {
+            if (i >= keys.size()) {
+                continue;
+            }
+            has_more = true;
+            if (dumped.insert(keys[i]).second) {
+                seqnums.push_back(keys[i]);
+            }
+        }
+        if (!has_more) {
+            break;
+        }
+    }
+    if (seqnums.empty()) {
+        return;
+    }
+    // Written to a temporary file first, so that a crash never leaves a
+    // partially written file
+    std::string file_path = GetHotKeysFilePath();
+    std::string tmp_file_path = file_path + ".tmp";
+    auto fd = fs_utils::Create(tmp_file_path);
+    if (!fd.has_value()) {
+        HLOG_F(ERROR, "Failed to create hot keys file {}", tmp_file_path);
+        return;
+    }
+    bool success = io_utils::WriteData(*fd, VECTOR_AS_CHAR_SPAN(seqnums));
+    PCHECK(close(*fd) == 0) << "Failed to close file";
+    if (!success || rename(tmp_file_path.c_str(), file_path.c_str()) != 0) {
+        PLOG_F(ERROR, "Failed to write hot keys file {}", file_path);
+        return;
+    }
+    HVLOG_F(1, "Dump {} hot keys", seqnums.size());
+}
+
+void StorageBase::HotKeysThreadMain() {
+    if (hot_key_shards_.empty()) {
+        return;
+    }
+    WarmupLogCache();
+    // Dumping hot keys writes a file, thus not done on IO workers
+    int dump_interval_s = absl::GetFlag(FLAGS_slog_storage_hot_keys_dump_interval_s);
+    if (dump_interval_s <= 0) {
+        return;
+    }
+    while (!hot_keys_stopped_.WaitForNotificationWithTimeout(absl::Seconds(dump_interval_s))) {
+        DumpHotKeys();
+    }
+}
+
+void StorageBase::WarmupLogCache() {
+    std::string file_path = GetHotKeysFilePath();
+    if (!fs_utils::Exists(file_path)) {
+        return;
+    }
+    std::string contents;
+    if (!fs_utils::ReadContents(file_path, &contents)
+            || contents.size() % sizeof(uint64_t) != 0) {
+        HLOG_F(ERROR, "Invalid hot keys file {}", file_path);
+        return;
+    }
+    std::vector<uint64_t> seqnums(contents.size() / sizeof(uint64_t));
+    memcpy(seqnums.data(), contents.data(), contents.size());
+    // Log spaces are installed into DB when views are created
+    while (!view_created_.WaitForNotificationWithTimeout(absl::Milliseconds(100))) {
+        if (state_.load(std::memory_order_acquire) == kStopping) {
+            return;
+        }
+    }
+    HLOG_F(INFO, "Start warming up log cache with {} hot keys", seqnums.size());
+    int rate = absl::GetFlag(FLAGS_slog_storage_warmup_rate);
+    int64_t start_timestamp = GetMonotonicMicroTimestamp();
+    size_t num_loaded = 0;
+    size_t num_skipped = 0;
+    constexpr size_t kBatchSize = 64;
+    for (size_t i = 0; i < seqnums.size(); i += kBatchSize) {
+        if (state_.load(std::memory_order_acquire) == kStopping) {
+            break;
+        }
+        size_t batch_end = std::min(i + kBatchSize, seqnums.size());
+        absl::flat_hash_map</* logspace_id */ uint32_t, std::vector<uint32_t>> keys;
+        for (size_t j = i; j < batch_end; j++) {
+            uint32_t logspace_id = bits::HighHalf64(seqnums[j]);
+            // Log spaces not in current views are skipped
+            if (!db_->HasLogSpace(logspace_id)) {
+                num_skipped++;
+                continue;
+            }
+            keys[logspace_id].push_back(bits::LowHalf64(seqnums[j]));
+        }
+        for (const auto& [logspace_id, seqnum_lowhalves] : keys) {
+            ReadLogEntriesFromDB(
+                logspace_id, seqnum_lowhalves,
+                [this, &num_loaded] (size_t index, const LogMetaData& metadata,
+                                     std::span<const uint64_t> user_tags,
+                                     std::span<const char> log_data) {
+                    LogCachePut(metadata, user_tags, log_data);
+                    num_loaded++;
+                }
+            );
+        }
+        if (rate > 0) {
+            int64_t next_timestamp = start_timestamp + gsl::narrow_cast<int64_t>(
+                batch_end * 1000000 / gsl::narrow_cast<size_t>(rate));
+            int64_t current_timestamp = GetMonotonicMicroTimestamp();
+            if (next_timestamp > current_timestamp) {
+                absl::SleepFor(absl::Microseconds(next_timestamp - current_timestamp));
+            }
+        }
+    }
+    HLOG_F(INFO, "Log cache warmed up with {} of {} hot keys ({} of uninstalled "
+                 "log spaces), takes {:.3f}s",
+           num_loaded, seqnums.size(), num_skipped,
+           (GetMonotonicMicroTimestamp() - start_timestamp) * 1e-6);
+}
+
+uint32_t StorageBase::GetArchivedPosition(uint32_t logspace_id) {
+    DCHECK(archive_ != nullptr);
+    return archive_->GetArchivedPosition(logspace_id);
+}
+
+bool StorageBase::TierLogEntries(uint32_t logspace_id, uint32_t start, uint32_t end) {
+    DCHECK(archive_ != nullptr);
+    DCHECK_LT(start, end);
+    std::vector<uint32_t> keys(end - start);
+    std::iota(keys.begin(), keys.end(), start);
+    std::vector<LogArchive::Entry> entries;
+    db_->MultiGetPinned(
+        logspace_id, keys,
+        [&keys, &entries] (size_t index, std::span<const char> data) {
+            entries.emplace_back(keys[index], std::string(data.data(), data.size()));
+        }
+    );
+    if (!archive_->WriteSegment(logspace_id, start, end, entries)) {
+        HLOG_F(ERROR, "Failed to archive log entries of log space {} in [{}, {})",
+               bits::HexStr0x(logspace_id), bits::HexStr0x(start), bits::HexStr0x(end));
+        return false;
+    }
+    std::vector<uint32_t> archived_keys;
+    archived_keys.reserve(entries.size());
+    for (const auto& entry : entries) {
+        archived_keys.push_back(entry.first);
+    }
+    db_->DeleteBatch(logspace_id, archived_keys);
+    return true;
+}
+
+void StorageBase::DeleteLoadedArchivedLogEntries() {
+    DCHECK(archive_ != nullptr);
+    for (uint32_t logspace_id : archive_->GetLogSpacesWithLoadedSegments()) {
+        // Log spaces are installed into DB when views are created
+        if (!db_->HasLogSpace(logspace_id)) {
+            continue;
+        }
+        size_t num_deleted = 0;
+        for (const auto& [start, end] : archive_->PollLoadedSegments(logspace_id)) {
+            std::vector<uint32_t> keys(end - start);
+            std::iota(keys.begin(), keys.end(), start);
+            // Only existing keys are deleted, as most segments have none left
+            std::vector<uint32_t> remaining_keys;
+            db_->MultiGetPinned(
+                logspace_id, keys,
+                [&keys, &remaining_keys] (size_t index, std::span<const char> data) {
+                    remaining_keys.push_back(keys[index]);
+                }
+            );
+            if (!remaining_keys.empty()) {
+                db_->DeleteBatch(logspace_id, remaining_keys);
+                num_deleted += remaining_keys.size();
+            }
+        }
+        if (num_deleted > 0) {
+            HLOG_F(INFO, "Delete {} archived log entries of log space {} left in DB",
+                   num_deleted, bits::HexStr0x(logspace_id));
+        }
+    }
+}
+
+void StorageBase::TieringThreadMain() {
+    if (archive_ == nullptr) {
+        return;
+    }
+    absl::Duration interval = absl::Seconds(
+        absl::GetFlag(FLAGS_slog_storage_tiering_interval_s));
+    while (!tiering_stopped_.WaitForNotificationWithTimeout(interval)) {
+        DeleteLoadedArchivedLogEntries();
+        TierColdLogEntries();
+    }
+}
+
+namespace {
+// Keeps all seqnums of `index_data_proto`, but only tags, checkpoints and
+// queue cursors indexed by `engine_id`
+IndexDataProto PartitionIndexData(const View::Sequencer* sequencer_node,
+                                  uint16_t engine_id,
+                                  const IndexDataProto& index_data_proto) {
+    IndexDataProto partition;
+    partition.set_logspace_id(index_data_proto.logspace_id());
+    *partition.mutable_seqnum_halves() = index_data_proto.seqnum_halves();
+    *partition.mutable_engine_ids() = index_data_proto.engine_ids();
+    *partition.mutable_user_logspaces() = index_data_proto.user_logspaces();
+    int tag_idx = 0;
+    for (uint32_t num_tags : index_data_proto.user_tag_sizes()) {
+        uint32_t num_partition_tags = 0;
+        for (uint32_t i = 0; i < num_tags; i++) {
+            uint64_t tag = index_data_proto.user_tags(tag_idx++);
+            if (sequencer_node->GetIndexEngineNodeForTag(tag) == engine_id) {
+                partition.add_user_tags(tag);
+                num_partition_tags++;
+            }
+        }
+        partition.add_user_tag_sizes(num_partition_tags);
+    }
+    for (int i = 0; i < index_data_proto.checkpoint_tags_size(); i++) {
+        uint64_t tag = index_data_proto.checkpoint_tags(i);
+        if (sequencer_node->GetIndexEngineNodeForTag(tag) == engine_id) {
+            partition.add_checkpoint_user_logspaces(index_data_proto.checkpoint_user_logspaces(i));
+            partition.add_checkpoint_tags(tag);
+            partition.add_checkpoint_seqnums(index_data_proto.checkpoint_seqnums(i));
+            partition.add_checkpoint_engine_ids(index_data_proto.checkpoint_engine_ids(i));
+        }
+    }
+    for (int i = 0; i < index_data_proto.queue_cursor_tags_size(); i++) {
+        uint64_t tag = index_data_proto.queue_cursor_tags(i);
+        if (sequencer_node->GetIndexEngineNodeForTag(tag) == engine_id) {
+            partition.add_queue_cursor_user_logspaces(
+                index_data_proto.queue_cursor_user_logspaces(i));
+            partition.add_queue_cursor_tags(tag);
+            partition.add_queue_cursor_seqnums(index_data_proto.queue_cursor_seqnums(i));
+        }
+    }
+    return partition;
+}
+}  // namespace
+
 void StorageBase::SendIndexData(const View* view,
                                 const IndexDataProto& index_data_proto) {
     uint32_t logspace_id = index_data_proto.logspace_id();
     DCHECK_EQ(view->id(), bits::HighHalf32(logspace_id));
     const View::Sequencer* sequencer_node = view->GetSequencerNode(
         bits::LowHalf32(logspace_id));
-    std::string serialized_data;
-    CHECK(index_data_proto.SerializeToString(&serialized_data));
     SharedLogMessage message = SharedLogMessageHelper::NewIndexDataMessage(
         logspace_id);
     message.origin_node_id = node_id_;
+    std::string serialized_data;
+    if (view->index_partitioned()) {
+        // Each index engine only receives tags of its own partition
+        for (uint16_t engine_id : sequencer_node->GetIndexEngineNodes()) {
+            IndexDataProto partition = PartitionIndexData(
+                sequencer_node, engine_id, index_data_proto);
+            if (partition.seqnum_halves_size() == 0
+                    && partition.checkpoint_tags_size() == 0
+                    && partition.queue_cursor_tags_size() == 0) {
+                continue;
+            }
+            CHECK(partition.SerializeToString(&serialized_data));
+            message.payload_size = gsl::narrow_cast<uint32_t>(serialized_data.size());
+            SendSharedLogMessage(protocol::ConnType::STORAGE_TO_ENGINE,
+                                 engine_id, message, STRING_AS_SPAN(serialized_data));
+        }
+        return;
+    }
+    CHECK(index_data_proto.SerializeToString(&serialized_data));
     message.payload_size = gsl::narrow_cast<uint32_t>(serialized_data.size());
     for (uint16_t engine_id : sequencer_node->GetIndexEngineNodes()) {
         SendSharedLogMessage(protocol::ConnType::STORAGE_TO_ENGINE,
@@ -172,6 +649,15 @@ bool StorageBase::SendSequencerMessage(uint16_t sequencer_id,
                                 sequencer_id, *message, payload);
 }
 
+bool StorageBase::SendStorageMessage(uint16_t storage_id,
+                                     SharedLogMessage* message,
+                                     std::span<const char> payload) {
+    message->origin_node_id = node_id_;
+    message->payload_size = gsl::narrow_cast<uint32_t>(payload.size());
+    return SendSharedLogMessage(protocol::ConnType::STORAGE_TO_STORAGE,
+                                storage_id, *message, payload);
+}
+
 bool StorageBase::SendEngineResponse(const SharedLogMessage& request,
                                      SharedLogMessage* response,
                                      std::span<const char> payload1,
@@ -196,6 +682,10 @@ void StorageBase::OnRecvSharedLogMessage(int conn_type, uint16_t src_node_id,
      || (conn_type == kEngineIngressTypeId && op_type == SharedLogOpType::READ_AT)
      || (conn_type == kEngineIngressTypeId && op_type == SharedLogOpType::REPLICATE)
      || (conn_type == kEngineIngressTypeId && op_type == SharedLogOpType::SET_AUXDATA)
+     || (conn_type == kEngineIngressTypeId && op_type == SharedLogOpType::SET_CHECKPOINT)
+     || (conn_type == kEngineIngressTypeId && op_type == SharedLogOpType::READ_CHECKPOINT)
+     || (conn_type == kStorageIngressTypeId && op_type == SharedLogOpType::BULK_SYNC)
+     || (conn_type == kStorageIngressTypeId && op_type == SharedLogOpType::RESPONSE)
     ) << fmt::format("Invalid combination: conn_type={:#x}, op_type={:#x}",
                      conn_type, message.op_type);
     MessageHandler(message, payload);
@@ -221,7 +711,7 @@ bool StorageBase::SendSharedLogMessage(protocol::ConnType conn_type, uint16_t ds
 
 void StorageBase::OnRemoteMessageConn(const protocol::HandshakeMessage& handshake,
                                       int sockfd) {
-    protocol::ConnType type = static_cast<protocol::ConnType>(handshake.conn_type);
+    protocol::ConnType type = protocol::GetConnType(handshake);
     uint16_t src_node_id = handshake.src_node_id;
 
     switch (type) {
@@ -229,6 +719,8 @@ void StorageBase::OnRemoteMessageConn(const protocol::HandshakeMessage& handshak
         break;
     case protocol::ConnType::SEQUENCER_TO_STORAGE:
         break;
+    case protocol::ConnType::STORAGE_TO_STORAGE:
+        break;
     default:
         HLOG(ERROR) << "Invalid connection type: " << handshake.conn_type;
         close(sockfd);
@@ -238,6 +730,9 @@ void StorageBase::OnRemoteMessageConn(const protocol::HandshakeMessage& handshak
     int conn_type_id = ServerBase::GetIngressConnTypeId(type, src_node_id);
     auto connection = std::make_unique<IngressConnection>(
         conn_type_id, sockfd, sizeof(SharedLogMessage));
+    if (protocol::IsStripedConn(handshake)) {
+        connection->EnableStriping();
+    }
     connection->SetMessageFullSizeCallback(
         &IngressConnection::SharedLogMessageFullSizeCallback);
     connection->SetNewMessageCallback(
@@ -255,11 +750,13 @@ void StorageBase::OnConnectionClose(ConnectionBase* connection) {
     switch (connection->type() & kConnectionTypeMask) {
     case kSequencerIngressTypeId:
     case kEngineIngressTypeId:
+    case kStorageIngressTypeId:
         DCHECK(ingress_conns_.contains(connection->id()));
         ingress_conns_.erase(connection->id());
         break;
     case kSequencerEgressHubTypeId:
     case kEngineEgressHubTypeId:
+    case kStorageEgressHubTypeId:
         {
             absl::MutexLock lk(&conn_mu_);
             DCHECK(egress_hubs_.contains(connection->id()));
@@ -283,9 +780,13 @@ EgressHub* StorageBase::CreateEgressHub(protocol::ConnType conn_type,
         ServerBase::GetEgressHubTypeId(conn_type, dst_node_id),
         &addr, absl::GetFlag(FLAGS_message_conn_per_worker));
     uint16_t src_node_id = node_id_;
+    bool striped = absl::GetFlag(FLAGS_egress_hub_enable_striping);
+    if (striped) {
+        egress_hub->EnableStriping();
+    }
     egress_hub->SetHandshakeMessageCallback(
-        [conn_type, src_node_id] (std::string* handshake) {
-            *handshake = protocol::EncodeHandshakeMessage(conn_type, src_node_id);
+        [conn_type, src_node_id, striped] (std::string* handshake) {
+            *handshake = protocol::EncodeHandshakeMessage(conn_type, src_node_id, striped);
         }
     );
     RegisterConnection(io_worker, egress_hub.get());
@@ -6,6 +6,7 @@
 #include "log/view_watcher.h"
 #include "log/db.h"
 #include "log/cache.h"
+#include "log/archive.h"
 #include "server/server_base.h"
 #include "server/ingress_connection.h"
 #include "server/egress_hub.h"
@@ -33,22 +34,90 @@ protected:
                                    std::span<const char> payload) = 0;
     virtual void OnRecvLogAuxData(const protocol::SharedLogMessage& message,
                                   std::span<const char> payload) = 0;
-
-    virtual void BackgroundThreadMain() = 0;
+    virtual void OnRecvCheckpoint(const protocol::SharedLogMessage& message,
+                                  std::span<const char> payload) = 0;
+    virtual void HandleReadCheckpointRequest(const protocol::SharedLogMessage& request,
+                                             std::span<const char> payload) = 0;
+    virtual void HandleBulkSyncRequest(const protocol::SharedLogMessage& request) = 0;
+    virtual void OnRecvBulkSyncResponse(const protocol::SharedLogMessage& message,
+                                        std::span<const char> payload) = 0;
+    // With FLAGS_slog_storage_bulk_sync set, called periodically from IO workers
+    virtual void IssueBulkSyncRequestsIfNeeded() = 0;
+
+    // Flush workers are started with the server, each calls FlushWorkerMain
+    // until StopFlushWorkers is called
+    size_t num_flush_workers() const { return num_flush_workers_; }
+    virtual void FlushWorkerMain(size_t worker_id) = 0;
+    virtual void StopFlushWorkers() = 0;
     virtual void SendShardProgressIfNeeded() = 0;
 
+    void LogCachePut(const LogMetaData& log_metadata, std::span<const uint64_t> user_tags,
+                     std::span<const char> log_data);
+    std::optional<LogEntry> LogCacheGet(uint64_t seqnum);
     void LogCachePutAuxData(uint64_t seqnum, std::span<const char> data);
     std::optional<std::string> LogCacheGetAuxData(uint64_t seqnum);
 
+    // Hot keys are seqnums of recently read log entries. They are dumped into
+    // DB directory periodically and on shutdown, and preloaded into log cache
+    // in the background after restart.
+    void RecordHotKey(uint64_t seqnum);
+
+    // With FLAGS_slog_storage_archive_dir set, TierColdLogEntries is called
+    // periodically from a background thread, which moves cold log entries
+    // from DB into archive files by TierLogEntries
+    bool tiering_enabled() const { return archive_ != nullptr; }
+    virtual void TierColdLogEntries() = 0;
+    uint32_t GetArchivedPosition(uint32_t logspace_id);
+    // Archives log entries with seqnum_lowhalf in [start, end), and removes
+    // them from DB
+    bool TierLogEntries(uint32_t logspace_id, uint32_t start, uint32_t end);
+
     void MessageHandler(const protocol::SharedLogMessage& message,
                         std::span<const char> payload);
-    std::optional<LogEntryProto> GetLogEntryFromDB(uint64_t seqnum);
+    // Calls `fn` with log entries parsed in place from DB, where `log_data`
+    // is only valid within `fn`, and `index` is the index of found log entries
+    // in `seqnum_lowhalves`. Log entries are from the same log space.
+    // Log entries not found in DB are looked up in archive files.
+    using LogEntryCallback = std::function<void(size_t /* index */,
+                                                const LogMetaData& metadata,
+                                                std::span<const uint64_t> user_tags,
+                                                std::span<const char> log_data)>;
+    void ReadLogEntriesFromDB(uint32_t logspace_id,
+                              std::span<const uint32_t> seqnum_lowhalves,
+                              const LogEntryCallback& fn);
+    // Calls `fn` with serialized log entries with seqnum_lowhalf in [start, end),
+    // including archived ones
+    using SerializedLogEntryCallback = std::function<void(uint32_t /* seqnum_lowhalf */,
+                                                          std::span<const char> data)>;
+    void ScanLogEntriesFromDB(uint32_t logspace_id, uint32_t start, uint32_t end,
+                              const SerializedLogEntryCallback& fn);
     void PutLogEntryToDB(const LogEntry& log_entry);
+    void PutSerializedLogEntryToDB(uint32_t logspace_id, uint32_t seqnum_lowhalf,
+                                   std::span<const char> data);
+    // For log entries not ordered yet, which are removed from DB by
+    // DeletePendingLogEntryFromDB once persisted as ordered ones
+    void PutPendingLogEntriesToDB(uint32_t logspace_id,
+                                  std::span<const std::shared_ptr<const LogEntry>> log_entries,
+                                  bool sync);
+    void DeletePendingLogEntryFromDB(const LogEntry& log_entry);
+    void DeletePendingLogEntriesFromDB(uint32_t logspace_id, std::span<const uint64_t> localids);
+    std::optional<std::string> GetCheckpointFromDB(uint32_t logspace_id, uint32_t user_logspace,
+                                                   uint64_t tag, uint64_t seqnum);
+    void PutCheckpointToDB(uint32_t logspace_id, uint32_t user_logspace,
+                           uint64_t tag, uint64_t seqnum, std::span<const char> data);
+    std::optional<uint64_t> GetQueueCursorFromDB(uint32_t logspace_id, uint32_t user_logspace,
+                                                 uint64_t tag);
+    // Cursors older than the stored ones are skipped, as messages carrying
+    // them can be reordered across connections
+    void PutQueueCursorsToDB(uint32_t logspace_id, std::span<const uint64_t> cursors);
 
     void SendIndexData(const View* view, const IndexDataProto& index_data_proto);
     bool SendSequencerMessage(uint16_t sequencer_id,
                               protocol::SharedLogMessage* message,
                               std::span<const char> payload);
+    bool SendStorageMessage(uint16_t storage_id,
+                            protocol::SharedLogMessage* message,
+                            std::span<const char> payload);
     bool SendEngineResponse(const protocol::SharedLogMessage& request,
                             protocol::SharedLogMessage* response,
                             std::span<const char> payload1 = EMPTY_CHAR_SPAN,
@@ -63,7 +132,8 @@ private:
     std::string db_path_;
     std::unique_ptr<DBInterface> db_;
 
-    base::Thread background_thread_;
+    size_t num_flush_workers_;
+    std::vector<std::unique_ptr<base::Thread>> flush_threads_;
 
     absl::flat_hash_map</* id */ int, std::unique_ptr<server::IngressConnection>>
         ingress_conns_;
@@ -74,6 +144,37 @@ private:
 
     std::optional<LRUCache> log_cache_;
 
+    // Serializes read-modify-write of queue cursors in DB
+    absl::Mutex queue_cursor_mu_;
+
+    // Hot keys are recorded into one shard per reading thread, so that IO
+    // workers do not contend on a single lock. Shards are merged when dumped.
+    struct HotKeyShard {
+        absl::Mutex mu;
+        // Ring buffer of hot keys, where `next` counts all recorded
+        std::vector<uint64_t> keys ABSL_GUARDED_BY(mu);
+        size_t next                ABSL_GUARDED_BY(mu);
+    };
+    std::vector<std::unique_ptr<HotKeyShard>> hot_key_shards_;
+
+    absl::Notification view_created_;
+    absl::Notification hot_keys_stopped_;
+    // Warms up log cache after restart, then dumps hot keys periodically
+    base::Thread hot_keys_thread_;
+
+    std::unique_ptr<LogArchive> archive_;
+    absl::Notification tiering_stopped_;
+    base::Thread tiering_thread_;
+
+    std::string GetHotKeysFilePath() const;
+    void DumpHotKeys();
+    void WarmupLogCache();
+    // Deletes log entries of archive files loaded at startup, which a crash
+    // may have left in DB after archiving them
+    void DeleteLoadedArchivedLogEntries();
+    void HotKeysThreadMain();
+    void TieringThreadMain();
+
     void SetupDB();
     void SetupZKWatchers();
     void SetupTimers();
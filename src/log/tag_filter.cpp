@@ -0,0 +1,109 @@
+#include "log/tag_filter.h"
+
+#include "utils/bits.h"
+#include "utils/hash.h"
+
+namespace faas {
+namespace log {
+
+TagFilter::TagFilter(size_t num_bits)
+    : bits_((num_bits + 63) / 64, 0),
+      changed_bitmap_((bits_.size() + 63) / 64, 0) {
+    DCHECK_GT(num_bits, 0U);
+}
+
+TagFilter::TagFilter(std::span<const char> data) {
+    if (data.empty() || data.size() % sizeof(uint64_t) != 0) {
+        LOG_F(FATAL, "Invalid size of tag filter data: {}", data.size());
+    }
+    bits_.resize(data.size() / sizeof(uint64_t));
+    memcpy(bits_.data(), data.data(), data.size());
+    changed_bitmap_.resize((bits_.size() + 63) / 64, 0);
+}
+
+TagFilter::~TagFilter() {}
+
+// Positions of the `kNumHashes` bits are derived from two halves of one
+// hash value, i.e., double hashing
+template<class Fn>
+void TagFilter::ForEachBit(uint32_t user_logspace, uint64_t tag, Fn&& fn) const {
+    uint64_t h = hash::xxHash64(tag, /* seed= */ hash::kDefaultHashSeed64 ^ user_logspace);
+    uint64_t h1 = bits::LowHalf64(h);
+    uint64_t h2 = bits::HighHalf64(h) | 1;
+    size_t n = num_bits();
+    for (size_t i = 0; i < kNumHashes; i++) {
+        size_t pos = (h1 + i * h2) % n;
+        fn(pos / 64, uint64_t{1} << (pos % 64));
+    }
+}
+
+void TagFilter::Add(uint32_t user_logspace, uint64_t tag) {
+    ForEachBit(user_logspace, tag, [this] (size_t word, uint64_t mask) {
+        if ((bits_[word] & mask) == 0) {
+            bits_[word] |= mask;
+            MarkChanged(word);
+        }
+    });
+}
+
+void TagFilter::MarkChanged(size_t word) {
+    uint64_t mask = uint64_t{1} << (word % 64);
+    if ((changed_bitmap_[word / 64] & mask) == 0) {
+        changed_bitmap_[word / 64] |= mask;
+        changed_words_.push_back(gsl::narrow_cast<uint32_t>(word));
+    }
+}
+
+bool TagFilter::MayContain(uint32_t user_logspace, uint64_t tag) const {
+    bool result = true;
+    ForEachBit(user_logspace, tag, [this, &result] (size_t word, uint64_t mask) {
+        if ((bits_[word] & mask) == 0) {
+            result = false;
+        }
+    });
+    return result;
+}
+
+void TagFilter::Serialize(std::string* data) {
+    data->assign(reinterpret_cast<const char*>(bits_.data()),
+                 bits_.size() * sizeof(uint64_t));
+    std::fill(changed_bitmap_.begin(), changed_bitmap_.end(), 0);
+    changed_words_.clear();
+}
+
+// Delta is a sequence of (word index, word) pairs, both as uint64_t
+void TagFilter::SerializeDelta(std::string* data) {
+    std::vector<uint64_t> delta;
+    delta.reserve(changed_words_.size() * 2);
+    for (uint32_t word : changed_words_) {
+        delta.push_back(word);
+        delta.push_back(bits_[word]);
+        changed_bitmap_[word / 64] &= ~(uint64_t{1} << (word % 64));
+    }
+    changed_words_.clear();
+    data->assign(reinterpret_cast<const char*>(delta.data()),
+                 delta.size() * sizeof(uint64_t));
+}
+
+bool TagFilter::ApplyDelta(std::span<const char> data) {
+    if (data.size() % (2 * sizeof(uint64_t)) != 0) {
+        LOG_F(ERROR, "Invalid size of tag filter delta: {}", data.size());
+        return false;
+    }
+    const uint64_t* delta = reinterpret_cast<const uint64_t*>(data.data());
+    size_t n = data.size() / sizeof(uint64_t);
+    for (size_t i = 0; i < n; i += 2) {
+        if (delta[i] >= bits_.size()) {
+            LOG_F(ERROR, "Word {} of tag filter delta out of range", delta[i]);
+            return false;
+        }
+    }
+    // Bits are never cleared, so words can be merged in any order
+    for (size_t i = 0; i < n; i += 2) {
+        bits_[delta[i]] |= delta[i + 1];
+    }
+    return true;
+}
+
+}  // namespace log
+}  // namespace faas
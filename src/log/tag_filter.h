@@ -0,0 +1,50 @@
+#pragma once
+
+#include "log/common.h"
+
+namespace faas {
+namespace log {
+
+// Bloom filter over (user_logspace, tag) pairs of log entries in one physical
+// log space. Index engines build filters as they index log entries, and copy
+// them to other engines, so that reads of tags without any log entries can
+// be answered without an index query. Other engines are kept up to date by
+// deltas of words changed since the last serialization.
+class TagFilter {
+public:
+    static constexpr size_t kNumHashes = 4;
+
+    explicit TagFilter(size_t num_bits);
+    // Restore the filter from data of `Serialize`
+    explicit TagFilter(std::span<const char> data);
+    ~TagFilter();
+
+    size_t num_bits() const { return bits_.size() * 64; }
+
+    void Add(uint32_t user_logspace, uint64_t tag);
+    // False positives are possible, but false negatives are not
+    bool MayContain(uint32_t user_logspace, uint64_t tag) const;
+
+    // Both clear the set of changed words
+    void Serialize(std::string* data);
+    void SerializeDelta(std::string* data);
+    size_t num_changed_words() const { return changed_words_.size(); }
+    // Returns false if `data` is not a valid delta of this filter
+    bool ApplyDelta(std::span<const char> data);
+
+private:
+    std::vector<uint64_t> bits_;
+    // Words changed since the last serialization
+    std::vector<uint64_t> changed_bitmap_;
+    std::vector<uint32_t> changed_words_;
+
+    void MarkChanged(size_t word);
+
+    template<class Fn>
+    void ForEachBit(uint32_t user_logspace, uint64_t tag, Fn&& fn) const;
+
+    DISALLOW_COPY_AND_ASSIGN(TagFilter);
+};
+
+}  // namespace log
+}  // namespace faas
@@ -2,6 +2,11 @@
 
 #include "utils/bits.h"
 
+__BEGIN_THIRD_PARTY_HEADERS
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/wire_format_lite.h>
+__END_THIRD_PARTY_HEADERS
+
 namespace faas {
 namespace log_utils {
 
@@ -132,5 +137,86 @@ void PopulateMetaDataToMessage(const LogEntryProto& log_entry, SharedLogMessage*
     message->localid = log_entry.localid();
 }
 
+bool ParseLogEntryInPlace(std::span<const char> serialized,
+                          LogMetaData* metadata, log::UserTagVec* user_tags,
+                          std::span<const char>* log_data) {
+    using google::protobuf::internal::WireFormatLite;
+    google::protobuf::io::CodedInputStream input(
+        reinterpret_cast<const uint8_t*>(serialized.data()),
+        gsl::narrow_cast<int>(serialized.size()));
+    *metadata = {
+        .user_logspace = 0,
+        .seqnum = 0,
+        .localid = 0,
+        .num_tags = 0,
+        .data_size = 0
+    };
+    user_tags->clear();
+    *log_data = EMPTY_CHAR_SPAN;
+    while (uint32_t tag = input.ReadTag()) {
+        int field_number = WireFormatLite::GetTagFieldNumber(tag);
+        WireFormatLite::WireType wire_type = WireFormatLite::GetTagWireType(tag);
+        if (field_number == LogEntryProto::kUserLogspaceFieldNumber
+                && wire_type == WireFormatLite::WIRETYPE_VARINT) {
+            if (!input.ReadVarint32(&metadata->user_logspace)) {
+                return false;
+            }
+        } else if (field_number == LogEntryProto::kSeqnumFieldNumber
+                       && wire_type == WireFormatLite::WIRETYPE_VARINT) {
+            if (!input.ReadVarint64(&metadata->seqnum)) {
+                return false;
+            }
+        } else if (field_number == LogEntryProto::kLocalidFieldNumber
+                       && wire_type == WireFormatLite::WIRETYPE_VARINT) {
+            if (!input.ReadVarint64(&metadata->localid)) {
+                return false;
+            }
+        } else if (field_number == LogEntryProto::kUserTagsFieldNumber) {
+            // Repeated scalars may be either packed or not
+            uint64_t user_tag;
+            if (wire_type == WireFormatLite::WIRETYPE_LENGTH_DELIMITED) {
+                uint32_t length;
+                if (!input.ReadVarint32(&length)) {
+                    return false;
+                }
+                auto limit = input.PushLimit(gsl::narrow_cast<int>(length));
+                while (input.BytesUntilLimit() > 0) {
+                    if (!input.ReadVarint64(&user_tag)) {
+                        return false;
+                    }
+                    user_tags->push_back(user_tag);
+                }
+                input.PopLimit(limit);
+            } else if (wire_type == WireFormatLite::WIRETYPE_VARINT) {
+                if (!input.ReadVarint64(&user_tag)) {
+                    return false;
+                }
+                user_tags->push_back(user_tag);
+            } else {
+                return false;
+            }
+        } else if (field_number == LogEntryProto::kDataFieldNumber
+                       && wire_type == WireFormatLite::WIRETYPE_LENGTH_DELIMITED) {
+            uint32_t length;
+            if (!input.ReadVarint32(&length)) {
+                return false;
+            }
+            size_t offset = gsl::narrow_cast<size_t>(input.CurrentPosition());
+            if (!input.Skip(gsl::narrow_cast<int>(length))) {
+                return false;
+            }
+            *log_data = serialized.subspan(offset, length);
+        } else if (!WireFormatLite::SkipField(&input, tag)) {
+            return false;
+        }
+    }
+    if (!input.ConsumedEntireMessage()) {
+        return false;
+    }
+    metadata->num_tags = user_tags->size();
+    metadata->data_size = log_data->size();
+    return true;
+}
+
 }  // namespace log_utils
 }  // namespace faas
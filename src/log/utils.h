@@ -69,6 +69,12 @@ void PopulateMetaDataToMessage(const log::LogMetaData& metadata,
 void PopulateMetaDataToMessage(const log::LogEntryProto& log_entry,
                                protocol::SharedLogMessage* message);
 
+// Parses serialized LogEntryProto in place, where `log_data` points into
+// `serialized`, instead of copying the data as LogEntryProto::ParseFromString
+bool ParseLogEntryInPlace(std::span<const char> serialized,
+                          log::LogMetaData* metadata, log::UserTagVec* user_tags,
+                          std::span<const char>* log_data);
+
 // Start implementation of ThreadedMap
 
 template<class T>
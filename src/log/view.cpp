@@ -9,6 +9,7 @@ View::View(const ViewProto& view_proto)
       userlog_replicas_(view_proto.userlog_replicas()),
       index_replicas_(view_proto.index_replicas()),
       num_phylogs_(view_proto.num_phylogs()),
+      index_partitioned_(view_proto.index_partitioned()),
       engine_node_ids_(static_cast<size_t>(view_proto.engine_nodes_size())),
       sequencer_node_ids_(static_cast<size_t>(view_proto.sequencer_nodes_size())),
       storage_node_ids_(static_cast<size_t>(view_proto.storage_nodes_size())),
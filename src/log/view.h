@@ -1,6 +1,7 @@
 #pragma once
 
 #include "base/common.h"
+#include "log/common.h"
 #include "utils/hash.h"
 #include "utils/bits.h"
 
@@ -23,6 +24,7 @@ public:
     size_t userlog_replicas() const { return userlog_replicas_; }
     size_t index_replicas() const { return index_replicas_; }
     size_t num_phylogs() const { return num_phylogs_; }
+    bool index_partitioned() const { return index_partitioned_; }
 
     size_t num_engine_nodes() const { return engine_node_ids_.size(); }
     size_t num_sequencer_nodes() const { return sequencer_node_ids_.size(); }
@@ -127,6 +129,51 @@ public:
             return index_engine_nodes_.at(idx % index_engine_nodes_.size());
         }
 
+        // With partitioned index, each tag is indexed by only one index engine node
+        uint16_t GetIndexEngineNodeForTag(uint64_t tag) const {
+            DCHECK(view_->index_partitioned());
+            DCHECK_NE(tag, kEmptyLogTag);
+            return index_engine_nodes_.at(hash::xxHash64(tag) % index_engine_nodes_.size());
+        }
+
+        // Pops of a queue are served by one index engine node, which keeps the
+        // consumer cursor. Same as GetIndexEngineNodeForTag with partitioned index.
+        uint16_t GetQueueEngineNodeForTag(uint64_t tag) const {
+            DCHECK_NE(tag, kEmptyLogTag);
+            return index_engine_nodes_.at(hash::xxHash64(tag) % index_engine_nodes_.size());
+        }
+
+        // For queries on `tags`, where seqnum-only queries have a single
+        // kEmptyLogTag. With partitioned index, all `tags` must be indexed by
+        // the same node (see InSameIndexPartition).
+        bool IsIndexEngineNodeForTags(uint16_t engine_node_id,
+                                      std::span<const uint64_t> tags) const {
+            if (!view_->index_partitioned() || tags.empty() || tags[0] == kEmptyLogTag) {
+                return IsIndexEngineNode(engine_node_id);
+            }
+            return GetIndexEngineNodeForTag(tags[0]) == engine_node_id;
+        }
+
+        uint16_t PickIndexEngineNodeForTags(std::span<const uint64_t> tags) const {
+            if (!view_->index_partitioned() || tags.empty() || tags[0] == kEmptyLogTag) {
+                return PickIndexEngineNode();
+            }
+            return GetIndexEngineNodeForTag(tags[0]);
+        }
+
+        bool InSameIndexPartition(std::span<const uint64_t> tags) const {
+            if (!view_->index_partitioned() || tags.size() <= 1) {
+                return true;
+            }
+            uint16_t engine_node_id = GetIndexEngineNodeForTag(tags[0]);
+            for (uint64_t tag : tags.subspan(1)) {
+                if (GetIndexEngineNodeForTag(tag) != engine_node_id) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
     private:
         friend class View;
         const View* view_;
@@ -191,6 +238,7 @@ private:
     size_t userlog_replicas_;
     size_t index_replicas_;
     size_t num_phylogs_;
+    bool index_partitioned_;
 
     NodeIdVec engine_node_ids_;
     NodeIdVec sequencer_node_ids_;
@@ -21,6 +21,9 @@ constexpr int kSLogLocalCutTimerTypeId      = kTimerTypeId + 1;
 constexpr int kSLogStateCheckTimerTypeId    = kTimerTypeId + 2;
 constexpr int kSendShardProgressTimerId     = kTimerTypeId + 3;
 constexpr int kMetaLogCutTimerId            = kTimerTypeId + 3;
+constexpr int kSLogTagFilterTimerTypeId     = kTimerTypeId + 4;
+constexpr int kStorageBulkSyncTimerId       = kTimerTypeId + 6;
+constexpr int kSLogQueueCursorTimerTypeId   = kTimerTypeId + 7;
 
 // Used by Gateway
 constexpr int kHttpConnectionTypeId         = 0x20 << 16;
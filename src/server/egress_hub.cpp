@@ -12,7 +12,19 @@ EgressHub::EgressHub(int type, const struct sockaddr_in* addr, size_t num_conn)
       state_(kCreated),
       sockfds_(num_conn, -1),
       log_header_(GetLogHeader(type)),
-      send_fn_scheduled_(false) {
+      send_fn_scheduled_(false),
+      striping_(false),
+      stripe_min_bytes_(std::max<size_t>(1, absl::GetFlag(FLAGS_egress_hub_stripe_min_bytes))),
+      next_stripe_seqnum_(0),
+      queue_limit_(absl::GetFlag(FLAGS_egress_hub_queue_limit_bytes)),
+      queue_resume_threshold_(gsl::narrow_cast<size_t>(
+          queue_limit_ * absl::GetFlag(FLAGS_egress_hub_queue_resume_ratio))),
+      inflight_bytes_(0),
+      congested_(false),
+      queue_depth_stat_(stat::StatisticsCollector<int>::VerboseLogReportCallback<1>(
+          log_header_ + "queue_depth")),
+      congested_counter_(stat::Counter::StandardReportCallback(
+          log_header_ + "congested")) {
     memcpy(&addr_, addr, sizeof(struct sockaddr_in));
 }
 
@@ -55,6 +67,15 @@ void EgressHub::SetHandshakeMessageCallback(HandshakeMessageCallback cb) {
     handshake_message_cb_ = cb;
 }
 
+void EgressHub::EnableStriping() {
+    DCHECK(state_ == kCreated);
+    striping_ = true;
+}
+
+void EgressHub::SetBackpressureCallback(BackpressureCallback cb) {
+    backpressure_cb_ = cb;
+}
+
 void EgressHub::SendMessage(std::span<const char> part1, std::span<const char> part2,
                             std::span<const char> part3, std::span<const char> part4) {
     DCHECK(io_worker_->WithinMyEventLoopThread());
@@ -69,6 +90,11 @@ void EgressHub::SendMessage(std::span<const char> part1, std::span<const char> p
     write_buffer_.AppendData(part2);
     write_buffer_.AppendData(part3);
     write_buffer_.AppendData(part4);
+    if (striping_) {
+        pending_message_sizes_.push_back(
+            part1.size() + part2.size() + part3.size() + part4.size());
+    }
+    UpdateCongestionState();
     ScheduleSendFunction();
 }
 
@@ -187,6 +213,11 @@ void EgressHub::SendPendingMessages() {
     send_fn_scheduled_ = false;
     DCHECK(!write_buffer_.empty());
 
+    if (striping_) {
+        SendStripedMessages();
+        return;
+    }
+
     int sockfd = -1;
     if (!connections_for_pick_.PickNext(&sockfd)) {
         HLOG(WARNING) << "No ready connections";
@@ -194,22 +225,95 @@ void EgressHub::SendPendingMessages() {
     }
     DCHECK(sockfd >= 0);
 
-    while (!write_buffer_.empty()) {
+    size_t length = write_buffer_.length();
+    SendFromWriteBuffer(sockfd, 0, length);
+    write_buffer_.ConsumeFront(length);
+}
+
+void EgressHub::SendStripedMessages() {
+    size_t num_conns = connections_for_pick_.size();
+    if (num_conns == 0) {
+        HLOG(WARNING) << "No ready connections";
+        return;
+    }
+    size_t total_size = write_buffer_.length();
+    size_t num_stripes = std::clamp<size_t>(total_size / stripe_min_bytes_, 1, num_conns);
+    size_t stripe_target_size = (total_size + num_stripes - 1) / num_stripes;
+    size_t offset = 0;
+    while (!pending_message_sizes_.empty()) {
+        size_t stripe_size = 0;
+        while (!pending_message_sizes_.empty() && stripe_size < stripe_target_size) {
+            stripe_size += pending_message_sizes_.front();
+            pending_message_sizes_.pop_front();
+        }
+        int sockfd = -1;
+        CHECK(connections_for_pick_.PickNext(&sockfd));
+        protocol::StripeHeader header = {
+            .seqnum = next_stripe_seqnum_++,
+            .size = gsl::narrow_cast<uint32_t>(stripe_size)
+        };
+        SendFromWriteBuffer(sockfd, offset, stripe_size, &header);
+        offset += stripe_size;
+    }
+    DCHECK_EQ(offset, total_size);
+    write_buffer_.ConsumeFront(total_size);
+}
+
+void EgressHub::SendFromWriteBuffer(int sockfd, size_t offset, size_t size,
+                                    const protocol::StripeHeader* header) {
+    size_t remaining = size;
+    while (remaining > 0) {
         std::span<char> buf;
         io_worker_->NewWriteBuffer(&buf);
-        size_t copy_size = std::min(buf.size(), write_buffer_.length());
-        std::span<const char> data(write_buffer_.data(), copy_size);
+        size_t header_size = 0;
+        if (header != nullptr) {
+            header_size = sizeof(protocol::StripeHeader);
+            CHECK_GT(buf.size(), header_size);
+            memcpy(buf.data(), header, header_size);
+            header = nullptr;
+        }
+        size_t copy_size = std::min(buf.size() - header_size, remaining);
+        memcpy(buf.data() + header_size, write_buffer_.data() + offset, copy_size);
+        size_t send_size = header_size + copy_size;
         URING_DCHECK_OK(current_io_uring()->SendAll(
-            sockfd, CopyToBuffer(buf, data),
-            [this, buf, sockfd] (int status) {
+            sockfd, std::span<const char>(buf.data(), send_size),
+            [this, buf, sockfd, send_size] (int status) {
                 io_worker_->ReturnWriteBuffer(buf);
+                DCHECK_GE(inflight_bytes_, send_size);
+                inflight_bytes_ -= send_size;
+                UpdateCongestionState();
                 if (status != 0) {
                     HPLOG(ERROR) << "Failed to send data";
                     RemoveSocket(sockfd);
                 }
             }
         ));
-        write_buffer_.ConsumeFront(copy_size);
+        offset += copy_size;
+        remaining -= copy_size;
+        inflight_bytes_ += send_size;
+    }
+}
+
+void EgressHub::UpdateCongestionState() {
+    size_t depth = queue_depth();
+    queue_depth_stat_.AddSample(gsl::narrow_cast<int>(
+        std::min<size_t>(depth, std::numeric_limits<int>::max())));
+    if (queue_limit_ == 0) {
+        return;
+    }
+    if (!congested_ && depth > queue_limit_) {
+        HLOG_F(WARNING, "Queue depth {} exceeds limit {}", depth, queue_limit_);
+        congested_ = true;
+        congested_counter_.Tick();
+        if (backpressure_cb_) {
+            backpressure_cb_(true);
+        }
+    } else if (congested_ && depth <= queue_resume_threshold_) {
+        HLOG_F(INFO, "Queue depth {} drops below {}", depth, queue_resume_threshold_);
+        congested_ = false;
+        if (backpressure_cb_) {
+            backpressure_cb_(false);
+        }
     }
 }
 
@@ -1,6 +1,8 @@
 #pragma once
 
 #include "base/common.h"
+#include "common/protocol.h"
+#include "common/stat.h"
 #include "utils/socket.h"
 #include "utils/appendable_buffer.h"
 #include "utils/round_robin_set.h"
@@ -20,11 +22,28 @@ public:
     using HandshakeMessageCallback = std::function<void(std::string* /* handshake */)>;
     void SetHandshakeMessageCallback(HandshakeMessageCallback cb);
 
+    // Split large flushes across all connections by message boundary. Each
+    // stripe is prefixed by protocol::StripeHeader, so the handshake of a
+    // striping hub must set protocol::kStripedConnTypeFlag. Like round-robin
+    // flushes, messages on different connections are not ordered with
+    // respect to each other, but stripe seqnums tell the sending order.
+    // Must be called before Start.
+    void EnableStriping();
+
+    // Invoked when the queue depth crosses the limit (`congested` is true),
+    // and when it drops back below the resume threshold (`congested` is false)
+    using BackpressureCallback = std::function<void(bool /* congested */)>;
+    void SetBackpressureCallback(BackpressureCallback cb);
+
     void SendMessage(std::span<const char> part1,
                      std::span<const char> part2 = EMPTY_CHAR_SPAN,
                      std::span<const char> part3 = EMPTY_CHAR_SPAN,
                      std::span<const char> part4 = EMPTY_CHAR_SPAN);
 
+    // Bytes not yet handed to the kernel, including those in flight
+    size_t queue_depth() const { return write_buffer_.length() + inflight_bytes_; }
+    bool congested() const { return congested_; }
+
 private:
     enum State { kCreated, kRunning, kClosing, kClosed };
 
@@ -36,16 +55,34 @@ private:
     utils::RoundRobinSet</* sockfd */ int> connections_for_pick_;
 
     HandshakeMessageCallback  handshake_message_cb_;
+    BackpressureCallback      backpressure_cb_;
 
     std::string log_header_;
     utils::AppendableBuffer write_buffer_;
     bool send_fn_scheduled_;
 
+    bool striping_;
+    size_t stripe_min_bytes_;
+    uint32_t next_stripe_seqnum_;
+    std::deque</* size */ size_t> pending_message_sizes_;
+
+    size_t queue_limit_;
+    size_t queue_resume_threshold_;
+    size_t inflight_bytes_;
+    bool congested_;
+
+    stat::StatisticsCollector<int> queue_depth_stat_;
+    stat::Counter congested_counter_;
+
     void OnSocketConnected(int sockfd, int status);
     void SocketReady(int sockfd);
     void RemoveSocket(int sockfd);
     void ScheduleSendFunction();
     void SendPendingMessages();
+    void SendStripedMessages();
+    void SendFromWriteBuffer(int sockfd, size_t offset, size_t size,
+                             const protocol::StripeHeader* header = nullptr);
+    void UpdateCongestionState();
 
     static std::string GetLogHeader(int type);
 
@@ -15,6 +15,9 @@ IngressConnection::IngressConnection(int type, int sockfd, size_t msghdr_size)
       msghdr_size_(msghdr_size),
       buf_group_(kDefaultIngressBufGroup),
       buf_size_(kDefaultBufSize),
+      striping_(false),
+      current_stripe_seqnum_(0),
+      stripe_remaining_size_(0),
       log_header_(GetLogHeader(type, sockfd)) {}
 
 IngressConnection::~IngressConnection() {
@@ -64,11 +67,29 @@ void IngressConnection::SetNewMessageCallback(NewMessageCallback cb) {
 
 void IngressConnection::ProcessMessages() {
     DCHECK(io_worker_->WithinMyEventLoopThread());
-    while (read_buffer_.length() >= msghdr_size_) {
+    while (true) {
+        if (striping_ && stripe_remaining_size_ == 0) {
+            if (read_buffer_.length() < sizeof(protocol::StripeHeader)) {
+                break;
+            }
+            protocol::StripeHeader stripe_header;
+            memcpy(&stripe_header, read_buffer_.data(), sizeof(protocol::StripeHeader));
+            current_stripe_seqnum_ = stripe_header.seqnum;
+            stripe_remaining_size_ = stripe_header.size;
+            read_buffer_.ConsumeFront(sizeof(protocol::StripeHeader));
+            continue;
+        }
+        if (read_buffer_.length() < msghdr_size_) {
+            break;
+        }
         std::span<const char> header(read_buffer_.data(), msghdr_size_);
         size_t full_size = message_full_size_cb_(header);
         DCHECK_GE(full_size, msghdr_size_);
         if (read_buffer_.length() >= full_size) {
+            if (striping_) {
+                DCHECK_GE(stripe_remaining_size_, full_size);
+                stripe_remaining_size_ -= full_size;
+            }
             new_message_cb_(std::span<const char>(read_buffer_.data(), full_size));
             read_buffer_.ConsumeFront(full_size);
         } else {
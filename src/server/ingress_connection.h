@@ -23,6 +23,12 @@ public:
         buf_size_  = buf_size;
     }
 
+    // Expect messages in stripes, see protocol::StripeHeader
+    void EnableStriping() { striping_ = true; }
+    // Sequence number of the stripe containing the message being processed,
+    // only meaningful within NewMessageCallback of striped connections
+    uint32_t current_stripe_seqnum() const { return current_stripe_seqnum_; }
+
     using MessageFullSizeCallback = std::function<size_t(std::span<const char> /* header */)>;
     void SetMessageFullSizeCallback(MessageFullSizeCallback cb);
 
@@ -50,6 +56,10 @@ private:
     uint16_t buf_group_;
     size_t   buf_size_;
 
+    bool     striping_;
+    uint32_t current_stripe_seqnum_;
+    size_t   stripe_remaining_size_;
+
     MessageFullSizeCallback  message_full_size_cb_;
     NewMessageCallback       new_message_cb_;
 
@@ -276,6 +276,30 @@ bool IOUring::Close(int fd, CloseCallback cb) {
 
 #undef GET_AND_CHECK_DESC
 
+bool IOUring::StartTimeout(absl::Duration timeout, TimeoutCallback cb, uint64_t* timeout_id) {
+    Op* op = AllocTimeoutOp(timeout);
+    timeout_cbs_[op->id] = cb;
+    EnqueueOp(op);
+    *timeout_id = op->id;
+    return true;
+}
+
+bool IOUring::CancelTimeout(uint64_t timeout_id) {
+    if (!ops_.contains(timeout_id)) {
+        HLOG_F(WARNING, "Timeout op {} not found", (timeout_id >> 8));
+        return false;
+    }
+    Op* timeout_op = ops_[timeout_id];
+    DCHECK_EQ(op_type(timeout_op), kTimeout);
+    if (timeout_op->flags & kOpFlagCancelled) {
+        return false;
+    }
+    timeout_op->flags |= kOpFlagCancelled;
+    Op* op = AllocCancelOp(timeout_id);
+    EnqueueOp(op);
+    return true;
+}
+
 void IOUring::EventLoopRunOnce(size_t* inflight_ops) {
     struct io_uring_cqe* cqe = nullptr;
     uint32_t nr_wait = absl::GetFlag(FLAGS_io_uring_cq_nr_wait);
@@ -408,6 +432,14 @@ IOUring::Op* IOUring::AllocCancelOp(uint64_t op_id) {
     return op;
 }
 
+IOUring::Op* IOUring::AllocTimeoutOp(absl::Duration timeout) {
+    ALLOC_OP(kTimeout, op);
+    int64_t timeout_ns = std::max<int64_t>(0, absl::ToInt64Nanoseconds(timeout));
+    op->timeout_ts.tv_sec = timeout_ns / 1000000000;
+    op->timeout_ts.tv_nsec = timeout_ns % 1000000000;
+    return op;
+}
+
 #undef ALLOC_OP
 
 void IOUring::UnregisterFd(Descriptor* desc) {
@@ -465,7 +497,14 @@ void IOUring::EnqueueOp(Op* op) {
     case kCancel:
         VLOG_F(1, "Going to cancel op {} (type {}): ",
                (op->root_op >> 8), kOpTypeStr[op->root_op & 0xff]);
-        io_uring_prep_cancel(sqe, reinterpret_cast<void*>(op->root_op), 0);
+        if ((op->root_op & 0xff) == kTimeout) {
+            io_uring_prep_timeout_remove(sqe, op->root_op, 0);
+        } else {
+            io_uring_prep_cancel(sqe, reinterpret_cast<void*>(op->root_op), 0);
+        }
+        break;
+    case kTimeout:
+        io_uring_prep_timeout(sqe, &op->timeout_ts, 0, 0);
         break;
     default:
         UNREACHABLE();
@@ -499,12 +538,15 @@ void IOUring::OnOpComplete(Op* op, struct io_uring_cqe* cqe) {
         HandleCloseOpComplete(op, res);
         break;
     case kCancel:
-        if (res < 0 && res != -EALREADY) {
+        if (res < 0 && res != -EALREADY && res != -ENOENT) {
             LOG_F(WARNING, "Failed to cancel op {} (type {}): {}",
                   (op->root_op >> 8), kOpTypeStr[op->root_op & 0xff],
                   ERRNO_LOGSTR(-res));
         }
         break;
+    case kTimeout:
+        HandleTimeoutOpComplete(op, res);
+        break;
     default:
         UNREACHABLE();
     }
@@ -656,5 +698,21 @@ void IOUring::HandleCloseOpComplete(Op* op, int res) {
     close_cbs_.erase(op->id);
 }
 
+void IOUring::HandleTimeoutOpComplete(Op* op, int res) {
+    DCHECK_EQ(op_type(op), kTimeout);
+    DCHECK(timeout_cbs_.contains(op->id));
+    TimeoutCallback cb;
+    cb.swap(timeout_cbs_[op->id]);
+    timeout_cbs_.erase(op->id);
+    // Pure timeouts complete with -ETIME when expired
+    if (res == -ETIME || res == 0) {
+        cb(false);
+    } else if (res == -ECANCELED) {
+        cb(true);
+    } else {
+        LOG_F(FATAL, "Timeout op failed: {}", ERRNO_LOGSTR(-res));
+    }
+}
+
 }  // namespace server
 }  // namespace faas
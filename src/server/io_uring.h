@@ -42,6 +42,12 @@ public:
     using CloseCallback = std::function<void()>;
     bool Close(int fd, CloseCallback cb);
 
+    // Not tied to any fd. `cb` is invoked with `cancelled` set to true
+    // if the timeout is removed by CancelTimeout before it expires.
+    using TimeoutCallback = std::function<void(bool /* cancelled */)>;
+    bool StartTimeout(absl::Duration timeout, TimeoutCallback cb, uint64_t* timeout_id);
+    bool CancelTimeout(uint64_t timeout_id);
+
     void EventLoopRunOnce(size_t* inflight_ops);
 
 private:
@@ -73,7 +79,8 @@ private:
         kWrite   = 2,
         kSendAll = 3,
         kClose   = 4,
-        kCancel  = 5
+        kCancel  = 5,
+        kTimeout = 6
     };
     static constexpr const char* kOpTypeStr[] = {
         "Connect",
@@ -81,7 +88,8 @@ private:
         "Write",
         "SendAll",
         "Close",
-        "Cancel"
+        "Cancel",
+        "Timeout"
     };
 
     enum {
@@ -109,6 +117,7 @@ private:
         };
         uint64_t root_op;    // Used by kSendAll
         uint64_t next_op;    // Used by kSendAll, kCancel
+        struct __kernel_timespec timeout_ts;  // Used by kTimeout
     };
 
     uint64_t next_op_id_;
@@ -120,6 +129,7 @@ private:
     absl::flat_hash_map</* op_id */ uint64_t, WriteCallback> write_cbs_;
     absl::flat_hash_map</* op_id */ uint64_t, SendAllCallback> sendall_cbs_;
     absl::flat_hash_map</* op_id */ uint64_t, CloseCallback> close_cbs_;
+    absl::flat_hash_map</* op_id */ uint64_t, TimeoutCallback> timeout_cbs_;
 
     stat::Counter ev_loop_counter_;
     stat::Counter wait_timeout_counter_;
@@ -150,6 +160,7 @@ private:
     Op* AllocSendAllOp(Descriptor* desc, std::span<const char> data);
     Op* AllocCloseOp(int fd);
     Op* AllocCancelOp(uint64_t op_id);
+    Op* AllocTimeoutOp(absl::Duration timeout);
 
     void UnregisterFd(Descriptor* desc);
     void EnqueueOp(Op* op);
@@ -160,6 +171,7 @@ private:
     void HandleWriteOpComplete(Op* op, int res);
     void HandleSendallOpComplete(Op* op, int res, Op** next_op);
     void HandleCloseOpComplete(Op* op, int res);
+    void HandleTimeoutOpComplete(Op* op, int res);
 
     void CleanUpFn();
 
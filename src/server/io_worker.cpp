@@ -1,9 +1,12 @@
 #include "server/io_worker.h"
 
+#include "common/time.h"
 #include "server/constants.h"
 
 #include <sys/eventfd.h>
 
+ABSL_FLAG(uint32_t, io_worker_timer_tick_us, 100, "");
+
 namespace faas {
 namespace server {
 
@@ -20,7 +23,11 @@ IOWorker::IOWorker(std::string_view worker_name, size_t write_buffer_size)
       event_loop_thread_(fmt::format("{}/EL", worker_name),
                          absl::bind_front(&IOWorker::EventLoopThreadMain, this)),
       write_buffer_pool_(fmt::format("{}_Write", worker_name), write_buffer_size),
-      connections_on_closing_(0) {}
+      connections_on_closing_(0),
+      timer_wheel_(absl::GetFlag(FLAGS_io_worker_timer_tick_us), GetMonotonicMicroTimestamp()),
+      timer_wheel_deadline_(-1),
+      timer_wheel_timeout_id_(0),
+      timer_wheel_timeout_seqnum_(0) {}
 
 IOWorker::~IOWorker() {
     State state = state_.load();
@@ -169,6 +176,7 @@ void IOWorker::EventLoopThreadMain() {
     do {
         io_uring_.EventLoopRunOnce(&inflight_ops);
         RunIdleFunctions();
+        AdvanceTimerWheel();
     } while (inflight_ops > 0);
     HLOG(INFO) << "Event loop finishes";
     state_.store(kStopped);
@@ -213,6 +221,66 @@ void IOWorker::ScheduleIdleFunction(ConnectionBase* owner, std::function<void()>
     });
 }
 
+uint64_t IOWorker::ScheduleTimer(ConnectionBase* owner, absl::Duration delay,
+                                 std::function<void()> fn) {
+    DCHECK(WithinMyEventLoopThread());
+    ScheduledFunction function = {
+        .owner_id = (owner == nullptr) ? -1 : owner->id(),
+        .fn = fn
+    };
+    return timer_wheel_.AddTimer(
+        GetMonotonicMicroTimestamp(), delay,
+        [this, function = std::move(function)] { InvokeFunction(function); });
+}
+
+uint64_t IOWorker::SchedulePeriodicTimer(ConnectionBase* owner, absl::Duration initial_delay,
+                                         absl::Duration interval, std::function<void()> fn) {
+    DCHECK(WithinMyEventLoopThread());
+    ScheduledFunction function = {
+        .owner_id = (owner == nullptr) ? -1 : owner->id(),
+        .fn = fn
+    };
+    return timer_wheel_.AddPeriodicTimer(
+        GetMonotonicMicroTimestamp(), initial_delay, interval,
+        [this, function = std::move(function)] { InvokeFunction(function); });
+}
+
+bool IOWorker::CancelTimer(uint64_t timer_id) {
+    DCHECK(WithinMyEventLoopThread());
+    return timer_wheel_.CancelTimer(timer_id);
+}
+
+void IOWorker::AdvanceTimerWheel() {
+    if (timer_wheel_.num_timers() == 0
+            || state_.load(std::memory_order_acquire) != kRunning) {
+        return;
+    }
+    int64_t current_timestamp = GetMonotonicMicroTimestamp();
+    timer_wheel_.Advance(current_timestamp);
+    int64_t deadline = timer_wheel_.NextDeadline();
+    if (deadline == -1) {
+        return;
+    }
+    if (timer_wheel_deadline_ != -1) {
+        if (deadline >= timer_wheel_deadline_) {
+            // Armed timeout will fire early enough
+            return;
+        }
+        io_uring_.CancelTimeout(timer_wheel_timeout_id_);
+    }
+    timer_wheel_deadline_ = deadline;
+    uint64_t seqnum = ++timer_wheel_timeout_seqnum_;
+    URING_DCHECK_OK(io_uring_.StartTimeout(
+        absl::Microseconds(std::max<int64_t>(0, deadline - current_timestamp)),
+        [this, seqnum] (bool cancelled) {
+            if (seqnum == timer_wheel_timeout_seqnum_) {
+                timer_wheel_deadline_ = -1;
+            }
+        },
+        &timer_wheel_timeout_id_
+    ));
+}
+
 void IOWorker::RunScheduledFunctions() {
     DCHECK(WithinMyEventLoopThread());
     if (state_.load(std::memory_order_acquire) != kRunning) {
@@ -257,6 +325,11 @@ void IOWorker::StopInternal() {
     }
     HLOG(INFO) << "Start stopping process";
     state_.store(kStopping);
+    timer_wheel_.CancelAll();
+    if (timer_wheel_deadline_ != -1) {
+        io_uring_.CancelTimeout(timer_wheel_timeout_id_);
+        timer_wheel_deadline_ = -1;
+    }
     if (connections_.empty() && connections_on_closing_ == 0) {
         CloseWorkerFds();
     } else {
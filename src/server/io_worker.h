@@ -5,6 +5,7 @@
 #include "utils/buffer_pool.h"
 #include "utils/round_robin_set.h"
 #include "server/io_uring.h"
+#include "server/timer_wheel.h"
 
 namespace faas {
 namespace server {
@@ -88,6 +89,16 @@ public:
     // Idle functions will be invoked at the end of each event loop iteration.
     void ScheduleIdleFunction(ConnectionBase* owner, std::function<void()> fn);
 
+    // Timers are managed by a per-worker timer wheel, driven by a single
+    // io_uring timeout. They can only be added or cancelled from this
+    // worker's event loop. Like ScheduleFunction, the function will not
+    // run if its owner connection is closed.
+    uint64_t ScheduleTimer(ConnectionBase* owner, absl::Duration delay,
+                           std::function<void()> fn);
+    uint64_t SchedulePeriodicTimer(ConnectionBase* owner, absl::Duration initial_delay,
+                                   absl::Duration interval, std::function<void()> fn);
+    bool CancelTimer(uint64_t timer_id);
+
 private:
     enum State { kCreated, kRunning, kStopping, kStopped };
 
@@ -117,10 +128,17 @@ private:
         scheduled_functions_ ABSL_GUARDED_BY(scheduled_function_mu_);
     absl::InlinedVector<ScheduledFunction, 16> idle_functions_;
 
+    TimerWheel timer_wheel_;
+    // Deadline of the armed io_uring timeout, -1 if not armed
+    int64_t timer_wheel_deadline_;
+    uint64_t timer_wheel_timeout_id_;
+    uint64_t timer_wheel_timeout_seqnum_;
+
     void EventLoopThreadMain();
     void RunScheduledFunctions();
     void RunIdleFunctions();
     void InvokeFunction(const ScheduledFunction& function);
+    void AdvanceTimerWheel();
     void StopInternal();
     void CloseWorkerFds();
 
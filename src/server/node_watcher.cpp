@@ -122,6 +122,7 @@ const absl::flat_hash_map<ConnType, NodeTypePair> kNodeTypeTable {
     { ConnType::STORAGE_TO_ENGINE,      NODE_PAIR(Storage, Engine) },
     { ConnType::SEQUENCER_TO_STORAGE,   NODE_PAIR(Sequencer, Storage) },
     { ConnType::STORAGE_TO_SEQUENCER,   NODE_PAIR(Storage, Sequencer) },
+    { ConnType::STORAGE_TO_STORAGE,     NODE_PAIR(Storage, Storage) },
 };
 
 #undef NODE_PAIR
@@ -314,6 +314,7 @@ const absl::flat_hash_map<ConnType, ConnTypeIdPair> kConnTypeIdTable {
     { ConnType::STORAGE_TO_ENGINE,      CONN_ID_PAIR(Storage, Engine) },
     { ConnType::SEQUENCER_TO_STORAGE,   CONN_ID_PAIR(Sequencer, Storage) },
     { ConnType::STORAGE_TO_SEQUENCER,   CONN_ID_PAIR(Storage, Sequencer) },
+    { ConnType::STORAGE_TO_STORAGE,     CONN_ID_PAIR(Storage, Storage) },
 };
 
 #undef CONN_ID_PAIR
@@ -1,7 +1,5 @@
 #include "server/timer.h"
 
-#include "utils/io.h"
-#include "utils/timerfd.h"
 #include "server/constants.h"
 
 namespace faas {
@@ -13,11 +11,10 @@ Timer::Timer(int timer_type, Callback cb)
       cb_(cb),
       io_worker_(nullptr),
       state_(kCreated),
-      timerfd_(-1) {}
+      timer_id_(TimerWheel::kInvalidTimerId) {}
 
 Timer::~Timer() {
     DCHECK(state_ == kCreated || state_ == kClosed);
-    DCHECK(timerfd_ == -1);
 }
 
 void Timer::SetPeriodic(absl::Time initial, absl::Duration interval) {
@@ -30,10 +27,6 @@ void Timer::SetPeriodic(absl::Time initial, absl::Duration interval) {
 void Timer::Start(server::IOWorker* io_worker) {
     DCHECK(io_worker->WithinMyEventLoopThread());
     io_worker_ = io_worker;
-    timerfd_ = io_utils::CreateTimerFd();
-    CHECK(timerfd_ != -1);
-    io_utils::FdUnsetNonblocking(timerfd_);
-    URING_DCHECK_OK(current_io_uring()->RegisterFd(timerfd_));
     state_ = kIdle;
     if (periodic_) {
         absl::Duration initial_duration = initial_ - absl::Now();
@@ -41,32 +34,26 @@ void Timer::Start(server::IOWorker* io_worker) {
             LOG(WARNING) << "Has past the initial duration";
             initial_duration = absl::Microseconds(1);
         }
-        CHECK(io_utils::SetupTimerFdPeriodic(timerfd_, initial_duration, interval_));
+        timer_id_ = io_worker_->SchedulePeriodicTimer(
+            this, initial_duration, interval_,
+            [this] () {
+                if (state_ == kScheduled) {
+                    cb_();
+                }
+            }
+        );
         state_ = kScheduled;
     }
-    URING_DCHECK_OK(current_io_uring()->StartRead(
-        timerfd_, kOctaBufGroup,
-        [this] (int status, std::span<const char> data) -> bool {
-            if (state_ != kScheduled) {
-                return false;
-            }
-            if (!periodic_) {
-                state_ = kIdle;
-            }
-            cb_();
-            return true;
-        }
-    ));
 }
 
 void Timer::ScheduleClose() {
     DCHECK(io_worker_->WithinMyEventLoopThread());
-    state_ = kClosing;
-    URING_DCHECK_OK(current_io_uring()->Close(timerfd_, [this] () {
-        timerfd_ = -1;
-        state_ = kClosed;
-        io_worker_->OnConnectionClose(this);
-    }));
+    if (state_ == kScheduled) {
+        io_worker_->CancelTimer(timer_id_);
+    }
+    timer_id_ = TimerWheel::kInvalidTimerId;
+    state_ = kClosed;
+    io_worker_->OnConnectionClose(this);
 }
 
 bool Timer::TriggerIn(absl::Duration d) {
@@ -77,7 +64,15 @@ bool Timer::TriggerIn(absl::Duration d) {
         return false;
     }
     state_ = kScheduled;
-    CHECK(io_utils::SetupTimerFdOneTime(timerfd_, d));
+    timer_id_ = io_worker_->ScheduleTimer(
+        this, d,
+        [this] () {
+            DCHECK(state_ == kScheduled);
+            state_ = kIdle;
+            timer_id_ = TimerWheel::kInvalidTimerId;
+            cb_();
+        }
+    );
     return true;
 }
 
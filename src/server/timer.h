@@ -20,7 +20,7 @@ public:
     bool TriggerIn(absl::Duration d);
 
 private:
-    enum State { kCreated, kIdle, kScheduled, kClosing, kClosed };
+    enum State { kCreated, kIdle, kScheduled, kClosed };
 
     bool periodic_;
     absl::Time initial_;
@@ -29,7 +29,7 @@ private:
     Callback cb_;
     IOWorker* io_worker_;
     State state_;
-    int timerfd_;
+    uint64_t timer_id_;
 
     DISALLOW_COPY_AND_ASSIGN(Timer);
 };
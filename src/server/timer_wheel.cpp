@@ -0,0 +1,233 @@
+#include "server/timer_wheel.h"
+
+namespace faas {
+namespace server {
+
+TimerWheel::TimerWheel(int64_t tick_us, int64_t now_us)
+    : tick_us_(tick_us),
+      current_tick_(now_us / tick_us),
+      next_timer_id_(1),
+      expiring_(nullptr),
+      running_(nullptr),
+      running_cancelled_(false) {
+    CHECK_GT(tick_us, 0);
+    for (int level = 0; level < kNumLevels; level++) {
+        for (int slot = 0; slot < kSlotsPerLevel; slot++) {
+            slots_[level][slot] = nullptr;
+        }
+        occupied_[level] = 0;
+    }
+}
+
+TimerWheel::~TimerWheel() {}
+
+int64_t TimerWheel::DurationToTicks(absl::Duration d) const {
+    int64_t us = std::max<int64_t>(0, absl::ToInt64Microseconds(d));
+    // Round up, so that timers never fire earlier than requested
+    return (us + tick_us_ - 1) / tick_us_;
+}
+
+uint64_t TimerWheel::AddTimer(int64_t now_us, absl::Duration delay, Callback cb) {
+    int64_t expiry_us = now_us + absl::ToInt64Microseconds(delay);
+    return NewTimer(now_us, (expiry_us + tick_us_ - 1) / tick_us_, 0, cb);
+}
+
+uint64_t TimerWheel::AddPeriodicTimer(int64_t now_us, absl::Duration initial_delay,
+                                      absl::Duration interval, Callback cb) {
+    int64_t expiry_us = now_us + absl::ToInt64Microseconds(initial_delay);
+    int64_t interval_ticks = std::max<int64_t>(1, DurationToTicks(interval));
+    return NewTimer(now_us, (expiry_us + tick_us_ - 1) / tick_us_, interval_ticks, cb);
+}
+
+uint64_t TimerWheel::NewTimer(int64_t now_us, int64_t expiry_tick, int64_t interval_ticks,
+                              Callback cb) {
+    if (timers_.empty()) {
+        // Advance is not called when there is no timer, so skip all idle ticks
+        current_tick_ = std::max(current_tick_, now_us / tick_us_);
+    }
+    Entry* entry = entry_pool_.Get();
+    entry->id = next_timer_id_++;
+    entry->expiry_tick = expiry_tick;
+    entry->interval_ticks = interval_ticks;
+    entry->cb = std::move(cb);
+    PlaceEntry(entry);
+    timers_[entry->id] = entry;
+    return entry->id;
+}
+
+bool TimerWheel::CancelTimer(uint64_t timer_id) {
+    if (!timers_.contains(timer_id)) {
+        return false;
+    }
+    Entry* entry = timers_[timer_id];
+    timers_.erase(timer_id);
+    UnlinkEntry(entry);
+    if (entry == running_) {
+        // Defer freeing it until its callback returns
+        running_cancelled_ = true;
+    } else {
+        FreeEntry(entry);
+    }
+    return true;
+}
+
+void TimerWheel::CancelAll() {
+    std::vector<uint64_t> timer_ids;
+    timer_ids.reserve(timers_.size());
+    for (const auto& [timer_id, entry] : timers_) {
+        timer_ids.push_back(timer_id);
+    }
+    for (uint64_t timer_id : timer_ids) {
+        CancelTimer(timer_id);
+    }
+}
+
+size_t TimerWheel::Advance(int64_t now_us) {
+    int64_t now_tick = now_us / tick_us_;
+    size_t fired = 0;
+    while (current_tick_ <= now_tick) {
+        if (timers_.empty()) {
+            current_tick_ = now_tick + 1;
+            break;
+        }
+        fired += ProcessTick(current_tick_);
+    }
+    return fired;
+}
+
+namespace {
+inline uint64_t RotateRight(uint64_t x, int n) {
+    return n == 0 ? x : ((x >> n) | (x << (64 - n)));
+}
+}  // namespace
+
+int64_t TimerWheel::NextDeadline() const {
+    if (timers_.empty()) {
+        return -1;
+    }
+    int idx = static_cast<int>(current_tick_ & (kSlotsPerLevel - 1));
+    int64_t dist = kSlotsPerLevel;
+    if (occupied_[0] != 0) {
+        dist = __builtin_ctzll(RotateRight(occupied_[0], idx));
+    }
+    for (int level = 1; level < kNumLevels; level++) {
+        if (occupied_[level] != 0) {
+            // Need to wake up at the next cascade point
+            dist = std::min<int64_t>(dist, (kSlotsPerLevel - idx) & (kSlotsPerLevel - 1));
+            break;
+        }
+    }
+    return (current_tick_ + dist) * tick_us_;
+}
+
+void TimerWheel::PlaceEntry(Entry* entry) {
+    int64_t delta = std::clamp<int64_t>(entry->expiry_tick - current_tick_, 0, kMaxTicks);
+    int64_t expiry_tick = current_tick_ + delta;
+    int level = 0;
+    while (level < kNumLevels - 1 && delta >= (int64_t{1} << (kLevelBits * (level + 1)))) {
+        level++;
+    }
+    int slot = static_cast<int>((expiry_tick >> (kLevelBits * level)) & (kSlotsPerLevel - 1));
+    LinkEntry(entry, level, slot);
+}
+
+void TimerWheel::LinkEntry(Entry* entry, int level, int slot) {
+    Entry** head = (level == kExpiringLevel) ? &expiring_ : &slots_[level][slot];
+    entry->level = level;
+    entry->slot = slot;
+    entry->prev = nullptr;
+    entry->next = *head;
+    if (*head != nullptr) {
+        (*head)->prev = entry;
+    }
+    *head = entry;
+    if (level < kNumLevels) {
+        occupied_[level] |= uint64_t{1} << slot;
+    }
+}
+
+void TimerWheel::UnlinkEntry(Entry* entry) {
+    int level = entry->level;
+    Entry** head = (level == kExpiringLevel) ? &expiring_ : &slots_[level][entry->slot];
+    if (entry->prev != nullptr) {
+        entry->prev->next = entry->next;
+    } else {
+        DCHECK(*head == entry);
+        *head = entry->next;
+    }
+    if (entry->next != nullptr) {
+        entry->next->prev = entry->prev;
+    }
+    entry->prev = nullptr;
+    entry->next = nullptr;
+    if (level < kNumLevels && *head == nullptr) {
+        occupied_[level] &= ~(uint64_t{1} << entry->slot);
+    }
+}
+
+void TimerWheel::Cascade(int level) {
+    int slot = static_cast<int>(
+        (current_tick_ >> (kLevelBits * level)) & (kSlotsPerLevel - 1));
+    Entry* entry = slots_[level][slot];
+    slots_[level][slot] = nullptr;
+    occupied_[level] &= ~(uint64_t{1} << slot);
+    while (entry != nullptr) {
+        Entry* next = entry->next;
+        PlaceEntry(entry);
+        entry = next;
+    }
+}
+
+size_t TimerWheel::ProcessTick(int64_t tick) {
+    DCHECK_EQ(tick, current_tick_);
+    DCHECK(expiring_ == nullptr);
+    for (int level = 1; level < kNumLevels; level++) {
+        if (((tick >> (kLevelBits * (level - 1))) & (kSlotsPerLevel - 1)) != 0) {
+            break;
+        }
+        Cascade(level);
+    }
+    int slot = static_cast<int>(tick & (kSlotsPerLevel - 1));
+    Entry* entry = slots_[0][slot];
+    slots_[0][slot] = nullptr;
+    occupied_[0] &= ~(uint64_t{1} << slot);
+    while (entry != nullptr) {
+        Entry* next = entry->next;
+        LinkEntry(entry, kExpiringLevel, 0);
+        entry = next;
+    }
+    // Timers added by callbacks will go to later ticks
+    current_tick_ = tick + 1;
+    size_t fired = 0;
+    while (expiring_ != nullptr) {
+        entry = expiring_;
+        UnlinkEntry(entry);
+        fired++;
+        if (entry->interval_ticks == 0) {
+            timers_.erase(entry->id);
+            Callback cb = std::move(entry->cb);
+            FreeEntry(entry);
+            cb();
+        } else {
+            entry->expiry_tick = std::max(entry->expiry_tick + entry->interval_ticks,
+                                          current_tick_);
+            PlaceEntry(entry);
+            running_ = entry;
+            entry->cb();
+            running_ = nullptr;
+            if (running_cancelled_) {
+                running_cancelled_ = false;
+                FreeEntry(entry);
+            }
+        }
+    }
+    return fired;
+}
+
+void TimerWheel::FreeEntry(Entry* entry) {
+    entry->cb = nullptr;
+    entry_pool_.Return(entry);
+}
+
+}  // namespace server
+}  // namespace faas
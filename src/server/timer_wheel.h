@@ -0,0 +1,91 @@
+#pragma once
+
+#include "base/common.h"
+#include "utils/object_pool.h"
+
+namespace faas {
+namespace server {
+
+// Hierarchical timer wheel (in the style of the classic Linux kernel timer
+// wheel). Adding, cancelling and expiring a timer are all O(1).
+// TimerWheel is NOT thread-safe. It does not own a clock either: its owner
+// is responsible for calling `Advance` with the current monotonic time, and
+// can use `NextDeadline` to decide when to wake up next.
+class TimerWheel {
+public:
+    using Callback = std::function<void()>;
+    static constexpr uint64_t kInvalidTimerId = 0;
+
+    TimerWheel(int64_t tick_us, int64_t now_us);
+    ~TimerWheel();
+
+    int64_t tick_us() const { return tick_us_; }
+    size_t num_timers() const { return timers_.size(); }
+
+    // Return the id of the new timer
+    uint64_t AddTimer(int64_t now_us, absl::Duration delay, Callback cb);
+    uint64_t AddPeriodicTimer(int64_t now_us, absl::Duration initial_delay,
+                              absl::Duration interval, Callback cb);
+    // Return false if the timer has already fired (for one-shot timers)
+    // or been cancelled. Timers can be cancelled from within callbacks.
+    bool CancelTimer(uint64_t timer_id);
+    void CancelAll();
+
+    // Run callbacks of all timers expired by `now_us`.
+    // Return the number of fired timers.
+    size_t Advance(int64_t now_us);
+
+    // Return the (monotonic) time by which `Advance` should be called
+    // again, or -1 if there is no timer.
+    int64_t NextDeadline() const;
+
+private:
+    static constexpr int kLevelBits = 6;
+    static constexpr int kSlotsPerLevel = 1 << kLevelBits;
+    static constexpr int kNumLevels = 4;
+    static constexpr int kExpiringLevel = kNumLevels;
+    static constexpr int64_t kMaxTicks = (int64_t{1} << (kLevelBits * kNumLevels)) - 1;
+
+    struct Entry {
+        uint64_t id;
+        int64_t  expiry_tick;
+        int64_t  interval_ticks;  // Zero for one-shot timers
+        int      level;
+        int      slot;
+        Entry*   prev;
+        Entry*   next;
+        Callback cb;
+    };
+
+    int64_t tick_us_;
+    // All ticks before `current_tick_` have been processed
+    int64_t current_tick_;
+    uint64_t next_timer_id_;
+
+    Entry* slots_[kNumLevels][kSlotsPerLevel];
+    uint64_t occupied_[kNumLevels];
+    // Entries of the slot being processed in `Advance`
+    Entry* expiring_;
+    // Periodic timer whose callback is running
+    Entry* running_;
+    bool running_cancelled_;
+
+    utils::SimpleObjectPool<Entry> entry_pool_;
+    absl::flat_hash_map</* timer_id */ uint64_t, Entry*> timers_;
+
+    int64_t DurationToTicks(absl::Duration d) const;
+    uint64_t NewTimer(int64_t now_us, int64_t expiry_tick, int64_t interval_ticks,
+                      Callback cb);
+
+    void PlaceEntry(Entry* entry);
+    void LinkEntry(Entry* entry, int level, int slot);
+    void UnlinkEntry(Entry* entry);
+    void Cascade(int level);
+    size_t ProcessTick(int64_t tick);
+    void FreeEntry(Entry* entry);
+
+    DISALLOW_COPY_AND_ASSIGN(TimerWheel);
+};
+
+}  // namespace server
+}  // namespace faas
@@ -29,6 +29,11 @@ inline uint16_t HighHalf32(uint32_t x) {
     return gsl::narrow_cast<uint16_t>(x >> 16);
 }
 
+template<class T>
+inline T AlignUp(T x, T alignment) {
+    return (x + alignment - 1) / alignment * alignment;
+}
+
 inline std::string HexStr(uint64_t x) {
     return fmt::format("{:016x}", x);
 }
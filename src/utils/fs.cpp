@@ -3,6 +3,7 @@
 
 #include <fcntl.h>
 #include <ftw.h>
+#include <dirent.h>
 
 namespace faas {
 namespace fs_utils {
@@ -82,6 +83,23 @@ bool ReadContents(std::string_view path, std::string* contents) {
     return true;
 }
 
+bool ListDirectory(std::string_view path, std::vector<std::string>* names) {
+    DIR* dir = opendir(std::string(path).c_str());
+    if (dir == nullptr) {
+        PLOG(ERROR) << "Failed to open directory: " << path;
+        return false;
+    }
+    auto close_dir = gsl::finally([dir] { closedir(dir); });
+    names->clear();
+    while (struct dirent* entry = readdir(dir)) {
+        std::string_view name(entry->d_name);
+        if (name != "." && name != "..") {
+            names->push_back(std::string(name));
+        }
+    }
+    return true;
+}
+
 std::optional<int> Open(std::string_view full_path, int flags) {
     int fd = open(std::string(full_path).c_str(), flags | O_CLOEXEC);
     if (fd == -1) {
@@ -13,6 +13,8 @@ bool MakeDirectory(std::string_view path);
 bool Remove(std::string_view path);
 bool RemoveDirectoryRecursively(std::string_view path);
 bool ReadContents(std::string_view path, std::string* contents);
+// Names of entries in the directory, excluding "." and ".."
+bool ListDirectory(std::string_view path, std::vector<std::string>* names);
 
 // Return fd on success
 std::optional<int> Open(std::string_view full_path, int flags);
@@ -15,5 +15,9 @@ uint64_t xxHash64(IntType value, uint64_t seed = kDefaultHashSeed64) {
     return XXH64(&value, sizeof(IntType), seed);
 }
 
+inline uint64_t xxHash64(std::span<const char> data, uint64_t seed = kDefaultHashSeed64) {
+    return XXH64(data.data(), data.size(), seed);
+}
+
 }  // namespace hash
 }  // namespace faas
@@ -119,7 +119,11 @@ void FuncWorker::MainServingLoop() {
         Message message;
         PCHECK(io_utils::RecvMessage(input_pipe_fd_, &message, nullptr))
             << "Failed to receive message from engine";
-        if (MessageHelper::IsDispatchFuncCall(message)) {
+        if (MessageHelper::IsFuncCallBatch(message)) {
+            MessageHelper::ForEachInFuncCallBatch(message, [this] (const Message& call) {
+                ExecuteFunc(call);
+            });
+        } else if (MessageHelper::IsDispatchFuncCall(message)) {
             ExecuteFunc(message);
         } else {
             LOG(FATAL) << "Unknown message type";
@@ -140,6 +144,8 @@ void FuncWorker::HandshakeWithEngine() {
             ipc::GetFuncWorkerInputFifoName(client_id_)).value_or(-1);
     }
     Message message = MessageHelper::NewFuncWorkerHandshake(func_id_, client_id_);
+    // Calls of a batch are executed in order by MainServingLoop
+    message.flags |= protocol::kFuncCallBatchFlag;
     PCHECK(io_utils::SendMessage(engine_sock_fd_, message));
     Message response;
     CHECK(io_utils::RecvMessage(engine_sock_fd_, &response, nullptr))
@@ -48,24 +48,35 @@ const (
 
 // SharedLogOpType enum
 const (
-	SharedLogOpType_INVALID     uint16 = 0x00
-	SharedLogOpType_APPEND      uint16 = 0x01
-	SharedLogOpType_READ_NEXT   uint16 = 0x02
-	SharedLogOpType_READ_PREV   uint16 = 0x03
-	SharedLogOpType_TRIM        uint16 = 0x04
-	SharedLogOpType_SET_AUXDATA uint16 = 0x05
-	SharedLogOpType_READ_NEXT_B uint16 = 0x06
+	SharedLogOpType_INVALID         uint16 = 0x00
+	SharedLogOpType_APPEND          uint16 = 0x01
+	SharedLogOpType_READ_NEXT       uint16 = 0x02
+	SharedLogOpType_READ_PREV       uint16 = 0x03
+	SharedLogOpType_TRIM            uint16 = 0x04
+	SharedLogOpType_SET_AUXDATA     uint16 = 0x05
+	SharedLogOpType_READ_NEXT_B     uint16 = 0x06
+	SharedLogOpType_READ_NEXT_MT    uint16 = 0x07
+	SharedLogOpType_READ_PREV_MT    uint16 = 0x08
+	SharedLogOpType_COUNT           uint16 = 0x09
+	SharedLogOpType_READ_SNAPSHOT   uint16 = 0x0A
+	SharedLogOpType_SET_CHECKPOINT  uint16 = 0x0B
+	SharedLogOpType_READ_CHECKPOINT uint16 = 0x0C
+	SharedLogOpType_QUEUE_POP       uint16 = 0x0D
+	SharedLogOpType_QUEUE_POP_B     uint16 = 0x0E
 )
 
 // SharedLogResultType enum
 const (
 	SharedLogResultType_INVALID uint16 = 0x00
 	// Successful results
-	SharedLogResultType_APPEND_OK  uint16 = 0x20
-	SharedLogResultType_READ_OK    uint16 = 0x21
-	SharedLogResultType_TRIM_OK    uint16 = 0x22
-	SharedLogResultType_LOCALID    uint16 = 0x23
-	SharedLogResultType_AUXDATA_OK uint16 = 0x24
+	SharedLogResultType_APPEND_OK     uint16 = 0x20
+	SharedLogResultType_READ_OK       uint16 = 0x21
+	SharedLogResultType_TRIM_OK       uint16 = 0x22
+	SharedLogResultType_LOCALID       uint16 = 0x23
+	SharedLogResultType_AUXDATA_OK    uint16 = 0x24
+	SharedLogResultType_COUNT_OK      uint16 = 0x25
+	SharedLogResultType_SNAPSHOT_OK   uint16 = 0x26
+	SharedLogResultType_CHECKPOINT_OK uint16 = 0x27
 	// Error results
 	SharedLogResultType_BAD_ARGS    uint16 = 0x30
 	SharedLogResultType_DISCARDED   uint16 = 0x31
@@ -76,6 +87,9 @@ const (
 
 const MaxLogSeqnum = uint64(0xffff000000000000)
 
+// Matches kInvalidLogSeqNum in common/protocol.h
+const InvalidLogSeqnum = ^uint64(0)
+
 const MessageTypeBits = 4
 
 // Matches __FAAS_CACHE_LINE_SIZE in base/macro.h
@@ -91,12 +105,23 @@ const (
 	FLAG_FuncWorkerUseEngineSocket uint32 = (1 << 0)
 	FLAG_UseFifoForNestedCall      uint32 = (1 << 1)
 	FLAG_kAsyncInvokeFuncFlag      uint32 = (1 << 2)
+	FLAG_FuncCallBatch             uint32 = (1 << 3)
+	FLAG_LogReadMatchAllTags       uint32 = (1 << 4)
+	FLAG_LogCheckpointTailComplete uint32 = (1 << 5)
+	FLAG_LogCountExists            uint32 = (1 << 6)
 )
 
+// Matches sizeof(FuncCallBatchEntry) in common/protocol.h
+const FuncCallBatchEntryByteSize = 16
+
 func GetFlagsFromMessage(buffer []byte) uint32 {
 	return binary.LittleEndian.Uint32(buffer[28:32])
 }
 
+func SetFlagsInMessage(buffer []byte, flags uint32) {
+	binary.LittleEndian.PutUint32(buffer[28:32], flags)
+}
+
 func GetFuncCallFromMessage(buffer []byte) FuncCall {
 	tmp := binary.LittleEndian.Uint64(buffer[0:8])
 	return FuncCallFromFullCallId(tmp >> MessageTypeBits)
@@ -114,6 +139,10 @@ func GetLogSeqNumFromMessage(buffer []byte) uint64 {
 	return binary.LittleEndian.Uint64(buffer[8:16])
 }
 
+func GetLogCountFromMessage(buffer []byte) uint64 {
+	return binary.LittleEndian.Uint64(buffer[8:16])
+}
+
 func GetLogNumTagsFromMessage(buffer []byte) int {
 	return int(binary.LittleEndian.Uint16(buffer[36:38]))
 }
@@ -148,6 +177,10 @@ func IsDispatchFuncCallMessage(buffer []byte) bool {
 	return getMessageType(buffer) == MessageType_DISPATCH_FUNC_CALL
 }
 
+func IsFuncCallBatchMessage(buffer []byte) bool {
+	return IsDispatchFuncCallMessage(buffer) && (GetFlagsFromMessage(buffer)&FLAG_FuncCallBatch) != 0
+}
+
 func IsFuncCallCompleteMessage(buffer []byte) bool {
 	return getMessageType(buffer) == MessageType_FUNC_CALL_COMPLETE
 }
@@ -230,6 +263,94 @@ func NewSharedLogReadMessage(currentCallId uint64, myClientId uint16, tag uint64
 	return buffer
 }
 
+func NewSharedLogMultiTagReadMessage(currentCallId uint64, myClientId uint16, numTags uint16, matchAll bool, seqNum uint64, direction int, clientData uint64) []byte {
+	buffer := NewEmptyMessage()
+	tmp := (currentCallId << MessageTypeBits) + uint64(MessageType_SHARED_LOG_OP)
+	binary.LittleEndian.PutUint64(buffer[0:8], tmp)
+	if direction > 0 {
+		binary.LittleEndian.PutUint16(buffer[32:34], SharedLogOpType_READ_NEXT_MT)
+	} else {
+		binary.LittleEndian.PutUint16(buffer[32:34], SharedLogOpType_READ_PREV_MT)
+	}
+	if matchAll {
+		binary.LittleEndian.PutUint32(buffer[28:32], FLAG_LogReadMatchAllTags)
+	}
+	binary.LittleEndian.PutUint16(buffer[34:36], myClientId)
+	binary.LittleEndian.PutUint16(buffer[36:38], numTags)
+	binary.LittleEndian.PutUint64(buffer[48:56], clientData)
+	binary.LittleEndian.PutUint64(buffer[8:16], seqNum)
+	return buffer
+}
+
+func NewSharedLogCountMessage(currentCallId uint64, myClientId uint16, tag uint64, startSeqNum uint64, endSeqNum uint64, clientData uint64) []byte {
+	buffer := NewEmptyMessage()
+	tmp := (currentCallId << MessageTypeBits) + uint64(MessageType_SHARED_LOG_OP)
+	binary.LittleEndian.PutUint64(buffer[0:8], tmp)
+	binary.LittleEndian.PutUint16(buffer[32:34], SharedLogOpType_COUNT)
+	binary.LittleEndian.PutUint16(buffer[34:36], myClientId)
+	binary.LittleEndian.PutUint64(buffer[40:48], tag)
+	binary.LittleEndian.PutUint64(buffer[48:56], clientData)
+	binary.LittleEndian.PutUint64(buffer[8:16], startSeqNum)
+	binary.LittleEndian.PutUint64(buffer[56:64], endSeqNum)
+	return buffer
+}
+
+// Matches READ_SNAPSHOT in common/protocol.h, whose inline data holds
+// query tags followed by seqnum bounds
+func NewSharedLogSnapshotReadMessage(currentCallId uint64, myClientId uint16, numReads uint16, snapshotSeqNum uint64, clientData uint64) []byte {
+	buffer := NewEmptyMessage()
+	tmp := (currentCallId << MessageTypeBits) + uint64(MessageType_SHARED_LOG_OP)
+	binary.LittleEndian.PutUint64(buffer[0:8], tmp)
+	binary.LittleEndian.PutUint16(buffer[32:34], SharedLogOpType_READ_SNAPSHOT)
+	binary.LittleEndian.PutUint16(buffer[34:36], myClientId)
+	binary.LittleEndian.PutUint16(buffer[36:38], numReads)
+	binary.LittleEndian.PutUint64(buffer[48:56], clientData)
+	binary.LittleEndian.PutUint64(buffer[8:16], snapshotSeqNum)
+	return buffer
+}
+
+// Matches SET_CHECKPOINT in common/protocol.h, whose inline data holds
+// checkpoint data
+func NewSharedLogSetCheckpointMessage(currentCallId uint64, myClientId uint16, tag uint64, seqNum uint64, clientData uint64) []byte {
+	buffer := NewEmptyMessage()
+	tmp := (currentCallId << MessageTypeBits) + uint64(MessageType_SHARED_LOG_OP)
+	binary.LittleEndian.PutUint64(buffer[0:8], tmp)
+	binary.LittleEndian.PutUint16(buffer[32:34], SharedLogOpType_SET_CHECKPOINT)
+	binary.LittleEndian.PutUint16(buffer[34:36], myClientId)
+	binary.LittleEndian.PutUint64(buffer[40:48], tag)
+	binary.LittleEndian.PutUint64(buffer[48:56], clientData)
+	binary.LittleEndian.PutUint64(buffer[8:16], seqNum)
+	return buffer
+}
+
+func NewSharedLogReadCheckpointMessage(currentCallId uint64, myClientId uint16, tag uint64, seqNum uint64, clientData uint64) []byte {
+	buffer := NewEmptyMessage()
+	tmp := (currentCallId << MessageTypeBits) + uint64(MessageType_SHARED_LOG_OP)
+	binary.LittleEndian.PutUint64(buffer[0:8], tmp)
+	binary.LittleEndian.PutUint16(buffer[32:34], SharedLogOpType_READ_CHECKPOINT)
+	binary.LittleEndian.PutUint16(buffer[34:36], myClientId)
+	binary.LittleEndian.PutUint64(buffer[40:48], tag)
+	binary.LittleEndian.PutUint64(buffer[48:56], clientData)
+	binary.LittleEndian.PutUint64(buffer[8:16], seqNum)
+	return buffer
+}
+
+// Matches QUEUE_POP and QUEUE_POP_B in common/protocol.h
+func NewSharedLogQueuePopMessage(currentCallId uint64, myClientId uint16, tag uint64, block bool, clientData uint64) []byte {
+	buffer := NewEmptyMessage()
+	tmp := (currentCallId << MessageTypeBits) + uint64(MessageType_SHARED_LOG_OP)
+	binary.LittleEndian.PutUint64(buffer[0:8], tmp)
+	if block {
+		binary.LittleEndian.PutUint16(buffer[32:34], SharedLogOpType_QUEUE_POP_B)
+	} else {
+		binary.LittleEndian.PutUint16(buffer[32:34], SharedLogOpType_QUEUE_POP)
+	}
+	binary.LittleEndian.PutUint16(buffer[34:36], myClientId)
+	binary.LittleEndian.PutUint64(buffer[40:48], tag)
+	binary.LittleEndian.PutUint64(buffer[48:56], clientData)
+	return buffer
+}
+
 func NewSharedLogSetAuxDataMessage(currentCallId uint64, myClientId uint16, seqNum uint64, clientData uint64) []byte {
 	buffer := NewEmptyMessage()
 	tmp := (currentCallId << MessageTypeBits) + uint64(MessageType_SHARED_LOG_OP)
@@ -275,6 +396,29 @@ func GetInlineDataFromMessage(buffer []byte) []byte {
 	}
 }
 
+// Split a batched DISPATCH_FUNC_CALL message into one message per call
+func SplitFuncCallBatchMessage(buffer []byte) [][]byte {
+	sendTimestamp := GetSendTimestampFromMessage(buffer)
+	data := GetInlineDataFromMessage(buffer)
+	messages := make([][]byte, 0, 4)
+	for len(data) >= FuncCallBatchEntryByteSize {
+		fullCallId := binary.LittleEndian.Uint64(data[0:8])
+		payloadSize := int32(binary.LittleEndian.Uint32(data[8:12]))
+		data = data[FuncCallBatchEntryByteSize:]
+		message := NewEmptyMessage()
+		tmp := (fullCallId << MessageTypeBits) + uint64(MessageType_DISPATCH_FUNC_CALL)
+		binary.LittleEndian.PutUint64(message[0:8], tmp)
+		SetSendTimestampInMessage(message, sendTimestamp)
+		SetPayloadSizeInMessage(message, payloadSize)
+		if payloadSize > 0 {
+			copy(message[MessageHeaderByteSize:], data[:payloadSize])
+			data = data[(payloadSize+7)/8*8:]
+		}
+		messages = append(messages, message)
+	}
+	return messages
+}
+
 func SetDispatchDelayInMessage(buffer []byte, dispatchDelay int32) {
 	binary.LittleEndian.PutUint32(buffer[8:12], uint32(dispatchDelay))
 }
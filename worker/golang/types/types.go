@@ -11,6 +11,16 @@ type LogEntry struct {
 	AuxData []byte
 }
 
+// Checkpoint of materialized state, returned with the tail of log entries after it
+type CheckpointEntry struct {
+	SeqNum uint64
+	Data   []byte
+	// Seqnums of logs after the checkpoint, in ascending order
+	TailSeqNums []uint64
+	// True if TailSeqNums includes all logs up to the queried seqnum
+	TailComplete bool
+}
+
 type Environment interface {
 	InvokeFunc(ctx context.Context, funcName string, input []byte) ( /* output */ []byte, error)
 	InvokeFuncAsync(ctx context.Context, funcName string, input []byte) error
@@ -28,10 +38,43 @@ type Environment interface {
 	// Read the last log with `tag` whose seqnum <= given `seqNum`
 	// `tag`==0 means considering log with any tag, including empty tag
 	SharedLogReadPrev(ctx context.Context, tag uint64, seqNum uint64) (*LogEntry, error)
+	// Multi-tag versions of ReadNext and ReadPrev, considering logs with all
+	// (`matchAll`) or any of `tags`, tags must be non-zero
+	SharedLogReadNextMultiTag(ctx context.Context, tags []uint64, matchAll bool, seqNum uint64) (*LogEntry, error)
+	SharedLogReadPrevMultiTag(ctx context.Context, tags []uint64, matchAll bool, seqNum uint64) (*LogEntry, error)
+	// Count logs with `tag` whose seqnum is within [`startSeqNum`, `endSeqNum`],
+	// answered by the index without reading any log entry
+	// `tag`==0 means considering log with any tag, including empty tag
+	SharedLogCount(ctx context.Context, tag uint64, startSeqNum uint64, endSeqNum uint64) (uint64, error)
+	// Same as Count(tag, 0, MaxSeqNum) > 0, but stops at the newest view
+	// that has a matching log, instead of counting through all views
+	SharedLogTagExists(ctx context.Context, tag uint64) (bool, error)
 	// Alias for ReadPrev(tag, MaxSeqNum)
 	SharedLogCheckTail(ctx context.Context, tag uint64) (*LogEntry, error)
+	// Resolve ReadPrev(tags[i], seqNums[i]) against the same snapshot of the
+	// log, returning seqnums of found logs (InvalidLogSeqnum if not found),
+	// and the snapshot, which includes all and only logs with smaller seqnums.
+	// `snapshotSeqNum` is a snapshot returned before, or InvalidLogSeqnum for
+	// a new one. Log data is not returned.
+	SharedLogSnapshotRead(ctx context.Context, tags []uint64, seqNums []uint64, snapshotSeqNum uint64) ( /* results */ []uint64 /* snapshot */, uint64, error)
 	// Set auxiliary data for log entry of given `seqNum`
 	SharedLogSetAuxData(ctx context.Context, seqNum uint64, auxData []byte) error
+	// Register `data` as the checkpoint of materialized state of `tag`, as of
+	// the log of given `seqNum`. Checkpoints are stored by storage nodes, and
+	// become visible to SharedLogReadCheckpoint asynchronously.
+	SharedLogSetCheckpoint(ctx context.Context, tag uint64, seqNum uint64, data []byte) error
+	// Read the latest checkpoint of `tag` whose seqnum <= given `seqNum`,
+	// together with seqnums of logs with `tag` after it. Returns nil if there
+	// is no such checkpoint.
+	SharedLogReadCheckpoint(ctx context.Context, tag uint64, seqNum uint64) (*CheckpointEntry, error)
+	// Read the first log with `tag` after the consumer cursor of the queue,
+	// and move the cursor past it, where logs are pushed by SharedLogAppend
+	// with `tag`. The cursor is kept by the engine. Returns nil if the queue
+	// is empty. The popped log is lost if `ctx` is done before the response.
+	SharedLogQueuePop(ctx context.Context, tag uint64) (*LogEntry, error)
+	// Blocking version of SharedLogQueuePop, which returns nil if no log is
+	// pushed within the timeout of the engine (1 second)
+	SharedLogQueuePopBlock(ctx context.Context, tag uint64) (*LogEntry, error)
 }
 
 type FuncHandler interface {
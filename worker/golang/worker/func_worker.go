@@ -126,6 +126,7 @@ func (w *FuncWorker) doHandshake() error {
 	w.inputPipe = ip
 
 	message := protocol.NewFuncWorkerHandshakeMessage(w.funcId, w.clientId)
+	protocol.SetFlagsInMessage(message, protocol.FLAG_FuncCallBatch)
 	_, err = w.engineConn.Write(message)
 	if err != nil {
 		return err
@@ -178,11 +179,34 @@ func (w *FuncWorker) doHandshake() error {
 func (w *FuncWorker) servingLoop() {
 	for {
 		message := <-w.newFuncCallChan
-		w.executeFunc(message)
+		if protocol.IsFuncCallBatchMessage(message) {
+			w.executeFuncBatch(message)
+		} else {
+			w.writeEngineMessage(w.executeFunc(message))
+		}
+	}
+}
+
+// Run calls of the batch one by one, and send all responses in one write
+func (w *FuncWorker) executeFuncBatch(batchMessage []byte) {
+	messages := protocol.SplitFuncCallBatchMessage(batchMessage)
+	responses := make([]byte, 0, len(messages)*protocol.MessageFullByteSize)
+	for _, message := range messages {
+		responses = append(responses, w.executeFunc(message)...)
 	}
+	w.writeEngineMessage(responses)
 }
 
-func (w *FuncWorker) executeFunc(dispatchFuncMessage []byte) {
+func (w *FuncWorker) writeEngineMessage(message []byte) {
+	w.mux.Lock()
+	_, err := w.outputPipe.Write(message)
+	w.mux.Unlock()
+	if err != nil {
+		log.Fatal("[FATAL] Failed to write engine message!")
+	}
+}
+
+func (w *FuncWorker) executeFunc(dispatchFuncMessage []byte) []byte {
 	dispatchDelay := common.GetMonotonicMicroTimestamp() - protocol.GetSendTimestampFromMessage(dispatchFuncMessage)
 	funcCall := protocol.GetFuncCallFromMessage(dispatchFuncMessage)
 
@@ -197,13 +221,7 @@ func (w *FuncWorker) executeFunc(dispatchFuncMessage []byte) {
 			log.Printf("[ERROR] ShmOpen %s failed: %v", shmName, err)
 			response := protocol.NewFuncCallFailedMessage(funcCall)
 			protocol.SetSendTimestampInMessage(response, common.GetMonotonicMicroTimestamp())
-			w.mux.Lock()
-			_, err = w.outputPipe.Write(response)
-			w.mux.Unlock()
-			if err != nil {
-				log.Fatal("[FATAL] Failed to write engine message!")
-			}
-			return
+			return response
 		}
 		defer inputRegion.Close()
 		input = inputRegion.Data
@@ -244,12 +262,7 @@ func (w *FuncWorker) executeFunc(dispatchFuncMessage []byte) {
 	}
 	protocol.SetDispatchDelayInMessage(response, int32(dispatchDelay))
 	protocol.SetSendTimestampInMessage(response, common.GetMonotonicMicroTimestamp())
-	w.mux.Lock()
-	_, err = w.outputPipe.Write(response)
-	w.mux.Unlock()
-	if err != nil {
-		log.Fatal("[FATAL] Failed to write engine message!")
-	}
+	return response
 }
 
 func (w *FuncWorker) funcCallFinished(funcCall protocol.FuncCall, success bool, output []byte, processingTime int32) []byte {
@@ -678,11 +691,218 @@ func (w *FuncWorker) SharedLogReadPrev(ctx context.Context, tag uint64, seqNum u
 	return w.sharedLogReadCommon(ctx, message, id)
 }
 
+func (w *FuncWorker) sharedLogMultiTagReadCommon(ctx context.Context, tags []uint64, matchAll bool, seqNum uint64, direction int) (*types.LogEntry, error) {
+	tags, err := checkAndDuplicateTags(tags)
+	if err != nil {
+		return nil, err
+	}
+	if len(tags) == 0 {
+		return nil, fmt.Errorf("Tags cannot be empty")
+	}
+	if len(tags)*protocol.SharedLogTagByteSize > protocol.MessageInlineDataSize {
+		return nil, fmt.Errorf("Too many tags (num_tags=%d)", len(tags))
+	}
+	id := atomic.AddUint64(&w.nextLogOpId, 1)
+	currentCallId := atomic.LoadUint64(&w.currentCall)
+	message := protocol.NewSharedLogMultiTagReadMessage(currentCallId, w.clientId, uint16(len(tags)), matchAll, seqNum, direction, id)
+	protocol.FillInlineDataInMessage(message, protocol.BuildLogTagsBuffer(tags))
+	return w.sharedLogReadCommon(ctx, message, id)
+}
+
+// Implement types.Environment
+func (w *FuncWorker) SharedLogReadNextMultiTag(ctx context.Context, tags []uint64, matchAll bool, seqNum uint64) (*types.LogEntry, error) {
+	return w.sharedLogMultiTagReadCommon(ctx, tags, matchAll, seqNum, 1 /* direction */)
+}
+
+// Implement types.Environment
+func (w *FuncWorker) SharedLogReadPrevMultiTag(ctx context.Context, tags []uint64, matchAll bool, seqNum uint64) (*types.LogEntry, error) {
+	return w.sharedLogMultiTagReadCommon(ctx, tags, matchAll, seqNum, -1 /* direction */)
+}
+
+func (w *FuncWorker) sharedLogCountCommon(ctx context.Context, tag uint64, startSeqNum uint64, endSeqNum uint64, existsOnly bool) (uint64, error) {
+	id := atomic.AddUint64(&w.nextLogOpId, 1)
+	currentCallId := atomic.LoadUint64(&w.currentCall)
+	message := protocol.NewSharedLogCountMessage(currentCallId, w.clientId, tag, startSeqNum, endSeqNum, id)
+	if existsOnly {
+		protocol.SetFlagsInMessage(message, protocol.FLAG_LogCountExists)
+	}
+
+	w.mux.Lock()
+	outputChan := make(chan []byte, 1)
+	w.outgoingLogOps[id] = outputChan
+	_, err := w.outputPipe.Write(message)
+	w.mux.Unlock()
+	if err != nil {
+		return 0, err
+	}
+
+	var response []byte
+	select {
+	case <-ctx.Done():
+		return 0, ctx.Err()
+	case response = <-outputChan:
+	}
+	result := protocol.GetSharedLogResultTypeFromMessage(response)
+	if result == protocol.SharedLogResultType_COUNT_OK {
+		return protocol.GetLogCountFromMessage(response), nil
+	} else {
+		return 0, fmt.Errorf("Failed to count logs")
+	}
+}
+
+// Implement types.Environment
+func (w *FuncWorker) SharedLogCount(ctx context.Context, tag uint64, startSeqNum uint64, endSeqNum uint64) (uint64, error) {
+	return w.sharedLogCountCommon(ctx, tag, startSeqNum, endSeqNum, false /* existsOnly */)
+}
+
+// Implement types.Environment
+func (w *FuncWorker) SharedLogTagExists(ctx context.Context, tag uint64) (bool, error) {
+	count, err := w.sharedLogCountCommon(ctx, tag, 0, protocol.MaxLogSeqnum, true /* existsOnly */)
+	if err != nil {
+		return false, err
+	}
+	return count > 0, nil
+}
+
 // Implement types.Environment
 func (w *FuncWorker) SharedLogCheckTail(ctx context.Context, tag uint64) (*types.LogEntry, error) {
 	return w.SharedLogReadPrev(ctx, tag, protocol.MaxLogSeqnum)
 }
 
+// Implement types.Environment
+func (w *FuncWorker) SharedLogSnapshotRead(ctx context.Context, tags []uint64, seqNums []uint64, snapshotSeqNum uint64) ([]uint64, uint64, error) {
+	if len(tags) != len(seqNums) {
+		return nil, 0, fmt.Errorf("Mismatched number of tags and seqnums")
+	}
+	if 2*len(tags)*protocol.SharedLogTagByteSize > protocol.MessageInlineDataSize {
+		return nil, 0, fmt.Errorf("Too many reads (num_reads=%d)", len(tags))
+	}
+	id := atomic.AddUint64(&w.nextLogOpId, 1)
+	currentCallId := atomic.LoadUint64(&w.currentCall)
+	message := protocol.NewSharedLogSnapshotReadMessage(currentCallId, w.clientId, uint16(len(tags)), snapshotSeqNum, id)
+	protocol.FillInlineDataInMessage(message, append(protocol.BuildLogTagsBuffer(tags), protocol.BuildLogTagsBuffer(seqNums)...))
+
+	w.mux.Lock()
+	outputChan := make(chan []byte, 1)
+	w.outgoingLogOps[id] = outputChan
+	_, err := w.outputPipe.Write(message)
+	w.mux.Unlock()
+	if err != nil {
+		return nil, 0, err
+	}
+
+	var response []byte
+	select {
+	case <-ctx.Done():
+		return nil, 0, ctx.Err()
+	case response = <-outputChan:
+	}
+	result := protocol.GetSharedLogResultTypeFromMessage(response)
+	if result != protocol.SharedLogResultType_SNAPSHOT_OK {
+		return nil, 0, fmt.Errorf("Failed to read snapshot")
+	}
+	numReads := protocol.GetLogNumTagsFromMessage(response)
+	results := make([]uint64, numReads)
+	for i := 0; i < numReads; i++ {
+		results[i] = protocol.GetLogTagFromMessage(response, i)
+	}
+	return results, protocol.GetLogSeqNumFromMessage(response), nil
+}
+
+// Implement types.Environment
+func (w *FuncWorker) SharedLogSetCheckpoint(ctx context.Context, tag uint64, seqNum uint64, data []byte) error {
+	if len(data) == 0 {
+		return fmt.Errorf("Checkpoint data cannot be empty")
+	}
+	if len(data) > protocol.MessageInlineDataSize {
+		return fmt.Errorf("Checkpoint data too larger (size=%d), expect no more than %d bytes", len(data), protocol.MessageInlineDataSize)
+	}
+
+	id := atomic.AddUint64(&w.nextLogOpId, 1)
+	currentCallId := atomic.LoadUint64(&w.currentCall)
+	message := protocol.NewSharedLogSetCheckpointMessage(currentCallId, w.clientId, tag, seqNum, id)
+	protocol.FillInlineDataInMessage(message, data)
+
+	w.mux.Lock()
+	outputChan := make(chan []byte, 1)
+	w.outgoingLogOps[id] = outputChan
+	_, err := w.outputPipe.Write(message)
+	w.mux.Unlock()
+	if err != nil {
+		return err
+	}
+
+	var response []byte
+	select {
+	case <-ctx.Done():
+		return ctx.Err()
+	case response = <-outputChan:
+	}
+	result := protocol.GetSharedLogResultTypeFromMessage(response)
+	if result == protocol.SharedLogResultType_CHECKPOINT_OK {
+		return nil
+	} else {
+		return fmt.Errorf("Failed to set checkpoint for log (seqnum %#016x)", seqNum)
+	}
+}
+
+// Implement types.Environment
+func (w *FuncWorker) SharedLogReadCheckpoint(ctx context.Context, tag uint64, seqNum uint64) (*types.CheckpointEntry, error) {
+	id := atomic.AddUint64(&w.nextLogOpId, 1)
+	currentCallId := atomic.LoadUint64(&w.currentCall)
+	message := protocol.NewSharedLogReadCheckpointMessage(currentCallId, w.clientId, tag, seqNum, id)
+
+	w.mux.Lock()
+	outputChan := make(chan []byte, 1)
+	w.outgoingLogOps[id] = outputChan
+	_, err := w.outputPipe.Write(message)
+	w.mux.Unlock()
+	if err != nil {
+		return nil, err
+	}
+
+	var response []byte
+	select {
+	case <-ctx.Done():
+		return nil, ctx.Err()
+	case response = <-outputChan:
+	}
+	result := protocol.GetSharedLogResultTypeFromMessage(response)
+	if result == protocol.SharedLogResultType_EMPTY {
+		return nil, nil
+	} else if result != protocol.SharedLogResultType_CHECKPOINT_OK {
+		return nil, fmt.Errorf("Failed to read checkpoint")
+	}
+	numTailLogs := protocol.GetLogNumTagsFromMessage(response)
+	tailSeqNums := make([]uint64, numTailLogs)
+	for i := 0; i < numTailLogs; i++ {
+		tailSeqNums[i] = protocol.GetLogTagFromMessage(response, i)
+	}
+	responseData := protocol.GetInlineDataFromMessage(response)
+	return &types.CheckpointEntry{
+		SeqNum:       protocol.GetLogSeqNumFromMessage(response),
+		Data:         responseData[numTailLogs*protocol.SharedLogTagByteSize:],
+		TailSeqNums:  tailSeqNums,
+		TailComplete: (protocol.GetFlagsFromMessage(response) & protocol.FLAG_LogCheckpointTailComplete) != 0,
+	}, nil
+}
+
+// Implement types.Environment
+func (w *FuncWorker) SharedLogQueuePop(ctx context.Context, tag uint64) (*types.LogEntry, error) {
+	id := atomic.AddUint64(&w.nextLogOpId, 1)
+	currentCallId := atomic.LoadUint64(&w.currentCall)
+	message := protocol.NewSharedLogQueuePopMessage(currentCallId, w.clientId, tag, false /* block */, id)
+	return w.sharedLogReadCommon(ctx, message, id)
+}
+
+// Implement types.Environment
+func (w *FuncWorker) SharedLogQueuePopBlock(ctx context.Context, tag uint64) (*types.LogEntry, error) {
+	id := atomic.AddUint64(&w.nextLogOpId, 1)
+	currentCallId := atomic.LoadUint64(&w.currentCall)
+	message := protocol.NewSharedLogQueuePopMessage(currentCallId, w.clientId, tag, true /* block */, id)
+	return w.sharedLogReadCommon(ctx, message, id)
+}
+
 // Implement types.Environment
 func (w *FuncWorker) SharedLogSetAuxData(ctx context.Context, seqNum uint64, auxData []byte) error {
 	if len(auxData) == 0 {